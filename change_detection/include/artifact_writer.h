@@ -0,0 +1,90 @@
+#ifndef ARTIFACT_WRITER_H
+#define ARTIFACT_WRITER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <pcl/point_cloud.h>
+#include <pcl/io/pcd_io.h>
+
+//which point clouds get written to disk: nothing, only the final results or also all intermediate debug clouds
+enum ArtifactLevel {ARTIFACTS_NONE, ARTIFACTS_RESULT, ARTIFACTS_DEBUG};
+
+//levels given on the command line or by a client are checked before they are cast to ArtifactLevel
+inline bool isArtifactLevel(int level) {
+    return level >= ARTIFACTS_NONE && level <= ARTIFACTS_DEBUG;
+}
+
+//single sink for all point clouds written by the pipeline. Clouds are copied when they are queued and written
+//as binary compressed PCD files by a background thread. If the queue is full, the caller waits for the writer.
+class ArtifactWriter
+{
+public:
+    static ArtifactWriter& instance();
+
+    ~ArtifactWriter();
+
+    void setLevel(ArtifactLevel level);
+    ArtifactLevel getLevel() const;
+    bool isEnabled(ArtifactLevel level) const { return level != ARTIFACTS_NONE && level <= getLevel(); }
+
+    void setMaxQueueSize(size_t max_queue_size);
+
+    template <typename PointT>
+    void save(ArtifactLevel level, const std::string &path, const pcl::PointCloud<PointT> &cloud) {
+        if (!isEnabled(level))
+            return;
+        typename pcl::PointCloud<PointT>::ConstPtr cloud_copy(new pcl::PointCloud<PointT>(cloud));
+        enqueue(path, [path, cloud_copy]() { return pcl::io::savePCDFileBinaryCompressed(path, *cloud_copy) >= 0; });
+    }
+
+    //blocks until every queued cloud is on disk
+    void flush();
+
+private:
+    ArtifactWriter();
+    ArtifactWriter(const ArtifactWriter&) = delete;
+    ArtifactWriter& operator=(const ArtifactWriter&) = delete;
+
+    void enqueue(const std::string &path, std::function<bool()> write_fn);
+    void run();
+    //failed writes are only logged, the pipeline does not depend on its artifacts
+    static void write(const std::string &path, const std::function<bool()> &write_fn);
+
+    struct Job {
+        std::string path;
+        std::function<bool()> write_fn;
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_not_empty_;
+    std::condition_variable queue_not_full_;
+    std::condition_variable queue_drained_;
+    std::deque<Job> queue_;
+    size_t max_queue_size_;
+    size_t nr_jobs_in_progress_;
+    ArtifactLevel level_;
+    bool stop_;
+    std::thread worker_;
+};
+
+template <typename PointT>
+inline void saveDebugCloud(const std::string &path, const pcl::PointCloud<PointT> &cloud) {
+    ArtifactWriter::instance().save(ARTIFACTS_DEBUG, path, cloud);
+}
+
+template <typename PointT>
+inline void saveResultCloud(const std::string &path, const pcl::PointCloud<PointT> &cloud) {
+    ArtifactWriter::instance().save(ARTIFACTS_RESULT, path, cloud);
+}
+
+inline bool debugArtifactsEnabled() {
+    return ArtifactWriter::instance().isEnabled(ARTIFACTS_DEBUG);
+}
+
+#endif // ARTIFACT_WRITER_H
@@ -0,0 +1,106 @@
+#ifndef BINARY_BUFFER_H
+#define BINARY_BUFFER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//helpers for the binary files of the pipeline (scene bundles, result manifests). Values are stored in native byte order.
+
+template <typename T>
+inline void writeValue(std::vector<char> &buffer, const T &value) {
+    const char *bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+inline void writeString(std::vector<char> &buffer, const std::string &str) {
+    writeValue(buffer, static_cast<uint32_t>(str.size()));
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+//reads the whole file at once, the content is parsed from memory
+inline bool readFileIntoBuffer(const std::string &path, std::vector<char> &buffer) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.good())
+        return false;
+    const std::streamsize file_size = file.tellg();
+    if (file_size < 0)
+        return false;
+    file.seekg(0, std::ios::beg);
+    //a directory opens fine and reports a bogus size, but nothing can be read from it
+    if (file_size > 0 && file.peek() == std::ifstream::traits_type::eof())
+        return false;
+    buffer.resize(file_size);
+    return static_cast<bool>(file.read(buffer.data(), file_size));
+}
+
+//the buffer is assembled in memory so that it is written with a single call
+inline bool writeBufferToFile(const std::string &path, const std::vector<char> &buffer) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.good())
+        return false;
+    file.write(buffer.data(), buffer.size());
+    return file.good();
+}
+
+//the buffer is written to a temporary file that replaces the file afterwards, an interrupted write leaves the old file intact
+inline bool writeBufferToFileAtomically(const std::string &path, const std::vector<char> &buffer) {
+    const std::string tmp_path = path + ".tmp";
+    if (!writeBufferToFile(tmp_path, buffer))
+        return false;
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+//64 bit FNV-1a, recognizes content that was seen before (plane extraction cache, pair checkpoints)
+static const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+static const uint64_t fnv_prime = 1099511628211ULL;
+
+inline void hashBytes(uint64_t &hash, const void *data, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= fnv_prime;
+    }
+}
+
+//reads values from a buffer and remembers if the buffer was too short
+class BufferReader {
+public:
+    BufferReader(const std::vector<char> &buffer) : buffer_(buffer), pos_(0), ok_(true) {}
+
+    template <typename T>
+    T read() {
+        T value = T();
+        if (!ok_ || pos_ + sizeof(T) > buffer_.size()) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, buffer_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        const uint32_t size = read<uint32_t>();
+        if (!canRead(size)) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string str(buffer_.data() + pos_, size);
+        pos_ += size;
+        return str;
+    }
+
+    bool canRead(size_t nr_bytes) const { return ok_ && pos_ + nr_bytes <= buffer_.size(); }
+    bool ok() const { return ok_; }
+
+private:
+    const std::vector<char> &buffer_;
+    size_t pos_;
+    bool ok_;
+};
+
+#endif // BINARY_BUFFER_H
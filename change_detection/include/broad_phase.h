@@ -0,0 +1,21 @@
+#ifndef BROAD_PHASE_H
+#define BROAD_PHASE_H
+
+#include <utility>
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+//bounding box of the finite points, grown by margin on every side. Empty if the cloud has no finite point.
+Eigen::AlignedBox3f finiteBoundingBox(const pcl::PointCloud<PointNormal> &cloud, float margin=0.0f);
+
+//pairs (i < j) of overlapping boxes. The boxes are sorted along x and swept (sweep and prune), only boxes overlapping in
+//x are compared in y and z. Empty boxes overlap nothing. The pairs are sorted.
+std::vector<std::pair<int, int> > overlappingBoxPairs(const std::vector<Eigen::AlignedBox3f> &boxes);
+
+#endif // BROAD_PHASE_H
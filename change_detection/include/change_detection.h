@@ -20,8 +20,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <v4r/common/task_scheduler.h>
 #include <v4r/geometry/normals.h>
-#include <PPFRecognizerParameter.h>
 
 #include "scene_differencing_points.h"
 #include "local_object_verification.h"
@@ -31,6 +31,10 @@
 #include "detected_object.h"
 #include "object_matching.h"
 #include "plane_object_extraction.h"
+#include "pipeline_context.h"
+#include "plane_extraction_cache.h"
+#include "occupancy_diff.h"
+#include "broad_phase.h"
 #include "color_histogram.h"
 
 #include "settings.h"
@@ -43,7 +47,7 @@ typedef pcl::PointXYZRGBL PointLabel;
 class ChangeDetection
 {
 public:
-    ChangeDetection(std::string ppf_config_path) : ppf_config_path_(ppf_config_path) {
+    ChangeDetection(PipelineContext &context) : context_(context) {
         curr_checked_plane_point_cloud_.reset(new pcl::PointCloud<PointNormal>);
         ref_checked_plane_point_cloud_.reset(new pcl::PointCloud<PointNormal>);
     }
@@ -69,6 +73,11 @@ public:
         this->curr_cloud_ = cloud;
     }
 
+    //the cache is owned by the caller and can be shared by several ChangeDetection instances
+    void setExtractionCache(PlaneExtractionCache *cache) {
+        extraction_cache_ = cache;
+    }
+
     void compute(std::vector<DetectedObject> &ref_result, std::vector<DetectedObject> &curr_result);
     std::vector<PlaneWithObjInd> getObjectsFromPlane(pcl::PointCloud<PointNormal>::Ptr input_cloud, Eigen::Vector4f plane_coeffs,
                                                      pcl::PointCloud<pcl::PointXYZ>::Ptr convex_hull_pts,
@@ -78,16 +87,22 @@ public:
     pcl::PointCloud<PointNormal>::Ptr fromObjectVecToObjectCloud(const std::vector<PlaneWithObjInd> objects, pcl::PointCloud<PointNormal>::Ptr cloud, bool keepOrganized=true);
     pcl::PointCloud<PointNormal>::Ptr fromDetObjectVecToCloud(const std::vector<DetectedObject> object_vec, bool withStaticObjects=true);
     void upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr orig_cloud, pcl::PointCloud<PointNormal>::Ptr ds_cloud,
-                                  std::vector<PlaneWithObjInd> &objects, double leaf_size, std::string res_path);
-    void upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr orig_cloud, std::vector<DetectedObject> &objects, double leaf_size, std::string res_path);
+                                  std::vector<PlaneWithObjInd> &objects, double leaf_size, std::string res_path, const VoxelIndexMap *voxel_map = nullptr);
+    //voxel_map: kept by downsampleCloudVG for orig_cloud, without it the points are found with an octree radius search
+    void upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr orig_cloud, std::vector<DetectedObject> &objects, double leaf_size, std::string res_path,
+                                  const VoxelIndexMap *voxel_map = nullptr);
     std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > upsampleObjects(pcl::octree::OctreePointCloudSearch<PointNormal>::Ptr octree, pcl::PointCloud<PointNormal>::ConstPtr orig_input_cloud,
                                                                                      pcl::PointCloud<PointNormal>::ConstPtr objects_ds_cloud, std::string output_path, int counter);
+    std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > upsampleObjects(const VoxelIndexMap &voxel_map, pcl::PointCloud<PointNormal>::ConstPtr orig_input_cloud,
+                                                                                     pcl::PointCloud<PointNormal>::ConstPtr objects_ds_cloud, std::string output_path, int counter);
 
     DetectedObject fromPlaneIndObjToDetectedObject (pcl::PointCloud<PointNormal>::Ptr curr_cloud, PlaneWithObjInd obj);
     void performLV(std::vector<DetectedObject> &ref_objects, std::vector<DetectedObject> &curr_objects);
 
 
-    static void mergeObjectParts(std::vector<DetectedObject> &detected_objects, std::string merge_object_parts_folder);
+    //returns the IDs of the objects that were removed because all their points were merged into other objects. Copies of
+    //these objects elsewhere (e.g. in maps of potential new/removed objects) are outdated.
+    static std::vector<int> mergeObjectParts(std::vector<DetectedObject> &detected_objects, std::string merge_object_parts_folder);
     static void filterSmallVolumes(std::vector<DetectedObject> &objects, double volume_thr, int min_obj_size=0);
     static void filterUnwantedObjects(std::vector<DetectedObject> &objects, double volume_thr=0, int min_obj_size=0, int max_obj_size=std::numeric_limits<int>::max(),
                                       double plane_dist_thr =0.01, double plane_thr =0.9, std::string save_path="");
@@ -95,7 +110,8 @@ public:
 
 private:
     //std::string object_store_path_; //the model objects and their ppf model get stored here --> for now we store everything in output path
-    std::string ppf_config_path_; //the config file that stores the parrameters for PPF
+    PipelineContext &context_; //PPF parameters and object IDs of the comparison
+    PlaneExtractionCache *extraction_cache_ = nullptr; //extraction results and refined normals of planes seen before
     std::string output_path_; //all debugging things will get stored there (+model objects and their ppf model)
     std::string ppf_model_path_;
     std::string merge_object_parts_path_;
@@ -122,6 +138,14 @@ private:
     void filterPlanarAndColor(std::vector<PlaneWithObjInd>& objects, pcl::PointCloud<PointNormal>::Ptr cloud, std::string path, float _plane_dist_thr=0.01, int _nr_bins=10 );
     double checkColorSimilarityHistogram(PlaneWithObjInd& object, pcl::PointCloud<PointNormal>::Ptr cloud, std::string path="", int _nr_bins=10) ;
     void cleanResult(std::vector<DetectedObject> &detected_objects);
+    void refinePlaneNormals(pcl::PointCloud<PointNormal>::Ptr plane_cloud);
+    std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > extractUpsampledObject(pcl::PointCloud<PointNormal>::ConstPtr orig_input_cloud,
+                                                                                            std::vector<int> &orig_object_ind, std::string output_path, int counter);
+    void saveObjectModels(const std::vector<DetectedObject> &objects, const std::string &folder, const std::string &object_file_name);
+    bool computeUnchangedPlane(pcl::PointCloud<PointNormal>::Ptr ref_cloud_downsampled, const VoxelIndexMap &ref_voxel_map,
+                               std::vector<PlaneWithObjInd> ref_objects_from_plane,
+                               pcl::PointCloud<PointNormal>::ConstPtr curr_cloud_downsampled, const std::vector<PlaneWithObjInd> &curr_objects_from_plane,
+                               const std::string &ref_res_path, std::vector<DetectedObject> &ref_result, std::vector<DetectedObject> &curr_result);
     void matchAndRemoveObjects (pcl::PointCloud<PointNormal>::Ptr remaining_scene_points, pcl::PointCloud<PointNormal>::Ptr full_object_cloud, std::vector<PlaneWithObjInd> &extracted_objects);
     int checkVerticalPlanarity(PlaneWithObjInd& object, pcl::PointCloud<PointNormal>::Ptr cloud, float _plane_dist_thr);
     void filterVerticalPlanes(std::vector<PlaneWithObjInd>& objects, pcl::PointCloud<PointNormal>::Ptr cloud, std::string path, float _plane_dist_thr=0.005);
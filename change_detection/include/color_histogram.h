@@ -6,6 +6,8 @@
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 
+#include <v4r/common/color_conversion.h>
+
 typedef pcl::PointXYZRGBNormal PointNormal;
 
 class ColorHistogram
@@ -14,8 +16,6 @@ public:
     cv::Mat computeHSVHistogram(pcl::PointCloud<PointNormal>::Ptr cloud, int _nrBins);
     double colorCorr(pcl::PointCloud<PointNormal>::Ptr cloud1,
                                      pcl::PointCloud<PointNormal>::Ptr cloud2, int _nrBins=10);
-private:
-    void RGBtoHSV (const Eigen::Vector3i &in, Eigen::Vector3f &out);
 };
 
 #endif // COLOR_HISTO_H
@@ -0,0 +1,80 @@
+#ifndef DAEMON_PROTOCOL_H
+#define DAEMON_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "binary_buffer.h"
+
+//Protocol between the comparison daemon (all_scenes_comparison -s) and its clients over a local Unix domain socket.
+//Every message is one frame (native byte order, both ends run on the same machine):
+//  frame:      uint32 payload size, payload
+//  payload:    uint32 message type, fields of the message
+//  JOB:        uint32 protocol version, string room path, string result path, string ppf config path,
+//              string map path (empty: all pairs of scenes), string resume path (empty: new run), uint8 memory-bounded mode,
+//              int32 artifact level
+//  SHUTDOWN:   no fields, the daemon exits after the connection is closed
+//  PROGRESS:   string message
+//  PAIR:       string reference scene, string current scene, string result folder,
+//              uint32 nr of removed, new, ref displaced, curr displaced, ref static, curr static objects
+//  ERROR:      string message
+//  DONE:       int32 status (0 on success)
+//Strings are stored as uint32 length followed by the characters.
+//A client sends one JOB (or SHUTDOWN) per connection and reads PROGRESS, PAIR and ERROR messages until DONE.
+static const uint32_t daemon_protocol_version = 2;
+
+//frames larger than this are rejected, a job or a result is only a few hundred bytes
+static const uint32_t daemon_max_frame_size = 1 << 20;
+
+//the daemon serves one connection at a time, a client that does not send its job within this time is dropped
+static const int daemon_receive_timeout_s = 10;
+
+enum DaemonMessage {DAEMON_JOB = 1, DAEMON_SHUTDOWN, DAEMON_PROGRESS, DAEMON_PAIR, DAEMON_ERROR, DAEMON_DONE};
+
+struct ComparisonJob {
+    std::string room_path;
+    std::string result_path;
+    std::string ppf_config_path;
+    std::string map_path;
+    std::string resume_path; //result folder of an interrupted run that is continued
+    bool bounded_memory = false;
+    int artifact_level = 2; //ArtifactLevel, debug clouds by default like the command line
+};
+
+struct PairResult {
+    std::string ref_scene;
+    std::string curr_scene;
+    std::string result_path; //contains the result manifest and the *_objects.pcd files
+    uint32_t nr_removed = 0;
+    uint32_t nr_new = 0;
+    uint32_t nr_ref_displaced = 0;
+    uint32_t nr_curr_displaced = 0;
+    uint32_t nr_ref_static = 0;
+    uint32_t nr_curr_static = 0;
+};
+
+//returns the file descriptor of the socket, -1 on error. An existing socket file at the path is replaced. Only the user
+//that runs the daemon can connect (mode 0600).
+int listenOnUnixSocket(const std::string &socket_path);
+int connectToUnixSocket(const std::string &socket_path);
+
+//receiveFrame fails if nothing arrives for this time
+bool setReceiveTimeout(int fd, int seconds);
+
+//both return false if the connection was closed or broken
+bool sendFrame(int fd, const std::vector<char> &payload);
+bool receiveFrame(int fd, std::vector<char> &payload);
+
+std::vector<char> encodeJob(const ComparisonJob &job);
+std::vector<char> encodeShutdown();
+std::vector<char> encodeProgress(const std::string &message);
+std::vector<char> encodePair(const PairResult &result);
+std::vector<char> encodeError(const std::string &message);
+std::vector<char> encodeDone(int status);
+
+//the reader has to be positioned after the message type
+bool decodeJob(BufferReader &reader, ComparisonJob &job);
+bool decodePair(BufferReader &reader, PairResult &result);
+
+#endif // DAEMON_PROTOCOL_H
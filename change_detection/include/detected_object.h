@@ -6,17 +6,16 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/PointIndices.h>
-#include <pcl/filters/filter.h>
 
 #include "mathhelpers.h"
+#include "object_cloud_data.h"
+#include "object_state.h"
 
 typedef pcl::PointXYZRGBNormal PointNormal;
 
 
 const float ds_voxel_size = 0.005;
 
-enum ObjectState {NEW, REMOVED, DISPLACED, STATIC, UNKNOWN};
-
 struct FitnessScoreStruct {
     FitnessScoreStruct() { object_conf = 0.0f; model_conf = 0.0f;}
     FitnessScoreStruct(float o_c, float m_c, std::vector<int> o_pts, std::vector<int> m_pts ) :
@@ -48,67 +47,43 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     DetectedObject(){}
 
-    //Constructor when we know the ID (e.g. extracted from a DB)
+    //the ID is either known (e.g. extracted from a DB) or a new one from PipelineContext::nextObjectID()
     DetectedObject(int id, pcl::PointCloud<PointNormal>::Ptr object_cloud, pcl::PointCloud<PointNormal>::Ptr plane_cloud, pcl::ModelCoefficients::Ptr plane_coeffs,
-                   ObjectState object_state = UNKNOWN, std::string object_folder_path = "") : unique_id_(id), object_cloud_(object_cloud),
-        plane_cloud_(plane_cloud), plane_coeffs_(plane_coeffs), state_(object_state), object_folder_path_(object_folder_path) {
-        removeNANsAndDownsample(object_cloud);
-    }
-
-    DetectedObject(pcl::PointCloud<PointNormal>::Ptr object_cloud, pcl::PointCloud<PointNormal>::Ptr plane_cloud, pcl::ModelCoefficients::Ptr plane_coeffs,
-                   ObjectState object_state = UNKNOWN, std::string object_folder_path = "") : unique_id_(++s_id), object_cloud_(object_cloud),
-        plane_cloud_(plane_cloud), plane_coeffs_(plane_coeffs), state_(object_state), object_folder_path_(object_folder_path) {
-
-        removeNANsAndDownsample(object_cloud);
+                   ObjectState object_state = UNKNOWN) :
+        plane_cloud_(plane_cloud), plane_coeffs_(plane_coeffs), state_(object_state), unique_id_(id),
+        cloud_data_(new ObjectCloudData(*object_cloud)) {
     }
 
     pcl::PointCloud<PointNormal>::Ptr plane_cloud_;
     pcl::ModelCoefficients::Ptr plane_coeffs_;
-    std::string object_folder_path_;
+    bool partially_matched_ = false; //only the matched part of the object is kept, the rest became a new object
     ObjectState state_;
     std::unordered_set<int> already_checked_model_ids;
     Match match_; //this is only relevant for displaced objects
 
     int getID() const {return unique_id_;}
+    //the object cloud and everything derived from it are replaced together, copies of the object keep the previous ones
     void setObjectCloud(pcl::PointCloud<PointNormal>::Ptr object_cloud) {
-        removeNANsAndDownsample(object_cloud);
+        cloud_data_.reset(new ObjectCloudData(*object_cloud));
     }
-    pcl::PointCloud<PointNormal>::ConstPtr getObjectCloud() const {return object_cloud_;}
-    pcl::PointCloud<PointNormal>::ConstPtr getObjectCloudDS() const {return object_cloud_ds_;}
+    pcl::PointCloud<PointNormal>::ConstPtr getObjectCloud() const {return cloud_data_->cloud();}
+    //downsampled with ds_voxel_size, computed on first use
+    pcl::PointCloud<PointNormal>::ConstPtr getObjectCloudDS() const {return cloud_data_->downsampled();}
+    const ObjectCloudData &getCloudData() const {return *cloud_data_;}
 
     inline void clearClouds() {
-        object_cloud_->clear();
-        object_cloud_ds_->clear();
-    }
-
-    static void setIDCounter(int latest_id) {
-        s_id = latest_id;
+        cloud_data_ = ObjectCloudData::empty();
     }
 
-    static int getIDCounter() {
-        return s_id;
+    //drops the references of this object to its clouds without touching clouds shared with copies of the object
+    inline void releaseClouds() {
+        cloud_data_ = ObjectCloudData::empty();
+        plane_cloud_.reset(new pcl::PointCloud<PointNormal>);
     }
-    
-protected:
-    static int s_id;
 
 private:
     int unique_id_;
-    pcl::PointCloud<PointNormal>::Ptr object_cloud_;
-    pcl::PointCloud<PointNormal>::Ptr object_cloud_ds_;
-
-    void inline removeNANsAndDownsample(pcl::PointCloud<PointNormal>::Ptr object_cloud) {
-        pcl::PointCloud<PointNormal>::Ptr obj_wo_nans(new pcl::PointCloud<PointNormal>);
-        std::vector<int> nan_ind;
-        pcl::removeNaNFromPointCloud(*object_cloud, *obj_wo_nans, nan_ind);
-
-        object_cloud_ = obj_wo_nans;
-        object_cloud_->is_dense = true;
-
-        object_cloud_ds_.reset(new pcl::PointCloud<PointNormal>);
-        object_cloud_ds_ = downsampleCloudVG(object_cloud_, ds_voxel_size);
-        object_cloud_ds_->is_dense = true;
-    }
+    ObjectCloudData::ConstPtr cloud_data_ = ObjectCloudData::empty();
 };
 
 #endif // DETECTED_OBJECT_H
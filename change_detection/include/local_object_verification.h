@@ -17,6 +17,7 @@
 #include "scene_differencing_points.h"
 #include "color_histogram.h"
 #include "object_matching.h"
+#include "artifact_writer.h"
 
 #include "settings.h"
 
@@ -7,6 +7,9 @@
 #include <pcl/surface/convex_hull.h>
 #include <pcl/io/pcd_io.h>
 
+#include "artifact_writer.h"
+#include "voxel_index_map.h"
+
 typedef pcl::PointXYZRGBNormal PointNormal;
 
 struct PlaneStruct {
@@ -55,6 +58,13 @@ inline pcl::PointCloud<PointNormal>::Ptr downsampleCloudVG(pcl::PointCloud<Point
     return cloud_filtered;
 }
 
+//additionally keeps which original points are behind each downsampled point, used to upsample without spatial searches
+inline pcl::PointCloud<PointNormal>::Ptr downsampleCloudVG(pcl::PointCloud<PointNormal>::Ptr input, double leafSize, VoxelIndexMap &voxel_map)
+{
+    voxel_map.build(*input, leafSize);
+    return downsampleCloudVG(input, leafSize);
+}
+
 inline bool isObjectPlanar(pcl::PointCloud<PointNormal>::ConstPtr object, float plane_dist_thr, float plane_acc_thr) {
     pcl::SACSegmentation<PointNormal> seg;
     pcl::PointIndices::Ptr inliers (new pcl::PointIndices);
@@ -84,19 +94,19 @@ inline bool isObjectUnwanted(const pcl::PointCloud<PointNormal>::ConstPtr &objec
     //does the object have enough points?
     if (object->size() < min_obj_size) {
         if (save_filename != "")
-            pcl::io::savePCDFileBinary(save_filename + "_toosmall.pcd", *object);
+            saveDebugCloud(save_filename + "_toosmall.pcd", *object);
         return true;
     }
     //does the object have too many points?
     if (object->size() > max_obj_size) {
         if (save_filename != "")
-            pcl::io::savePCDFileBinary(save_filename + "_toobig.pcd", *object);
+            saveDebugCloud(save_filename + "_toobig.pcd", *object);
         return true;
     }
     //is the object planar?
     if (isObjectPlanar(object, plane_dist_thr, plane_thr)) {
         if (save_filename != "")
-            pcl::io::savePCDFileBinary(save_filename + "_toosplanar.pcd", *object);
+            saveDebugCloud(save_filename + "_toosplanar.pcd", *object);
         return true;
     }
 
@@ -110,7 +120,7 @@ inline bool isObjectUnwanted(const pcl::PointCloud<PointNormal>::ConstPtr &objec
     double volume = chull.getTotalVolume();
     if (volume < volume_thr) {
         if (save_filename != "")
-            pcl::io::savePCDFileBinary(save_filename + "_toolittlevolume.pcd", *object);
+            saveDebugCloud(save_filename + "_toolittlevolume.pcd", *object);
         return true;
     }
 
@@ -0,0 +1,44 @@
+#ifndef OBJECT_CLOUD_DATA_H
+#define OBJECT_CLOUD_DATA_H
+
+#include <memory>
+#include <mutex>
+
+#include <Eigen/Geometry>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+//The cloud of a detected object and what is derived from it. The data does not change after construction and is shared
+//by all copies of an object, a copy costs a reference count. The derived values are computed on first use only (most
+//objects never need all of them) and at most once, also if copies on several threads ask for them at the same time.
+class ObjectCloudData
+{
+public:
+    typedef std::shared_ptr<const ObjectCloudData> ConstPtr;
+
+    //the NaN points of the cloud are removed, the data keeps its own copy
+    explicit ObjectCloudData(const pcl::PointCloud<PointNormal> &cloud);
+
+    //shared instance without points
+    static ConstPtr empty();
+
+    pcl::PointCloud<PointNormal>::ConstPtr cloud() const { return cloud_; }
+
+    //voxel grid with ds_voxel_size
+    pcl::PointCloud<PointNormal>::ConstPtr downsampled() const;
+    Eigen::Vector4f centroid() const;
+    Eigen::AlignedBox3f boundingBox() const;
+
+private:
+    pcl::PointCloud<PointNormal>::Ptr cloud_;
+
+    mutable std::once_flag downsampled_once_, centroid_once_, bounding_box_once_;
+    mutable pcl::PointCloud<PointNormal>::Ptr downsampled_;
+    mutable Eigen::Matrix<float,4,1,Eigen::DontAlign> centroid_;
+    mutable Eigen::AlignedBox3f bounding_box_;
+};
+
+#endif // OBJECT_CLOUD_DATA_H
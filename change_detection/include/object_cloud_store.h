@@ -0,0 +1,37 @@
+#ifndef OBJECT_CLOUD_STORE_H
+#define OBJECT_CLOUD_STORE_H
+
+#include <string>
+#include <unordered_set>
+
+#include "detected_object.h"
+
+//keeps the clouds of objects on disk while they are not needed, e.g. of objects whose state does not change anymore
+//while the remaining planes are compared. Only the object cloud is stored, the plane cloud of a spilled object is gone.
+class ObjectCloudStore
+{
+public:
+    ObjectCloudStore() {}
+
+    //starts a new store in the given folder, files of a previous store are removed
+    void reset(const std::string &store_dir);
+
+    //writes the object cloud to the store and releases the clouds of the object
+    bool spill(DetectedObject &obj);
+    //loads the object cloud again, does nothing if the object is not in the store
+    bool restore(DetectedObject &obj);
+
+    bool isSpilled(int id) const { return spilled_ids_.find(id) != spilled_ids_.end(); }
+    size_t size() const { return spilled_ids_.size(); }
+
+    //removes all files of the store
+    void clear();
+
+private:
+    std::string cloudPath(int id) const;
+
+    std::string store_dir_;
+    std::unordered_set<int> spilled_ids_;
+};
+
+#endif // OBJECT_CLOUD_STORE_H
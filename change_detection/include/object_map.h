@@ -0,0 +1,93 @@
+#ifndef OBJECT_MAP_H
+#define OBJECT_MAP_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "object_state.h"
+#include "scene_bundle.h"
+
+//file name of the objects inside the folder of an object map, the planes are stored as scene bundle next to it
+static const std::string object_map_filename = "object.map";
+
+//The objects of an object map are stored in one binary file (native byte order):
+//  header:     char[4] "CDOM", uint32 version, int32 last object id, int32 last plane id
+//  scenes:     uint32 nr of scenes, per scene: string name (in the order they were added to the map)
+//  objects:    uint32 nr of objects, per object: int32 id, int32 plane id, uint32 state, string first seen scene,
+//              string last seen scene, float[16] pose (row major), uint32 nr of points,
+//              nr of points * (float[3] xyz, float[3] normal, uint32 rgba, float curvature)
+//Strings are stored as uint32 length followed by the characters.
+static const uint32_t object_map_version = 1;
+
+//max. distance between the centroid of an object extracted from a map plane and the centroid of the map object
+const float map_object_assoc_dist = 0.1;
+
+struct MapObject {
+    int id;
+    int plane_id; //map plane the object was seen on the last time
+    ObjectState state; //last transition, objects with state REMOVED are not on their plane anymore
+    std::string first_seen_scene;
+    std::string last_seen_scene;
+    Eigen::Matrix<float,4,4,Eigen::DontAlign> pose = Eigen::Matrix<float,4,4,Eigen::DontAlign>::Identity(); //from the first to the last observation
+    pcl::PointCloud<PointNormal>::Ptr cloud; //object cloud of the last observation
+
+    bool isOnPlane() const { return state != ObjectState::REMOVED; }
+};
+
+//Persistent map of the planes of a room and the objects on them. The plane clouds are the latest observation of each
+//plane, so a new scene is compared with one change detection pass against the map instead of against every earlier scene.
+class ObjectMap
+{
+public:
+    ObjectMap() {}
+
+    //a map whose last save was interrupted is restored to the state before that save
+    bool load(const std::string &map_dir);
+    //plane clouds that were released are read again from the map folder before it is replaced
+    bool save(const std::string &map_dir);
+
+    bool empty() const { return planes_.empty(); }
+
+    //starts the map with the planes of the first scene, their objects are added during the first comparison
+    void init(const std::map<int, ReconstructedPlane> &rec_planes, const std::string &scene_name);
+
+    std::map<int, ReconstructedPlane> &planes() { return planes_; }
+    std::map<int, MapObject> &objects() { return objects_; }
+    const std::map<int, MapObject> &objects() const { return objects_; }
+
+    const std::vector<std::string> &scenes() const { return scenes_; }
+    bool containsScene(const std::string &scene_name) const;
+    const std::string &lastScene() const { return scenes_.back(); }
+    void addScene(const std::string &scene_name) { scenes_.push_back(scene_name); }
+
+    //replaces the plane with the latest observation
+    void updatePlane(int plane_id, const ReconstructedPlane &plane);
+    //adds a plane that was not part of the map yet and returns its map ID
+    int addPlane(const ReconstructedPlane &plane);
+
+    int addObject(int plane_id, ObjectState state, pcl::PointCloud<PointNormal>::ConstPtr cloud, const std::string &first_seen_scene,
+                  const std::string &last_seen_scene);
+    //returns the ID of the object of the plane with the closest centroid (within map_object_assoc_dist), -1 if there is none.
+    //With plane_id -1 the objects of all planes are searched.
+    int findObject(int plane_id, pcl::PointCloud<PointNormal>::ConstPtr cloud) const;
+    //transform aligns the last observation of the object to the new one
+    void observeObject(int id, int plane_id, ObjectState state, pcl::PointCloud<PointNormal>::ConstPtr cloud,
+                       const Eigen::Matrix4f &transform, const std::string &scene_name);
+    void removeObject(int id);
+
+private:
+    std::map<int, ReconstructedPlane> planes_;
+    std::map<int, MapObject> objects_;
+    std::vector<std::string> scenes_;
+    int last_object_id_ = 0;
+    int last_plane_id_ = 0;
+};
+
+#endif // OBJECT_MAP_H
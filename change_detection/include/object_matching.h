@@ -33,7 +33,9 @@
 
 #include <v4r/recognition/object_hypothesis.h>
 #include <v4r/common/color_comparison.h>
+#include <v4r/common/color_conversion.h>
 #include <v4r/geometry/normals.h>
+#include <v4r/common/trace.h>
 
 #include "plane_object_extraction.h"
 #include "warp_point_rigid_4d.h"
@@ -41,6 +43,8 @@
 #include "color_histogram.h"
 #include "detected_object.h"
 #include "mathhelpers.h"
+#include "pipeline_context.h"
+#include "point_soa.h"
 
 #include <PPFRecognizer.h>
 
@@ -95,7 +99,7 @@ class ObjectMatching
 {
 public:
     ObjectMatching(std::vector<DetectedObject> model_vec, std::vector<DetectedObject> object_vec,
-                   std::string model_path, std::string cfg_path, std::string obj_match_dir="");
+                   std::string model_path, PipelineContext &context, std::string obj_match_dir="");
 
     std::vector<Match> compute(std::vector<DetectedObject> &ref_result, std::vector<DetectedObject> &curr_result);
     static FitnessScoreStruct computeModelFitness(pcl::PointCloud<PointNormal>::ConstPtr object, pcl::PointCloud<PointNormal>::ConstPtr model,
@@ -112,7 +116,7 @@ private:
     std::vector<DetectedObject> model_vec_;
     std::vector<DetectedObject> object_vec_;
     std::string model_path_;
-    std::string cfg_path_;
+    PipelineContext &context_;
     std::string cloud_matches_dir_;
 
     boost::shared_ptr<v4r::apps::PPFRecognizer<pcl::PointXYZRGB> > rec_;
@@ -121,10 +125,11 @@ private:
     bool isBelowPlane(pcl::PointCloud<PointNormal>::ConstPtr model, pcl::PointCloud<PointNormal>::ConstPtr plane_cloud);
     std::vector<Match> weightedGraphMatching(std::vector<ObjectHypothesesStruct> global_hypotheses,
                                              std::function<float(FitnessScoreStruct)> computeFitness, double fitness_thr);
+    std::vector<std::pair<std::string, pcl::PointCloud<PointNormal>::ConstPtr> > createModelClouds() const;
     std::vector<v4r::ObjectHypothesesGroup> callRecognizer(DetectedObject &obj);
     std::pair<HypothesesStruct, bool> filterRecoHypothesis(DetectedObject obj, std::vector<v4r::ObjectHypothesis::Ptr> hg);
     std::vector<ObjectHypothesesStruct> createHypotheses();
-    float computeMeanPointDistance(pcl::PointCloud<PointNormal>::ConstPtr ref_object, pcl::PointCloud<PointNormal>::ConstPtr curr_obj);
+    float computeMeanPointDistance(const DetectedObject &ref_object, const DetectedObject &curr_obj);
 
 };
 
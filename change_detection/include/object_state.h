@@ -0,0 +1,6 @@
+#ifndef OBJECT_STATE_H
+#define OBJECT_STATE_H
+
+enum ObjectState {NEW, REMOVED, DISPLACED, STATIC, UNKNOWN};
+
+#endif // OBJECT_STATE_H
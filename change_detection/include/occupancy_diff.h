@@ -0,0 +1,27 @@
+#ifndef OCCUPANCY_DIFF_H
+#define OCCUPANCY_DIFF_H
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+//Cheap test if anything changed on a plane between two scenes. Only the points above the plane are compared, as voxel occupancy
+//with the mean colour per voxel, from coarse to fine voxels (occupancy_voxel_sizes). A voxel of one plane matches if the other
+//plane occupies the same voxel (with a similar colour) or one of its neighbours. The test stops at the first level where more
+//voxels than tolerated are unmatched, so most changed planes are rejected with the coarsest grid already.
+//Both clouds have to be in the same (map) frame.
+bool haveSameOccupancy(const pcl::PointCloud<PointNormal> &ref_cloud, const Eigen::Vector4f &ref_plane_coeffs,
+                       const pcl::PointCloud<PointNormal> &curr_cloud, const Eigen::Vector4f &curr_plane_coeffs);
+
+//haveSameOccupancy tolerates a few unmatched voxels, a small object added to a crowded plane fits into that tolerance. Every
+//object of one plane (indices into cloud) has to be explained by the objects of the other plane: at least
+//unchanged_min_object_coverage of its points need a point of covering_cloud within max_dist.
+bool areObjectsCovered(const pcl::PointCloud<PointNormal> &cloud, const std::vector<std::vector<int> > &objects,
+                       const pcl::PointCloud<PointNormal> &covering_cloud, float max_dist);
+
+#endif // OCCUPANCY_DIFF_H
@@ -0,0 +1,23 @@
+#ifndef PAIR_CHECKPOINT_H
+#define PAIR_CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+
+//file name of the completion record inside the result folder of a scene comparison
+static const std::string pair_checkpoint_filename = "pair.complete";
+
+//The completion record of a scene comparison is written after all its results are on disk (native byte order):
+//  header:     char[4] "CDPC", uint32 version, string reference scene, string current scene
+//  files:      uint32 nr of files, per file: string file name, uint64 size, uint64 FNV-1a hash of the content
+//It lists every file directly in the result folder (result manifest, result clouds, config), the debug folders are not part of it.
+//Strings are stored as uint32 length followed by the characters.
+static const uint32_t pair_checkpoint_version = 1;
+
+//the record replaces an older one atomically, a folder without a valid record is an interrupted comparison
+bool writePairCheckpoint(const std::string &result_path, const std::string &ref_scene, const std::string &curr_scene);
+
+//true if the record belongs to the two scenes and every file listed in it still has the recorded size and content
+bool verifyPairCheckpoint(const std::string &result_path, const std::string &ref_scene, const std::string &curr_scene);
+
+#endif // PAIR_CHECKPOINT_H
@@ -0,0 +1,54 @@
+#ifndef PIPELINE_CONTEXT_H
+#define PIPELINE_CONTEXT_H
+
+#include <map>
+#include <string>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <PPFRecognizerParameter.h>
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+//State shared by the stages of one scene comparison (ChangeDetection, ObjectMatching and the PPF recognizer).
+//Every comparison owns its own context, nothing of it is process-wide. Several comparisons can therefore run in the
+//same process, and the object IDs only depend on the comparison itself and not on what ran before.
+class PipelineContext
+{
+public:
+    PipelineContext() {}
+
+    //reads the PPF parameters from the config file, the defaults are kept if the file does not exist
+    bool loadPPFParams(const std::string &ppf_config_path);
+    //takes the parameters of a config that was parsed before, e.g. by the daemon for an earlier job
+    void setPPFParams(const v4r::apps::PPFRecognizerParameter &params, const std::string &ppf_config_path) {
+        ppf_params_ = params;
+        ppf_config_path_ = ppf_config_path;
+    }
+
+    const v4r::apps::PPFRecognizerParameter &ppfParams() const { return ppf_params_; }
+    const std::string &ppfConfigPath() const { return ppf_config_path_; }
+
+    //IDs of detected objects, the first object of a comparison gets ID 1
+    int nextObjectID() { return ++last_object_id_; }
+    int lastObjectID() const { return last_object_id_; }
+    void setLastObjectID(int id) { last_object_id_ = id; }
+
+    //object models that are available for matching with PPF, keyed by the ID of the reference object they belong to
+    void addModel(int object_id, pcl::PointCloud<PointNormal>::ConstPtr model_cloud) { models_[object_id] = model_cloud; }
+    void removeModel(int object_id) { models_.erase(object_id); }
+    bool hasModel(int object_id) const { return models_.find(object_id) != models_.end(); }
+    pcl::PointCloud<PointNormal>::ConstPtr modelCloud(int object_id) const {
+        auto it = models_.find(object_id);
+        return it == models_.end() ? pcl::PointCloud<PointNormal>::ConstPtr() : it->second;
+    }
+
+private:
+    v4r::apps::PPFRecognizerParameter ppf_params_;
+    std::string ppf_config_path_;
+    int last_object_id_ = 0;
+    std::map<int, pcl::PointCloud<PointNormal>::ConstPtr> models_;
+};
+
+#endif // PIPELINE_CONTEXT_H
@@ -0,0 +1,59 @@
+#ifndef PLANE_EXTRACTION_CACHE_H
+#define PLANE_EXTRACTION_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "mathhelpers.h"
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+//Results of the object extraction of a plane and of the normal refinement of a plane cloud, shared by all scene comparisons
+//of a run. In all-pairs mode every scene is part of n-1 comparisons, with the cache each plane is only segmented once.
+//Entries are keyed by a hash of the content of all inputs. The thresholds of the extraction are compile-time constants
+//and the cache only lives as long as the process, therefore they are not part of the key.
+class PlaneExtractionCache
+{
+public:
+    //refined plane clouds have the full resolution, in memory-bounded mode only the extraction results should be kept
+    PlaneExtractionCache(bool cache_normals = true) : cache_normals_(cache_normals) {}
+
+    static uint64_t normalsKey(const pcl::PointCloud<PointNormal> &cloud);
+    static uint64_t objectsKey(const pcl::PointCloud<PointNormal> &input_cloud, const Eigen::Vector4f &plane_coeffs,
+                               const pcl::PointCloud<pcl::PointXYZ> &convex_hull_pts, const pcl::PointCloud<PointNormal> &checked_plane_cloud);
+
+    bool cachesNormals() const { return cache_normals_; }
+    bool getRefinedNormals(uint64_t key, pcl::PointCloud<PointNormal> &cloud);
+    void putRefinedNormals(uint64_t key, const pcl::PointCloud<PointNormal> &cloud);
+
+    //objects found on the plane and the plane points the extraction added to the checked plane cloud
+    bool getObjects(uint64_t key, std::vector<PlaneWithObjInd> &objects, pcl::PointCloud<PointNormal> &checked_plane_points);
+    void putObjects(uint64_t key, const std::vector<PlaneWithObjInd> &objects, const pcl::PointCloud<PointNormal> &checked_plane_points);
+
+    size_t hits() const;
+    size_t misses() const;
+    //drops all entries, e.g. when the daemon moves on to another room
+    void clear();
+
+private:
+    struct ObjectsEntry {
+        std::vector<PlaneWithObjInd> objects;
+        pcl::PointCloud<PointNormal> checked_plane_points;
+    };
+
+    bool cache_normals_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, pcl::PointCloud<PointNormal>::Ptr> normals_;
+    std::unordered_map<uint64_t, ObjectsEntry> objects_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+#endif // PLANE_EXTRACTION_CACHE_H
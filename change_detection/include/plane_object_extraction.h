@@ -28,6 +28,7 @@
 #include "region_growing.h"
 #include "object_matching.h"
 #include "mathhelpers.h"
+#include "artifact_writer.h"
 
 typedef pcl::PointXYZRGBNormal PointNormal;
 typedef pcl::PointXYZRGB PointRGB;
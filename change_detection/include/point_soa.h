@@ -0,0 +1,76 @@
+#ifndef POINT_SOA_H
+#define POINT_SOA_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+//Structure-of-arrays copy of the fields of a point cloud. Loops that only read xyz, normals or the colour touch
+//4 bytes per field and point instead of the 64 bytes of a PointXYZRGBNormal and can be vectorized by the compiler.
+//The arrays are filled once per cloud (one pass over the AoS data), indices are the same as in the original cloud.
+struct PointCloudSoA {
+    std::vector<float> x, y, z;
+    std::vector<float> normal_x, normal_y, normal_z;
+    std::vector<uint32_t> rgba;
+
+    size_t size() const { return x.size(); }
+    bool hasNormals() const { return !normal_x.empty(); }
+    bool hasColor() const { return !rgba.empty(); }
+
+    template <typename PointT>
+    void setXYZ(const pcl::PointCloud<PointT> &cloud) {
+        const size_t n = cloud.points.size();
+        x.resize(n); y.resize(n); z.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            x[i] = cloud.points[i].x;
+            y[i] = cloud.points[i].y;
+            z[i] = cloud.points[i].z;
+        }
+    }
+
+    //works for every point type with normal_x/y/z, e.g. pcl::Normal or PointXYZRGBNormal
+    template <typename PointT>
+    void setNormals(const pcl::PointCloud<PointT> &cloud) {
+        const size_t n = cloud.points.size();
+        normal_x.resize(n); normal_y.resize(n); normal_z.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            normal_x[i] = cloud.points[i].normal_x;
+            normal_y[i] = cloud.points[i].normal_y;
+            normal_z[i] = cloud.points[i].normal_z;
+        }
+    }
+
+    template <typename PointT>
+    void setRGB(const pcl::PointCloud<PointT> &cloud) {
+        const size_t n = cloud.points.size();
+        rgba.resize(n);
+        for (size_t i = 0; i < n; i++)
+            rgba[i] = cloud.points[i].rgba;
+    }
+
+    bool isFinite(size_t i) const { return std::isfinite(x[i]) && std::isfinite(y[i]) && std::isfinite(z[i]); }
+
+    float normalDot(size_t i, const PointCloudSoA &other, size_t j) const {
+        return normal_x[i] * other.normal_x[j] + normal_y[i] * other.normal_y[j] + normal_z[i] * other.normal_z[j];
+    }
+
+    Eigen::Vector3i getRGBVector3i(size_t i) const {
+        return Eigen::Vector3i((rgba[i] >> 16) & 0xff, (rgba[i] >> 8) & 0xff, rgba[i] & 0xff);
+    }
+};
+
+//xyz, normals and colour of a PointXYZRGBNormal cloud
+inline PointCloudSoA toSoA(const pcl::PointCloud<pcl::PointXYZRGBNormal> &cloud) {
+    PointCloudSoA soa;
+    soa.setXYZ(cloud);
+    soa.setNormals(cloud);
+    soa.setRGB(cloud);
+    return soa;
+}
+
+#endif // POINT_SOA_H
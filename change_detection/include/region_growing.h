@@ -1,7 +1,8 @@
 #ifndef REGIONGROWING_H
 #define REGIONGROWING_H
 
-#include <opencv2/imgproc/imgproc.hpp>
+#include <algorithm>
+#include <memory>
 
 #include <pcl/common/angles.h>
 #include <pcl/octree/octree.h>
@@ -11,6 +12,39 @@
 #include <pcl/search/search.h>
 
 #include <v4r/common/color_comparison.h>
+#include <v4r/common/color_conversion.h>
+
+#include "point_soa.h"
+#include "voxel_index_map.h"
+
+//Lab colours of all points, converted in one batch from the packed colours of the SoA
+inline std::vector<Eigen::Vector3f> rgbToLab(const PointCloudSoA &soa) {
+    std::vector<Eigen::Vector3f> lab(soa.size());
+    v4r::convertRGBToLab(soa.rgba.data(), soa.size(), lab.data());
+    return lab;
+}
+
+//Neighbour grid, SoA fields and Lab colours of a scene, built once and shared read-only by several RegionGrowing instances
+//on the same scene (e.g. one per object cluster, running concurrently).
+template <typename PointT>
+struct RegionGrowingIndex {
+    RadiusSearchGrid grid;
+    PointCloudSoA scene_soa;
+    std::vector<Eigen::Vector3f> scene_lab; //empty without colour
+
+    //cell_size should be the search radius of the growing (sqrt(2) * max_neighbour_distance), other radii work as well
+    RegionGrowingIndex(typename pcl::PointCloud<PointT>::ConstPtr scene, pcl::PointCloud<pcl::Normal>::ConstPtr scene_normals,
+                       float cell_size, bool with_color=true) {
+        //the growing loop only reads xyz (finite check), normals and colour of the scene
+        scene_soa.setXYZ(*scene);
+        scene_soa.setNormals(*scene_normals);
+        grid.build(scene_soa, cell_size);
+        if (with_color) {
+            scene_soa.setRGB(*scene);
+            scene_lab = rgbToLab(scene_soa);
+        }
+    }
+};
 
 
 template <typename PointT, typename PointQ>
@@ -19,14 +53,20 @@ class RegionGrowing
 public:
     RegionGrowing(typename pcl::PointCloud<PointT>::ConstPtr scene, typename pcl::PointCloud<PointQ>::ConstPtr object,
                   pcl::PointCloud<pcl::Normal>::ConstPtr scene_normals, bool is_object_downsampled,
-                  float color_thr=std::numeric_limits<float>::max(), float eps_angle_threshold_deg=10, float max_neighbour_distance=0.01, float curvature_threshold=0.08,
-                  double octree_res=0.05) :
+                  float color_thr=std::numeric_limits<float>::max(), float eps_angle_threshold_deg=10, float max_neighbour_distance=0.01, float curvature_threshold=0.08) :
         scene_(scene), object_(object), scene_normals_(scene_normals), is_object_downsampled_(is_object_downsampled),
-        octree_res_(octree_res), eps_angle_threshold_deg_(eps_angle_threshold_deg),
+        eps_angle_threshold_deg_(eps_angle_threshold_deg),
         max_neighbour_distance_(max_neighbour_distance), curvature_threshold_(curvature_threshold), color_thr_(color_thr)
     {
     }
 
+    //use an index that was built for the scene before instead of building one in compute(). Blocked points (same size as
+    //the scene) are treated like missing points: they are never added and the seed search skips them.
+    void setSharedIndex(const RegionGrowingIndex<PointT> *index, const std::vector<bool> *blocked=nullptr) {
+        shared_index_ = index;
+        blocked_ = blocked;
+    }
+
     std::vector<int> compute() {
 //        typename pcl::PointCloud<PointT>::Ptr vis_cloud(new pcl::PointCloud<PointT>);
 //        pcl::copyPointCloud(*scene_, *vis_cloud);
@@ -41,19 +81,23 @@ public:
 
         assert(scene_->points.size() == scene_normals_->points.size());
 
-        /// create an octree for search
-        octree_.reset(new pcl::octree::OctreePointCloudSearch<PointT>(octree_res_));
-        octree_->setInputCloud(scene_);
-        octree_->addPointsFromInputCloud();
-        //std::cout << "Created octree" << std::endl;
+        const bool use_color = color_thr_ != std::numeric_limits<float>::max();
+        const float radius = std::sqrt(2) * max_neighbour_distance_;
+        /// create a neighbour grid for search
+        std::unique_ptr<RegionGrowingIndex<PointT> > own_index;
+        if (!shared_index_)
+            own_index.reset(new RegionGrowingIndex<PointT>(scene_, scene_normals_, radius, use_color));
+        const RegionGrowingIndex<PointT> &index = shared_index_ ? *shared_index_ : *own_index;
+        const RadiusSearchGrid &grid = index.grid;
+        const PointCloudSoA &scene_soa = index.scene_soa;
+        assert(!use_color || index.scene_lab.size() == scene_soa.size());
+        const float cos_eps_angle = cos(pcl::deg2rad(eps_angle_threshold_deg_));
 
         //  // Create a bool vector of processed point indices, and initialize it to false
         std::vector<bool> processed_scene(scene_->points.size(), false);
         std::vector<int> nn_indices;
         std::vector<float> nn_sqrt_distances;
 
-        float eps_angle_threshold_rad = pcl::deg2rad(eps_angle_threshold_deg_);
-
         std::vector<int> orig_object_ind;
 //        while (!viewer->wasStopped ()) {
         for (size_t i = 0; i < object_->points.size(); ++i) {
@@ -63,27 +107,21 @@ public:
             std::vector<int> seed_queue;
             int sq_idx = 0;
 
-            PointT p_object;
-            p_object.x = object_->points[i].x;
-            p_object.y = object_->points[i].y;
-            p_object.z = object_->points[i].z;
+            const float px = object_->points[i].x, py = object_->points[i].y, pz = object_->points[i].z;
 
-            octree_->nearestKSearch(p_object, 1, nn_indices, nn_sqrt_distances);
-            if (nn_sqrt_distances[0] > max_neighbour_distance_*max_neighbour_distance_ || processed_scene[nn_indices[0]] || !pcl::isFinite(scene_->points[nn_indices[0]]))
+            const int seed_ind = findSeed(grid, px, py, pz, nn_indices, nn_sqrt_distances);
+            if (seed_ind == -1 || processed_scene[seed_ind])
                 continue;
 
-            const PointT query_pt = scene_->points[nn_indices[0]];
-            const pcl::Normal query_n = scene_normals_->points[nn_indices[0]];
-
-            seed_queue.push_back(nn_indices[0]);
-            processed_scene[nn_indices[0]] = true;
-            orig_object_ind.push_back(nn_indices[0]);
+            seed_queue.push_back(seed_ind);
+            processed_scene[seed_ind] = true;
+            orig_object_ind.push_back(seed_ind);
 
             if (is_object_downsampled_) {
-                int closest_orig_ind = nn_indices[0];
-                if (octree_->radiusSearch(p_object, std::sqrt(2) * 0.01, nn_indices, nn_sqrt_distances) > 0){ //we want to add all points within a radius of 1 cm to the result
+                int closest_orig_ind = seed_ind;
+                if (grid.radiusSearch(px, py, pz, std::sqrt(2) * 0.01, nn_indices, nn_sqrt_distances) > 0){ //we want to add all points within a radius of 1 cm to the result
                     for (size_t j = 0; j < nn_indices.size(); j++) {
-                        if (processed_scene[nn_indices[j]] || !pcl::isFinite(scene_->points[nn_indices[j]]))
+                        if (processed_scene[nn_indices[j]] || !scene_soa.isFinite(nn_indices[j]) || isBlocked(nn_indices[j]))
                             continue;
 //                        if (nn_indices[j] == closest_orig_ind) { //only add the closest point to the downsampled point as seed for region growing
 //                            seed_queue.push_back(nn_indices[j]);
@@ -96,8 +134,6 @@ public:
 
             while (sq_idx < seed_queue.size()) {
                 int sidx = seed_queue[sq_idx];
-                const PointT &query_pt = scene_->points[sidx];
-                const pcl::Normal &query_n = scene_normals_->points[sidx];
 
                 //                    if (query_n.curvature > curvature_threshold_) {
                 //                        sq_idx++;
@@ -105,37 +141,25 @@ public:
                 //                        continue;
                 //                    }
 
-                float radius = max_neighbour_distance_;
-
-                if (!octree_->radiusSearch(query_pt, std::sqrt(2) * radius, nn_indices, nn_sqrt_distances)) {
+                if (!grid.radiusSearch(scene_soa.x[sidx], scene_soa.y[sidx], scene_soa.z[sidx], radius, nn_indices, nn_sqrt_distances)) {
                     sq_idx++;
                     continue;
                 }
 
                 for (size_t j = 0; j < nn_indices.size(); j++) {
-                    if (processed_scene[nn_indices[j]] || !pcl::isFinite(scene_->points[nn_indices[j]]))  // Has this point been processed before ?
+                    if (processed_scene[nn_indices[j]] || !scene_soa.isFinite(nn_indices[j]) || isBlocked(nn_indices[j]))  // Has this point been processed before ?
                         continue;
 
 //                    if (scene_normals_->points[nn_indices[j]].curvature > curvature_threshold_)
 //                        //std::cout << "Neighbour point high curvature" <<std::endl;
 //                        continue;
 
-                    Eigen::Vector3f n1;
-                    n1 = query_n.getNormalVector3fMap();
+                    float dot_p = scene_soa.normalDot(sidx, scene_soa, nn_indices[j]);
 
-                    pcl::Normal nn = scene_normals_->points[nn_indices[j]];
-                    const Eigen::Vector3f &n2 = nn.getNormalVector3fMap();
-
-                    double dot_p = n1.dot(n2);
-
-                    if (fabs(dot_p) > cos(eps_angle_threshold_rad)) {
-                        if (color_thr_ != std::numeric_limits<float>::max()) {
+                    if (fabs(dot_p) > cos_eps_angle) {
+                        if (use_color) {
                         //check if also color is similar
-                            Eigen::Vector3i  m_rgb =  query_pt.getRGBVector3i();
-                            Eigen::Vector3f color_m = rgb2lab(m_rgb);
-                            Eigen::Vector3i  o_rgb =  scene_->points[nn_indices[j]].getRGBVector3i();
-                            Eigen::Vector3f color_o = rgb2lab(o_rgb);
-                            float color_distance_ = v4r::computeCIEDE2000(color_o, color_m);
+                            float color_distance_ = v4r::computeCIEDE2000(index.scene_lab[nn_indices[j]], index.scene_lab[sidx]);
                             if (color_distance_ > color_thr_) {
                                 continue;
                             }
@@ -166,6 +190,8 @@ public:
         }
 //        viewer->close();
 //    }
+        //points of the downsampled object radius are added without being marked as processed and can be added again later
+        std::sort(orig_object_ind.begin(), orig_object_ind.end());
         orig_object_ind.erase(std::unique(orig_object_ind.begin(), orig_object_ind.end()), orig_object_ind.end());
         return orig_object_ind;
 
@@ -174,27 +200,35 @@ private:
     typename pcl::PointCloud<PointT>::ConstPtr scene_;
     typename pcl::PointCloud<PointQ>::ConstPtr object_;
     pcl::PointCloud<pcl::Normal>::ConstPtr scene_normals_; //normals of the scene cloud
-    typename pcl::octree::OctreePointCloudSearch<PointT>::Ptr octree_;
+    const RegionGrowingIndex<PointT> *shared_index_ = nullptr;
+    const std::vector<bool> *blocked_ = nullptr;
 
     bool is_object_downsampled_;
 
-    double octree_res_;
     float eps_angle_threshold_deg_;
     float max_neighbour_distance_;
     float curvature_threshold_;
     float color_thr_;
 
-    Eigen::Vector3f rgb2lab(const Eigen::Vector3i &rgb) {
-        cv::Mat rgb_cv (1,1, CV_8UC3);  //this has some information loss because Lab values are also just uchar and not float
-        rgb_cv.at<cv::Vec3b>(0,0)[0] = rgb[0];
-        rgb_cv.at<cv::Vec3b>(0,0)[1] = rgb[1];
-        rgb_cv.at<cv::Vec3b>(0,0)[2] = rgb[2];
-        cv::Mat lab_cv;
-        cv::cvtColor(rgb_cv, lab_cv, CV_RGB2Lab);
-
-        Eigen::Vector3f lab; //from opencv lab to orig lab definition
-        lab << lab_cv.at<cv::Vec3b>(0,0)[0] / 2.55f, lab_cv.at<cv::Vec3b>(0,0)[1] - 128.f, lab_cv.at<cv::Vec3b>(0,0)[2] - 128.f;
-        return lab;
+    bool isBlocked(int ind) const {
+        return blocked_ && (*blocked_)[ind];
+    }
+
+    //closest scene point within max_neighbour_distance_, -1 if there is none. Blocked points are skipped like points
+    //missing in the scene. Ties are broken by the index, the result does not depend on the order of the grid cells.
+    int findSeed(const RadiusSearchGrid &grid, float px, float py, float pz, std::vector<int> &nn_indices, std::vector<float> &nn_sqrt_distances) const {
+        int seed_ind = -1;
+        float seed_sqr_dist = std::numeric_limits<float>::max();
+        grid.radiusSearch(px, py, pz, max_neighbour_distance_, nn_indices, nn_sqrt_distances);
+        for (size_t j = 0; j < nn_indices.size(); j++) {
+            if (isBlocked(nn_indices[j]))
+                continue;
+            if (nn_sqrt_distances[j] < seed_sqr_dist || (nn_sqrt_distances[j] == seed_sqr_dist && nn_indices[j] < seed_ind)) {
+                seed_ind = nn_indices[j];
+                seed_sqr_dist = nn_sqrt_distances[j];
+            }
+        }
+        return seed_ind;
     }
 };
 
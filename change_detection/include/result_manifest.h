@@ -0,0 +1,85 @@
+#ifndef RESULT_MANIFEST_H
+#define RESULT_MANIFEST_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+//file name of the manifest inside the result folder of a scene comparison
+static const std::string result_manifest_filename = "result.manifest";
+
+//A result manifest stores the outcome of one scene comparison in one binary file (native byte order):
+//  header:     char[4] "CDRM", uint32 version, string reference scene, string current scene
+//  timings:    uint32 nr of stages, per stage: string name, double runtime in ms
+//  objects:    uint32 nr of objects, per object: int32 id, uint32 scene, uint32 state, int32 match id, int32 label,
+//              float object confidence, float model confidence, float[16] transform (row major),
+//              uint32 nr of points, nr of points * (float[3] xyz, uint32 rgba)
+//Strings are stored as uint32 length followed by the characters.
+static const uint32_t result_manifest_version = 1;
+
+enum ManifestScene {MANIFEST_REFERENCE, MANIFEST_CURRENT};
+
+struct ManifestObject {
+    int id;
+    ManifestScene scene;
+    int state; //ObjectState of the object
+    int match_id = -1; //id of the object in the other scene, -1 for new and removed objects
+    int label = 0; //label of the object points in the *_objects.pcd result clouds
+    float object_conf = 0.0f;
+    float model_conf = 0.0f;
+    Eigen::Matrix<float,4,4,Eigen::DontAlign> transform = Eigen::Matrix<float,4,4,Eigen::DontAlign>::Identity();
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+};
+
+struct ManifestTiming {
+    std::string stage;
+    double runtime_ms;
+};
+
+struct ResultManifest {
+    std::string ref_scene;
+    std::string curr_scene;
+    std::vector<ManifestTiming> timings;
+    std::vector<ManifestObject> objects;
+
+    void clear() { timings.clear(); objects.clear(); }
+};
+
+bool writeResultManifest(const std::string &path, const ResultManifest &manifest);
+bool readResultManifest(const std::string &path, ResultManifest &manifest);
+
+//object points of the manifest grouped like the *_objects.pcd files of the result folder, including the labels
+struct ManifestResultClouds {
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr ref_removed;
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr ref_displaced;
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr ref_static;
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr curr_new;
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr curr_displaced;
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr curr_static;
+};
+
+ManifestResultClouds extractResultClouds(const ResultManifest &manifest);
+
+//adds the runtime of its scope as a stage to the manifest
+class ManifestStageTimer {
+public:
+    ManifestStageTimer(ResultManifest &manifest, const std::string &stage) :
+        manifest_(manifest), stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    ~ManifestStageTimer() {
+        std::chrono::duration<double, std::milli> runtime = std::chrono::steady_clock::now() - start_;
+        manifest_.timings.push_back(ManifestTiming{stage_, runtime.count()});
+    }
+
+private:
+    ResultManifest &manifest_;
+    std::string stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // RESULT_MANIFEST_H
@@ -0,0 +1,66 @@
+#ifndef SCENE_BUNDLE_H
+#define SCENE_BUNDLE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <Eigen/Core>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+typedef Eigen::Matrix<float,4,4,Eigen::DontAlign> Matrix4f_NotAligned;
+typedef Eigen::Matrix<float,4,1,Eigen::DontAlign> Vector4f_NotAligned;
+
+//storing single pcl points in a container leeds to weird alignment problems
+struct Point3D {
+    float x;
+    float y;
+    float z;
+
+    static float squaredEuclideanDistance (const Point3D& p1, const Point3D& p2)
+    {
+        float diff_x = p2.x - p1.x, diff_y = p2.y - p1.y, diff_z = p2.z - p1.z;
+        return (diff_x*diff_x + diff_y*diff_y + diff_z*diff_z);
+    }
+};
+
+struct ReconstructedPlane {
+    pcl::PointCloud<PointNormal>::Ptr cloud; //can be null if the scene was loaded without clouds
+    size_t nr_points = 0; //size of the cloud, also known if the cloud is not loaded
+    Point3D center_point = {0.f, 0.f, 0.f};
+    Vector4f_NotAligned plane_coeffs = Vector4f_NotAligned::Zero();
+    pcl::PointCloud<pcl::PointXYZ>::Ptr convex_hull_cloud;
+    Matrix4f_NotAligned transform = Matrix4f_NotAligned::Identity(); //already applied to cloud
+    bool is_checked;
+};
+
+//file name of the bundle inside a scene folder
+static const std::string scene_bundle_filename = "scene.bundle";
+
+//A scene bundle stores all reconstructed planes of a scene in one binary file (native byte order):
+//  header:    char[4] "CDSB", uint32 version, uint32 nr of planes
+//  per plane: int32 plane id, float[3] center, float[4] plane coeffs, float[16] transform (row major),
+//             uint32 nr of hull points, uint32 cloud width, uint32 cloud height,
+//             nr of hull points * float[3] (x,y,z),
+//             width*height * (float[3] xyz, float[3] normal, uint32 rgba, float curvature)
+//Every field is 4 bytes, so the file can also be mapped into memory and read in place.
+static const uint32_t scene_bundle_version = 1;
+
+//reads table.txt (convex hulls, plane coefficients, centers), log.txt (transformations) and planes/N/merged_plane_clouds_ds002.pcd
+//without load_clouds only the headers of the pcd files are read
+std::map<int, ReconstructedPlane> loadSceneFromFolder(const std::string &data_path, bool load_clouds = true);
+
+bool writeSceneBundle(const std::string &path, const std::map<int, ReconstructedPlane> &rec_planes);
+bool readSceneBundle(const std::string &path, std::map<int, ReconstructedPlane> &rec_planes, bool load_clouds = true);
+
+//uses the scene bundle of the folder if there is one, otherwise the original folder layout
+std::map<int, ReconstructedPlane> loadScene(const std::string &data_path, bool load_clouds = true);
+
+//loads (again) the cloud of a single plane of a scene that was loaded without clouds or whose cloud was released
+bool loadPlaneCloud(const std::string &data_path, int plane_id, ReconstructedPlane &plane);
+
+#endif // SCENE_BUNDLE_H
@@ -1,8 +1,6 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
-#include <PPFRecognizerParameter.h>
-
 static const double ds_leaf_size_LV = 0.01;
 static const double ds_leaf_size_ppf = 0.005;
 
@@ -12,6 +10,14 @@ static const int min_object_volume = 0.000125; //0.05^3
 
 const float max_dist_for_being_static = 0.2; //how much can the object be displaced to still count as static
 
-static v4r::apps::PPFRecognizerParameter ppf_params;
+//early-out for plane pairs where nothing changed (see occupancy_diff.h)
+static const float occupancy_voxel_sizes[] = {0.08f, 0.04f, 0.02f}; //from coarse to fine
+static const float occupancy_min_height = 0.015f; //points closer to the plane belong to the plane
+static const float occupancy_max_unmatched_ratio = 0.02f; //of all occupied voxels of both planes
+static const int occupancy_max_unmatched_voxels = 4; //always tolerated, e.g. single outliers
+static const float occupancy_max_color_dist = 0.2f; //between the mean colours of a voxel, rgb in [0,1]
+static const float unchanged_min_fitness = 0.5f; //min. overlap of an object of an unchanged plane with its counterpart
+static const float unchanged_min_object_coverage = 0.9f; //of the points of a current object close to a reference object
+static const float unchanged_max_cover_dist = 0.02f; //2 voxels of the downsampled clouds
 
 #endif // SETTINGS_H
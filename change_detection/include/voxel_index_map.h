@@ -0,0 +1,67 @@
+#ifndef VOXEL_INDEX_MAP_H
+#define VOXEL_INDEX_MAP_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "point_soa.h"
+
+typedef pcl::PointXYZRGBNormal PointNormal;
+
+//21 bits per axis, enough for +-10km with 1cm voxels
+inline uint64_t voxelKey(int ix, int iy, int iz) {
+    const int64_t offset = 1 << 20;
+    return (static_cast<uint64_t>(ix + offset) & 0x1FFFFF) << 42 |
+           (static_cast<uint64_t>(iy + offset) & 0x1FFFFF) << 21 |
+           (static_cast<uint64_t>(iz + offset) & 0x1FFFFF);
+}
+
+//Indices of the original points in every voxel of downsampleCloudVG. The voxels are stored sorted by key, the indices of
+//a voxel are consecutive in one array (no container per voxel). A downsampled point is the centroid of its voxel, therefore
+//its voxel is found again from its coordinates and upsampling does not need any spatial search. By rounding, a centroid
+//can lie just outside of its voxel. Near a voxel border the neighbouring voxels are candidates as well, the one with the
+//nearest centroid is taken.
+class VoxelIndexMap {
+public:
+    //same voxel layout as pcl::VoxelGrid: voxel = floor(coordinate / leaf_size)
+    void build(const pcl::PointCloud<PointNormal> &cloud, double leaf_size);
+
+    //appends the indices of the original points in the voxel of the downsampled point; returns false if there is none
+    bool gather(const PointNormal &pt, std::vector<int> &indices) const;
+
+    bool empty() const {
+        return voxel_keys_.empty();
+    }
+
+private:
+    float inv_leaf_size_ = 0.0f;
+    std::vector<uint64_t> voxel_keys_;
+    std::vector<uint32_t> voxel_offsets_; //one more than voxels, the indices of voxel v are [offsets[v], offsets[v+1])
+    std::vector<int> point_indices_;
+    std::vector<float> centroid_x_, centroid_y_, centroid_z_; //per voxel
+};
+
+//Points of a cloud hashed into cubic cells for fixed-radius neighbour searches without a tree. With cells as large as the
+//search radius a search looks at the 27 cells around the query point. The points of a cell are consecutive (indices and a
+//copy of their coordinates), a search reads a few short arrays instead of walking down an octree. Searches are const and
+//can run concurrently.
+class RadiusSearchGrid {
+public:
+    void build(const PointCloudSoA &cloud, float cell_size);
+
+    //indices and squared distances of the finite points within radius, in no particular order. Returns the number of points.
+    size_t radiusSearch(float x, float y, float z, float radius, std::vector<int> &indices, std::vector<float> &sqr_distances) const;
+
+private:
+    float inv_cell_size_ = 0.0f;
+    std::unordered_map<uint64_t, uint32_t> cells_; //cell key -> cell number
+    std::vector<uint32_t> cell_offsets_; //one more than cells, the points of cell c are [offsets[c], offsets[c+1])
+    std::vector<int> point_indices_;
+    std::vector<float> x_, y_, z_; //coordinates in the order of point_indices_
+};
+
+#endif // VOXEL_INDEX_MAP_H
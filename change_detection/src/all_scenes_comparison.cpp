@@ -9,16 +9,29 @@
 
 
 #include <boost/filesystem.hpp>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <stdlib.h>
 #include <chrono>
 
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <pcl/console/parse.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/io/ply_io.h>
 
 #include "change_detection.h"
+#include "daemon_protocol.h"
+#include "object_cloud_store.h"
+#include "object_map.h"
+#include "pair_checkpoint.h"
+#include "result_manifest.h"
+#include "scene_bundle.h"
 
 bool do_LV_before_matching = true;
 
@@ -26,45 +39,55 @@ typedef pcl::PointXYZRGBNormal PointNormal;
 typedef pcl::PointXYZRGB PointRGB;
 typedef pcl::PointXYZRGBL PointLabel;
 
-typedef Eigen::Matrix<float,4,4,Eigen::DontAlign> Matrix4f_NotAligned;
-typedef Eigen::Matrix<float,4,1,Eigen::DontAlign> Vector4f_NotAligned;
+//all state of one scene comparison, a new one is created for every pair of scenes
+struct SceneComparison {
+    PipelineContext context;
 
-//storing single pcl points in a container leeds to weird alignment problems
-struct Point3D {
-    float x;
-    float y;
-    float z;
+    std::string result_path;
+    std::string ppf_model_path;
 
-    static float squaredEuclideanDistance (const Point3D& p1, const Point3D& p2)
-    {
-        float diff_x = p2.x - p1.x, diff_y = p2.y - p1.y, diff_z = p2.z - p1.z;
-        return (diff_x*diff_x + diff_y*diff_y + diff_z*diff_z);
-    }
-};
+    std::map<int, DetectedObject> new_obj;
+    std::map<int, DetectedObject> removed_obj;
+    std::map<int, DetectedObject> pot_new_obj;
+    std::map<int, DetectedObject> pot_removed_obj;
+    std::map<int, DetectedObject> ref_displaced_obj;
+    std::map<int, DetectedObject> curr_displaced_obj;
+    std::map<int, DetectedObject> curr_static_obj;
+    std::map<int, DetectedObject> ref_static_obj;
 
-struct ReconstructedPlane {
-    pcl::PointCloud<PointNormal>::Ptr cloud;
-    Point3D center_point;
-    Vector4f_NotAligned plane_coeffs;
-    pcl::PointCloud<pcl::PointXYZ>::Ptr convex_hull_cloud;
-    bool is_checked;
-};
+    ResultManifest result_manifest;
+
+    //memory-bounded mode: plane clouds are only loaded while the plane is compared and objects with a final state are kept on disk
+    bool bounded_memory = false;
+    ObjectCloudStore object_store;
 
-std::map<int, DetectedObject> new_obj;
-std::map<int, DetectedObject> removed_obj;
-std::map<int, DetectedObject> pot_new_obj;
-std::map<int, DetectedObject> pot_removed_obj;
-std::map<int, DetectedObject> ref_displaced_obj;
-std::map<int, DetectedObject> curr_displaced_obj;
-std::map<int, DetectedObject> curr_static_obj;
-std::map<int, DetectedObject> ref_static_obj;
+    //plane extraction results of the whole run, shared by all comparisons
+    PlaneExtractionCache *extraction_cache = nullptr;
+
+    //compared planes (reference plane ID -> current plane ID) and the plane each object was detected on, needed for the object map
+    std::map<int, int> plane_pairs;
+    std::map<int, int> ref_object_plane;
+    std::map<int, int> curr_object_plane;
+};
 
-std::string ppf_model_path;
-std::string base_result_path;
-std::string result_path;
+//options of a run over the scenes of a room, shared by the command line and the daemon
+struct RunOptions {
+    std::string base_result_path;
+    std::string ppf_config_path;
+    bool bounded_memory = false;
+    //continue the run in base_result_path, pairs with a valid completion record are skipped
+    bool resume = false;
+    PlaneExtractionCache *extraction_cache = nullptr;
+    //PPF config parsed before (daemon), otherwise the config is parsed for every comparison
+    const PipelineContext *ppf_config = nullptr;
+
+    //the daemon streams the progress and the result of every finished comparison to its client
+    std::function<void(const std::string &message)> on_progress;
+    std::function<void(const SceneComparison &comparison)> on_result;
+};
 
 
-std::vector<DetectedObject> fromMapToValVec(std::map<int, DetectedObject> map) {
+std::vector<DetectedObject> fromMapToValVec(const std::map<int, DetectedObject> &map) {
     //transform map into vec to be able to call object matching
     std::vector<DetectedObject> vec;
     vec.reserve(map.size());
@@ -114,328 +137,651 @@ bool readInput(std::string input_path, const pcl::PointCloud<PointNormal>::Ptr &
     }
 }
 
-void createNewModelFolder(DetectedObject &ro, std::string ppf_model_path, std::string result_path) {
-    std::string orig_path = ppf_model_path + "/" + std::to_string(ro.getID());
-    ro.object_folder_path_ = orig_path;
-
-    boost::filesystem::create_directories(orig_path);
-    pcl::io::savePCDFile(orig_path + "/3D_model.pcd", *ro.getObjectCloud()); //PPF will create a new model with the new cloud
+//the model was matched partially and should not be used anymore, the whole model is kept as result
+void removeModel(PipelineContext &context, const DetectedObject &ro, std::string ppf_model_path, std::string result_path) {
+    if (!context.hasModel(ro.getID()))
+        return;
+    std::string dest_folder = result_path + "/model_partially_matched/" + std::to_string(ro.getID());
+    boost::filesystem::create_directories(dest_folder);
+    saveResultCloud(dest_folder + "/3D_model.pcd", *context.modelCloud(ro.getID()));
+    context.removeModel(ro.getID());
+    //the trained PPF model cached in the model folder is outdated as well
+    boost::filesystem::remove_all(ppf_model_path + "/" + std::to_string(ro.getID()));
 }
 
-
-void removeModelFolder(DetectedObject ro, std::string ppf_model_path, std::string result_path) {
-    //there should already exist a folder
-    std::string orig_path = ppf_model_path + "/" + std::to_string(ro.getID());
-    if (boost::filesystem::exists(orig_path)) {
-        boost::filesystem::path dest_folder = result_path + "/model_partially_matched/" + std::to_string(ro.getID());
-        boost::filesystem::create_directories(dest_folder);
-        //count pcd-files in the folder
-        int nr_pcd_files = 0;
-        boost::filesystem::directory_iterator end_iter; // Default constructor for an iterator is the end iterator
-        for (boost::filesystem::directory_iterator iter(dest_folder); iter != end_iter; ++iter) {
-            if (iter->path().extension() == ".pcd")
-                ++nr_pcd_files;
-        }
-
-        //copy the folder to another directory. The model is already matched and should not be used anymore
-        for (const auto& dirEnt : boost::filesystem::recursive_directory_iterator{orig_path})
-        {
-            if (dirEnt.path().extension() == ".pcd") {
-                const auto& path = dirEnt.path();
-                boost::filesystem::path dest_filename = path.stem().string() + std::to_string(nr_pcd_files) + path.extension().string();
-                boost::filesystem::copy(path, dest_folder / dest_filename);
-                std::cout << "Copy " << path << " to " << (dest_folder / path.filename()) << std::endl;
-            }
-        }
-    }
-    boost::filesystem::remove_all(orig_path);
-}
-
-bool updateDetectedObjects(std::vector<DetectedObject>& ref_result, std::vector<DetectedObject>& curr_result) {
+//the plane IDs are -1 if the objects are not from a single plane (e.g. after matching the leftover objects)
+bool updateDetectedObjects(SceneComparison &comparison, std::vector<DetectedObject>& ref_result, std::vector<DetectedObject>& curr_result,
+                           int ref_plane_id = -1, int curr_plane_id = -1) {
     bool isObjectOrModelNew= false;
     for (DetectedObject ro : ref_result) {
+        if (ref_plane_id != -1)
+            comparison.ref_object_plane[ro.getID()] = ref_plane_id;
         if (ro.state_ == ObjectState::REMOVED) {
-            //means that there was a partial match and have to create a new model folder
-            //if (ro.object_folder_path_ == "") {
-            if (pot_removed_obj.find(ro.getID()) == pot_removed_obj.end()) {
-                createNewModelFolder(ro, ppf_model_path, result_path);
+            //means that there was a partial match and we need a model of the new part
+            if (comparison.pot_removed_obj.find(ro.getID()) == comparison.pot_removed_obj.end()) {
+                comparison.context.addModel(ro.getID(), ro.getObjectCloud());
                 isObjectOrModelNew= true;
             }
-            pot_removed_obj[ro.getID()] = ro;
+            comparison.pot_removed_obj[ro.getID()] = ro;
         } else if (ro.state_ == ObjectState::DISPLACED) {
             //means that there was a partial match and we do not need the model anymore
-            if (ro.object_folder_path_ == "") {
-                removeModelFolder(ro, ppf_model_path, result_path);
+            if (ro.partially_matched_) {
+                removeModel(comparison.context, ro, comparison.ppf_model_path, comparison.result_path);
             }
-            ref_displaced_obj[ro.getID()] = ro;
-            pot_removed_obj.erase(ro.getID());
+            comparison.ref_displaced_obj[ro.getID()] = ro;
+            comparison.pot_removed_obj.erase(ro.getID());
         } else if (ro.state_ == ObjectState::STATIC) {
             //means that there was a partial match and we do not need the model anymore
-            if (ro.object_folder_path_ == "") {
-                removeModelFolder(ro, ppf_model_path, result_path);
+            if (ro.partially_matched_) {
+                removeModel(comparison.context, ro, comparison.ppf_model_path, comparison.result_path);
             }
-            ref_static_obj[ro.getID()] = ro;
-            pot_removed_obj.erase(ro.getID());
+            comparison.ref_static_obj[ro.getID()] = ro;
+            comparison.pot_removed_obj.erase(ro.getID());
         }
 
     }
     for (DetectedObject co : curr_result) {
+        if (curr_plane_id != -1)
+            comparison.curr_object_plane[co.getID()] = curr_plane_id;
         if (co.state_ == ObjectState::NEW) {
-            if (pot_new_obj.find(co.getID()) == pot_new_obj.end())
+            if (comparison.pot_new_obj.find(co.getID()) == comparison.pot_new_obj.end())
                 isObjectOrModelNew= true;
-            pot_new_obj[co.getID()] = co;
+            comparison.pot_new_obj[co.getID()] = co;
         } else if (co.state_ == ObjectState::DISPLACED) {
-            curr_displaced_obj[co.getID()] = co;
-            pot_new_obj.erase(co.getID());
+            comparison.curr_displaced_obj[co.getID()] = co;
+            comparison.pot_new_obj.erase(co.getID());
         }  else if (co.state_ == ObjectState::STATIC) {
-            curr_static_obj[co.getID()] = co;
-            pot_new_obj.erase(co.getID());
+            comparison.curr_static_obj[co.getID()] = co;
+            comparison.pot_new_obj.erase(co.getID());
         }
     }
     return isObjectOrModelNew;
 }
 
-//map of map because for one plane several occurrences are possible
-std::map<int, std::map<int, Matrix4f_NotAligned>> transformationParser(std::string path) {
-    std::map<int, std::map<int, Matrix4f_NotAligned>> transformation_map;
-    std::ifstream file(path);
-    if (!file.good()) {
-        std::cerr << "File " << path << "does not exist << std::endl";
-        return transformation_map;
-    }
-    std::string str;
-    //Table 1, start at 1567875713.42, occurance 0. Transform:
-    while (std::getline(file, str)) {
-        if (str.rfind("Table",0) == 0) {
-            std::vector<std::string> row_split_result;
-            boost::split(row_split_result, str, boost::is_any_of(",")); //split the first row
-            std::vector<std::string> split_result;
-            boost::split(split_result, row_split_result[0], boost::is_any_of(" ")); //split "Table 1"
-            int table_nr = std::stoi(split_result[1]);
-            boost::split(split_result, row_split_result[2], boost::is_any_of(" ")); //split " occurance 1. Transform"
-            split_result[2].pop_back();
-            int occurrance = std::stoi(split_result[2]);
-
-            //now extract the transformation matrix
-            Matrix4f_NotAligned mat;
-            std::getline(file, str);
-            boost::split(split_result, str, boost::is_any_of("[[ ]"), boost::token_compress_on);
-            mat(0,0) = std::stof(split_result[2]);
-            mat(0,1) = std::stof(split_result[3]);
-            mat(0,2) = std::stof(split_result[4]);
-            mat(0,3) = std::stof(split_result[5]);
-
-            std::getline(file, str);
-            str = str.substr(2, str.size() - 3); //remove the first 2 chars and the last one
-            boost::trim(str);
-            std::vector<std::string> transf_split_result;
-            boost::split(transf_split_result, str, boost::is_any_of(" "), boost::token_compress_on);
-            mat(1,0) = std::stof(transf_split_result[0]);
-            mat(1,1) = std::stof(transf_split_result[1]);
-            mat(1,2) = std::stof(transf_split_result[2]);
-            mat(1,3) = std::stof(transf_split_result[3]);
-
-            std::getline(file, str);
-            str = str.substr(2, str.size() - 3); //remove the first 2 chars and the last one
-            boost::trim(str);
-            boost::split(transf_split_result, str, boost::is_any_of(" "), boost::token_compress_on);
-            mat(2,0) = std::stof(transf_split_result[0]);
-            mat(2,1) = std::stof(transf_split_result[1]);
-            mat(2,2) = std::stof(transf_split_result[2]);
-            mat(2,3) = std::stof(transf_split_result[3]);
-
-            std::getline(file, str);
-            str = str.substr(2, str.size() - 4); //remove the first 2 chars and the last two
-            boost::trim(str);
-            boost::split(transf_split_result, str, boost::is_any_of(" "), boost::token_compress_on);
-            mat(3,0) = std::stof(transf_split_result[0]);
-            mat(3,1) = std::stof(transf_split_result[1]);
-            mat(3,2) = std::stof(transf_split_result[2]);
-            mat(3,3) = std::stof(transf_split_result[3]);
-
-            //transformation_map[table_nr].insert(std::make_pair(occurrance, mat.inverse())); //from camera frame to map frame
-            transformation_map[table_nr].insert(std::make_pair(occurrance, Eigen::Matrix4f::Identity()));
-        }
+pcl::PointCloud<PointNormal>::Ptr acquirePlaneCloud(const std::string &scene_path, int plane_id, ReconstructedPlane &plane) {
+    if (!plane.cloud && !loadPlaneCloud(scene_path, plane_id, plane))
+        plane.cloud.reset(new pcl::PointCloud<PointNormal>);
+    return plane.cloud;
+}
+
+void releasePlaneCloud(const SceneComparison &comparison, ReconstructedPlane &plane) {
+    if (comparison.bounded_memory)
+        plane.cloud.reset();
+}
+
+//static and displaced objects do not change anymore, they are only needed again for the results
+void spillFinishedObjects(SceneComparison &comparison) {
+    if (!comparison.bounded_memory)
+        return;
+    for (std::map<int, DetectedObject> *objects : {&comparison.ref_displaced_obj, &comparison.curr_displaced_obj, &comparison.ref_static_obj, &comparison.curr_static_obj}) {
+        for (auto &o : *objects)
+            comparison.object_store.spill(o.second);
     }
-    return transformation_map;
 }
 
-std::map<int, ReconstructedPlane> convexHullPtsParser(std::string path) {
-    std::map<int, ReconstructedPlane> rec_planes;
-    std::ifstream file(path);
-    if (!file.good()) {
-        std::cerr << "File " << path << "does not exist << std::endl";
-        return rec_planes;
-    }
-    std::string str;
-    int plane_cnt = 0;
-    while (std::getline(file, str)) {
-        if (str.rfind("center",0) == 0) {
-            std::getline(file, str);
-            Point3D point;
-            std::vector<std::string> split_str;
-            boost::split(split_str, str, boost::is_any_of(":"));
-            point.x = std::stof(split_str[1]);
-
-            std::getline(file, str);
-            boost::split(split_str, str, boost::is_any_of(":"));
-            point.y = std::stof(split_str[1]);
-
-            std::getline(file, str);
-            boost::split(split_str, str, boost::is_any_of(":"));
-            point.z = std::stof(split_str[1]);
-
-            rec_planes[plane_cnt].center_point = point;
-            continue;
+void restoreFinishedObjects(SceneComparison &comparison) {
+    for (std::map<int, DetectedObject> *objects : {&comparison.ref_displaced_obj, &comparison.curr_displaced_obj, &comparison.ref_static_obj, &comparison.curr_static_obj}) {
+        for (auto &o : *objects)
+            comparison.object_store.restore(o.second);
+    }
+}
+
+void addToManifest(SceneComparison &comparison, const std::vector<DetectedObject> &objects, ManifestScene scene) {
+    for (const DetectedObject &obj : objects) {
+        ManifestObject mo;
+        mo.id = obj.getID();
+        mo.scene = scene;
+        mo.state = obj.state_;
+        if (obj.state_ == ObjectState::DISPLACED || obj.state_ == ObjectState::STATIC) {
+            //the match of a current object points to the reference object, the label is based on the reference ID
+            mo.match_id = (scene == MANIFEST_CURRENT) ? obj.match_.model_id : obj.match_.object_id;
+            mo.label = (scene == MANIFEST_CURRENT ? obj.match_.model_id : obj.getID()) * 20;
+            mo.transform = obj.match_.transform;
+            mo.object_conf = obj.match_.fitness_score.object_conf;
+            mo.model_conf = obj.match_.fitness_score.model_conf;
         }
-        if (str.rfind("points",0) != 0) {
+        mo.cloud.reset(new pcl::PointCloud<pcl::PointXYZRGB>);
+        pcl::copyPointCloud(*obj.getObjectCloud(), *mo.cloud);
+        comparison.result_manifest.objects.push_back(mo);
+    }
+}
+
+std::string extractSceneName(std::string path) {
+    size_t last_of;
+    last_of = path.find_last_of("/");
+
+    if (last_of == path.size()-1) {
+        path.erase(last_of,1);
+        last_of = path.find_last_of("/");
+    }
+    return path.substr(last_of+1, path.size()-1);
+}
+
+std::string pairResultPath(const RunOptions &options, const std::string &ref_scene_name, const std::string &curr_scene_name) {
+    return options.base_result_path + ref_scene_name + "-" + curr_scene_name + "/";
+}
+
+//creates the result folder of the comparison of two scenes
+bool setupComparison(SceneComparison &comparison, const RunOptions &options, const std::string &ref_scene_name,
+                     const std::string &curr_scene_name) {
+    comparison.bounded_memory = options.bounded_memory;
+    comparison.extraction_cache = options.extraction_cache;
+    if (options.ppf_config && options.ppf_config->ppfConfigPath() == options.ppf_config_path) {
+        comparison.context.setPPFParams(options.ppf_config->ppfParams(), options.ppf_config_path);
+    } else if (!comparison.context.loadPPFParams(options.ppf_config_path)) {
+        std::cerr << "Could not parse the PPF config " << options.ppf_config_path << std::endl;
+        return false;
+    }
+
+    comparison.result_path = pairResultPath(options, ref_scene_name, curr_scene_name);
+    //the outputs of an interrupted comparison (e.g. its model folders) must not leak into the new one
+    if (options.resume)
+        boost::filesystem::remove_all(comparison.result_path);
+    boost::filesystem::create_directories(comparison.result_path);
+
+    boost::filesystem::copy(options.ppf_config_path, comparison.result_path+"/config.ini");
+
+    //----------------------------setup ppf model folder-------------------------------
+    comparison.ppf_model_path = comparison.result_path + "/model_objects/";
+    boost::filesystem::create_directories(comparison.ppf_model_path);
+
+    comparison.object_store.reset(comparison.result_path + "/object_store");
+    comparison.result_manifest.ref_scene = ref_scene_name;
+    comparison.result_manifest.curr_scene = curr_scene_name;
+    return true;
+}
+
+//compares the planes of the reference scene with the closest planes of the current scene and matches the leftover objects afterwards
+void compareScenes(SceneComparison &comparison, const std::string &reference_path, std::map<int, ReconstructedPlane> &ref_rec_planes,
+                   const std::string &current_path, std::map<int, ReconstructedPlane> &curr_rec_planes) {
+    for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
+        saveDebugCloud(reference_path + "/convex_hull_" + std::to_string(ref_it->first) + ".pcd", *(ref_it->second.convex_hull_cloud));
+    }
+    for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
+        saveDebugCloud(current_path + "/convex_hull_" + std::to_string(curr_it->first) + ".pcd", *(curr_it->second.convex_hull_cloud));
+    }
+
+    //iterate through all reference planes
+    ChangeDetection change_detection(comparison.context);
+    change_detection.setExtractionCache(comparison.extraction_cache);
+    for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
+        if (ref_it->second.nr_points == 0) {
+            ref_it->second.is_checked=true;
             continue;
         }
-        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>());
-        while (std::getline(file, str) && str.rfind("plane", 0) != 0) {
-            boost::trim(str);
-            if (str.rfind("x",0) == 0) {
-                pcl::PointXYZ point;
-                std::vector<std::string> split_str;
-                boost::split(split_str, str, boost::is_any_of(":"));
-                point.x = std::stof(split_str[1]);
-
-                std::getline(file, str);
-                boost::split(split_str, str, boost::is_any_of(":"));
-                point.y = std::stof(split_str[1]);
-
-                std::getline(file, str);
-                boost::split(split_str, str, boost::is_any_of(":"));
-                point.z = std::stof(split_str[1]);
-
-                cloud->points.push_back(point);
+        // find the closest plane in the current scene
+        std::pair<int, ReconstructedPlane> closest_curr_element;
+        float min_dist = std::numeric_limits<float>::max();
+        for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
+            if (curr_it->second.nr_points == 0) {
+                curr_it->second.is_checked=true;
+                continue;
+            }
+            float dist = Point3D::squaredEuclideanDistance(ref_it->second.center_point, curr_it->second.center_point);
+            if (dist < min_dist) {
+                min_dist = dist;
+                closest_curr_element = *curr_it;
             }
         }
-        cloud->height=1;
-        cloud->width=cloud->points.size();
-        rec_planes[plane_cnt].convex_hull_cloud = cloud;
 
-        //now it is time to parse plane:
-        std::getline(file, str);
-        Vector4f_NotAligned plane_coeffs;
-        std::vector<std::string> split_str;
-        boost::split(split_str, str, boost::is_any_of(":"));
-        plane_coeffs[0] = std::stof(split_str[1]); //x
+        if (min_dist < 0.5 && !closest_curr_element.second.is_checked) {
+            ref_it->second.is_checked=true;
+            curr_rec_planes[closest_curr_element.first].is_checked = true;
+            comparison.plane_pairs[ref_it->first] = closest_curr_element.first;
+
+            std::cout << "-------------------------- " << ref_it->first << "-" << closest_curr_element.first << " --------------------------" << std::endl;
+            V4R_TRACE_SCOPE_DYNAMIC("plane pair " + std::to_string(ref_it->first) + "-" + std::to_string(closest_curr_element.first));
+            ManifestStageTimer timer(comparison.result_manifest, "plane pair " + std::to_string(ref_it->first) + "-" + std::to_string(closest_curr_element.first));
+            std::string plane_comparison_path = comparison.result_path + "/" + std::to_string(ref_it->first) + "_" + std::to_string(closest_curr_element.first);
+            boost::filesystem::create_directories(plane_comparison_path);
+
+            std::string merge_object_parts_folder = plane_comparison_path + "/mergeObjectParts";
+            boost::filesystem::create_directory(merge_object_parts_folder);
+
+            ReconstructedPlane &curr_plane = curr_rec_planes[closest_curr_element.first];
+            acquirePlaneCloud(reference_path, ref_it->first, ref_it->second);
+            closest_curr_element.second.cloud = acquirePlaneCloud(current_path, closest_curr_element.first, curr_plane);
+
+            saveDebugCloud(plane_comparison_path + "/ref_cloud.pcd", *ref_it->second.cloud);
+            saveDebugCloud(plane_comparison_path + "/curr_cloud.pcd", *closest_curr_element.second.cloud);
+
 
-        std::getline(file, str);
-        boost::split(split_str, str, boost::is_any_of(":"));
-        plane_coeffs[1] = std::stof(split_str[1]); //y
+            std::vector<DetectedObject> ref_result, curr_result;
+            change_detection.init(ref_it->second.cloud, closest_curr_element.second.cloud,
+                                  ref_it->second.plane_coeffs, closest_curr_element.second.plane_coeffs,
+                                  ref_it->second.convex_hull_cloud, closest_curr_element.second.convex_hull_cloud,
+                                  comparison.ppf_model_path, plane_comparison_path, merge_object_parts_folder);
+            change_detection.compute(ref_result, curr_result);
 
-        std::getline(file, str);
-        boost::split(split_str, str, boost::is_any_of(":"));
-        plane_coeffs[2] = std::stof(split_str[1]); //z
+            //TODO check if all existing model folders are also present in ref_result
+            //all detected objects labeled as removed (ref_objects) or new (curr_objects) could be placed on another plane
+            updateDetectedObjects(comparison, ref_result, curr_result, ref_it->first, closest_curr_element.first);
 
-        std::getline(file, str);
-        boost::split(split_str, str, boost::is_any_of(":"));
-        plane_coeffs[3] = std::stof(split_str[1]); //d
+            releasePlaneCloud(comparison, ref_it->second);
+            releasePlaneCloud(comparison, curr_plane);
+            spillFinishedObjects(comparison);
 
-        rec_planes[plane_cnt].plane_coeffs = plane_coeffs;
 
-        plane_cnt += 1;
+//                    //after collecting potential new and removed objects from the plane, try to match them
+//                    if (comparison.pot_removed_obj.size() != 0 && comparison.pot_new_obj.size() != 0) {
+//                        //transform map into vec to be able to call object matching
+//                        std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
+//                        pot_rem_obj_vec = fromMapToValVec(comparison.pot_removed_obj);
+//                        pot_new_obj_vec = fromMapToValVec(comparison.pot_new_obj);
+//                        ObjectMatching matching(pot_rem_obj_vec, pot_new_obj_vec, comparison.ppf_model_path, comparison.context);
+//                        ref_result.clear(); curr_result.clear();
+//                        matching.compute(ref_result, curr_result);
+
+//                        ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
+//                        ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
+
+//                        updateDetectedObjects(comparison, ref_result, curr_result);
+//                    }
+        }
     }
-    return rec_planes;
-}
 
-std::map<int, ReconstructedPlane> prepareInputData(std::string data_path) {
-    std::map<int, ReconstructedPlane> rec_planes;
-    if(!boost::filesystem::exists(data_path) && !boost::filesystem::is_directory(data_path) ) {
-        std::cerr << "The data path does not exist or is not a directory " << data_path << std::endl;
-        return rec_planes;
-    }
-
-    //TODO Read plane coeffs and convex hull points from DB
-    std::map<int, ReconstructedPlane> center_and_convexHull= convexHullPtsParser(data_path + "/table.txt");
-    std::map<int, std::map<int, Matrix4f_NotAligned>> transformations = transformationParser(data_path + "/log.txt");
-
-    //iterate through all plane folders and extract the reconstructed ply-files
-    int plane_nr = 0;
-    bool found_plane_folder = true;
-    while (found_plane_folder) {
-        std::string plane_nr_path = data_path + "/planes/" + std::to_string(plane_nr);
-        if (boost::filesystem::exists(plane_nr_path) && boost::filesystem::is_directory(plane_nr_path)) {
-            pcl::PointCloud<PointNormal>::Ptr plane_cloud(new pcl::PointCloud<PointNormal>);
-            if (!readInput(plane_nr_path + "/merged_plane_clouds_ds002.pcd", plane_cloud)) {
-                continue;
-            }
-            //transform the ply
-            Matrix4f_NotAligned & mat = transformations[plane_nr][0];
-            pcl::transformPointCloudWithNormals(*plane_cloud, *plane_cloud, mat);
-
-            //save in vector of planeStructs
-            ReconstructedPlane rec_plane;
-            rec_plane.cloud = plane_cloud;
-            rec_plane.is_checked = false;
-            rec_planes[plane_nr] = rec_plane;
-            plane_nr++;
-        } else {
-            found_plane_folder = false;
+
+    //extract objects from all planes where is_checked=false and try to match them
+    for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
+        if (ref_it->second.is_checked == false) {
+            V4R_TRACE_SCOPE_DYNAMIC("leftover ref plane " + std::to_string(ref_it->first));
+            ManifestStageTimer timer(comparison.result_manifest, "leftover ref plane " + std::to_string(ref_it->first));
+            std::string plane_comparison_path = comparison.result_path + "/ref_" + std::to_string(ref_it->first);
+            boost::filesystem::create_directories(plane_comparison_path);
+            acquirePlaneCloud(reference_path, ref_it->first, ref_it->second);
+            saveDebugCloud(plane_comparison_path + "/ref_cloud.pcd", *ref_it->second.cloud);
+
+            std::string merge_object_parts_folder = plane_comparison_path + "/mergeObjectParts";
+            boost::filesystem::create_directory(merge_object_parts_folder);
+
+            std::vector<DetectedObject> ref_result, curr_result;
+            pcl::PointCloud<PointNormal>::Ptr fake_cloud(new pcl::PointCloud<PointNormal>);
+            pcl::PointCloud<pcl::PointXYZ>::Ptr fake_hull_cloud(new pcl::PointCloud<pcl::PointXYZ>);
+            change_detection.init(ref_it->second.cloud, fake_cloud,
+                                  ref_it->second.plane_coeffs, Vector4f_NotAligned(),
+                                  ref_it->second.convex_hull_cloud, fake_hull_cloud,
+                                  comparison.ppf_model_path, plane_comparison_path, merge_object_parts_folder);
+            change_detection.compute(ref_result, curr_result);
+            updateDetectedObjects(comparison, ref_result, curr_result, ref_it->first, -1);
+
+            releasePlaneCloud(comparison, ref_it->second);
+            spillFinishedObjects(comparison);
+        }
+    }
+    for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
+        if (curr_it->second.is_checked == false) {
+            V4R_TRACE_SCOPE_DYNAMIC("leftover curr plane " + std::to_string(curr_it->first));
+            ManifestStageTimer timer(comparison.result_manifest, "leftover curr plane " + std::to_string(curr_it->first));
+            std::string plane_comparison_path = comparison.result_path + "/curr_" + std::to_string(curr_it->first);
+            boost::filesystem::create_directories(plane_comparison_path);
+            acquirePlaneCloud(current_path, curr_it->first, curr_it->second);
+            saveDebugCloud(plane_comparison_path + "/curr_cloud.pcd", *curr_it->second.cloud);
+
+            std::string merge_object_parts_folder = plane_comparison_path + "/mergeObjectParts";
+            boost::filesystem::create_directory(merge_object_parts_folder);
+
+            std::vector<DetectedObject> ref_result, curr_result;
+            pcl::PointCloud<PointNormal>::Ptr fake_cloud(new pcl::PointCloud<PointNormal>);
+            pcl::PointCloud<pcl::PointXYZ>::Ptr fake_hull_cloud(new pcl::PointCloud<pcl::PointXYZ>);
+            change_detection.init(fake_cloud, curr_it->second.cloud,
+                                  Vector4f_NotAligned(), curr_it->second.plane_coeffs,
+                                  fake_hull_cloud, curr_it->second.convex_hull_cloud,
+                                  comparison.ppf_model_path, plane_comparison_path, merge_object_parts_folder);
+            change_detection.compute(ref_result, curr_result);
+            updateDetectedObjects(comparison, ref_result, curr_result, -1, curr_it->first);
+
+            releasePlaneCloud(comparison, curr_it->second);
+            spillFinishedObjects(comparison);
         }
     }
 
-    //merge center point and convex hull points with loaded point cloud
-    for (std::map<int, ReconstructedPlane>::iterator it = center_and_convexHull.begin(); it != center_and_convexHull.end(); it++) {
-        rec_planes.at(it->first).center_point = it->second.center_point;
-        rec_planes.at(it->first).convex_hull_cloud = it->second.convex_hull_cloud;
-        rec_planes.at(it->first).plane_coeffs = it->second.plane_coeffs;
+    //after collecting potential new and removed objects from the plane, try to match them
+    if (comparison.pot_removed_obj.size() != 0 && comparison.pot_new_obj.size() != 0) {
+        V4R_TRACE_SCOPE("Leftover object matching");
+        ManifestStageTimer timer(comparison.result_manifest, "leftover object matching");
+        std::string merge_object_parts_folder = comparison.result_path + "/leftover_mergeObjectParts";
+        boost::filesystem::create_directory(merge_object_parts_folder);
+
+        bool newObjectOrModel = true;
+        while(newObjectOrModel) {
+            //transform map into vec to be able to call object matching
+            std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
+            pot_rem_obj_vec = fromMapToValVec(comparison.pot_removed_obj);
+            pot_new_obj_vec = fromMapToValVec(comparison.pot_new_obj);
+            ObjectMatching matching(std::move(pot_rem_obj_vec), std::move(pot_new_obj_vec), comparison.ppf_model_path, comparison.context);
+            std::vector<DetectedObject> ref_result, curr_result;
+            matching.compute(ref_result, curr_result);
+
+            for (int id : ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder)) //merged completely, the copy in the map is outdated
+                comparison.pot_removed_obj.erase(id);
+            for (int id : ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder))
+                comparison.pot_new_obj.erase(id);
+
+            newObjectOrModel = updateDetectedObjects(comparison, ref_result, curr_result);
+        }
     }
-    return rec_planes;
+
+
+    //all pot. moved objects are in the end either removed or new
+    comparison.removed_obj = comparison.pot_removed_obj;
+    comparison.new_obj = comparison.pot_new_obj;
+
+    std::cout << "FINAL RESULT" << std::endl;
+    std::cout << "Removed objects: " << comparison.removed_obj << std::endl;
+    std::cout << "New objects: " << comparison.new_obj << std::endl;
+    std::cout << "Displaced objects in reference: " << comparison.ref_displaced_obj << std::endl;
+    std::cout << "Displaced objects in current: " << comparison.curr_displaced_obj << std::endl;
+    std::cout << "Static objects in reference: " << comparison.ref_static_obj << std::endl;
+    std::cout << "Static objects in current: " << comparison.curr_static_obj << std::endl;
 }
 
-std::string extractSceneName(std::string path) {
-    size_t last_of;
-    last_of = path.find_last_of("/");
+//writes the result clouds and the manifest of the comparison
+void writeResults(SceneComparison &comparison, const std::string &reference_path, std::map<int, ReconstructedPlane> &ref_rec_planes,
+                  const std::string &current_path, std::map<int, ReconstructedPlane> &curr_rec_planes) {
+    //STORING RESULTS AND VISUALIZE THEM
+    restoreFinishedObjects(comparison);
+
+    //create point clouds of detected objects to save results as pcd-files
+    pcl::PointCloud<PointNormal>::Ptr ref_removed_objects_cloud(new pcl::PointCloud<PointNormal>);
+    pcl::PointCloud<PointLabel>::Ptr ref_displaced_objects_cloud(new pcl::PointCloud<PointLabel>);
+    pcl::PointCloud<PointLabel>::Ptr ref_static_objects_cloud(new pcl::PointCloud<PointLabel>);
+    pcl::PointCloud<PointNormal>::Ptr curr_new_objects_cloud(new pcl::PointCloud<PointNormal>);
+    pcl::PointCloud<PointLabel>::Ptr curr_displaced_objects_cloud(new pcl::PointCloud<PointLabel>);
+    pcl::PointCloud<PointLabel>::Ptr curr_static_objects_cloud(new pcl::PointCloud<PointLabel>);
+
+    //transform maps to vectors
+    std::vector<DetectedObject> removed_obj_vec, new_obj_vec, ref_dis_obj_vec, curr_dis_obj_vec, ref_static_obj_vec, curr_static_obj_vec;
+    removed_obj_vec = fromMapToValVec(comparison.removed_obj);
+    new_obj_vec = fromMapToValVec(comparison.new_obj);
+    ref_dis_obj_vec = fromMapToValVec(comparison.ref_displaced_obj);
+    curr_dis_obj_vec = fromMapToValVec(comparison.curr_displaced_obj);
+    ref_static_obj_vec = fromMapToValVec(comparison.ref_static_obj);
+    curr_static_obj_vec = fromMapToValVec(comparison.curr_static_obj);
+
+    for (auto const & o : comparison.removed_obj) {
+        *ref_removed_objects_cloud += *(o.second.getObjectCloud());
+    }
+    if (!ref_removed_objects_cloud->empty())
+        saveResultCloud(comparison.result_path + "/ref_removed_objects.pcd", *ref_removed_objects_cloud);
 
-    if (last_of == path.size()-1) {
-        path.erase(last_of,1);
-        last_of = path.find_last_of("/");
+    for (auto const & o : comparison.new_obj) {
+        *curr_new_objects_cloud += *(o.second.getObjectCloud());
+    }
+    if (!curr_new_objects_cloud->empty())
+        saveResultCloud(comparison.result_path + "/curr_new_objects.pcd", *curr_new_objects_cloud);
+
+    //assign labels to the object based on the matches for DISPLACED objects
+    for (size_t o = 0; o < ref_dis_obj_vec.size(); o++) {
+        const DetectedObject &ref_object = ref_dis_obj_vec[o];
+        auto curr_obj_iter = std::find_if( curr_dis_obj_vec.begin(), curr_dis_obj_vec.end(),[ref_object]
+                                           (DetectedObject const &o) {return o.match_.model_id == ref_object.getID(); });
+        const DetectedObject &curr_object = *curr_obj_iter;
+        pcl::PointCloud<PointLabel>::Ptr ref_objects_cloud(new pcl::PointCloud<PointLabel>);
+        pcl::PointCloud<PointLabel>::Ptr curr_objects_cloud(new pcl::PointCloud<PointLabel>);
+        pcl::copyPointCloud(*ref_object.getObjectCloud(), *ref_objects_cloud);
+        pcl::copyPointCloud(*curr_object.getObjectCloud(), *curr_objects_cloud);
+        for (size_t i = 0; i < ref_objects_cloud->size(); i++) {
+            ref_objects_cloud->points[i].label=ref_object.getID() * 20;
+        }
+        for (size_t i = 0; i < curr_objects_cloud->size(); i++) {
+            curr_objects_cloud->points[i].label = ref_object.getID() * 20;
+        }
+        *ref_displaced_objects_cloud += *ref_objects_cloud;
+        *curr_displaced_objects_cloud += *curr_objects_cloud;
     }
-    return path.substr(last_of+1, path.size()-1);
-}
 
-int main(int argc, char* argv[])
-{
-    /// Check arguments and print info
-    if (argc < 4) {
-        pcl::console::print_info("\n\
-                                 -- Object change detection based on reconstructions of a plane of interest at two different timestamps for all scenes in the given folder -- : \n\
-                                 \n\
-                                 Syntax: %s room_path \n\
-                                 [Options] \n\
-                                 -r path, where results should be stored, a folder with date and time gets created there \n\
-                                 -c config path for ppf params",
-                                 argv[0]);
-        return(1);
+    if (!ref_displaced_objects_cloud->empty())
+        saveResultCloud(comparison.result_path + "/ref_displaced_objects.pcd", *ref_displaced_objects_cloud);
+    if (!curr_displaced_objects_cloud->empty())
+        saveResultCloud(comparison.result_path + "/curr_displaced_objects.pcd", *curr_displaced_objects_cloud);
+
+
+    //assign labels to the object based on the matches for STATIC objects
+    for (size_t o = 0; o < ref_static_obj_vec.size(); o++) {
+        const DetectedObject &ref_object = ref_static_obj_vec[o];
+        auto curr_obj_iter = std::find_if( curr_static_obj_vec.begin(), curr_static_obj_vec.end(),[ref_object]
+                                           (DetectedObject const &o) {return o.match_.model_id == ref_object.getID(); });
+        const DetectedObject &curr_object = *curr_obj_iter;
+        pcl::PointCloud<PointLabel>::Ptr ref_objects_cloud(new pcl::PointCloud<PointLabel>);
+        pcl::PointCloud<PointLabel>::Ptr curr_objects_cloud(new pcl::PointCloud<PointLabel>);
+        pcl::copyPointCloud(*ref_object.getObjectCloud(), *ref_objects_cloud);
+        pcl::copyPointCloud(*curr_object.getObjectCloud(), *curr_objects_cloud);
+        for (size_t i = 0; i < ref_objects_cloud->size(); i++) {
+            ref_objects_cloud->points[i].label = ref_object.getID() * 20;
+        }
+        for (size_t i = 0; i < curr_objects_cloud->size(); i++) {
+            curr_objects_cloud->points[i].label = ref_object.getID() * 20;
+        }
+        *ref_static_objects_cloud += *ref_objects_cloud;
+        *curr_static_objects_cloud += *curr_objects_cloud;
+    }
+    if (!ref_static_objects_cloud->empty())
+        saveResultCloud(comparison.result_path + "/ref_static_objects.pcd", *ref_static_objects_cloud);
+    if (!curr_static_objects_cloud->empty())
+        saveResultCloud(comparison.result_path + "/curr_static_objects.pcd", *curr_static_objects_cloud);
+
+    //the manifest contains the same objects and labels as the *_objects.pcd files and is read by the evaluation
+    addToManifest(comparison, removed_obj_vec, MANIFEST_REFERENCE);
+    addToManifest(comparison, new_obj_vec, MANIFEST_CURRENT);
+    addToManifest(comparison, ref_dis_obj_vec, MANIFEST_REFERENCE);
+    addToManifest(comparison, curr_dis_obj_vec, MANIFEST_CURRENT);
+    addToManifest(comparison, ref_static_obj_vec, MANIFEST_REFERENCE);
+    addToManifest(comparison, curr_static_obj_vec, MANIFEST_CURRENT);
+    writeResultManifest(comparison.result_path + "/" + result_manifest_filename, comparison.result_manifest);
+
+
+
+    //put all planes together in one file as reference
+    pcl::PointCloud<PointNormal>::Ptr ref_cloud_merged(new pcl::PointCloud<PointNormal>);
+    pcl::PointCloud<PointNormal>::Ptr curr_cloud_merged(new pcl::PointCloud<PointNormal>);
+
+    for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
+        //crop cloud according to the convex hull points, find min and max values in x and y direction
+        pcl::PointXYZ max_hull_pt, min_hull_pt;
+        pcl::getMinMax3D(*(ref_it->second.convex_hull_cloud), min_hull_pt, max_hull_pt);
+
+        //add some alignment because hull points were computed from a full room reconstruction that may include drift
+        pcl::PointCloud<PointNormal>::Ptr cropped_cloud(new pcl::PointCloud<PointNormal>);
+        pcl::PassThrough<PointNormal> pass;
+        pass.setInputCloud(acquirePlaneCloud(reference_path, ref_it->first, ref_it->second));
+        pass.setFilterFieldName("x");
+        pass.setFilterLimits(min_hull_pt.x - 0.15, max_hull_pt.x + 0.15);
+        pass.setKeepOrganized(true);
+        pass.filter(*cropped_cloud);
+        pass.setInputCloud(cropped_cloud);
+        pass.setFilterFieldName("y");
+        pass.setFilterLimits(min_hull_pt.y - 0.15, max_hull_pt.y + 0.15);
+        pass.setKeepOrganized(true);
+        pass.filter(*cropped_cloud);
+        releasePlaneCloud(comparison, ref_it->second);
+
+        //only the downsampled planes are kept, the merged cloud is downsampled with the same leaf size anyway
+        if (comparison.bounded_memory)
+            cropped_cloud = downsampleCloudVG(cropped_cloud, 0.01);
+        *ref_cloud_merged += *cropped_cloud;
     }
+    pcl::PointCloud<PointNormal>::Ptr ref_merged_ds(new pcl::PointCloud<PointNormal>);
+    ref_merged_ds = downsampleCloudVG(ref_cloud_merged, 0.01);
+    saveResultCloud(comparison.result_path + "/ref_cloud_merged.pcd", *ref_merged_ds);
+
+    for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
+        //crop cloud according to the convex hull points, find min and max values in x and y direction
+        pcl::PointXYZ max_hull_pt, min_hull_pt;
+        pcl::getMinMax3D(*(curr_it->second.convex_hull_cloud), min_hull_pt, max_hull_pt);
+
+        //add some alignment because hull points were computed from a full room reconstruction that may include drift
+        pcl::PointCloud<PointNormal>::Ptr cropped_cloud(new pcl::PointCloud<PointNormal>);
+        pcl::PassThrough<PointNormal> pass;
+        pass.setInputCloud(acquirePlaneCloud(current_path, curr_it->first, curr_it->second));
+        pass.setFilterFieldName("x");
+        pass.setFilterLimits(min_hull_pt.x - 0.15, max_hull_pt.x + 0.15);
+        pass.setKeepOrganized(true);
+        pass.filter(*cropped_cloud);
+        pass.setInputCloud(cropped_cloud);
+        pass.setFilterFieldName("y");
+        pass.setFilterLimits(min_hull_pt.y - 0.15, max_hull_pt.y + 0.15);
+        pass.setKeepOrganized(true);
+        pass.filter(*cropped_cloud);
+        releasePlaneCloud(comparison, curr_it->second);
+
+        //only the downsampled planes are kept, the merged cloud is downsampled with the same leaf size anyway
+        if (comparison.bounded_memory)
+            cropped_cloud = downsampleCloudVG(cropped_cloud, 0.01);
+        *curr_cloud_merged += *cropped_cloud;
+    }
+    pcl::PointCloud<PointNormal>::Ptr curr_merged_ds(new pcl::PointCloud<PointNormal>);
+    curr_merged_ds = downsampleCloudVG(curr_cloud_merged, 0.01);
+    saveResultCloud(comparison.result_path + "/curr_cloud_merged.pcd", *curr_merged_ds);
 
-    /// Parse command line arguments
-    std::string room_path = argv[1];
-    std::string ppf_config_path_path="";
-    pcl::console::parse(argc, argv, "-r", base_result_path);
-    pcl::console::parse(argc, argv, "-c", ppf_config_path_path);
+    comparison.object_store.clear();
 
-    //extract all scene folders
-    if (!boost::filesystem::exists(room_path) || !boost::filesystem::is_directory(room_path)) {
-        std::cout << room_path << " does not exist or is not a directory" << std::endl;
-        return -1;
+    //visualization with PCLViewer
+    //copy the fused cloud and add colored points from detected objects (e.g. removed ones red, new ones green, and displaced ones r and g random and b high number)
+    //ObjectVisualization vis(ref_cloud_merged, curr_cloud_merged, removed_obj_vec, new_obj_vec,
+    //                        ref_dis_obj_vec, curr_dis_obj_vec, ref_static_obj_vec, curr_static_obj_vec);
+    //vis.visualize();
+}
+
+//applies the NEW, REMOVED, DISPLACED and STATIC transitions of a comparison between the map and a new scene to the map
+void updateObjectMap(ObjectMap &object_map, const SceneComparison &comparison, const std::string &scene_path,
+                     std::map<int, ReconstructedPlane> &curr_rec_planes, const std::string &scene_name) {
+    //compared planes are replaced by their latest observation, all other planes of the scene are new in the map
+    std::map<int, int> curr_to_map_plane;
+    for (auto const &plane_pair : comparison.plane_pairs)
+        curr_to_map_plane[plane_pair.second] = plane_pair.first;
+    for (auto &curr_plane : curr_rec_planes) {
+        if (curr_plane.second.nr_points == 0)
+            continue;
+        acquirePlaneCloud(scene_path, curr_plane.first, curr_plane.second);
+        auto map_plane_it = curr_to_map_plane.find(curr_plane.first);
+        if (map_plane_it != curr_to_map_plane.end())
+            object_map.updatePlane(map_plane_it->second, curr_plane.second);
+        else
+            curr_to_map_plane[curr_plane.first] = object_map.addPlane(curr_plane.second);
+        releasePlaneCloud(comparison, curr_plane.second);
     }
-    std::vector<std::string> all_scene_paths;
-    for (boost::filesystem::directory_entry& scene : boost::filesystem::directory_iterator(room_path)) {
-        if (boost::filesystem::is_directory(scene)) {
-            std::string p = scene.path().string();
-            if (p.find("scene", p.length()-8) !=std::string::npos)
-                all_scene_paths.push_back(p);
+    auto mapPlaneOfCurrObject = [&](int curr_obj_id) {
+        auto plane_it = comparison.curr_object_plane.find(curr_obj_id);
+        if (plane_it == comparison.curr_object_plane.end())
+            return -1;
+        return curr_to_map_plane[plane_it->second];
+    };
+
+    //the reference objects were extracted again from the map planes, they get the ID of the map object at the same place
+    auto mapObjectID = [&](const DetectedObject &ro) {
+        auto plane_it = comparison.ref_object_plane.find(ro.getID());
+        const int plane_id = (plane_it == comparison.ref_object_plane.end()) ? -1 : plane_it->second;
+        int id = object_map.findObject(plane_id, ro.getObjectCloud());
+        if (id == -1) //e.g. the objects of the first scene of the map
+            id = object_map.addObject(plane_id, ObjectState::UNKNOWN, ro.getObjectCloud(), object_map.lastScene(), object_map.lastScene());
+        return id;
+    };
+
+    for (auto const &o : comparison.removed_obj)
+        object_map.removeObject(mapObjectID(o.second));
+
+    //the match of a current object points to the reference object, its transform aligns the reference object to the current one
+    auto observeMatchedObjects = [&](const std::map<int, DetectedObject> &ref_objects, const std::map<int, DetectedObject> &curr_objects) {
+        for (auto const &o : curr_objects) {
+            const DetectedObject &co = o.second;
+            auto ro_it = ref_objects.find(co.match_.model_id);
+            if (ro_it == ref_objects.end())
+                continue;
+            const int map_id = mapObjectID(ro_it->second);
+            int plane_id = mapPlaneOfCurrObject(co.getID());
+            if (plane_id == -1)
+                plane_id = object_map.objects().at(map_id).plane_id;
+            object_map.observeObject(map_id, plane_id, co.state_, co.getObjectCloud(), Eigen::Matrix4f(co.match_.transform), scene_name);
+        }
+    };
+    observeMatchedObjects(comparison.ref_displaced_obj, comparison.curr_displaced_obj);
+    observeMatchedObjects(comparison.ref_static_obj, comparison.curr_static_obj);
+
+    for (auto const &o : comparison.new_obj)
+        object_map.addObject(mapPlaneOfCurrObject(o.first), ObjectState::NEW, o.second.getObjectCloud(), scene_name, scene_name);
+
+    object_map.addScene(scene_name);
+}
+
+//marks the comparison as complete once all its results are on disk, a resumed run skips it
+bool finishComparison(const SceneComparison &comparison) {
+    ArtifactWriter::instance().flush();
+    return writePairCheckpoint(comparison.result_path, comparison.result_manifest.ref_scene, comparison.result_manifest.curr_scene);
+}
+
+//incremental mode: every scene is only compared against the object map, which is updated afterwards. Scenes that are already
+//part of the map are skipped, so adding a scene to a room needs only one comparison. The map is only saved after the completion
+//record of the comparison was written, a scene whose comparison was interrupted is not part of the map and compared again.
+int runIncremental(const std::vector<std::string> &all_scene_paths, const std::string &map_path, const RunOptions &options) {
+    ObjectMap object_map;
+    if (object_map.load(map_path))
+        std::cout << "Continue the object map " << map_path << " with " << object_map.scenes().size() << " scenes" << std::endl;
+
+    //start at 1 because element 0 is scene1 without objects
+    for (size_t idx = 1; idx < all_scene_paths.size(); idx++) {
+        const std::string &current_path = all_scene_paths[idx];
+        std::string curr_scene_name = extractSceneName(current_path);
+        if (object_map.containsScene(curr_scene_name))
+            continue;
+
+        if (object_map.empty()) {
+            object_map.init(loadScene(current_path), curr_scene_name);
+            if (!object_map.save(map_path))
+                return -1;
+            continue;
+        }
+
+        std::string ref_scene_name = object_map.lastScene();
+        V4R_TRACE_SCOPE_DYNAMIC(ref_scene_name + "-" + curr_scene_name);
+        if (options.on_progress)
+            options.on_progress("Comparing " + curr_scene_name + " with the object map (" + std::to_string(idx) + "/" + std::to_string(all_scene_paths.size()-1) + ")");
+
+        SceneComparison comparison;
+        if (!setupComparison(comparison, options, ref_scene_name, curr_scene_name))
+            return -1;
+
+        std::map<int, ReconstructedPlane> &map_planes = object_map.planes();
+        for (auto &p : map_planes)
+            p.second.is_checked = false;
+        std::map<int, ReconstructedPlane> curr_rec_planes;
+        {
+            ManifestStageTimer timer(comparison.result_manifest, "load scenes");
+            curr_rec_planes = loadScene(current_path, !comparison.bounded_memory);
+        }
+
+        //the planes of the map are stored as scene bundle in the map folder and can be read again from there
+        compareScenes(comparison, map_path, map_planes, current_path, curr_rec_planes);
+        writeResults(comparison, map_path, map_planes, current_path, curr_rec_planes);
+        if (!finishComparison(comparison))
+            return -1;
+
+        {
+            V4R_TRACE_SCOPE("update object map");
+            updateObjectMap(object_map, comparison, current_path, curr_rec_planes, curr_scene_name);
+            if (!object_map.save(map_path))
+                return -1;
+        }
+        if (options.on_result)
+            options.on_result(comparison);
+        if (comparison.bounded_memory) {
+            for (auto &p : map_planes)
+                p.second.cloud.reset();
+        }
+
+        std::cout << "OBJECT MAP after " << curr_scene_name << std::endl;
+        for (auto const &o : object_map.objects()) {
+            const MapObject &mo = o.second;
+            std::cout << "Object " << mo.id << " on plane " << mo.plane_id << ": state " << mo.state << ", first seen in " << mo.first_seen_scene
+                      << ", last seen in " << mo.last_seen_scene << std::endl;
         }
     }
-    std::sort(all_scene_paths.begin(), all_scene_paths.end());
+    return 0;
+}
 
-    std::string timestamp = getCurrentTime();
-    base_result_path =  base_result_path + "/" + timestamp + (do_LV_before_matching ? "_withLV":"" ) + "_filterUnwantedObjects_clusterMatchingDiff_mergeObj10deg_fullPipeline/";
-    //----------------------------setup result folder----------------------------------
+//compares every scene with every later scene
+int runAllPairs(const std::vector<std::string> &all_scene_paths, const RunOptions &options) {
+    const size_t nr_pairs = all_scene_paths.size() < 3 ? 0 : (all_scene_paths.size()-1) * (all_scene_paths.size()-2) / 2;
+    size_t pair_idx = 0;
     //start at 1 because element 0 is scene1 without objects
     for (size_t idx = 1; idx < all_scene_paths.size(); idx++)
     {
@@ -446,24 +792,21 @@ int main(int argc, char* argv[])
             //extract the two scene names
             std::string ref_scene_name = extractSceneName(reference_path);
             std::string curr_scene_name = extractSceneName(current_path);
+            V4R_TRACE_SCOPE_DYNAMIC(ref_scene_name + "-" + curr_scene_name);
+            const std::string pair_progress = " (" + std::to_string(++pair_idx) + "/" + std::to_string(nr_pairs) + ")";
+            if (options.resume && verifyPairCheckpoint(pairResultPath(options, ref_scene_name, curr_scene_name), ref_scene_name, curr_scene_name)) {
+                std::cout << ref_scene_name << "-" << curr_scene_name << " is already complete" << std::endl;
+                if (options.on_progress)
+                    options.on_progress(ref_scene_name + "-" + curr_scene_name + " is already complete" + pair_progress);
+                continue;
+            }
+            if (options.on_progress)
+                options.on_progress("Comparing " + ref_scene_name + " with " + curr_scene_name + pair_progress);
 
-            result_path = base_result_path + ref_scene_name + "-" + curr_scene_name + "/";
-            boost::filesystem::create_directories(result_path);
-
-            boost::filesystem::copy(ppf_config_path_path, result_path+"/config.ini");
-
-            //----------------------------setup ppf model folder-------------------------------
-            ppf_model_path = result_path + "/model_objects/";
-            boost::filesystem::create_directories(ppf_model_path);
-
-            pot_removed_obj.clear();
-            pot_new_obj.clear();
-            ref_displaced_obj.clear();
-            curr_displaced_obj.clear();
-            ref_static_obj.clear();
-            curr_static_obj.clear();
-            new_obj.clear();
-            removed_obj.clear();
+            //----------------------------setup result folder----------------------------------
+            SceneComparison comparison;
+            if (!setupComparison(comparison, options, ref_scene_name, curr_scene_name))
+                return -1;
 
             /// Input: Two reconstructed POI in map frame with RGB, Normals and Lables (?), coefficients of the plane/plane points
             /// Parameters:
@@ -473,309 +816,253 @@ int main(int argc, char* argv[])
             ///     - filter objects (based on size, planarity, color...)
 
             //-----------------------read convex hull points and transformations into map frame from input files-----------------------------------
-            std::map<int, ReconstructedPlane> ref_rec_planes = prepareInputData(reference_path);
-            std::map<int, ReconstructedPlane> curr_rec_planes = prepareInputData(current_path);
-
-            for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
-                pcl::io::savePCDFile(reference_path + "/convex_hull_" + std::to_string(ref_it->first) + ".pcd", *(ref_it->second.convex_hull_cloud));
-            }
-            for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
-                pcl::io::savePCDFile(current_path + "/convex_hull_" + std::to_string(curr_it->first) + ".pcd", *(curr_it->second.convex_hull_cloud));
+            std::map<int, ReconstructedPlane> ref_rec_planes, curr_rec_planes;
+            {
+                ManifestStageTimer timer(comparison.result_manifest, "load scenes");
+                ref_rec_planes = loadScene(reference_path, !comparison.bounded_memory);
+                curr_rec_planes = loadScene(current_path, !comparison.bounded_memory);
             }
 
-            //iterate through all reference planes
-            ChangeDetection change_detection(ppf_config_path_path);
-            for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
-                if (ref_it->second.cloud->empty()) {
-                    ref_it->second.is_checked=true;
-                    continue;
-                }
-                // find the closest plane in the current scene
-                std::pair<int, ReconstructedPlane> closest_curr_element;
-                float min_dist = std::numeric_limits<float>::max();
-                for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
-                    if (curr_it->second.cloud->empty()) {
-                        curr_it->second.is_checked=true;
-                        continue;
-                    }
-                    float dist = Point3D::squaredEuclideanDistance(ref_it->second.center_point, curr_it->second.center_point);
-                    if (dist < min_dist) {
-                        min_dist = dist;
-                        closest_curr_element = *curr_it;
-                    }
-                }
-
-                if (min_dist < 0.5 && !closest_curr_element.second.is_checked) {
-                    ref_it->second.is_checked=true;
-                    curr_rec_planes[closest_curr_element.first].is_checked = true;
-
-                    std::cout << "-------------------------- " << ref_it->first << "-" << closest_curr_element.first << " --------------------------" << std::endl;
-                    std::string plane_comparison_path = result_path + "/" + std::to_string(ref_it->first) + "_" + std::to_string(closest_curr_element.first);
-                    boost::filesystem::create_directories(plane_comparison_path);
-
-                    std::string merge_object_parts_folder = plane_comparison_path + "/mergeObjectParts";
-                    boost::filesystem::create_directory(merge_object_parts_folder);
-
-                    pcl::io::savePCDFile(plane_comparison_path + "/ref_cloud.pcd", *ref_it->second.cloud);
-                    pcl::io::savePCDFile(plane_comparison_path + "/curr_cloud.pcd", *closest_curr_element.second.cloud);
-
-
-                    std::vector<DetectedObject> ref_result, curr_result;
-                    change_detection.init(ref_it->second.cloud, closest_curr_element.second.cloud,
-                                          ref_it->second.plane_coeffs, closest_curr_element.second.plane_coeffs,
-                                          ref_it->second.convex_hull_cloud, closest_curr_element.second.convex_hull_cloud,
-                                          ppf_model_path, plane_comparison_path, merge_object_parts_folder);
-                    change_detection.compute(ref_result, curr_result);
-
-                    //TODO check if all existing model folders are also present in ref_result
-                    //all detected objects labeled as removed (ref_objects) or new (curr_objects) could be placed on another plane
-                    updateDetectedObjects(ref_result, curr_result);
+            compareScenes(comparison, reference_path, ref_rec_planes, current_path, curr_rec_planes);
+            writeResults(comparison, reference_path, ref_rec_planes, current_path, curr_rec_planes);
+            if (!finishComparison(comparison))
+                return -1;
+            if (options.on_result)
+                options.on_result(comparison);
+        }
+    }
+    return 0;
+}
 
+//all scene folders of the room, sorted by name
+bool collectScenePaths(const std::string &room_path, std::vector<std::string> &all_scene_paths) {
+    if (!boost::filesystem::exists(room_path) || !boost::filesystem::is_directory(room_path)) {
+        std::cout << room_path << " does not exist or is not a directory" << std::endl;
+        return false;
+    }
+    for (boost::filesystem::directory_entry& scene : boost::filesystem::directory_iterator(room_path)) {
+        if (boost::filesystem::is_directory(scene)) {
+            std::string p = scene.path().string();
+            if (p.find("scene", p.length()-8) !=std::string::npos)
+                all_scene_paths.push_back(p);
+        }
+    }
+    std::sort(all_scene_paths.begin(), all_scene_paths.end());
+    return true;
+}
 
-//                    //after collecting potential new and removed objects from the plane, try to match them
-//                    if (pot_removed_obj.size() != 0 && pot_new_obj.size() != 0) {
-//                        //transform map into vec to be able to call object matching
-//                        std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
-//                        pot_rem_obj_vec = fromMapToValVec(pot_removed_obj);
-//                        pot_new_obj_vec = fromMapToValVec(pot_new_obj);
-//                        ObjectMatching matching(pot_rem_obj_vec, pot_new_obj_vec, ppf_model_path, ppf_config_path_path);
-//                        ref_result.clear(); curr_result.clear();
-//                        matching.compute(ref_result, curr_result);
+//a folder with date and time is created in the result path of every run
+std::string createBaseResultPath(const std::string &result_path) {
+    std::string timestamp = getCurrentTime();
+    return result_path + "/" + timestamp + (do_LV_before_matching ? "_withLV":"" ) + "_filterUnwantedObjects_clusterMatchingDiff_mergeObj10deg_fullPipeline/";
+}
 
-//                        ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
-//                        ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
+PairResult toPairResult(const SceneComparison &comparison) {
+    PairResult result;
+    result.ref_scene = comparison.result_manifest.ref_scene;
+    result.curr_scene = comparison.result_manifest.curr_scene;
+    result.result_path = comparison.result_path;
+    result.nr_removed = comparison.removed_obj.size();
+    result.nr_new = comparison.new_obj.size();
+    result.nr_ref_displaced = comparison.ref_displaced_obj.size();
+    result.nr_curr_displaced = comparison.curr_displaced_obj.size();
+    result.nr_ref_static = comparison.ref_static_obj.size();
+    result.nr_curr_static = comparison.curr_static_obj.size();
+    return result;
+}
 
-//                        updateDetectedObjects(ref_result, curr_result);
-//                    }
-                }
-            }
+//PPF config of the daemon, parsed again only if the file changed
+struct CachedPPFConfig {
+    std::time_t last_write_time = 0;
+    PipelineContext context;
+};
 
+//runs one job of a client and streams the progress and the results of the comparisons to it. If the client goes away,
+//the job is still finished, the results are on disk anyway.
+int runJob(int fd, const ComparisonJob &job, PlaneExtractionCache &extraction_cache, std::map<std::string, CachedPPFConfig> &ppf_configs) {
+    if (!isArtifactLevel(job.artifact_level)) {
+        sendFrame(fd, encodeError("Invalid artifact level " + std::to_string(job.artifact_level) + ", it has to be 0, 1 or 2"));
+        return -1;
+    }
 
-            //extract objects from all planes where is_checked=false and try to match them
-            for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
-                if (ref_it->second.is_checked == false) {
-                    std::string plane_comparison_path = result_path + "/ref_" + std::to_string(ref_it->first);
-                    boost::filesystem::create_directories(plane_comparison_path);
-                    pcl::io::savePCDFile(plane_comparison_path + "/ref_cloud.pcd", *ref_it->second.cloud);
-
-                    std::string merge_object_parts_folder = plane_comparison_path + "/mergeObjectParts";
-                    boost::filesystem::create_directory(merge_object_parts_folder);
-
-                    std::vector<DetectedObject> ref_result, curr_result;
-                    pcl::PointCloud<PointNormal>::Ptr fake_cloud(new pcl::PointCloud<PointNormal>);
-                    pcl::PointCloud<pcl::PointXYZ>::Ptr fake_hull_cloud(new pcl::PointCloud<pcl::PointXYZ>);
-                    change_detection.init(ref_it->second.cloud, fake_cloud,
-                                          ref_it->second.plane_coeffs, Vector4f_NotAligned(),
-                                          ref_it->second.convex_hull_cloud, fake_hull_cloud,
-                                          ppf_model_path, plane_comparison_path, merge_object_parts_folder);
-                    change_detection.compute(ref_result, curr_result);
-                    updateDetectedObjects(ref_result, curr_result);
-                }
-            }
-            for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
-                if (curr_it->second.is_checked == false) {
-                    std::string plane_comparison_path = result_path + "/curr_" + std::to_string(curr_it->first);
-                    boost::filesystem::create_directories(plane_comparison_path);
-                    pcl::io::savePCDFile(plane_comparison_path + "/curr_cloud.pcd", *curr_it->second.cloud);
-
-                    std::string merge_object_parts_folder = plane_comparison_path + "/mergeObjectParts";
-                    boost::filesystem::create_directory(merge_object_parts_folder);
-
-                    std::vector<DetectedObject> ref_result, curr_result;
-                    pcl::PointCloud<PointNormal>::Ptr fake_cloud(new pcl::PointCloud<PointNormal>);
-                    pcl::PointCloud<pcl::PointXYZ>::Ptr fake_hull_cloud(new pcl::PointCloud<pcl::PointXYZ>);
-                    change_detection.init(fake_cloud, curr_it->second.cloud,
-                                          Vector4f_NotAligned(), curr_it->second.plane_coeffs,
-                                          fake_hull_cloud, curr_it->second.convex_hull_cloud,
-                                          ppf_model_path, plane_comparison_path, merge_object_parts_folder);
-                    change_detection.compute(ref_result, curr_result);
-                    updateDetectedObjects(ref_result, curr_result);
-                }
-            }
+    std::vector<std::string> all_scene_paths;
+    if (!collectScenePaths(job.room_path, all_scene_paths)) {
+        sendFrame(fd, encodeError(job.room_path + " does not exist or is not a directory"));
+        return -1;
+    }
 
-            //after collecting potential new and removed objects from the plane, try to match them
-            if (pot_removed_obj.size() != 0 && pot_new_obj.size() != 0) {
-                std::string merge_object_parts_folder = result_path + "/leftover_mergeObjectParts";
-                boost::filesystem::create_directory(merge_object_parts_folder);
-
-                bool newObjectOrModel = true;
-                while(newObjectOrModel) {
-                    //transform map into vec to be able to call object matching
-                    std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
-                    pot_rem_obj_vec = fromMapToValVec(pot_removed_obj);
-                    pot_new_obj_vec = fromMapToValVec(pot_new_obj);
-                    ObjectMatching matching(pot_rem_obj_vec, pot_new_obj_vec, ppf_model_path, ppf_config_path_path);
-                    std::vector<DetectedObject> ref_result, curr_result;
-                    matching.compute(ref_result, curr_result);
-
-                    ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
-                    ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
-
-                    newObjectOrModel = updateDetectedObjects(ref_result, curr_result);
-                }
+    RunOptions options;
+    options.base_result_path = job.resume_path.empty() ? createBaseResultPath(job.result_path) : job.resume_path + "/";
+    options.resume = !job.resume_path.empty();
+    options.ppf_config_path = job.ppf_config_path;
+    options.bounded_memory = job.bounded_memory;
+    options.extraction_cache = &extraction_cache;
+    if (boost::filesystem::exists(job.ppf_config_path)) {
+        CachedPPFConfig &config = ppf_configs[job.ppf_config_path];
+        std::time_t last_write_time = boost::filesystem::last_write_time(job.ppf_config_path);
+        if (config.context.ppfConfigPath().empty() || config.last_write_time != last_write_time) {
+            if (!config.context.loadPPFParams(job.ppf_config_path)) {
+                ppf_configs.erase(job.ppf_config_path);
+                sendFrame(fd, encodeError("Could not parse the PPF config " + job.ppf_config_path));
+                return -1;
             }
+            config.last_write_time = last_write_time;
+        }
+        options.ppf_config = &config.context;
+    }
+    options.on_progress = [fd](const std::string &message) { sendFrame(fd, encodeProgress(message)); };
+    options.on_result = [fd](const SceneComparison &comparison) { sendFrame(fd, encodePair(toPairResult(comparison))); };
+
+    ArtifactWriter::instance().setLevel(static_cast<ArtifactLevel>(job.artifact_level));
+    int ret = job.map_path.empty() ? runAllPairs(all_scene_paths, options) : runIncremental(all_scene_paths, job.map_path, options);
+    //the client may read the results as soon as the job is done
+    ArtifactWriter::instance().flush();
+    return ret;
+}
 
+//daemon mode: the process with the thread pool, the parsed PPF configs and the plane extraction caches stays alive and runs the
+//jobs clients send over the socket. Jobs run one after another, every comparison is parallelized by the task scheduler anyway.
+int runDaemon(const std::string &socket_path) {
+    int listen_fd = listenOnUnixSocket(socket_path);
+    if (listen_fd == -1)
+        return -1;
+    std::cout << "Waiting for comparison jobs on " << socket_path << std::endl;
+
+    //the normals are not kept for memory-bounded jobs, see PlaneExtractionCache
+    PlaneExtractionCache extraction_cache, bounded_extraction_cache(false);
+    std::string cached_room_path;
+    std::map<std::string, CachedPPFConfig> ppf_configs;
+
+    bool shutdown = false;
+    while (!shutdown) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd == -1) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "Could not accept a connection on " << socket_path << ": " << std::strerror(errno) << std::endl;
+            break;
+        }
 
-            //all pot. moved objects are in the end either removed or new
-            removed_obj = pot_removed_obj;
-            new_obj = pot_new_obj;
-
-            std::cout << "FINAL RESULT" << std::endl;
-            std::cout << "Removed objects: " << removed_obj << std::endl;
-            std::cout << "New objects: " << new_obj << std::endl;
-            std::cout << "Displaced objects in reference: " << ref_displaced_obj << std::endl;
-            std::cout << "Displaced objects in current: " << curr_displaced_obj << std::endl;
-            std::cout << "Static objects in reference: " << ref_static_obj << std::endl;
-            std::cout << "Static objects in current: " << curr_static_obj << std::endl;
-
-
-            //STORING RESULTS AND VISUALIZE THEM
-
-            //create point clouds of detected objects to save results as pcd-files
-            pcl::PointCloud<PointNormal>::Ptr ref_removed_objects_cloud(new pcl::PointCloud<PointNormal>);
-            pcl::PointCloud<PointLabel>::Ptr ref_displaced_objects_cloud(new pcl::PointCloud<PointLabel>);
-            pcl::PointCloud<PointLabel>::Ptr ref_static_objects_cloud(new pcl::PointCloud<PointLabel>);
-            pcl::PointCloud<PointNormal>::Ptr curr_new_objects_cloud(new pcl::PointCloud<PointNormal>);
-            pcl::PointCloud<PointLabel>::Ptr curr_displaced_objects_cloud(new pcl::PointCloud<PointLabel>);
-            pcl::PointCloud<PointLabel>::Ptr curr_static_objects_cloud(new pcl::PointCloud<PointLabel>);
-
-            //transform maps to vectors
-            std::vector<DetectedObject> removed_obj_vec, new_obj_vec, ref_dis_obj_vec, curr_dis_obj_vec, ref_static_obj_vec, curr_static_obj_vec;
-            removed_obj_vec = fromMapToValVec(removed_obj);
-            new_obj_vec = fromMapToValVec(new_obj);
-            ref_dis_obj_vec = fromMapToValVec(ref_displaced_obj);
-            curr_dis_obj_vec = fromMapToValVec(curr_displaced_obj);
-            ref_static_obj_vec = fromMapToValVec(ref_static_obj);
-            curr_static_obj_vec = fromMapToValVec(curr_static_obj);
-
-            for (auto const & o : removed_obj) {
-                *ref_removed_objects_cloud += *(o.second.getObjectCloud());
-            }
-            if (!ref_removed_objects_cloud->empty())
-                pcl::io::savePCDFile(result_path + "/ref_removed_objects.pcd", *ref_removed_objects_cloud);
-
-            for (auto const & o : new_obj) {
-                *curr_new_objects_cloud += *(o.second.getObjectCloud());
+        //a client that connects and sends nothing must not block the daemon
+        std::vector<char> payload;
+        if (!setReceiveTimeout(fd, daemon_receive_timeout_s) || !receiveFrame(fd, payload)) {
+            close(fd);
+            continue;
+        }
+        BufferReader reader(payload);
+        const uint32_t type = reader.read<uint32_t>();
+        ComparisonJob job;
+        int status = -1;
+        if (type == DAEMON_SHUTDOWN) {
+            shutdown = true;
+            status = 0;
+        } else if (type != DAEMON_JOB || !decodeJob(reader, job)) {
+            sendFrame(fd, encodeError("Invalid job"));
+        } else {
+            //entries of other rooms are never hit again, the caches only grow with the scenes of one room
+            if (job.room_path != cached_room_path) {
+                extraction_cache.clear();
+                bounded_extraction_cache.clear();
+                cached_room_path = job.room_path;
             }
-            if (!curr_new_objects_cloud->empty())
-                pcl::io::savePCDFile(result_path + "/curr_new_objects.pcd", *curr_new_objects_cloud);
-
-            //assign labels to the object based on the matches for DISPLACED objects
-            for (size_t o = 0; o < ref_dis_obj_vec.size(); o++) {
-                const DetectedObject &ref_object = ref_dis_obj_vec[o];
-                auto curr_obj_iter = std::find_if( curr_dis_obj_vec.begin(), curr_dis_obj_vec.end(),[ref_object]
-                                                   (DetectedObject const &o) {return o.match_.model_id == ref_object.getID(); });
-                const DetectedObject &curr_object = *curr_obj_iter;
-                pcl::PointCloud<PointLabel>::Ptr ref_objects_cloud(new pcl::PointCloud<PointLabel>);
-                pcl::PointCloud<PointLabel>::Ptr curr_objects_cloud(new pcl::PointCloud<PointLabel>);
-                pcl::copyPointCloud(*ref_object.getObjectCloud(), *ref_objects_cloud);
-                pcl::copyPointCloud(*curr_object.getObjectCloud(), *curr_objects_cloud);
-                for (size_t i = 0; i < ref_objects_cloud->size(); i++) {
-                    ref_objects_cloud->points[i].label=ref_object.getID() * 20;
-                }
-                for (size_t i = 0; i < curr_objects_cloud->size(); i++) {
-                    curr_objects_cloud->points[i].label = ref_object.getID() * 20;
-                }
-                pcl::io::savePCDFileBinary("/home/edith/Desktop/curr_object_displ.pcd", *curr_objects_cloud);
-                *ref_displaced_objects_cloud += *ref_objects_cloud;
-                *curr_displaced_objects_cloud += *curr_objects_cloud;
+            std::cout << "Job " << job.room_path << std::endl;
+            try {
+                status = runJob(fd, job, job.bounded_memory ? bounded_extraction_cache : extraction_cache, ppf_configs);
+            } catch (const std::exception &e) {
+                std::cerr << "Job " << job.room_path << " failed: " << e.what() << std::endl;
+                sendFrame(fd, encodeError(e.what()));
             }
+        }
+        sendFrame(fd, encodeDone(status));
+        close(fd);
+    }
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    return shutdown ? 0 : -1;
+}
 
-            if (!ref_displaced_objects_cloud->empty())
-                pcl::io::savePCDFile(result_path + "/ref_displaced_objects.pcd", *ref_displaced_objects_cloud);
-            if (!curr_displaced_objects_cloud->empty())
-                pcl::io::savePCDFile(result_path + "/curr_displaced_objects.pcd", *curr_displaced_objects_cloud);
-
-
-            //assign labels to the object based on the matches for STATIC objects
-            for (size_t o = 0; o < ref_static_obj_vec.size(); o++) {
-                const DetectedObject &ref_object = ref_static_obj_vec[o];
-                auto curr_obj_iter = std::find_if( curr_static_obj_vec.begin(), curr_static_obj_vec.end(),[ref_object]
-                                                   (DetectedObject const &o) {return o.match_.model_id == ref_object.getID(); });
-                const DetectedObject &curr_object = *curr_obj_iter;
-                pcl::PointCloud<PointLabel>::Ptr ref_objects_cloud(new pcl::PointCloud<PointLabel>);
-                pcl::PointCloud<PointLabel>::Ptr curr_objects_cloud(new pcl::PointCloud<PointLabel>);
-                pcl::copyPointCloud(*ref_object.getObjectCloud(), *ref_objects_cloud);
-                pcl::copyPointCloud(*curr_object.getObjectCloud(), *curr_objects_cloud);
-                for (size_t i = 0; i < ref_objects_cloud->size(); i++) {
-                    ref_objects_cloud->points[i].label = ref_object.getID() * 20;
-                }
-                for (size_t i = 0; i < curr_objects_cloud->size(); i++) {
-                    curr_objects_cloud->points[i].label = ref_object.getID() * 20;
-                }
-                *ref_static_objects_cloud += *ref_objects_cloud;
-                *curr_static_objects_cloud += *curr_objects_cloud;
-            }
-            if (!ref_static_objects_cloud->empty())
-                pcl::io::savePCDFile(result_path + "/ref_static_objects.pcd", *ref_static_objects_cloud);
-            if (!curr_static_objects_cloud->empty())
-                pcl::io::savePCDFile(result_path + "/curr_static_objects.pcd", *curr_static_objects_cloud);
-
-
-
-            //put all planes together in one file as reference
-            pcl::PointCloud<PointNormal>::Ptr ref_cloud_merged(new pcl::PointCloud<PointNormal>);
-            pcl::PointCloud<PointNormal>::Ptr curr_cloud_merged(new pcl::PointCloud<PointNormal>);
-
-            for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
-                //crop cloud according to the convex hull points, find min and max values in x and y direction
-                pcl::PointXYZ max_hull_pt, min_hull_pt;
-                pcl::getMinMax3D(*(ref_it->second.convex_hull_cloud), min_hull_pt, max_hull_pt);
-
-                //add some alignment because hull points were computed from a full room reconstruction that may include drift
-                pcl::PointCloud<PointNormal>::Ptr cropped_cloud(new pcl::PointCloud<PointNormal>);
-                pcl::PassThrough<PointNormal> pass;
-                pass.setInputCloud(ref_it->second.cloud);
-                pass.setFilterFieldName("x");
-                pass.setFilterLimits(min_hull_pt.x - 0.15, max_hull_pt.x + 0.15);
-                pass.setKeepOrganized(true);
-                pass.filter(*cropped_cloud);
-                pass.setInputCloud(cropped_cloud);
-                pass.setFilterFieldName("y");
-                pass.setFilterLimits(min_hull_pt.y - 0.15, max_hull_pt.y + 0.15);
-                pass.setKeepOrganized(true);
-                pass.filter(*cropped_cloud);
-
-                *ref_cloud_merged += *cropped_cloud;
-            }
-            pcl::PointCloud<PointNormal>::Ptr ref_merged_ds(new pcl::PointCloud<PointNormal>);
-            ref_merged_ds = downsampleCloudVG(ref_cloud_merged, 0.01);
-            pcl::io::savePCDFile(result_path + "/ref_cloud_merged.pcd", *ref_merged_ds);
-
-            for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
-                //crop cloud according to the convex hull points, find min and max values in x and y direction
-                pcl::PointXYZ max_hull_pt, min_hull_pt;
-                pcl::getMinMax3D(*(curr_it->second.convex_hull_cloud), min_hull_pt, max_hull_pt);
-
-                //add some alignment because hull points were computed from a full room reconstruction that may include drift
-                pcl::PointCloud<PointNormal>::Ptr cropped_cloud(new pcl::PointCloud<PointNormal>);
-                pcl::PassThrough<PointNormal> pass;
-                pass.setInputCloud(curr_it->second.cloud);
-                pass.setFilterFieldName("x");
-                pass.setFilterLimits(min_hull_pt.x - 0.15, max_hull_pt.x + 0.15);
-                pass.setKeepOrganized(true);
-                pass.filter(*cropped_cloud);
-                pass.setInputCloud(cropped_cloud);
-                pass.setFilterFieldName("y");
-                pass.setFilterLimits(min_hull_pt.y - 0.15, max_hull_pt.y + 0.15);
-                pass.setKeepOrganized(true);
-                pass.filter(*cropped_cloud);
-
-                *curr_cloud_merged += *cropped_cloud;
-            }
-            pcl::PointCloud<PointNormal>::Ptr curr_merged_ds(new pcl::PointCloud<PointNormal>);
-            curr_merged_ds = downsampleCloudVG(curr_cloud_merged, 0.01);
-            pcl::io::savePCDFile(result_path + "/curr_cloud_merged.pcd", *curr_merged_ds);
+int main(int argc, char* argv[])
+{
+    std::string socket_path="";
+    pcl::console::parse(argc, argv, "-s", socket_path);
 
+    /// Check arguments and print info
+    if (argc < 4 && socket_path.empty()) {
+        pcl::console::print_info("\n\
+                                 -- Object change detection based on reconstructions of a plane of interest at two different timestamps for all scenes in the given folder -- : \n\
+                                 \n\
+                                 Syntax: %s room_path \n\
+                                 [Options] \n\
+                                 -r path, where results should be stored, a folder with date and time gets created there \n\
+                                 -c config path for ppf params \n\
+                                 -v which point clouds are written: 0 none, 1 only results, 2 also intermediate debug clouds (default) \n\
+                                 -m memory-bounded mode for large rooms: plane clouds are loaded per plane pair, finished objects are kept on disk \n\
+                                 -t path, where a Chrome trace (chrome://tracing) of the run should be written \n\
+                                 -i path of a persistent object map: every scene is only compared against the map instead of all other scenes \n\
+                                 -R path of the result folder (with date and time) of an interrupted run, which is continued: completed pairs are skipped \n\
+                                 \n\
+                                 Daemon: %s -s socket_path [-t trace_path] \n\
+                                 keeps running and accepts comparison jobs on the Unix socket, see comparison_client",
+                                 argv[0], argv[0]);
+        return(1);
+    }
 
-            //visualization with PCLViewer
-            //copy the fused cloud and add colored points from detected objects (e.g. removed ones red, new ones green, and displaced ones r and g random and b high number)
-            //ObjectVisualization vis(ref_cloud_merged, curr_cloud_merged, removed_obj_vec, new_obj_vec,
-            //                        ref_dis_obj_vec, curr_dis_obj_vec, ref_static_obj_vec, curr_static_obj_vec);
-            //vis.visualize();
+    std::string trace_path="";
+    pcl::console::parse(argc, argv, "-t", trace_path);
+    if (!trace_path.empty())
+        v4r::trace::enable();
 
-        }
+    if (!socket_path.empty()) {
+        int ret = runDaemon(socket_path);
+        if (!trace_path.empty())
+            v4r::trace::writeChromeTrace(trace_path);
+        return ret;
     }
-}
 
+    /// Parse command line arguments
+    std::string room_path = argv[1];
+    std::string base_result_path="";
+    std::string ppf_config_path_path="";
+    pcl::console::parse(argc, argv, "-r", base_result_path);
+    pcl::console::parse(argc, argv, "-c", ppf_config_path_path);
+    int artifact_level = ARTIFACTS_DEBUG;
+    pcl::console::parse(argc, argv, "-v", artifact_level);
+    if (!isArtifactLevel(artifact_level)) {
+        std::cerr << "Invalid artifact level " << artifact_level << " (-v), it has to be 0, 1 or 2" << std::endl;
+        return -1;
+    }
+    ArtifactWriter::instance().setLevel(static_cast<ArtifactLevel>(artifact_level));
+    bool bounded_memory = pcl::console::find_switch(argc, argv, "-m");
+    std::string map_path="";
+    pcl::console::parse(argc, argv, "-i", map_path);
+    std::string resume_path="";
+    pcl::console::parse(argc, argv, "-R", resume_path);
+
+    //extract all scene folders
+    std::vector<std::string> all_scene_paths;
+    if (!collectScenePaths(room_path, all_scene_paths))
+        return -1;
+
+    //every scene is part of several comparisons, its planes are only segmented once
+    PlaneExtractionCache extraction_cache(!bounded_memory);
 
+    RunOptions options;
+    options.base_result_path = resume_path.empty() ? createBaseResultPath(base_result_path) : resume_path + "/";
+    options.resume = !resume_path.empty();
+    options.ppf_config_path = ppf_config_path_path;
+    options.bounded_memory = bounded_memory;
+    options.extraction_cache = &extraction_cache;
+
+    int ret;
+    if (!map_path.empty()) {
+        ret = runIncremental(all_scene_paths, map_path, options);
+    } else {
+        ret = runAllPairs(all_scene_paths, options);
+        std::cout << "Plane extraction cache: " << extraction_cache.hits() << " hits, " << extraction_cache.misses() << " misses" << std::endl;
+    }
+
+    ArtifactWriter::instance().flush();
+    if (!trace_path.empty())
+        v4r::trace::writeChromeTrace(trace_path);
+    return ret;
+}
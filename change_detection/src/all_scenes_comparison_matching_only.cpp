@@ -64,7 +64,7 @@ std::string base_result_path;
 std::string result_path;
 
 
-std::vector<DetectedObject> fromMapToValVec(std::map<int, DetectedObject> map) {
+std::vector<DetectedObject> fromMapToValVec(const std::map<int, DetectedObject> &map) {
     //transform map into vec to be able to call object matching
     std::vector<DetectedObject> vec;
     vec.reserve(map.size());
@@ -114,62 +114,37 @@ bool readInput(std::string input_path, const pcl::PointCloud<PointNormal>::Ptr &
     }
 }
 
-void createNewModelFolder(DetectedObject &ro, std::string ppf_model_path, std::string result_path) {
-    std::string orig_path = ppf_model_path + "/" + std::to_string(ro.getID());
-    ro.object_folder_path_ = orig_path;
-
-    boost::filesystem::create_directories(orig_path);
-    pcl::io::savePCDFile(orig_path + "/3D_model.pcd", *ro.getObjectCloud()); //PPF will create a new model with the new cloud
-}
-
-
-void removeModelFolder(DetectedObject ro, std::string ppf_model_path, std::string result_path) {
-    //there should already exist a folder
-    std::string orig_path = ppf_model_path + "/" + std::to_string(ro.getID());
-    if (boost::filesystem::exists(orig_path)) {
-        boost::filesystem::path dest_folder = result_path + "/model_partially_matched/" + std::to_string(ro.getID());
-        boost::filesystem::create_directories(dest_folder);
-        //count pcd-files in the folder
-        int nr_pcd_files = 0;
-        boost::filesystem::directory_iterator end_iter; // Default constructor for an iterator is the end iterator
-        for (boost::filesystem::directory_iterator iter(dest_folder); iter != end_iter; ++iter) {
-            if (iter->path().extension() == ".pcd")
-                ++nr_pcd_files;
-        }
-
-        //copy the folder to another directory. The model is already matched and should not be used anymore
-        for (const auto& dirEnt : boost::filesystem::recursive_directory_iterator{orig_path})
-        {
-            if (dirEnt.path().extension() == ".pcd") {
-                const auto& path = dirEnt.path();
-                boost::filesystem::path dest_filename = path.stem().string() + std::to_string(nr_pcd_files) + path.extension().string();
-                boost::filesystem::copy(path, dest_folder / dest_filename);
-                std::cout << "Copy " << path << " to " << (dest_folder / path.filename()) << std::endl;
-            }
-        }
-    }
-    boost::filesystem::remove_all(orig_path);
+//the model was matched partially and should not be used anymore, the whole model is kept as result
+void removeModel(PipelineContext &context, const DetectedObject &ro, std::string ppf_model_path, std::string result_path) {
+    if (!context.hasModel(ro.getID()))
+        return;
+    std::string dest_folder = result_path + "/model_partially_matched/" + std::to_string(ro.getID());
+    boost::filesystem::create_directories(dest_folder);
+    saveResultCloud(dest_folder + "/3D_model.pcd", *context.modelCloud(ro.getID()));
+    context.removeModel(ro.getID());
+    //the trained PPF model cached in the model folder is outdated as well
+    boost::filesystem::remove_all(ppf_model_path + "/" + std::to_string(ro.getID()));
 }
 
-void updateDetectedObjects(std::vector<DetectedObject>& ref_result, std::vector<DetectedObject>& curr_result) {
+void updateDetectedObjects(PipelineContext &context, std::vector<DetectedObject>& ref_result, std::vector<DetectedObject>& curr_result) {
     for (DetectedObject ro : ref_result) {
         if (ro.state_ == ObjectState::REMOVED) {
-            //means that there was a partial match and have to create a new model folder
-            if (ro.object_folder_path_ == "") {
-                createNewModelFolder(ro, ppf_model_path, result_path);
+            //means that there was a partial match and we need a model of the new part
+            if (!context.hasModel(ro.getID())) {
+                context.addModel(ro.getID(), ro.getObjectCloud());
             }
             pot_removed_obj[ro.getID()] = ro;
         } else if (ro.state_ == ObjectState::DISPLACED) {
             //means that there was a partial match and we do not need the model anymore
-            if (ro.object_folder_path_ == "") {
-                removeModelFolder(ro, ppf_model_path, result_path);
+            if (ro.partially_matched_) {
+                removeModel(context, ro, ppf_model_path, result_path);
             }
             ref_displaced_obj[ro.getID()] = ro;
             pot_removed_obj.erase(ro.getID());
         } else if (ro.state_ == ObjectState::STATIC) {
             //means that there was a partial match and we do not need the model anymore
-            if (ro.object_folder_path_ == "") {
-                removeModelFolder(ro, ppf_model_path, result_path);
+            if (ro.partially_matched_) {
+                removeModel(context, ro, ppf_model_path, result_path);
             }
             ref_static_obj[ro.getID()] = ro;
             pot_removed_obj.erase(ro.getID());
@@ -201,7 +176,8 @@ int main(int argc, char* argv[])
                                  Syntax: %s room_path \n\
                                  [Options] \n\
                                  -r path, where results should be stored, a folder with date and time gets created there \n\
-                                 -c config path for ppf params",
+                                 -c config path for ppf params \n\
+                                 -v which point clouds are written: 0 none, 1 only results, 2 also intermediate debug clouds (default)",
                                  argv[0]);
         return(1);
     }
@@ -211,6 +187,13 @@ int main(int argc, char* argv[])
     std::string ppf_config_path="";
     pcl::console::parse(argc, argv, "-r", base_result_path);
     pcl::console::parse(argc, argv, "-c", ppf_config_path);
+    int artifact_level = ARTIFACTS_DEBUG;
+    pcl::console::parse(argc, argv, "-v", artifact_level);
+    if (!isArtifactLevel(artifact_level)) {
+        std::cerr << "Invalid artifact level " << artifact_level << " (-v), it has to be 0, 1 or 2" << std::endl;
+        return -1;
+    }
+    ArtifactWriter::instance().setLevel(static_cast<ArtifactLevel>(artifact_level));
 
     //extract all scene folders
     if (!boost::filesystem::exists(room_path) || !boost::filesystem::is_directory(room_path)) {
@@ -245,6 +228,13 @@ int main(int argc, char* argv[])
         ppf_model_path = result_path + "/model_objects/";
         boost::filesystem::create_directories(ppf_model_path);
 
+        //every scene comparison has its own context, the object IDs start again at 1
+        PipelineContext context;
+        if (!context.loadPPFParams(ppf_config_path)) {
+            std::cerr << "Could not parse the PPF config " << ppf_config_path << std::endl;
+            return -1;
+        }
+
         std::string filtered_obj_by_size_path = result_path + "/filtered_by_size/";
         boost::filesystem::create_directories(filtered_obj_by_size_path);
 
@@ -293,11 +283,8 @@ int main(int argc, char* argv[])
                                 if (!readInput(model_path.path().string() + "/plane.pcd", plane_cloud))
                                     continue;
 
-                                DetectedObject model_obj(obj_cloud, plane_cloud);
-                                std::string obj_folder = ppf_model_path + std::to_string(model_obj.getID()); //PPF uses the folder name as model_id!
-                                boost::filesystem::create_directories(obj_folder);
-                                pcl::io::savePCDFile(obj_folder + "/3D_model.pcd", *(model_obj.getObjectCloud()));
-                                model_obj.object_folder_path_ = obj_folder;
+                                DetectedObject model_obj(context.nextObjectID(), obj_cloud, plane_cloud, pcl::ModelCoefficients::Ptr());
+                                context.addModel(model_obj.getID(), model_obj.getObjectCloud());
                                 ref_objects_vec.push_back(model_obj);
 
                                 *ref_merged_cloud += *obj_cloud;
@@ -321,7 +308,7 @@ int main(int argc, char* argv[])
                                 if (!readInput(obj_path.path().string() + "/plane.pcd", plane_cloud))
                                     continue;
 
-                                DetectedObject obj(obj_cloud, plane_cloud);
+                                DetectedObject obj(context.nextObjectID(), obj_cloud, plane_cloud, pcl::ModelCoefficients::Ptr());
                                 curr_objects_vec.push_back(obj);
 
                                 *curr_merged_cloud += *obj_cloud;
@@ -336,7 +323,7 @@ int main(int argc, char* argv[])
                             ref_objects_vec[i].state_ = ObjectState::REMOVED;
                         }
                         ref_result = ref_objects_vec;
-                        updateDetectedObjects(ref_result, curr_result);
+                        updateDetectedObjects(context, ref_result, curr_result);
                         continue;
                     }
 
@@ -345,22 +332,24 @@ int main(int argc, char* argv[])
                             curr_objects_vec[i].state_ = ObjectState::NEW;
                         }
                         curr_result = curr_objects_vec;
-                        updateDetectedObjects(ref_result, curr_result);
+                        updateDetectedObjects(context, ref_result, curr_result);
                         continue;
                     }
 
                     //matches between same plane different timestamps
-                    ObjectMatching object_matching(ref_objects_vec, curr_objects_vec, ppf_model_path, ppf_config_path);
+                    ObjectMatching object_matching(ref_objects_vec, curr_objects_vec, ppf_model_path, context);
                     std::vector<Match> matches = object_matching.compute(ref_result, curr_result);
 
                     //region growing of static/displaced objects (should create more precise results if e.g. the model was smaller than die object or not precisely aligned
-                    ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
-                    ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
+                    for (int id : ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder)) //merged completely, the copy in the map is outdated
+                        pot_removed_obj.erase(id);
+                    for (int id : ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder))
+                        pot_new_obj.erase(id);
                     ChangeDetection::filterUnwantedObjects(ref_result, min_object_volume, min_object_size_ds, std::numeric_limits<int>::max(), 0.01, 0.9, filtered_obj_by_size_path);
                     ChangeDetection::filterUnwantedObjects(curr_result, min_object_volume, min_object_size_ds, std::numeric_limits<int>::max(), 0.01, 0.9, filtered_obj_by_size_path);
 
                     //all detected objects labeled as removed (ref_objects) or new (curr_objects) could be placed on another plane
-                    updateDetectedObjects(ref_result, curr_result);
+                    updateDetectedObjects(context, ref_result, curr_result);
                 }
 
                 if(plane_comp_path.path().filename().string().rfind("curr_",0) == 0 ) { //ref-plane_curr_plane
@@ -384,7 +373,7 @@ int main(int argc, char* argv[])
                                     return false;
                                 if (!readInput(obj_path.path().string() + "/plane.pcd", plane_cloud))
                                     return false;
-                                DetectedObject obj (obj_cloud, plane_cloud);
+                                DetectedObject obj(context.nextObjectID(), obj_cloud, plane_cloud, pcl::ModelCoefficients::Ptr());
                                 curr_objects_vec.push_back(obj);
 
                                 *curr_merged_cloud += *obj_cloud;
@@ -394,7 +383,7 @@ int main(int argc, char* argv[])
 
                         std::vector<DetectedObject> ref_result, curr_result;
                         curr_result = curr_objects_vec;
-                        updateDetectedObjects(ref_result, curr_result);
+                        updateDetectedObjects(context, ref_result, curr_result);
                     }
                 }
 
@@ -419,7 +408,7 @@ int main(int argc, char* argv[])
                                     return false;
                                 if (!readInput(model_path.path().string() + "/plane.pcd", plane_cloud))
                                     return false;
-                                DetectedObject obj (obj_cloud, plane_cloud);
+                                DetectedObject obj(context.nextObjectID(), obj_cloud, plane_cloud, pcl::ModelCoefficients::Ptr());
                                 ref_objects_vec.push_back(obj);
 
                                 *ref_merged_cloud += *obj_cloud;
@@ -429,7 +418,7 @@ int main(int argc, char* argv[])
 
                         std::vector<DetectedObject> ref_result, curr_result;
                         ref_result = ref_objects_vec;
-                        updateDetectedObjects(ref_result, curr_result);
+                        updateDetectedObjects(context, ref_result, curr_result);
                     }
                 }
             }
@@ -444,17 +433,19 @@ int main(int argc, char* argv[])
             std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
             pot_rem_obj_vec = fromMapToValVec(pot_removed_obj);
             pot_new_obj_vec = fromMapToValVec(pot_new_obj);
-            ObjectMatching matching(pot_rem_obj_vec, pot_new_obj_vec, ppf_model_path, ppf_config_path);
+            ObjectMatching matching(std::move(pot_rem_obj_vec), std::move(pot_new_obj_vec), ppf_model_path, context);
             std::vector<DetectedObject> ref_result, curr_result;
             matching.compute(ref_result, curr_result);
 
-            ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
-            ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
+            for (int id : ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder)) //merged completely, the copy in the map is outdated
+                pot_removed_obj.erase(id);
+            for (int id : ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder))
+                pot_new_obj.erase(id);
 
             ChangeDetection::filterUnwantedObjects(ref_result, min_object_volume, min_object_size_ds, std::numeric_limits<int>::max(), 0.01, 0.9, filtered_obj_by_size_path);
             ChangeDetection::filterUnwantedObjects(curr_result, min_object_volume, min_object_size_ds, std::numeric_limits<int>::max(), 0.01, 0.9, filtered_obj_by_size_path);
 
-            updateDetectedObjects(ref_result, curr_result);
+            updateDetectedObjects(context, ref_result, curr_result);
         }
 
 
@@ -473,9 +464,9 @@ int main(int argc, char* argv[])
 
         //STORING RESULTS AND VISUALIZE THEM
         if (!ref_merged_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/ref_merged_objects.pcd", *ref_merged_cloud);
+            saveResultCloud(result_path + "/ref_merged_objects.pcd", *ref_merged_cloud);
         if (!curr_merged_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/curr_merged_objects.pcd", *curr_merged_cloud);
+            saveResultCloud(result_path + "/curr_merged_objects.pcd", *curr_merged_cloud);
 
 
         //create point clouds of detected objects to save results as pcd-files
@@ -499,13 +490,13 @@ int main(int argc, char* argv[])
             *ref_removed_objects_cloud += *(o.second.getObjectCloud());
         }
         if (!ref_removed_objects_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/ref_removed_objects.pcd", *ref_removed_objects_cloud);
+            saveResultCloud(result_path + "/ref_removed_objects.pcd", *ref_removed_objects_cloud);
 
         for (auto const & o : new_obj) {
             *curr_new_objects_cloud += *(o.second.getObjectCloud());
         }
         if (!curr_new_objects_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/curr_new_objects.pcd", *curr_new_objects_cloud);
+            saveResultCloud(result_path + "/curr_new_objects.pcd", *curr_new_objects_cloud);
 
         //assign labels to the object based on the matches for DISPLACED objects
         for (size_t o = 0; o < ref_dis_obj_vec.size(); o++) {
@@ -523,15 +514,14 @@ int main(int argc, char* argv[])
             for (size_t i = 0; i < curr_objects_cloud->size(); i++) {
                 curr_objects_cloud->points[i].label = ref_object.getID() * 20;
             }
-            pcl::io::savePCDFileBinary("/home/edith/Desktop/curr_object_displ.pcd", *curr_objects_cloud);
             *ref_displaced_objects_cloud += *ref_objects_cloud;
             *curr_displaced_objects_cloud += *curr_objects_cloud;
         }
 
         if (!ref_displaced_objects_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/ref_displaced_objects.pcd", *ref_displaced_objects_cloud);
+            saveResultCloud(result_path + "/ref_displaced_objects.pcd", *ref_displaced_objects_cloud);
         if (!curr_displaced_objects_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/curr_displaced_objects.pcd", *curr_displaced_objects_cloud);
+            saveResultCloud(result_path + "/curr_displaced_objects.pcd", *curr_displaced_objects_cloud);
 
 
         //assign labels to the object based on the matches for STATIC objects
@@ -554,11 +544,12 @@ int main(int argc, char* argv[])
             *curr_static_objects_cloud += *curr_objects_cloud;
         }
         if (!ref_static_objects_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/ref_static_objects.pcd", *ref_static_objects_cloud);
+            saveResultCloud(result_path + "/ref_static_objects.pcd", *ref_static_objects_cloud);
         if (!curr_static_objects_cloud->empty())
-            pcl::io::savePCDFile(result_path + "/curr_static_objects.pcd", *curr_static_objects_cloud);
+            saveResultCloud(result_path + "/curr_static_objects.pcd", *curr_static_objects_cloud);
 
     }
+    ArtifactWriter::instance().flush();
 }
 
 
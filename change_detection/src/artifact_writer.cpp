@@ -0,0 +1,92 @@
+#include "artifact_writer.h"
+
+#include <iostream>
+
+ArtifactWriter& ArtifactWriter::instance() {
+    static ArtifactWriter writer;
+    return writer;
+}
+
+ArtifactWriter::ArtifactWriter() : max_queue_size_(64), nr_jobs_in_progress_(0), level_(ARTIFACTS_DEBUG), stop_(false) {
+    worker_ = std::thread(&ArtifactWriter::run, this);
+}
+
+ArtifactWriter::~ArtifactWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queue_not_empty_.notify_all();
+    queue_not_full_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+void ArtifactWriter::setLevel(ArtifactLevel level) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    level_ = level;
+}
+
+ArtifactLevel ArtifactWriter::getLevel() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return level_;
+}
+
+void ArtifactWriter::setMaxQueueSize(size_t max_queue_size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_queue_size_ = std::max<size_t>(max_queue_size, 1);
+    }
+    queue_not_full_.notify_all();
+}
+
+void ArtifactWriter::enqueue(const std::string &path, std::function<bool()> write_fn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_not_full_.wait(lock, [this]() { return queue_.size() < max_queue_size_ || stop_; });
+    if (stop_) { //the writer is already shutting down, write it directly
+        lock.unlock();
+        write(path, write_fn);
+        return;
+    }
+    queue_.push_back(Job{path, std::move(write_fn)});
+    lock.unlock();
+    queue_not_empty_.notify_one();
+}
+
+void ArtifactWriter::write(const std::string &path, const std::function<bool()> &write_fn) {
+    try {
+        if (!write_fn())
+            std::cerr << "Could not write " << path << std::endl;
+    } catch (const std::exception &e) { //e.g. empty clouds can not be written
+        std::cerr << "Could not write " << path << ": " << e.what() << std::endl;
+    }
+}
+
+void ArtifactWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_drained_.wait(lock, [this]() { return queue_.empty() && nr_jobs_in_progress_ == 0; });
+}
+
+void ArtifactWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queue_not_empty_.wait(lock, [this]() { return !queue_.empty() || stop_; });
+        //the remaining jobs are written before the thread stops
+        if (queue_.empty() && stop_)
+            break;
+
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        nr_jobs_in_progress_++;
+        lock.unlock();
+        queue_not_full_.notify_one();
+
+        write(job.path, job.write_fn);
+
+        lock.lock();
+        nr_jobs_in_progress_--;
+        if (queue_.empty() && nr_jobs_in_progress_ == 0)
+            queue_drained_.notify_all();
+    }
+    queue_drained_.notify_all();
+}
@@ -0,0 +1,43 @@
+#include "broad_phase.h"
+
+#include <algorithm>
+#include <cmath>
+
+Eigen::AlignedBox3f finiteBoundingBox(const pcl::PointCloud<PointNormal> &cloud, float margin) {
+    Eigen::AlignedBox3f box;
+    for (const PointNormal &pt : cloud.points) {
+        if (std::isfinite(pt.x) && std::isfinite(pt.y) && std::isfinite(pt.z))
+            box.extend(Eigen::Vector3f(pt.x, pt.y, pt.z));
+    }
+    if (!box.isEmpty()) {
+        box.min().array() -= margin;
+        box.max().array() += margin;
+    }
+    return box;
+}
+
+std::vector<std::pair<int, int> > overlappingBoxPairs(const std::vector<Eigen::AlignedBox3f> &boxes) {
+    std::vector<int> order;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (!boxes[i].isEmpty())
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&boxes](int a, int b) {
+        return boxes[a].min().x() < boxes[b].min().x();
+    });
+
+    std::vector<std::pair<int, int> > pairs;
+    for (size_t a = 0; a < order.size(); a++) {
+        const Eigen::AlignedBox3f &box_a = boxes[order[a]];
+        //boxes further in the order start at a larger x, the sweep stops at the first one starting after box a ends
+        for (size_t b = a + 1; b < order.size() && boxes[order[b]].min().x() <= box_a.max().x(); b++) {
+            const Eigen::AlignedBox3f &box_b = boxes[order[b]];
+            if (box_a.min().y() > box_b.max().y() || box_b.min().y() > box_a.max().y() ||
+                    box_a.min().z() > box_b.max().z() || box_b.min().z() > box_a.max().z())
+                continue;
+            pairs.push_back(std::minmax(order[a], order[b]));
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
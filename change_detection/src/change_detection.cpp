@@ -1,7 +1,5 @@
 #include "change_detection.h"
 
-int DetectedObject::s_id = 0;
-
 const float diff_dist = ds_leaf_size_LV * std::sqrt(2);
 const float add_crop_static = 0.10; //the amount that should be added to each cluster in the static version when doing the crop
 const float icp_max_corr_dist = 0.15;
@@ -44,22 +42,24 @@ void ChangeDetection::init(pcl::PointCloud<PointNormal>::Ptr ref_cloud, pcl::Poi
 
 
 void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vector<DetectedObject> &curr_result) {
+    V4R_TRACE_SCOPE("ChangeDetection::compute");
 
     if (ref_cloud_->empty() && curr_cloud_->empty()) {
         std::cerr << "You have to call ChangeDetection::init before calling ChangeDetection::compute !!" << std::endl;
         return;
     }
 
-    refineNormals(curr_cloud_);
-    refineNormals(ref_cloud_);
+    refinePlaneNormals(curr_cloud_);
+    refinePlaneNormals(ref_cloud_);
 
 
 
     //----------------------------downsample input clouds for faster computation-------
     pcl::PointCloud<PointNormal>::Ptr curr_cloud_downsampled (new pcl::PointCloud<PointNormal>);
     pcl::PointCloud<PointNormal>::Ptr ref_cloud_downsampled (new pcl::PointCloud<PointNormal>);
-    curr_cloud_downsampled = downsampleCloudVG(curr_cloud_, ds_leaf_size_LV);
-    ref_cloud_downsampled = downsampleCloudVG(ref_cloud_, ds_leaf_size_LV);
+    VoxelIndexMap curr_voxel_map, ref_voxel_map; //for upsampling the objects again
+    curr_cloud_downsampled = downsampleCloudVG(curr_cloud_, ds_leaf_size_LV, curr_voxel_map);
+    ref_cloud_downsampled = downsampleCloudVG(ref_cloud_, ds_leaf_size_LV, ref_voxel_map);
 
     //---------------------------------------------------------------------------------
 
@@ -79,6 +79,15 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
     std::vector<PlaneWithObjInd> ref_objects_from_plane = getObjectsFromPlane(ref_cloud_downsampled, ref_plane_coeffs_, ref_convex_hull_pts_,
                                                                    ref_checked_plane_point_cloud_, ref_res_path);
 
+    //most planes do not change between two visits, then LV, PPF and the matching are skipped
+    if (!ref_cloud_->empty() && !curr_cloud_->empty() &&
+            haveSameOccupancy(*ref_cloud_, ref_plane_coeffs_, *curr_cloud_, curr_plane_coeffs_)) {
+        const int last_object_id = context_.lastObjectID();
+        if (computeUnchangedPlane(ref_cloud_downsampled, ref_voxel_map, ref_objects_from_plane, curr_cloud_downsampled, curr_objects_from_plane,
+                                  ref_res_path, ref_result, curr_result))
+            return;
+        context_.setLastObjectID(last_object_id);
+    }
 
 
     //hopefully remove objects from ref_objects that were detected because of reconstruction inaccuracies
@@ -98,7 +107,7 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
     }
     //could be empty if the method was called with only one valid plane reconstruction
     if (!curr_non_object_points->empty()) {
-        pcl::io::savePCDFileBinary(ref_res_path + "/curr_non_object_points.pcd", *curr_non_object_points);
+        saveDebugCloud(ref_res_path + "/curr_non_object_points.pcd", *curr_non_object_points);
         matchAndRemoveObjects(curr_non_object_points, ref_cloud_downsampled, ref_objects_from_plane);
     }
 
@@ -119,32 +128,36 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
     }
     //could be empty if the method was called with only one valid plane reconstruction
     if (!ref_non_object_points->empty()) {
-        pcl::io::savePCDFileBinary(curr_res_path + "/ref_non_object_points.pcd", *ref_non_object_points);
+        saveDebugCloud(curr_res_path + "/ref_non_object_points.pcd", *ref_non_object_points);
         matchAndRemoveObjects(ref_non_object_points, curr_cloud_downsampled, curr_objects_from_plane);
     }
 
-    if (curr_objects_from_plane.size() != 0) {
+    if (debugArtifactsEnabled() && curr_objects_from_plane.size() != 0) {
         pcl::PointCloud<PointNormal>::Ptr curr_obj_cloud = fromObjectVecToObjectCloud(curr_objects_from_plane, curr_cloud_downsampled);
-        pcl::io::savePCDFileBinary(curr_res_path + "/objects_after_matching_non_obj.pcd", *curr_obj_cloud);
+        saveDebugCloud(curr_res_path + "/objects_after_matching_non_obj.pcd", *curr_obj_cloud);
     }
-    if (ref_objects_from_plane.size() != 0) {
+    if (debugArtifactsEnabled() && ref_objects_from_plane.size() != 0) {
         pcl::PointCloud<PointNormal>::Ptr ref_obj_cloud = fromObjectVecToObjectCloud(ref_objects_from_plane, ref_cloud_downsampled);
-        pcl::io::savePCDFileBinary(ref_res_path + "/objects_after_matching_non_obj.pcd", *ref_obj_cloud);
+        saveDebugCloud(ref_res_path + "/objects_after_matching_non_obj.pcd", *ref_obj_cloud);
     }
 
     //region growing
     if (curr_objects_from_plane.size() > 0) {
         objectRegionGrowing(curr_cloud_downsampled, curr_objects_from_plane);  //this removes very big clusters after growing
         mergeObjects(curr_objects_from_plane); //in case an object was detected several times (disjoint sets originally, but prob. overlapping after region growing)
-        pcl::PointCloud<PointNormal>::Ptr novel_objects_cloud = fromObjectVecToObjectCloud(curr_objects_from_plane, curr_cloud_downsampled);
-        pcl::io::savePCDFileBinary(curr_res_path + "/result_after_objectGrowing.pcd", *novel_objects_cloud);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr novel_objects_cloud = fromObjectVecToObjectCloud(curr_objects_from_plane, curr_cloud_downsampled);
+            saveDebugCloud(curr_res_path + "/result_after_objectGrowing.pcd", *novel_objects_cloud);
+        }
     }
 
     if (ref_objects_from_plane.size() > 0) {
         objectRegionGrowing(ref_cloud_downsampled, ref_objects_from_plane);  //this removes very big clusters after growing
         mergeObjects(ref_objects_from_plane); //in case an object was detected several times (disjoint sets originally, but prob. overlapping after region growing)
-        pcl::PointCloud<PointNormal>::Ptr disappeared_objects_cloud = fromObjectVecToObjectCloud(ref_objects_from_plane, ref_cloud_downsampled);
-        pcl::io::savePCDFileBinary(ref_res_path + "/result_after_objectGrowing.pcd", *disappeared_objects_cloud);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr disappeared_objects_cloud = fromObjectVecToObjectCloud(ref_objects_from_plane, ref_cloud_downsampled);
+            saveDebugCloud(ref_res_path + "/result_after_objectGrowing.pcd", *disappeared_objects_cloud);
+        }
     }
 
     //----------------Upsample again to have the objects and planes in full resolution----------
@@ -178,12 +191,14 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
     if (do_LV_before_matching_ && curr_obj_vec.size() != 0 && ref_obj_vec.size() != 0) {
         performLV(ref_obj_vec, curr_obj_vec);
 
-        pcl::PointCloud<PointNormal>::Ptr ref_obj_cloud = fromDetObjectVecToCloud(ref_obj_vec, false);
-        pcl::PointCloud<PointNormal>::Ptr curr_obj_cloud = fromDetObjectVecToCloud(curr_obj_vec, false);
-        if (!curr_obj_cloud->empty())
-            pcl::io::savePCDFileBinary(curr_res_path + "/objects_after_LV.pcd", *curr_obj_cloud);
-        if (!ref_obj_cloud->empty())
-            pcl::io::savePCDFileBinary(ref_res_path + "/objects_after_LV.pcd", *ref_obj_cloud);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr ref_obj_cloud = fromDetObjectVecToCloud(ref_obj_vec, false);
+            pcl::PointCloud<PointNormal>::Ptr curr_obj_cloud = fromDetObjectVecToCloud(curr_obj_vec, false);
+            if (!curr_obj_cloud->empty())
+                saveDebugCloud(curr_res_path + "/objects_after_LV.pcd", *curr_obj_cloud);
+            if (!ref_obj_cloud->empty())
+                saveDebugCloud(ref_res_path + "/objects_after_LV.pcd", *ref_obj_cloud);
+        }
     }
 
     if (curr_obj_vec.size() > 0) {
@@ -194,15 +209,19 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
         //pcl::PointCloud<PointNormal>::Ptr  novel_objects_cloud = fromObjectVecToObjectCloud(curr_objects, curr_cloud_downsampled);
         //pcl::io::savePCDFileBinary(curr_res_path + "/result_after_filtering_planar_objects.pcd", *novel_objects_cloud);
         //----------------Upsample again to have the objects and planes in full resolution----------
-        upsampleObjectsAndPlanes(curr_cloud_, curr_obj_vec, ds_leaf_size_LV, curr_res_path);
-        pcl::PointCloud<PointNormal>::Ptr novel_objects_cloud = fromDetObjectVecToCloud(curr_obj_vec, false);
-        if (!novel_objects_cloud->empty())
-            pcl::io::savePCDFileBinary(curr_res_path + "/upsampled_objects.pcd", *novel_objects_cloud);
+        upsampleObjectsAndPlanes(curr_cloud_, curr_obj_vec, ds_leaf_size_LV, curr_res_path, &curr_voxel_map);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr novel_objects_cloud = fromDetObjectVecToCloud(curr_obj_vec, false);
+            if (!novel_objects_cloud->empty())
+                saveDebugCloud(curr_res_path + "/upsampled_objects.pcd", *novel_objects_cloud);
+        }
 
         filterUnwantedObjects(curr_obj_vec, min_object_volume, min_object_size_ds, max_object_size_ds);
-        novel_objects_cloud = fromDetObjectVecToCloud(curr_obj_vec, false);
-        if (!novel_objects_cloud->empty())
-            pcl::io::savePCDFileBinary(curr_res_path + "/final_objects.pcd", *novel_objects_cloud);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr novel_objects_cloud = fromDetObjectVecToCloud(curr_obj_vec, false);
+            if (!novel_objects_cloud->empty())
+                saveDebugCloud(curr_res_path + "/final_objects.pcd", *novel_objects_cloud);
+        }
 
 
         //save each object including its supporting plane
@@ -219,15 +238,19 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
         //pcl::PointCloud<PointNormal>::Ptr disappeared_objects_cloud = fromObjectVecToObjectCloud(ref_objects_from_plane, ref_cloud_downsampled);
         //pcl::io::savePCDFileBinary(ref_res_path + "/result_after_filtering_planar_objects.pcd", *disappeared_objects_cloud);
         //----------------Upsample again to have the objects and planes in full resolution----------
-        upsampleObjectsAndPlanes(ref_cloud_, ref_obj_vec, ds_leaf_size_LV, ref_res_path);
-        pcl::PointCloud<PointNormal>::Ptr disappeared_objects_cloud = fromDetObjectVecToCloud(ref_obj_vec, false);
-        if (!disappeared_objects_cloud->empty())
-            pcl::io::savePCDFileBinary(ref_res_path + "/upsampled_objects.pcd", *disappeared_objects_cloud);
+        upsampleObjectsAndPlanes(ref_cloud_, ref_obj_vec, ds_leaf_size_LV, ref_res_path, &ref_voxel_map);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr disappeared_objects_cloud = fromDetObjectVecToCloud(ref_obj_vec, false);
+            if (!disappeared_objects_cloud->empty())
+                saveDebugCloud(ref_res_path + "/upsampled_objects.pcd", *disappeared_objects_cloud);
+        }
 
         filterUnwantedObjects(ref_obj_vec, min_object_volume, min_object_size_ds, max_object_size_ds);
-        disappeared_objects_cloud = fromDetObjectVecToCloud(ref_obj_vec, false);
-        if (!disappeared_objects_cloud->empty())
-            pcl::io::savePCDFileBinary(ref_res_path + "/final_objects.pcd", *disappeared_objects_cloud);
+        if (debugArtifactsEnabled()) {
+            pcl::PointCloud<PointNormal>::Ptr disappeared_objects_cloud = fromDetObjectVecToCloud(ref_obj_vec, false);
+            if (!disappeared_objects_cloud->empty())
+                saveDebugCloud(ref_res_path + "/final_objects.pcd", *disappeared_objects_cloud);
+        }
 
 
         //save each object including its supporting plane
@@ -252,22 +275,7 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
 
     //------------------Match detected objects against each other with PPF-----------------------
     //depending on if LV was performed before, static objects can be matched
-    std::string debug_model_path = output_path_ + "/model_objects/";
-    for (DetectedObject obj : ref_obj_vec) {
-        pcl::PointCloud<PointNormal>::Ptr refined_normals_cloud (new pcl::PointCloud<PointNormal>);
-        pcl::copyPointCloud(*(obj.getObjectCloud()), *refined_normals_cloud);
-        refineNormals(refined_normals_cloud);
-        obj.setObjectCloud(refined_normals_cloud);
-
-        std::string debug_obj_folder = debug_model_path + std::to_string(obj.getID()); //PPF uses the folder name as model_id!
-        boost::filesystem::create_directories(debug_obj_folder);
-        std::string obj_folder = ppf_model_path_ + std::to_string(obj.getID()); //PPF uses the folder name as model_id!
-        boost::filesystem::create_directories(obj_folder);
-        pcl::io::savePCDFile(debug_obj_folder + "/3D_model.pcd", *(obj.getObjectCloud())); //each detected reference object is saved in a folder for further use with PPF
-        pcl::io::savePCDFileBinary(debug_obj_folder + "/plane.pcd", *(obj.plane_cloud_));
-        pcl::io::savePCDFile(obj_folder + "/3D_model.pcd", *(obj.getObjectCloud()));
-        obj.object_folder_path_ = obj_folder;
-    }
+    saveObjectModels(ref_obj_vec, output_path_ + "/model_objects/", "3D_model.pcd"); //each detected reference object is saved for offline use (all_scenes_comparison_matching_only)
 
     filterUnwantedObjects(ref_obj_vec, min_object_volume, min_object_size_ds); //0.05^3
 
@@ -280,17 +288,7 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
         return;
     }
 
-    for (DetectedObject obj : curr_obj_vec) {
-        pcl::PointCloud<PointNormal>::Ptr refined_normals_cloud (new pcl::PointCloud<PointNormal>);
-        pcl::copyPointCloud(*(obj.getObjectCloud()), *refined_normals_cloud);
-        refineNormals(refined_normals_cloud);
-        obj.setObjectCloud(refined_normals_cloud);
-
-        std::string debug_obj_folder = output_path_ + "/current_det_objects/" + std::to_string(obj.getID());
-        boost::filesystem::create_directories(debug_obj_folder);
-        pcl::io::savePCDFileBinary(debug_obj_folder + "/object.pcd", *(obj.getObjectCloud()));
-        pcl::io::savePCDFileBinary(debug_obj_folder + "/plane.pcd", *(obj.plane_cloud_));
-    }
+    saveObjectModels(curr_obj_vec, output_path_ + "/current_det_objects/", "object.pcd");
 
     filterUnwantedObjects(curr_obj_vec, min_object_volume, min_object_size_ds);
 
@@ -311,7 +309,7 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
     filterUnwantedObjects(curr_result, min_object_volume, min_object_size_ds);
 
     //matches between same plane different timestamps
-    ObjectMatching object_matching(ref_obj_vec, curr_obj_vec, ppf_model_path_, ppf_config_path_);
+    ObjectMatching object_matching(ref_obj_vec, curr_obj_vec, ppf_model_path_, context_);
     std::vector<Match> matches = object_matching.compute(ref_result, curr_result);
 
     //region growing of static/displaced objects (should create more precise results if e.g. the model was smaller than die object or not precisely aligned
@@ -321,16 +319,23 @@ void ChangeDetection::compute(std::vector<DetectedObject> &ref_result, std::vect
     filterUnwantedObjects(curr_result, min_object_volume, min_object_size_ds);
 }
 
-void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr orig_cloud, std::vector<DetectedObject> &objects, double leaf_size, std::string res_path) {
+void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr orig_cloud, std::vector<DetectedObject> &objects, double leaf_size, std::string res_path,
+                                               const VoxelIndexMap *voxel_map) {
+    V4R_TRACE_SCOPE("ChangeDetection::upsampleObjectsAndPlanes");
     pcl::octree::OctreePointCloudSearch<PointNormal>::Ptr octree;
-    octree.reset(new pcl::octree::OctreePointCloudSearch<PointNormal>(leaf_size));
-    octree->setInputCloud(orig_cloud);
-    octree->addPointsFromInputCloud();
+    if (!voxel_map) {
+        octree.reset(new pcl::octree::OctreePointCloudSearch<PointNormal>(leaf_size));
+        octree->setInputCloud(orig_cloud);
+        octree->addPointsFromInputCloud();
+    }
+    auto upsample = [&](pcl::PointCloud<PointNormal>::ConstPtr object_ds_cloud, int counter) {
+        return voxel_map ? upsampleObjects(*voxel_map, orig_cloud, object_ds_cloud, res_path, counter) : upsampleObjects(octree, orig_cloud, object_ds_cloud, res_path, counter);
+    };
 
     for (size_t i = 0; i < objects.size(); i++) {
         DetectedObject &obj = objects[i];
         //upsample plane indices
-        std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > obj_cloud_ind_tuple = upsampleObjects(octree, orig_cloud, obj.plane_cloud_, res_path, i);
+        std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > obj_cloud_ind_tuple = upsample(obj.plane_cloud_, i);
         obj.plane_cloud_ = std::get<0>(obj_cloud_ind_tuple);
 
         PointNormal minPt_object, maxPt_object;
@@ -353,7 +358,7 @@ void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr
         dit -> selectWithinDistance (vec_coeff, leaf_size/2, inliers);
 
         //also object indices need to be upsampled (this could lead to a state where a point is assigned to an object AND the plane!)
-        obj_cloud_ind_tuple= upsampleObjects(octree, orig_cloud, obj.getObjectCloud(), res_path, i);
+        obj_cloud_ind_tuple= upsample(obj.getObjectCloud(), i);
         std::vector<int> ind =get<1>(obj_cloud_ind_tuple);
 
         //remove points that are detected as planes and object from the object. we don't want plane points in the object for better feature detection
@@ -378,12 +383,18 @@ void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr
 }
 
 void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr orig_cloud, pcl::PointCloud<PointNormal>::Ptr ds_cloud,
-                                               std::vector<PlaneWithObjInd> &objects, double leaf_size, std::string res_path) {
+                                               std::vector<PlaneWithObjInd> &objects, double leaf_size, std::string res_path, const VoxelIndexMap *voxel_map) {
+    V4R_TRACE_SCOPE("ChangeDetection::upsampleObjectsAndPlanes");
     pcl::octree::OctreePointCloudSearch<PointNormal>::Ptr octree;
-    octree.reset(new pcl::octree::OctreePointCloudSearch<PointNormal>(leaf_size));
-    octree->setInputCloud(orig_cloud);
-    octree->addPointsFromInputCloud();
-    std::cout << "Created octree" << std::endl;
+    if (!voxel_map) {
+        octree.reset(new pcl::octree::OctreePointCloudSearch<PointNormal>(leaf_size));
+        octree->setInputCloud(orig_cloud);
+        octree->addPointsFromInputCloud();
+        std::cout << "Created octree" << std::endl;
+    }
+    auto upsample = [&](pcl::PointCloud<PointNormal>::ConstPtr object_ds_cloud, int counter) {
+        return voxel_map ? upsampleObjects(*voxel_map, orig_cloud, object_ds_cloud, res_path, counter) : upsampleObjects(octree, orig_cloud, object_ds_cloud, res_path, counter);
+    };
 
     for (size_t i = 0; i < objects.size(); i++) {
         //upsample plane indices
@@ -396,7 +407,7 @@ void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr
         extract_object_ind.setKeepOrganized(false);
         extract_object_ind.setNegative (false);
         extract_object_ind.filter (*plane_ds_cloud);
-        std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > obj_cloud_ind_tuple = upsampleObjects(octree, orig_cloud, plane_ds_cloud, res_path, i);
+        std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > obj_cloud_ind_tuple = upsample(plane_ds_cloud, i);
         objects[i].plane.plane_ind->indices = std::get<1>(obj_cloud_ind_tuple);
 
         PointNormal minPt_object, maxPt_object;
@@ -428,7 +439,7 @@ void ChangeDetection::upsampleObjectsAndPlanes(pcl::PointCloud<PointNormal>::Ptr
         extract_object_ind.setNegative (false);
         extract_object_ind.filter (*object_ds_cloud);
         //pcl::io::savePCDFileBinary(res_path + "/ds_objects" + std::to_string(i)+ ".pcd", *object_ds_cloud);
-        obj_cloud_ind_tuple= upsampleObjects(octree, orig_cloud, object_ds_cloud, res_path, i);
+        obj_cloud_ind_tuple= upsample(object_ds_cloud, i);
         std::vector<int> ind =get<1>(obj_cloud_ind_tuple);
 
         //remove points that are detected as planes and object from the object. we don't want plane points in the object for better feature detection
@@ -462,6 +473,22 @@ std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > ChangeDetection
             }
         }
     }
+    return extractUpsampledObject(orig_input_cloud, orig_object_ind, output_path, counter);
+}
+
+//a downsampled point is the centroid of its voxel, all original points of that voxel belong to the object
+std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > ChangeDetection::upsampleObjects(const VoxelIndexMap &voxel_map, pcl::PointCloud<PointNormal>::ConstPtr orig_input_cloud,
+                                                                                                  pcl::PointCloud<PointNormal>::ConstPtr objects_ds_cloud, std::string output_path, int counter) {
+    std::vector<int> orig_object_ind;
+    orig_object_ind.reserve(objects_ds_cloud->points.size() * 8);
+    for (size_t i = 0; i < objects_ds_cloud->points.size(); ++i) {
+        voxel_map.gather(objects_ds_cloud->points[i], orig_object_ind);
+    }
+    return extractUpsampledObject(orig_input_cloud, orig_object_ind, output_path, counter);
+}
+
+std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > ChangeDetection::extractUpsampledObject(pcl::PointCloud<PointNormal>::ConstPtr orig_input_cloud,
+                                                                                                         std::vector<int> &orig_object_ind, std::string output_path, int counter) {
     std::sort(orig_object_ind.begin(), orig_object_ind.end());
     orig_object_ind.erase(std::unique(orig_object_ind.begin(), orig_object_ind.end()), orig_object_ind.end());
 
@@ -473,7 +500,7 @@ std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > ChangeDetection
     extract_object_ind.setKeepOrganized(true);
     extract_object_ind.setNegative (false);
     extract_object_ind.filter (*orig_object);
-    pcl::io::savePCDFileBinary(output_path + "/object_orig" + std::to_string(counter)+ ".pcd", *orig_object);
+    saveDebugCloud(output_path + "/object_orig" + std::to_string(counter)+ ".pcd", *orig_object);
 
     std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > obj_cloud_ind_tuple;
     obj_cloud_ind_tuple = std::make_tuple(orig_object, orig_object_ind);
@@ -483,7 +510,18 @@ std::tuple<pcl::PointCloud<PointNormal>::Ptr, std::vector<int> > ChangeDetection
 
 //upsample objects and region growing; filter big objects
 void ChangeDetection::objectRegionGrowing(pcl::PointCloud<PointNormal>::Ptr cloud, std::vector<PlaneWithObjInd> &objects, int max_object_size) {
-    for (size_t i = 0; i < objects.size(); i++) {
+    V4R_TRACE_SCOPE("ChangeDetection::objectRegionGrowing");
+    if (objects.empty())
+        return;
+
+    //one search index for all clusters. The clusters only read the cloud and the index and are grown concurrently.
+    pcl::PointCloud<pcl::Normal>::Ptr scene_normals (new pcl::PointCloud<pcl::Normal>);
+    pcl::copyPointCloud(*cloud, *scene_normals);
+    const RegionGrowingIndex<PointNormal> index(cloud, scene_normals, std::sqrt(2) * 0.01, false);
+
+    std::vector<std::vector<int> > grown_indices(objects.size());
+    std::vector<uint8_t> is_grown(objects.size(), 0);
+    v4r::parallelFor(0, objects.size(), [&](size_t i) {
         pcl::PointCloud<PointNormal>::Ptr object_cloud(new pcl::PointCloud<PointNormal>);
         for (size_t p = 0; p < objects[i].obj_indices.size(); p++) {
             object_cloud->points.push_back(cloud->points[objects[i].obj_indices[p]]);
@@ -493,31 +531,18 @@ void ChangeDetection::objectRegionGrowing(pcl::PointCloud<PointNormal>::Ptr clou
 
         /// crop cloud
         float crop_margin = 0.5; //choosing a larger crop margin lets objects grow larger (especially FP objects) that are then filtered out
-        pcl::PointCloud<PointNormal>::Ptr cloud_crop(new pcl::PointCloud<PointNormal>);
-        pcl::PassThrough<PointNormal> pass;
-        pass.setInputCloud(cloud);
-        pass.setFilterFieldName("x");
-        pass.setFilterLimits(minPt_object.x - crop_margin, maxPt_object.x + crop_margin);
-        pass.setKeepOrganized(true);
-        pass.filter(*cloud_crop);
-        pass.setInputCloud(cloud_crop);
-        pass.setFilterFieldName("y");
-        pass.setFilterLimits(minPt_object.y - crop_margin, maxPt_object.y + crop_margin);
-        pass.setKeepOrganized(true);
-        pass.filter(*cloud_crop);
-        pass.setInputCloud(cloud_crop);
-        pass.setFilterFieldName("z");
-        pass.setFilterLimits(minPt_object.z, maxPt_object.z + crop_margin);
-        pass.setKeepOrganized(true);
-        pass.filter(*cloud_crop);
+        //instead of a cropped copy of the cloud, points outside of the crop box are blocked for the region growing
+        std::vector<bool> blocked(cloud->points.size());
+        for (size_t p = 0; p < cloud->points.size(); p++) {
+            const PointNormal &pt = cloud->points[p];
+            blocked[p] = !(pt.x >= minPt_object.x - crop_margin && pt.x <= maxPt_object.x + crop_margin &&
+                           pt.y >= minPt_object.y - crop_margin && pt.y <= maxPt_object.y + crop_margin &&
+                           pt.z >= minPt_object.z && pt.z <= maxPt_object.z + crop_margin);
+        }
 
         //remove supporting plane
-        pcl::ExtractIndices<PointNormal> extract_plane_ind;
-        extract_plane_ind.setInputCloud (cloud_crop);
-        extract_plane_ind.setIndices(objects[i].plane.plane_ind);
-        extract_plane_ind.setKeepOrganized(true);
-        extract_plane_ind.setNegative (true);
-        extract_plane_ind.filter (*cloud_crop);
+        for (int p : objects[i].plane.plane_ind->indices)
+            blocked[p] = true;
         //we do not use the plane points directly because there is a chance that they do not cover the whole plane.
         //This is because the plane extraction part operates on semantic segmentation and if one plane is assigned to several labels, they are not part of the detected plane.
         //        pcl::SampleConsensusModelPlane<PointNormal>::Ptr dit (new pcl::SampleConsensusModelPlane<PointNormal> (cloud_crop));
@@ -530,33 +555,26 @@ void ChangeDetection::objectRegionGrowing(pcl::PointCloud<PointNormal>::Ptr clou
         //            cloud_crop->points[inliers[p]] = nan_point;
         //        }
 
-        //pcl::io::savePCDFileBinary("/home/edith/crop_no_plane" + std::to_string(i) + ".pcd", *cloud_crop);
-        //pcl::io::savePCDFileBinary("/home/edith/object_cloud" + std::to_string(i) + ".pcd", *object_cloud);
-
-
-        pcl::PointCloud<pcl::Normal>::Ptr scene_normals (new pcl::PointCloud<pcl::Normal>);
-        pcl::copyPointCloud(*cloud_crop, *scene_normals);
-
         //call the region growing method and extract upsampled object
-        RegionGrowing<PointNormal, PointNormal> region_growing(cloud_crop, object_cloud, scene_normals, true);
+        RegionGrowing<PointNormal, PointNormal> region_growing(cloud, object_cloud, scene_normals, true);
+        region_growing.setSharedIndex(&index, &blocked);
         std::vector<int> orig_object_ind = region_growing.compute();
 
-        pcl::PointCloud<PointNormal>::Ptr orig_object_cloud(new pcl::PointCloud<PointNormal>);
-        //extract object indices from downsampled cloud
-        pcl::ExtractIndices<PointNormal> extract_object_ind;
-        extract_object_ind.setInputCloud (cloud_crop);
-        extract_object_ind.setIndices(boost::make_shared<std::vector<int> > (orig_object_ind));
-        extract_object_ind.setKeepOrganized(false);
-        extract_object_ind.setNegative (false);
-        extract_object_ind.filter (*orig_object_cloud);
+        Eigen::Vector4f minPt_orig_object, maxPt_orig_object;
+        pcl::getMinMax3D (*cloud, orig_object_ind, minPt_orig_object, maxPt_orig_object);
 
-        PointNormal minPt_orig_object, maxPt_orig_object;
-        pcl::getMinMax3D (*orig_object_cloud, minPt_orig_object, maxPt_orig_object);
+        if (std::abs(maxPt_orig_object[0] - minPt_orig_object[0]) < 10*std::abs(maxPt_object.x - minPt_object.x) &&
+                std::abs(maxPt_orig_object[1] - minPt_orig_object[1]) < 10*std::abs(maxPt_object.y - minPt_object.y) &&
+                std::abs(maxPt_orig_object[2] - minPt_orig_object[2]) < 10*std::abs(maxPt_object.z - minPt_object.z) ) { //otherwise something went wrong with the region growing (expanded too much)
+            grown_indices[i] = std::move(orig_object_ind);
+            is_grown[i] = 1;
+        }
+    }, 1);
 
-        if (std::abs(maxPt_orig_object.x - minPt_orig_object.x) < 10*std::abs(maxPt_object.x - minPt_object.x) &&
-                std::abs(maxPt_orig_object.y - minPt_orig_object.y) < 10*std::abs(maxPt_object.y - minPt_object.y) &&
-                std::abs(maxPt_orig_object.z - minPt_orig_object.z) < 10*std::abs(maxPt_object.z - minPt_object.z) ) //otherwise something went wrong with the region growing (expanded too much)
-            objects[i].obj_indices = orig_object_ind;
+    //every cluster was grown from the same input, the results are applied in the order of the clusters
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (is_grown[i])
+            objects[i].obj_indices = std::move(grown_indices[i]);
     }
 //    std::cout << "Original number of objects: " << objects.size() << ", objects after region growing (big ones got filtered): ";
 //    objects.erase(
@@ -593,6 +611,9 @@ pcl::PointCloud<PointNormal>::Ptr ChangeDetection::fromObjectVecToObjectCloud(co
 }
 
 void ChangeDetection::saveObjectsWithPlanes(std::string path, const std::vector<DetectedObject> objects) {
+    if (!debugArtifactsEnabled())
+        return;
+
     PointLabel nan_point;
     nan_point.x = nan_point.y = nan_point.z = std::numeric_limits<float>::quiet_NaN();
 
@@ -615,11 +636,14 @@ void ChangeDetection::saveObjectsWithPlanes(std::string path, const std::vector<
             p_l.label = 1;  //label 1 for plane
             res_cloud->points.push_back(p_l);
         }
-        pcl::io::savePCDFileBinary(path + "object" + std::to_string(o) + ".pcd", *res_cloud);
+        saveDebugCloud(path + "object" + std::to_string(o) + ".pcd", *res_cloud);
     }
 }
 
 void ChangeDetection::saveObjectsWithPlanes(std::string path, const std::vector<PlaneWithObjInd> objects, pcl::PointCloud<PointNormal>::Ptr cloud) {
+    if (!debugArtifactsEnabled())
+        return;
+
     PointLabel nan_point;
     nan_point.x = nan_point.y = nan_point.z = std::numeric_limits<float>::quiet_NaN();
 
@@ -645,12 +669,13 @@ void ChangeDetection::saveObjectsWithPlanes(std::string path, const std::vector<
             res_cloud->points[plane_ind[i]].rgb = p.rgb;
             res_cloud->points[plane_ind[i]].label = 1; //label 1 for plane
         }
-        pcl::io::savePCDFileBinary(path + "object" + std::to_string(o) + ".pcd", *res_cloud);
+        saveDebugCloud(path + "object" + std::to_string(o) + ".pcd", *res_cloud);
     }
 }
 
 //this method changes the object vector!
 void ChangeDetection::mergeObjects(std::vector<PlaneWithObjInd>& objects) {
+    V4R_TRACE_SCOPE("ChangeDetection::mergeObjects");
     std::cout << "Number of objects before merging " << objects.size() << std::endl;
     //sort point indices for further operations
     for (size_t o = 0; o < objects.size(); o++) {
@@ -763,8 +788,8 @@ double ChangeDetection::checkColorSimilarityHistogram(PlaneWithObjInd& object, p
     pass.filter(*cloud_crop);
 
     if (path!="") {
-        pcl::io::savePCDFileBinary(path + "/object.pcd", *object_cloud);
-        pcl::io::savePCDFileBinary(path + "/cloud_crop.pcd", *cloud_crop);
+        saveDebugCloud(path + "/object.pcd", *object_cloud);
+        saveDebugCloud(path + "/cloud_crop.pcd", *cloud_crop);
     }
 
     ColorHistogram color_hist;
@@ -867,7 +892,7 @@ void ChangeDetection::filterVerticalPlanes(std::vector<PlaneWithObjInd>& objects
             extract.setNegative (false);
             extract.filter (*filtered_object_cloud);
 
-            pcl::io::savePCDFileBinary(path + "/object" + std::to_string(o) + "planarity" + std::to_string(planarity) + ".pcd", *filtered_object_cloud);
+            saveDebugCloud(path + "/object" + std::to_string(o) + "planarity" + std::to_string(planarity) + ".pcd", *filtered_object_cloud);
         }
     }
     for (auto i = obj_ind_to_del.rbegin(); i != obj_ind_to_del.rend(); ++ i)
@@ -902,7 +927,7 @@ void ChangeDetection::filterPlanarAndColor(std::vector<PlaneWithObjInd>& objects
             extract.setNegative (false);
             extract.filter (*filtered_object_cloud);
 
-            pcl::io::savePCDFileBinary(path + "/object" + std::to_string(o) + ".pcd", *filtered_object_cloud);
+            saveDebugCloud(path + "/object" + std::to_string(o) + ".pcd", *filtered_object_cloud);
         }
     }
     for (auto i = obj_ind_to_del.rbegin(); i != obj_ind_to_del.rend(); ++ i)
@@ -939,188 +964,318 @@ void ChangeDetection::refineNormals(pcl::PointCloud<PointNormal>::Ptr object_clo
     pcl::removeNaNNormalsFromPointCloud(*object_cloud, *object_cloud, nan);
 }
 
-//merge objects classified as NEW/REMOVED  with neighbouring objects classified as DISPLACED/STATIC
-void ChangeDetection::mergeObjectParts(std::vector<DetectedObject> &detected_objects, std::string merge_object_parts_folder) {
-    for (size_t i = 0; i < detected_objects.size(); i++) {
-        if (detected_objects[i].state_ == ObjectState::NEW || detected_objects[i].state_ == ObjectState::REMOVED) {
-            for (size_t j = 0; j < detected_objects.size(); j++) {
-                if (detected_objects[j].state_ == ObjectState::STATIC || detected_objects[j].state_ == ObjectState::DISPLACED) {
+//the normals of a plane cloud only depend on its points, a plane that is part of several comparisons is refined once
+void ChangeDetection::refinePlaneNormals(pcl::PointCloud<PointNormal>::Ptr plane_cloud) {
+    if (!extraction_cache_ || !extraction_cache_->cachesNormals() || plane_cloud->empty()) {
+        refineNormals(plane_cloud);
+        return;
+    }
+    uint64_t cache_key = PlaneExtractionCache::normalsKey(*plane_cloud);
+    if (extraction_cache_->getRefinedNormals(cache_key, *plane_cloud))
+        return;
+    refineNormals(plane_cloud);
+    extraction_cache_->putRefinedNormals(cache_key, *plane_cloud);
+}
 
-                    if (detected_objects[j].getObjectCloud()->empty() || detected_objects[i].getObjectCloud()->empty())
-                        continue;
+//Saves every object with refined normals and its supporting plane to <folder>/<id>/, e.g. for the offline matching in
+//all_scenes_comparison_matching_only. The objects themselves keep their normals.
+void ChangeDetection::saveObjectModels(const std::vector<DetectedObject> &objects, const std::string &folder, const std::string &object_file_name) {
+    for (const DetectedObject &obj : objects) {
+        pcl::PointCloud<PointNormal>::Ptr refined_normals_cloud (new pcl::PointCloud<PointNormal>);
+        pcl::copyPointCloud(*(obj.getObjectCloud()), *refined_normals_cloud);
+        refineNormals(refined_normals_cloud);
 
-                    pcl::PointCloud<PointNormal>::Ptr good_pts(new pcl::PointCloud<PointNormal>);
-                    /// the detected objects is from the current frame
-                    if (detected_objects[i].state_ == ObjectState::NEW && detected_objects[j].getID() == detected_objects[j].match_.object_id) {
-                        /// are the potential overlapping objects close?
-                        pcl::KdTreeFLANN<PointNormal> kdtree;
-                        kdtree.setInputCloud (detected_objects[i].getObjectCloud());
-
-                        bool is_obj_close = false;
-                        int K = 1;
-                        for (size_t p = 0; p < detected_objects[j].getObjectCloud()->size(); p++) {
-                            const PointNormal &searchPoint = detected_objects[j].getObjectCloud()->points[p];
-                            if (!pcl::isFinite(searchPoint))
-                                continue;
-
-                            std::vector<int> pointIdxKNNSearch(K);
-                            std::vector<float> pointKNNSquaredDistance(K);
-
-                            if ( kdtree.nearestKSearch (searchPoint, K, pointIdxKNNSearch, pointKNNSquaredDistance) > 0 )
-                            {
-                                if (pointKNNSquaredDistance[0] < 0.02*0.02) {   //if any pair of points of the two objects is closer than 2 cm
-                                    is_obj_close = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (!is_obj_close)
-                            continue;
+        std::string obj_folder = folder + std::to_string(obj.getID());
+        boost::filesystem::create_directories(obj_folder);
+        saveResultCloud(obj_folder + "/" + object_file_name, *refined_normals_cloud);
+        saveResultCloud(obj_folder + "/plane.pcd", *(obj.plane_cloud_));
+    }
+}
 
-                        pcl::ExtractIndices<PointNormal> extract;
-                        extract.setInputCloud (detected_objects[j].getObjectCloud());
-                        pcl::PointIndices::Ptr obj_ind(new pcl::PointIndices);
-                        obj_ind->indices = detected_objects[j].match_.fitness_score.object_overlapping_pts;
-                        extract.setIndices (obj_ind);
-                        extract.setNegative (false);
-                        extract.setKeepOrganized(false);
-                        extract.filter(*good_pts);
+//The occupancy of both planes agrees, every object of the reference plane is STATIC. Its counterpart are the points of the current
+//plane at the same place, matched with the identity. Returns false if an object has no counterpart after all or if a current
+//object is not explained by the reference objects (e.g. a small object added next to the others).
+bool ChangeDetection::computeUnchangedPlane(pcl::PointCloud<PointNormal>::Ptr ref_cloud_downsampled, const VoxelIndexMap &ref_voxel_map,
+                                            std::vector<PlaneWithObjInd> ref_objects_from_plane,
+                                            pcl::PointCloud<PointNormal>::ConstPtr curr_cloud_downsampled, const std::vector<PlaneWithObjInd> &curr_objects_from_plane,
+                                            const std::string &ref_res_path, std::vector<DetectedObject> &ref_result, std::vector<DetectedObject> &curr_result) {
+    V4R_TRACE_SCOPE("ChangeDetection::computeUnchangedPlane");
+    if (ref_objects_from_plane.size() > 0) {
+        objectRegionGrowing(ref_cloud_downsampled, ref_objects_from_plane);
+        mergeObjects(ref_objects_from_plane);
+    }
+
+    pcl::PointCloud<PointNormal> ref_objects_cloud;
+    for (const PlaneWithObjInd &ro : ref_objects_from_plane) {
+        for (int idx : ro.obj_indices)
+            ref_objects_cloud.push_back(ref_cloud_downsampled->points[idx]);
+    }
+    std::vector<std::vector<int> > curr_objects;
+    for (const PlaneWithObjInd &co : curr_objects_from_plane)
+        curr_objects.push_back(co.obj_indices);
+    if (!areObjectsCovered(*curr_cloud_downsampled, curr_objects, ref_objects_cloud, unchanged_max_cover_dist))
+        return false;
+
+    std::vector<DetectedObject> ref_obj_vec;
+    for (size_t i = 0; i < ref_objects_from_plane.size(); i++) {
+        ref_obj_vec.push_back(fromPlaneIndObjToDetectedObject(ref_cloud_downsampled, ref_objects_from_plane[i]));
+    }
+    if (ref_obj_vec.size() > 0) {
+        upsampleObjectsAndPlanes(ref_cloud_, ref_obj_vec, ds_leaf_size_LV, ref_res_path, &ref_voxel_map);
+        filterUnwantedObjects(ref_obj_vec, min_object_volume, min_object_size_ds, max_object_size_ds);
+    }
+
+    std::vector<DetectedObject> curr_obj_vec;
+    if (ref_obj_vec.size() > 0) {
+        pcl::KdTreeFLANN<PointNormal> curr_kdtree;
+        curr_kdtree.setInputCloud(curr_cloud_);
+        std::vector<int> nn_indices;
+        std::vector<float> nn_sqrd_distances;
+        std::vector<bool> is_object_point(curr_cloud_->size(), false);
+        for (DetectedObject &ro : ref_obj_vec) {
+            pcl::PointCloud<PointNormal>::Ptr curr_object_cloud(new pcl::PointCloud<PointNormal>);
+            for (const PointNormal &pt : ro.getObjectCloud()->points) {
+                curr_kdtree.radiusSearch(pt, ds_leaf_size_LV, nn_indices, nn_sqrd_distances);
+                for (int idx : nn_indices) {
+                    if (!is_object_point[idx]) {
+                        is_object_point[idx] = true;
+                        curr_object_cloud->push_back(curr_cloud_->points[idx]);
                     }
-                    /// the detected objects is from the reference frame
-                    else if (detected_objects[i].state_ == ObjectState::REMOVED && detected_objects[j].getID() == detected_objects[j].match_.model_id) {
-                        /// are the potential overlapping objects close?
-                        pcl::KdTreeFLANN<PointNormal> kdtree;
-                        kdtree.setInputCloud (detected_objects[i].getObjectCloud());
-
-                        bool is_obj_close = false;
-                        int K = 1;
-                        for (size_t p = 0; p < detected_objects[j].getObjectCloud()->size(); p++) {
-                            const PointNormal &searchPoint = detected_objects[j].getObjectCloud()->points[p];
-                            if (!pcl::isFinite(searchPoint))
-                                continue;
-
-                            std::vector<int> pointIdxKNNSearch(K);
-                            std::vector<float> pointKNNSquaredDistance(K);
-
-                            if ( kdtree.nearestKSearch (searchPoint, K, pointIdxKNNSearch, pointKNNSquaredDistance) > 0 )
-                            {
-                                if (pointKNNSquaredDistance[0] < 0.02*0.02) {   //if any pair of points of the two objects is closer than 2 cm
-                                    is_obj_close = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (!is_obj_close)
-                            continue;
+                }
+            }
+            if (curr_object_cloud->empty())
+                return false;
+            FitnessScoreStruct fitness = ObjectMatching::computeModelFitness(curr_object_cloud, ro.getObjectCloud(), context_.ppfParams());
+            if (std::min(fitness.object_conf, fitness.model_conf) < unchanged_min_fitness)
+                return false;
+
+            //the supporting plane did not change either, its equation is kept and its current points are collected below
+            pcl::ModelCoefficients::Ptr curr_plane_coeffs = boost::make_shared<pcl::ModelCoefficients>(*(ro.plane_coeffs_));
+            DetectedObject co(context_.nextObjectID(), curr_object_cloud, pcl::PointCloud<PointNormal>::Ptr(new pcl::PointCloud<PointNormal>),
+                              curr_plane_coeffs, ObjectState::STATIC);
+            Match match(ro.getID(), co.getID(), Eigen::Matrix4f::Identity(), fitness);
+            ro.state_ = ObjectState::STATIC;
+            ro.match_ = match;
+            co.match_ = match;
+            curr_obj_vec.push_back(co);
+        }
 
-                        pcl::ExtractIndices<PointNormal> extract;
-                        extract.setInputCloud (detected_objects[j].getObjectCloud());
-                        pcl::PointIndices::Ptr obj_ind(new pcl::PointIndices);
-                        obj_ind->indices = detected_objects[j].match_.fitness_score.model_overlapping_pts;
-                        extract.setIndices (obj_ind);
-                        extract.setNegative (false);
-                        extract.setKeepOrganized(false);
-                        extract.filter(*good_pts);
+        //the current plane points are the ones at the reference plane that are not taken by any current object
+        std::vector<bool> is_plane_point(curr_cloud_->size(), false);
+        for (size_t i = 0; i < ref_obj_vec.size(); i++) {
+            std::fill(is_plane_point.begin(), is_plane_point.end(), false);
+            pcl::PointCloud<PointNormal>::Ptr curr_plane_cloud = curr_obj_vec[i].plane_cloud_;
+            for (const PointNormal &pt : ref_obj_vec[i].plane_cloud_->points) {
+                curr_kdtree.radiusSearch(pt, ds_leaf_size_LV, nn_indices, nn_sqrd_distances);
+                for (int idx : nn_indices) {
+                    if (!is_object_point[idx] && !is_plane_point[idx]) {
+                        is_plane_point[idx] = true;
+                        curr_plane_cloud->push_back(curr_cloud_->points[idx]);
                     }
-                    else
-                        continue;
+                }
+            }
+        }
+    }
 
-                    //call the region growing method
-                    std::string path = merge_object_parts_folder + "/" + std::to_string(detected_objects[i].getID()) + "-" + std::to_string(detected_objects[j].getID());
-                    boost::filesystem::create_directory(path);
+    std::cout << "Plane is unchanged, " << ref_obj_vec.size() << " static objects" << std::endl;
+    saveObjectModels(ref_obj_vec, output_path_ + "/model_objects/", "3D_model.pcd");
+    saveObjectModels(curr_obj_vec, output_path_ + "/current_det_objects/", "object.pcd");
+    ref_result = ref_obj_vec;
+    curr_result = curr_obj_vec;
+    return true;
+}
 
+//merge objects classified as NEW/REMOVED  with neighbouring objects classified as DISPLACED/STATIC
+std::vector<int> ChangeDetection::mergeObjectParts(std::vector<DetectedObject> &detected_objects, std::string merge_object_parts_folder) {
+    V4R_TRACE_SCOPE("ChangeDetection::mergeObjectParts");
+    const float max_part_dist = 0.02; //parts are merged if any pair of points of the two objects is closer than 2 cm
+
+    auto isPart = [](const DetectedObject &o) {
+        return o.state_ == ObjectState::NEW || o.state_ == ObjectState::REMOVED;
+    };
+    //a NEW part can be merged with an object of the current frame, a REMOVED part with one of the reference frame
+    auto canMerge = [](const DetectedObject &part, const DetectedObject &o) {
+        if (o.state_ != ObjectState::STATIC && o.state_ != ObjectState::DISPLACED)
+            return false;
+        if (part.state_ == ObjectState::NEW)
+            return o.getID() == o.match_.object_id;
+        return part.state_ == ObjectState::REMOVED && o.getID() == o.match_.model_id;
+    };
+
+    /// broad phase: only objects whose bounding boxes are closer than the distance can have close points
+    std::vector<Eigen::AlignedBox3f> boxes(detected_objects.size());
+    for (size_t i = 0; i < detected_objects.size(); i++) {
+        boxes[i] = detected_objects[i].getCloudData().boundingBox(); //memoized with the object cloud
+        if (!boxes[i].isEmpty()) {
+            boxes[i].min().array() -= max_part_dist / 2;
+            boxes[i].max().array() += max_part_dist / 2;
+        }
+    }
+    std::vector<std::vector<int> > candidates(detected_objects.size()); //per part, ascending
+    for (const std::pair<int, int> &p : overlappingBoxPairs(boxes)) {
+        if (isPart(detected_objects[p.first]) && canMerge(detected_objects[p.first], detected_objects[p.second]))
+            candidates[p.first].push_back(p.second);
+        if (isPart(detected_objects[p.second]) && canMerge(detected_objects[p.second], detected_objects[p.first]))
+            candidates[p.second].push_back(p.first);
+    }
+    for (std::vector<int> &c : candidates)
+        std::sort(c.begin(), c.end());
 
+    /// narrow phase: a part belongs to the first object (by index) with a point close to it. Targets are never merged
+    /// with each other, so every group is one target and its parts and a target index per part is all the bookkeeping.
+    std::vector<int> part_target(detected_objects.size(), -1);
+    for (size_t i = 0; i < detected_objects.size(); i++) {
+        if (candidates[i].empty())
+            continue;
+        pcl::KdTreeFLANN<PointNormal> kdtree; //one tree per part for all its candidates
+        kdtree.setInputCloud (detected_objects[i].getObjectCloud());
+        std::vector<int> pointIdxKNNSearch(1);
+        std::vector<float> pointKNNSquaredDistance(1);
+        for (int j : candidates[i]) {
+            bool is_obj_close = false;
+            for (const PointNormal &searchPoint : detected_objects[j].getObjectCloud()->points) {
+                if (!pcl::isFinite(searchPoint))
+                    continue;
+                if (kdtree.nearestKSearch (searchPoint, 1, pointIdxKNNSearch, pointKNNSquaredDistance) > 0 &&
+                        pointKNNSquaredDistance[0] < max_part_dist * max_part_dist) {
+                    is_obj_close = true;
+                    break;
+                }
+            }
+            if (is_obj_close) {
+                part_target[i] = j;
+                break;
+            }
+        }
+    }
 
-                    pcl::PointCloud<PointNormal>::Ptr combined_object(new pcl::PointCloud<PointNormal>);
-                    pcl::PointCloud<PointNormal>::Ptr object_i_refined(new pcl::PointCloud<PointNormal>);
-                    pcl::PointCloud<PointNormal>::Ptr object_j_refined(new pcl::PointCloud<PointNormal>);
-                    pcl::copyPointCloud(*detected_objects[i].getObjectCloud(), *object_i_refined);
-                    pcl::copyPointCloud(*detected_objects[j].getObjectCloud(), *object_j_refined);
-                    //refineNormals(object_i_refined);
-                    //refineNormals(object_j_refined);
-
-                    pcl::io::savePCDFileBinary(path + "/good_fitness_points.pcd", *good_pts);
-                    pcl::io::savePCDFileBinary(path+ "/startingToMerge" + std::to_string(detected_objects[j].getID()) + ".pcd", *object_j_refined);
-                    pcl::io::savePCDFileBinary(path+ "/tryToMerge" + std::to_string(detected_objects[i].getID()) + ".pcd", *object_i_refined);
-
-                    //                    *combined_object += *detected_objects[i].getObjectCloud();
-                    //                    *combined_object += *detected_objects[j].getObjectCloud();
-                    *combined_object += *object_i_refined;
-                    *combined_object += *object_j_refined;
-                    pcl::PointCloud<pcl::Normal>::Ptr scene_normals(new pcl::PointCloud<pcl::Normal>);
-                    pcl::copyPointCloud(*combined_object, *scene_normals);
-                    RegionGrowing<PointNormal, PointNormal> region_growing(combined_object, good_pts, scene_normals, false, 15.0, 10);
-                    std::vector<int> add_object_ind = region_growing.compute();
+    /// one region growing per target and part state (the seed points depend on the state)
+    for (size_t j = 0; j < detected_objects.size(); j++) {
+        for (ObjectState part_state : {ObjectState::NEW, ObjectState::REMOVED}) {
+            std::vector<int> parts;
+            for (size_t i = 0; i < detected_objects.size(); i++) {
+                if (part_target[i] == static_cast<int>(j) && detected_objects[i].state_ == part_state)
+                    parts.push_back(i);
+            }
+            if (parts.empty())
+                continue;
+            DetectedObject &target = detected_objects[j];
 
-                    //nothing was added to the static/displaced object
-                    if (add_object_ind.size() == good_pts->size())
-                        continue;
+            pcl::PointCloud<PointNormal>::Ptr good_pts(new pcl::PointCloud<PointNormal>);
+            pcl::ExtractIndices<PointNormal> extract;
+            extract.setInputCloud (target.getObjectCloud());
+            pcl::PointIndices::Ptr obj_ind(new pcl::PointIndices);
+            obj_ind->indices = part_state == ObjectState::NEW ? target.match_.fitness_score.object_overlapping_pts
+                                                              : target.match_.fitness_score.model_overlapping_pts;
+            extract.setIndices (obj_ind);
+            extract.setNegative (false);
+            extract.setKeepOrganized(false);
+            extract.filter(*good_pts);
+
+            //call the region growing method
+            std::string parts_ids;
+            for (int i : parts)
+                parts_ids += (parts_ids.empty() ? "" : "_") + std::to_string(detected_objects[i].getID());
+            std::string path = merge_object_parts_folder + "/" + parts_ids + "-" + std::to_string(target.getID());
+            boost::filesystem::create_directory(path);
+
+            saveDebugCloud(path + "/good_fitness_points.pcd", *good_pts);
+            saveDebugCloud(path+ "/startingToMerge" + std::to_string(target.getID()) + ".pcd", *target.getObjectCloud());
+
+            //target first, then the parts; part_begin[k] is the first index of part k in the combined cloud
+            pcl::PointCloud<PointNormal>::Ptr combined_object(new pcl::PointCloud<PointNormal>);
+            pcl::copyPointCloud(*target.getObjectCloud(), *combined_object);
+            std::vector<size_t> part_begin;
+            for (int i : parts) {
+                saveDebugCloud(path+ "/tryToMerge" + std::to_string(detected_objects[i].getID()) + ".pcd", *detected_objects[i].getObjectCloud());
+                part_begin.push_back(combined_object->size());
+                *combined_object += *detected_objects[i].getObjectCloud();
+            }
+            part_begin.push_back(combined_object->size());
 
+            pcl::PointCloud<pcl::Normal>::Ptr scene_normals(new pcl::PointCloud<pcl::Normal>);
+            pcl::copyPointCloud(*combined_object, *scene_normals);
+            RegionGrowing<PointNormal, PointNormal> region_growing(combined_object, good_pts, scene_normals, false, 15.0, 10);
+            std::vector<int> add_object_ind = region_growing.compute();
 
-                    pcl::PointCloud<PointNormal>::Ptr extracted_cloud(new pcl::PointCloud<PointNormal>);
-                    pcl::ExtractIndices<PointNormal> extract;
-                    extract.setInputCloud (combined_object);
-                    pcl::PointIndices::Ptr obj_ind(new pcl::PointIndices);
-                    obj_ind->indices = add_object_ind;
-                    extract.setIndices (obj_ind);
-                    extract.setNegative (false);
-                    extract.setKeepOrganized(false);
-                    extract.filter(*extracted_cloud);
-                    detected_objects[j].setObjectCloud(extracted_cloud);
-
-                    extract.setNegative (true);
-                    extract.setKeepOrganized(false);
-                    extract.filter(*extracted_cloud);
-                    detected_objects[i].setObjectCloud(extracted_cloud);
-
-
-                    if (!detected_objects[j].getObjectCloud()->empty())
-                        pcl::io::savePCDFileBinary(path + "/after_merging"+ std::to_string(detected_objects[j].getID()) + ".pcd", *detected_objects[j].getObjectCloud());
-                    if (!detected_objects[i].getObjectCloud()->empty())
-                        pcl::io::savePCDFileBinary(path + "/after_merging"+ std::to_string(detected_objects[i].getID()) + ".pcd", *detected_objects[i].getObjectCloud());
-
-                    //remove very small clusters
-                    std::vector<int> small_cluster_ind;
-                    ObjectMatching::clusterOutliersBySize(detected_objects[i].getObjectCloud(), small_cluster_ind, 0.014, min_object_size_ds);
-
-                    pcl::PointCloud<PointNormal>::Ptr small_cluster_cloud(new pcl::PointCloud<PointNormal>);
-                    extract.setInputCloud (detected_objects[i].getObjectCloud());
-                    obj_ind->indices = small_cluster_ind;
-                    extract.setIndices (obj_ind);
-                    extract.setNegative (false);
-                    extract.setKeepOrganized(false);
-                    extract.filter(*small_cluster_cloud);
-                    *small_cluster_cloud += *detected_objects[j].getObjectCloud();
-                    detected_objects[j].setObjectCloud(small_cluster_cloud);
-
-                    extract.setNegative (true);
-                    extract.setKeepOrganized(false);
-                    extract.filter(*extracted_cloud);
-                    detected_objects[i].setObjectCloud(extracted_cloud);
-
-                    if (isObjectPlanar(detected_objects[i].getObjectCloud(), 0.01, 0.9)) {
-                        pcl::PointCloud<PointNormal>::Ptr combined_cloud(new pcl::PointCloud<PointNormal>);
-                        pcl::copyPointCloud(*detected_objects[j].getObjectCloud(), *combined_cloud);
-                        *combined_cloud += *detected_objects[i].getObjectCloud();
-                        detected_objects[j].setObjectCloud(combined_cloud);
-                        detected_objects[i].clearClouds();
-                    }
+            //nothing was added to the static/displaced object
+            if (add_object_ind.size() == good_pts->size())
+                continue;
 
-                    if (!detected_objects[j].getObjectCloud()->empty())
-                        pcl::io::savePCDFileBinary(path + "/after_merging_cleaning"+ std::to_string(detected_objects[j].getID()) + ".pcd", *detected_objects[j].getObjectCloud());
-                    if (!detected_objects[i].getObjectCloud()->empty())
-                        pcl::io::savePCDFileBinary(path + "/after_merging_cleaning"+ std::to_string(detected_objects[i].getID()) + ".pcd", *detected_objects[i].getObjectCloud());
+            //the grown points are the target now. The rest goes back to the parts, points of the target that were not
+            //reached go to the first part (like merging the parts one after the other).
+            std::vector<bool> is_grown(combined_object->size(), false);
+            for (int ind : add_object_ind)
+                is_grown[ind] = true;
+            pcl::PointCloud<PointNormal>::Ptr grown_cloud(new pcl::PointCloud<PointNormal>);
+            std::vector<pcl::PointCloud<PointNormal>::Ptr> remaining_parts(parts.size());
+            for (size_t k = 0; k < parts.size(); k++) {
+                remaining_parts[k].reset(new pcl::PointCloud<PointNormal>);
+                for (size_t p = (k == 0 ? 0 : part_begin[k]); p < part_begin[k+1]; p++) {
+                    if (!is_grown[p])
+                        remaining_parts[k]->push_back(combined_object->points[p]);
                 }
             }
+            for (int ind : add_object_ind)
+                grown_cloud->push_back(combined_object->points[ind]);
+            target.setObjectCloud(grown_cloud);
+            if (!target.getObjectCloud()->empty())
+                saveDebugCloud(path + "/after_merging"+ std::to_string(target.getID()) + ".pcd", *target.getObjectCloud());
+
+            for (size_t k = 0; k < parts.size(); k++) {
+                DetectedObject &part = detected_objects[parts[k]];
+                part.setObjectCloud(remaining_parts[k]);
+                if (!part.getObjectCloud()->empty())
+                    saveDebugCloud(path + "/after_merging"+ std::to_string(part.getID()) + ".pcd", *part.getObjectCloud());
+
+                //remove very small clusters
+                std::vector<int> small_cluster_ind;
+                ObjectMatching::clusterOutliersBySize(part.getObjectCloud(), small_cluster_ind, 0.014, min_object_size_ds);
+
+                pcl::PointCloud<PointNormal>::Ptr small_cluster_cloud(new pcl::PointCloud<PointNormal>);
+                extract.setInputCloud (part.getObjectCloud());
+                obj_ind->indices = small_cluster_ind;
+                extract.setIndices (obj_ind);
+                extract.setNegative (false);
+                extract.setKeepOrganized(false);
+                extract.filter(*small_cluster_cloud);
+                *small_cluster_cloud += *target.getObjectCloud();
+                target.setObjectCloud(small_cluster_cloud);
+
+                pcl::PointCloud<PointNormal>::Ptr extracted_cloud(new pcl::PointCloud<PointNormal>);
+                extract.setNegative (true);
+                extract.setKeepOrganized(false);
+                extract.filter(*extracted_cloud);
+                part.setObjectCloud(extracted_cloud);
+
+                if (isObjectPlanar(part.getObjectCloud(), 0.01, 0.9)) {
+                    pcl::PointCloud<PointNormal>::Ptr combined_cloud(new pcl::PointCloud<PointNormal>);
+                    pcl::copyPointCloud(*target.getObjectCloud(), *combined_cloud);
+                    *combined_cloud += *part.getObjectCloud();
+                    target.setObjectCloud(combined_cloud);
+                    part.clearClouds();
+                }
+
+                if (!part.getObjectCloud()->empty())
+                    saveDebugCloud(path + "/after_merging_cleaning"+ std::to_string(part.getID()) + ".pcd", *part.getObjectCloud());
+            }
+            if (!target.getObjectCloud()->empty())
+                saveDebugCloud(path + "/after_merging_cleaning"+ std::to_string(target.getID()) + ".pcd", *target.getObjectCloud());
         }
     }
 
     //remove objects that have an empty cloud now
+    std::vector<int> removed_ids;
+    for (const DetectedObject &o : detected_objects) {
+        if (o.getObjectCloud()->size() == 0)
+            removed_ids.push_back(o.getID());
+    }
     detected_objects.erase(std::remove_if(
                                detected_objects.begin(),
                                detected_objects.end(),
                                [&](DetectedObject const & o) { return o.getObjectCloud()->size() == 0; }
                            ), detected_objects.end());
+    return removed_ids;
 }
 
 
@@ -1188,6 +1343,7 @@ void ChangeDetection::cleanResult(std::vector<DetectedObject> &detected_objects)
 //match extracted objects from one scene to the spatially close part of remaining points from the other scene
 void ChangeDetection::matchAndRemoveObjects (pcl::PointCloud<PointNormal>::Ptr remaining_scene_points, pcl::PointCloud<PointNormal>::Ptr full_object_cloud,
                                              std::vector<PlaneWithObjInd> &extracted_objects) {
+    V4R_TRACE_SCOPE("ChangeDetection::matchAndRemoveObjects");
     for (std::vector<PlaneWithObjInd>::iterator obj_iter = extracted_objects.begin(); obj_iter != extracted_objects.end(); ) {
         //get object as cloud
         pcl::PointCloud<PointNormal>::Ptr object_cloud(new pcl::PointCloud<PointNormal>);
@@ -1228,8 +1384,6 @@ void ChangeDetection::matchAndRemoveObjects (pcl::PointCloud<PointNormal>::Ptr r
             continue;
         }
 
-        pcl::io::savePCDFileBinary("/home/edith/Desktop/object.pcd", *object_cloud);
-        pcl::io::savePCDFileBinary("/home/edith/Desktop/remaining_cloud_crop.pcd", *remaining_cloud_crop);
 
         //ICP alignment
         pcl::PointCloud<PointNormal>::Ptr object_registered(new pcl::PointCloud<PointNormal>());
@@ -1245,12 +1399,11 @@ void ChangeDetection::matchAndRemoveObjects (pcl::PointCloud<PointNormal>::Ptr r
 
 
 
-        pcl::io::savePCDFileBinary("/home/edith/Desktop/object_aligned.pcd", *object_registered);
 
         //check color
         v4r::apps::PPFRecognizerParameter params;
         FitnessScoreStruct fitness_score = ObjectMatching::computeModelFitness(object_registered, remaining_cloud_crop, params);
-        if (fitness_score.object_conf > ppf_params.single_obj_min_fitness_weight_thr_) {
+        if (fitness_score.object_conf > context_.ppfParams().single_obj_min_fitness_weight_thr_) {
             obj_iter = extracted_objects.erase(obj_iter);
         }
         else {
@@ -1277,7 +1430,7 @@ DetectedObject ChangeDetection::fromPlaneIndObjToDetectedObject (pcl::PointCloud
 
     pcl::ModelCoefficients::Ptr plane_coeffs = boost::make_shared<pcl::ModelCoefficients>(*(obj.plane.coeffs));
 
-    DetectedObject det_obj(object_cloud, plane_cloud, plane_coeffs);
+    DetectedObject det_obj(context_.nextObjectID(), object_cloud, plane_cloud, plane_coeffs);
 
     return det_obj;
 }
@@ -1310,6 +1463,20 @@ void ChangeDetection::filterSmallVolumes(std::vector<DetectedObject> &objects, d
 std::vector<PlaneWithObjInd> ChangeDetection::getObjectsFromPlane(pcl::PointCloud<PointNormal>::Ptr input_cloud, Eigen::Vector4f plane_coeffs,
                                                                   pcl::PointCloud<pcl::PointXYZ>::Ptr convex_hull_pts,
                                                                   pcl::PointCloud<PointNormal>::Ptr prev_checked_plane_cloud, std::string res_path) {
+    V4R_TRACE_SCOPE("ChangeDetection::getObjectsFromPlane");
+    //the result depends on the plane points checked before, the points the extraction adds to them are cached as well
+    uint64_t cache_key = 0;
+    if (extraction_cache_) {
+        cache_key = PlaneExtractionCache::objectsKey(*input_cloud, plane_coeffs, *convex_hull_pts, *prev_checked_plane_cloud);
+        std::vector<PlaneWithObjInd> cached_objects;
+        pcl::PointCloud<PointNormal> checked_plane_points;
+        if (extraction_cache_->getObjects(cache_key, cached_objects, checked_plane_points)) {
+            *prev_checked_plane_cloud += checked_plane_points;
+            return cached_objects;
+        }
+    }
+    const size_t nr_prev_checked_points = prev_checked_plane_cloud->size();
+
     ExtractObjectsFromPlanes extract_curr_objects(input_cloud, plane_coeffs, convex_hull_pts,  res_path);
     std::vector<PlaneWithObjInd> objects_merged = extract_curr_objects.computeObjectsOnPlanes(prev_checked_plane_cloud);
 
@@ -1339,8 +1506,16 @@ std::vector<PlaneWithObjInd> ChangeDetection::getObjectsFromPlane(pcl::PointClou
             }
         }
         if (!objects_plane_cloud->empty())
-            pcl::io::savePCDFileBinary(res_path + "/objects_from_plane.pcd", *objects_plane_cloud);
+            saveDebugCloud(res_path + "/objects_from_plane.pcd", *objects_plane_cloud);
+
+    }
 
+    if (extraction_cache_) {
+        pcl::PointCloud<PointNormal> checked_plane_points;
+        checked_plane_points.points.assign(prev_checked_plane_cloud->points.begin() + nr_prev_checked_points, prev_checked_plane_cloud->points.end());
+        checked_plane_points.width = checked_plane_points.points.size();
+        checked_plane_points.height = 1;
+        extraction_cache_->putObjects(cache_key, objects, checked_plane_points);
     }
     return objects;
 }
@@ -1348,6 +1523,7 @@ std::vector<PlaneWithObjInd> ChangeDetection::getObjectsFromPlane(pcl::PointClou
 //use the downsampled object cloud to filter objects with no volume, are planar or do not have enough points
 void ChangeDetection::filterUnwantedObjects(std::vector<DetectedObject> &objects, double volume_thr, int min_obj_size, int max_obj_size,
                                             double plane_dist_thr, double plane_thr, std::string save_path) {
+    V4R_TRACE_SCOPE("ChangeDetection::filterUnwantedObjects");
     std::vector<int> filtered_ind;
     for (size_t i = 0;  i < objects.size(); i++) {
         if (objects[i].state_ == ObjectState::DISPLACED || objects[i].state_ == ObjectState::STATIC)
@@ -1369,6 +1545,7 @@ void ChangeDetection::filterUnwantedObjects(std::vector<DetectedObject> &objects
 //uses the downsampled cloud to increase speed of ICP
 //overwrites the original cloud!! --> upsampling afterwards needed
 void ChangeDetection::performLV(std::vector<DetectedObject> &ref_objects, std::vector<DetectedObject> &curr_objects) {
+    V4R_TRACE_SCOPE("ChangeDetection::performLV");
     std::string LV_path =  output_path_ + "/LV_output/";
     boost::filesystem::create_directories(LV_path);
 
@@ -1471,7 +1648,7 @@ void ChangeDetection::performLV(std::vector<DetectedObject> &ref_objects, std::v
                         extract.setNegative (true);
                         extract.filter (*matched_cloud);
 
-                        DetectedObject obj(matched_cloud, ro_it->plane_cloud_, ro_it->plane_coeffs_, ObjectState::STATIC);
+                        DetectedObject obj(context_.nextObjectID(), matched_cloud, ro_it->plane_cloud_, ro_it->plane_coeffs_, ObjectState::STATIC);
                         ref_obj_static.push_back(obj);
 
                         pcl::PointCloud<PointNormal>::Ptr remaining_cloud(new pcl::PointCloud<PointNormal>);
@@ -1502,7 +1679,7 @@ void ChangeDetection::performLV(std::vector<DetectedObject> &ref_objects, std::v
                         extract.setNegative (true);
                         extract.filter (*matched_cloud);
 
-                        DetectedObject obj(matched_cloud, co_it->plane_cloud_, co_it->plane_coeffs_, ObjectState::STATIC);
+                        DetectedObject obj(context_.nextObjectID(), matched_cloud, co_it->plane_cloud_, co_it->plane_coeffs_, ObjectState::STATIC);
                         curr_obj_static.push_back(obj);
 
                         pcl::PointCloud<PointNormal>::Ptr remaining_cloud(new pcl::PointCloud<PointNormal>);
@@ -1522,8 +1699,8 @@ void ChangeDetection::performLV(std::vector<DetectedObject> &ref_objects, std::v
 
                     std::string LV_match_path = LV_path + "/" + std::to_string(matched_ref.getID()) + "-" + std::to_string(matched_curr.getID());
                     boost::filesystem::create_directories(LV_match_path);
-                    pcl::io::savePCDFileBinary(LV_match_path + "/ref_object.pcd", *matched_ref.getObjectCloud());
-                    pcl::io::savePCDFileBinary(LV_match_path + "/curr_object.pcd", *matched_curr.getObjectCloud());
+                    saveDebugCloud(LV_match_path + "/ref_object.pcd", *matched_ref.getObjectCloud());
+                    saveDebugCloud(LV_match_path + "/curr_object.pcd", *matched_curr.getObjectCloud());
 
                     if (erased_co_elem)
                         break; //we found already an association, check next current element
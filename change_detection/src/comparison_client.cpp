@@ -0,0 +1,95 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <unistd.h>
+
+#include <pcl/console/parse.h>
+#include <pcl/console/print.h>
+
+#include "daemon_protocol.h"
+
+//the daemon has its own working directory, relative paths of the client are resolved before they are sent
+std::string absolutePath(const std::string &path) {
+    if (path.empty())
+        return path;
+    return boost::filesystem::absolute(path).string();
+}
+
+int main(int argc, char* argv[])
+{
+    /// Check arguments and print info
+    if (argc < 3) {
+        pcl::console::print_info("\n\
+                                 -- Submits a room to a running change detection daemon (all_scenes_comparison -s) and prints the results -- : \n\
+                                 \n\
+                                 Syntax: %s socket_path room_path \n\
+                                 [Options] \n\
+                                 -r path, where results should be stored, a folder with date and time gets created there \n\
+                                 -c config path for ppf params \n\
+                                 -v which point clouds are written: 0 none, 1 only results, 2 also intermediate debug clouds (default) \n\
+                                 -m memory-bounded mode for large rooms \n\
+                                 -i path of a persistent object map: every scene is only compared against the map instead of all other scenes \n\
+                                 -R path of the result folder of an interrupted run, which is continued \n\
+                                 \n\
+                                 Stop the daemon: %s socket_path -shutdown",
+                                 argv[0], argv[0]);
+        return(1);
+    }
+
+    std::string socket_path = argv[1];
+    std::vector<char> request;
+    if (pcl::console::find_switch(argc, argv, "-shutdown")) {
+        request = encodeShutdown();
+    } else {
+        ComparisonJob job;
+        job.room_path = absolutePath(argv[2]);
+        pcl::console::parse(argc, argv, "-r", job.result_path);
+        pcl::console::parse(argc, argv, "-c", job.ppf_config_path);
+        pcl::console::parse(argc, argv, "-v", job.artifact_level);
+        pcl::console::parse(argc, argv, "-i", job.map_path);
+        pcl::console::parse(argc, argv, "-R", job.resume_path);
+        job.bounded_memory = pcl::console::find_switch(argc, argv, "-m");
+        job.result_path = absolutePath(job.result_path);
+        job.ppf_config_path = absolutePath(job.ppf_config_path);
+        job.map_path = absolutePath(job.map_path);
+        job.resume_path = absolutePath(job.resume_path);
+        request = encodeJob(job);
+    }
+
+    int fd = connectToUnixSocket(socket_path);
+    if (fd == -1)
+        return -1;
+    if (!sendFrame(fd, request)) {
+        std::cerr << "Could not send the job to " << socket_path << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    //the daemon streams progress and results until the job is done
+    int status = -1;
+    std::vector<char> payload;
+    while (receiveFrame(fd, payload)) {
+        BufferReader reader(payload);
+        const uint32_t type = reader.read<uint32_t>();
+        if (type == DAEMON_PROGRESS) {
+            std::cout << reader.readString() << std::endl;
+        } else if (type == DAEMON_PAIR) {
+            PairResult result;
+            if (!decodePair(reader, result))
+                break;
+            std::cout << result.ref_scene << "-" << result.curr_scene << ": " << result.nr_removed << " removed, " << result.nr_new << " new, "
+                      << result.nr_ref_displaced << "/" << result.nr_curr_displaced << " displaced, "
+                      << result.nr_ref_static << "/" << result.nr_curr_static << " static (" << result.result_path << ")" << std::endl;
+        } else if (type == DAEMON_ERROR) {
+            std::cerr << "Error: " << reader.readString() << std::endl;
+        } else if (type == DAEMON_DONE) {
+            status = reader.read<int32_t>();
+            break;
+        }
+    }
+    close(fd);
+    return status;
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <pcl/console/parse.h>
+#include <pcl/console/print.h>
+
+#include "scene_bundle.h"
+
+//converts a scene in the folder layout (table.txt, log.txt, planes/N/merged_plane_clouds_ds002.pcd) into a scene bundle
+bool convertScene(const std::string &scene_path) {
+    std::map<int, ReconstructedPlane> rec_planes = loadSceneFromFolder(scene_path);
+    if (rec_planes.empty()) {
+        std::cerr << "No planes found in " << scene_path << std::endl;
+        return false;
+    }
+    const std::string bundle_path = scene_path + "/" + scene_bundle_filename;
+    if (!writeSceneBundle(bundle_path, rec_planes))
+        return false;
+
+    //make sure the bundle can be read again before it is used instead of the original files
+    std::map<int, ReconstructedPlane> read_planes;
+    if (!readSceneBundle(bundle_path, read_planes) || read_planes.size() != rec_planes.size()) {
+        std::cerr << "Verifying " << bundle_path << " failed" << std::endl;
+        boost::filesystem::remove(bundle_path);
+        return false;
+    }
+    std::cout << "Wrote " << rec_planes.size() << " planes to " << bundle_path << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    /// Check arguments and print info
+    if (argc < 2) {
+        pcl::console::print_info("\n\
+                                 -- Converts scenes into scene bundles (%s) that are read by all_scenes_comparison -- : \n\
+                                 \n\
+                                 Syntax: %s path \n\
+                                 [Options] \n\
+                                 -s path is a single scene folder instead of a room folder with scene folders",
+                                 scene_bundle_filename.c_str(), argv[0]);
+        return(1);
+    }
+
+    std::string path = argv[1];
+    bool single_scene = pcl::console::find_switch(argc, argv, "-s");
+
+    if (!boost::filesystem::exists(path) || !boost::filesystem::is_directory(path)) {
+        std::cout << path << " does not exist or is not a directory" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> scene_paths;
+    if (single_scene) {
+        scene_paths.push_back(path);
+    } else {
+        //same scene folder selection as in all_scenes_comparison
+        for (boost::filesystem::directory_entry& scene : boost::filesystem::directory_iterator(path)) {
+            if (boost::filesystem::is_directory(scene)) {
+                std::string p = scene.path().string();
+                if (p.find("scene", p.length()-8) !=std::string::npos)
+                    scene_paths.push_back(p);
+            }
+        }
+        std::sort(scene_paths.begin(), scene_paths.end());
+    }
+
+    int nr_failed = 0;
+    for (const std::string &scene_path : scene_paths) {
+        if (!convertScene(scene_path))
+            nr_failed++;
+    }
+    return nr_failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,205 @@
+#include "daemon_protocol.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static bool fillSocketAddress(const std::string &socket_path, sockaddr_un &addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path " << socket_path << " is too long" << std::endl;
+        return false;
+    }
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+int listenOnUnixSocket(const std::string &socket_path) {
+    sockaddr_un addr;
+    if (!fillSocketAddress(socket_path, addr))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        std::cerr << "Could not create socket: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    unlink(socket_path.c_str()); //left over from a daemon that was killed
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(fd, 16) == -1) {
+        std::cerr << "Could not listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    if (chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) == -1) {
+        std::cerr << "Could not restrict the permissions of " << socket_path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        unlink(socket_path.c_str());
+        return -1;
+    }
+    return fd;
+}
+
+int connectToUnixSocket(const std::string &socket_path) {
+    sockaddr_un addr;
+    if (!fillSocketAddress(socket_path, addr))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        std::cerr << "Could not create socket: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+        std::cerr << "Could not connect to " << socket_path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool setReceiveTimeout(int fd, int seconds) {
+    timeval timeout;
+    timeout.tv_sec = seconds;
+    timeout.tv_usec = 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == -1) {
+        std::cerr << "Could not set the receive timeout: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool sendAll(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        //MSG_NOSIGNAL: a client that went away must not kill the daemon with SIGPIPE
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent == -1 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static bool receiveAll(int fd, char *data, size_t size) {
+    while (size > 0) {
+        ssize_t received = recv(fd, data, size, 0);
+        if (received == -1 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            return false;
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool sendFrame(int fd, const std::vector<char> &payload) {
+    std::vector<char> frame;
+    frame.reserve(sizeof(uint32_t) + payload.size());
+    writeValue(frame, static_cast<uint32_t>(payload.size()));
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return sendAll(fd, frame.data(), frame.size());
+}
+
+bool receiveFrame(int fd, std::vector<char> &payload) {
+    uint32_t size;
+    if (!receiveAll(fd, reinterpret_cast<char*>(&size), sizeof(size)))
+        return false;
+    if (size > daemon_max_frame_size) {
+        std::cerr << "Received a frame of " << size << " bytes, the maximum is " << daemon_max_frame_size << std::endl;
+        return false;
+    }
+    payload.resize(size);
+    return receiveAll(fd, payload.data(), size);
+}
+
+static std::vector<char> startMessage(DaemonMessage type) {
+    std::vector<char> payload;
+    writeValue(payload, static_cast<uint32_t>(type));
+    return payload;
+}
+
+std::vector<char> encodeJob(const ComparisonJob &job) {
+    std::vector<char> payload = startMessage(DAEMON_JOB);
+    writeValue(payload, daemon_protocol_version);
+    writeString(payload, job.room_path);
+    writeString(payload, job.result_path);
+    writeString(payload, job.ppf_config_path);
+    writeString(payload, job.map_path);
+    writeString(payload, job.resume_path);
+    writeValue(payload, static_cast<uint8_t>(job.bounded_memory));
+    writeValue(payload, static_cast<int32_t>(job.artifact_level));
+    return payload;
+}
+
+std::vector<char> encodeShutdown() {
+    return startMessage(DAEMON_SHUTDOWN);
+}
+
+std::vector<char> encodeProgress(const std::string &message) {
+    std::vector<char> payload = startMessage(DAEMON_PROGRESS);
+    writeString(payload, message);
+    return payload;
+}
+
+std::vector<char> encodePair(const PairResult &result) {
+    std::vector<char> payload = startMessage(DAEMON_PAIR);
+    writeString(payload, result.ref_scene);
+    writeString(payload, result.curr_scene);
+    writeString(payload, result.result_path);
+    writeValue(payload, result.nr_removed);
+    writeValue(payload, result.nr_new);
+    writeValue(payload, result.nr_ref_displaced);
+    writeValue(payload, result.nr_curr_displaced);
+    writeValue(payload, result.nr_ref_static);
+    writeValue(payload, result.nr_curr_static);
+    return payload;
+}
+
+std::vector<char> encodeError(const std::string &message) {
+    std::vector<char> payload = startMessage(DAEMON_ERROR);
+    writeString(payload, message);
+    return payload;
+}
+
+std::vector<char> encodeDone(int status) {
+    std::vector<char> payload = startMessage(DAEMON_DONE);
+    writeValue(payload, static_cast<int32_t>(status));
+    return payload;
+}
+
+bool decodeJob(BufferReader &reader, ComparisonJob &job) {
+    const uint32_t version = reader.read<uint32_t>();
+    if (reader.ok() && version != daemon_protocol_version) {
+        std::cerr << "Job has protocol version " << version << ", but only version " << daemon_protocol_version << " is supported" << std::endl;
+        return false;
+    }
+    job.room_path = reader.readString();
+    job.result_path = reader.readString();
+    job.ppf_config_path = reader.readString();
+    job.map_path = reader.readString();
+    job.resume_path = reader.readString();
+    job.bounded_memory = reader.read<uint8_t>() != 0;
+    job.artifact_level = reader.read<int32_t>();
+    return reader.ok();
+}
+
+bool decodePair(BufferReader &reader, PairResult &result) {
+    result.ref_scene = reader.readString();
+    result.curr_scene = reader.readString();
+    result.result_path = reader.readString();
+    result.nr_removed = reader.read<uint32_t>();
+    result.nr_new = reader.read<uint32_t>();
+    result.nr_ref_displaced = reader.read<uint32_t>();
+    result.nr_curr_displaced = reader.read<uint32_t>();
+    result.nr_ref_static = reader.read<uint32_t>();
+    result.nr_curr_static = reader.read<uint32_t>();
+    return reader.ok();
+}
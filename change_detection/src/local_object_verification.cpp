@@ -26,10 +26,10 @@ LVResult LocalObjectVerification::computeLV() {
 
 
     std::cout << "Ref cluster has " << ref_object_->size() << " points." << std::endl;
-    pcl::io::savePCDFileBinary(debug_output_path + "/ref_object.pcd", *ref_object_);
+    saveDebugCloud(debug_output_path + "/ref_object.pcd", *ref_object_);
 
     std::cout << "Curr cluster has " << curr_object_->size() << " points." << std::endl;
-    pcl::io::savePCDFileBinary(debug_output_path + "/curr_object.pcd", *curr_object_);
+    saveDebugCloud(debug_output_path + "/curr_object.pcd", *curr_object_);
 
     //use that plane to align the cluster in z-direction
     //    pcl::io::savePCDFileBinary(debug_output_path + "/ref_supp_plane.pcd", *ref_plane_);
@@ -119,11 +119,11 @@ LVResult LocalObjectVerification::computeLV() {
         FitnessScoreStruct fitness_score  = ObjectMatching::computeModelFitness(curr_object_registered, ref_object_noNans, params);
         result.fitness_score = fitness_score;
         float confidence = std::min(fitness_score.object_conf, fitness_score.model_conf);
-        pcl::io::savePCDFileBinary(debug_output_path + "/curr_object_aligned.pcd", *curr_object_registered);
+        saveDebugCloud(debug_output_path + "/curr_object_aligned.pcd", *curr_object_registered);
         std::stringstream stream;
         stream << std::fixed << std::setprecision(2) << confidence;
         std::string conf_str = stream.str();
-        pcl::io::savePCDFileBinary(debug_output_path + "/ref_object_conf_" +conf_str + ".pcd", *ref_object_noNans);
+        saveDebugCloud(debug_output_path + "/ref_object_conf_" +conf_str + ".pcd", *ref_object_noNans);
 
         if (confidence > params_.min_score_thr) {
             //remove points from MODEL object input cloud
@@ -157,8 +157,8 @@ LVResult LocalObjectVerification::computeLV() {
                 extract.setNegative (true);
                 extract.filter(*matched_ref_part);
 
-                pcl::io::savePCDFileBinary(debug_output_path + "/ref_object_partial_match.pcd", *matched_ref_part);
-                pcl::io::savePCDFileBinary(debug_output_path + "/ref_object_diff.pcd", *ref_diff_cloud);
+                saveDebugCloud(debug_output_path + "/ref_object_partial_match.pcd", *matched_ref_part);
+                saveDebugCloud(debug_output_path + "/ref_object_diff.pcd", *ref_diff_cloud);
 
                 //tranform non matchting points back to orig ind
                 std::vector<int> ref_orig_ind;
@@ -196,8 +196,8 @@ LVResult LocalObjectVerification::computeLV() {
                 pcl::transformPointCloudWithNormals(*matched_curr_part, *matched_curr_part, icp.getFinalTransformation().inverse());
                 pcl::transformPointCloudWithNormals(*curr_diff_cloud, *curr_diff_cloud, icp.getFinalTransformation().inverse());
 
-                pcl::io::savePCDFileBinary(debug_output_path + "/curr_object_partial_match.pcd", *matched_curr_part);
-                pcl::io::savePCDFileBinary(debug_output_path + "/curr_object_diff.pcd", *curr_diff_cloud);
+                saveDebugCloud(debug_output_path + "/curr_object_partial_match.pcd", *matched_curr_part);
+                saveDebugCloud(debug_output_path + "/curr_object_diff.pcd", *curr_diff_cloud);
 
                 //transform non matching points back to orig ind
                 std::vector<int> curr_orig_ind;
@@ -0,0 +1,42 @@
+#include "object_cloud_data.h"
+
+#include <pcl/common/centroid.h>
+#include <pcl/filters/filter.h>
+
+#include "broad_phase.h"
+#include "detected_object.h"
+
+ObjectCloudData::ObjectCloudData(const pcl::PointCloud<PointNormal> &cloud) : cloud_(new pcl::PointCloud<PointNormal>) {
+    std::vector<int> nan_ind;
+    pcl::removeNaNFromPointCloud(cloud, *cloud_, nan_ind);
+    cloud_->is_dense = true;
+}
+
+ObjectCloudData::ConstPtr ObjectCloudData::empty() {
+    static const ConstPtr empty_data(new ObjectCloudData(pcl::PointCloud<PointNormal>()));
+    return empty_data;
+}
+
+pcl::PointCloud<PointNormal>::ConstPtr ObjectCloudData::downsampled() const {
+    std::call_once(downsampled_once_, [this]() {
+        downsampled_ = downsampleCloudVG(cloud_, ds_voxel_size);
+        downsampled_->is_dense = true;
+    });
+    return downsampled_;
+}
+
+Eigen::Vector4f ObjectCloudData::centroid() const {
+    std::call_once(centroid_once_, [this]() {
+        Eigen::Vector4f centroid = Eigen::Vector4f::Zero();
+        pcl::compute3DCentroid(*cloud_, centroid);
+        centroid_ = centroid;
+    });
+    return centroid_;
+}
+
+Eigen::AlignedBox3f ObjectCloudData::boundingBox() const {
+    std::call_once(bounding_box_once_, [this]() {
+        bounding_box_ = finiteBoundingBox(*cloud_);
+    });
+    return bounding_box_;
+}
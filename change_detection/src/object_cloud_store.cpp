@@ -0,0 +1,54 @@
+#include "object_cloud_store.h"
+
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+
+#include <pcl/io/pcd_io.h>
+
+void ObjectCloudStore::reset(const std::string &store_dir) {
+    clear();
+    store_dir_ = store_dir;
+}
+
+bool ObjectCloudStore::spill(DetectedObject &obj) {
+    if (isSpilled(obj.getID()))
+        return true;
+    if (store_dir_.empty())
+        return false;
+    boost::filesystem::create_directories(store_dir_);
+
+    //empty clouds can not be written as pcd file, there is nothing to release anyway
+    if (obj.getObjectCloud()->empty())
+        return false;
+    if (pcl::io::savePCDFileBinary(cloudPath(obj.getID()), *obj.getObjectCloud()) != 0) {
+        std::cerr << "Could not spill object " << obj.getID() << " to " << store_dir_ << std::endl;
+        return false;
+    }
+    obj.releaseClouds();
+    spilled_ids_.insert(obj.getID());
+    return true;
+}
+
+bool ObjectCloudStore::restore(DetectedObject &obj) {
+    if (!isSpilled(obj.getID()))
+        return true;
+    pcl::PointCloud<PointNormal>::Ptr cloud(new pcl::PointCloud<PointNormal>);
+    if (pcl::io::loadPCDFile<PointNormal>(cloudPath(obj.getID()), *cloud) == -1) {
+        std::cerr << "Could not restore object " << obj.getID() << " from " << store_dir_ << std::endl;
+        return false;
+    }
+    obj.setObjectCloud(cloud);
+    spilled_ids_.erase(obj.getID());
+    return true;
+}
+
+void ObjectCloudStore::clear() {
+    if (!store_dir_.empty() && boost::filesystem::exists(store_dir_))
+        boost::filesystem::remove_all(store_dir_);
+    spilled_ids_.clear();
+}
+
+std::string ObjectCloudStore::cloudPath(int id) const {
+    return store_dir_ + "/" + std::to_string(id) + ".pcd";
+}
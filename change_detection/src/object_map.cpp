@@ -0,0 +1,268 @@
+#include "object_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include <boost/filesystem.hpp>
+
+#include <pcl/common/centroid.h>
+#include <pcl/common/io.h>
+
+#include "binary_buffer.h"
+
+static const char object_map_magic[4] = {'C', 'D', 'O', 'M'};
+
+//fixed layout of a point in the map, independent of the padding of PointNormal
+struct MapPoint {
+    float x, y, z;
+    float normal_x, normal_y, normal_z;
+    uint32_t rgba;
+    float curvature;
+};
+static_assert(sizeof(MapPoint) == 32, "MapPoint must not be padded");
+
+//smallest entry of an object: id, plane id, state, two empty strings, pose, nr of points
+static const size_t map_object_min_size = 3*4 + 2*4 + 16*4 + 4;
+
+bool ObjectMap::load(const std::string &map_dir) {
+    //a save was interrupted after the old map was moved away, the old map is the last complete state
+    const std::string old_dir = map_dir + ".old";
+    if (!boost::filesystem::exists(map_dir) && boost::filesystem::exists(old_dir)) {
+        std::cout << "Restore the object map " << map_dir << " from " << old_dir << std::endl;
+        boost::filesystem::rename(old_dir, map_dir);
+    }
+
+    const std::string bundle_path = map_dir + "/" + scene_bundle_filename;
+    const std::string objects_path = map_dir + "/" + object_map_filename;
+    if (!boost::filesystem::exists(bundle_path) || !boost::filesystem::exists(objects_path))
+        return false;
+
+    std::map<int, ReconstructedPlane> planes;
+    if (!readSceneBundle(bundle_path, planes))
+        return false;
+
+    std::vector<char> buffer;
+    if (!readFileIntoBuffer(objects_path, buffer)) {
+        std::cerr << "Could not read object map " << objects_path << std::endl;
+        return false;
+    }
+    BufferReader reader(buffer);
+    char magic[4];
+    for (int i = 0; i < 4; i++)
+        magic[i] = reader.read<char>();
+    if (!reader.ok() || std::memcmp(magic, object_map_magic, 4) != 0) {
+        std::cerr << objects_path << " is not an object map" << std::endl;
+        return false;
+    }
+    const uint32_t version = reader.read<uint32_t>();
+    if (version != object_map_version) {
+        std::cerr << "Object map " << objects_path << " has version " << version << ", but only version " << object_map_version << " is supported" << std::endl;
+        return false;
+    }
+    const int last_object_id = reader.read<int32_t>();
+    const int last_plane_id = reader.read<int32_t>();
+
+    std::vector<std::string> scenes;
+    //the counts are checked against the rest of the file before anything is allocated
+    const uint32_t nr_scenes = reader.read<uint32_t>();
+    if (!reader.canRead(static_cast<uint64_t>(nr_scenes) * sizeof(uint32_t))) {
+        std::cerr << "Object map " << objects_path << " is truncated or corrupted, " << nr_scenes << " scenes do not fit into the file" << std::endl;
+        return false;
+    }
+    for (uint32_t s = 0; s < nr_scenes && reader.ok(); s++)
+        scenes.push_back(reader.readString());
+
+    std::map<int, MapObject> objects;
+    const uint32_t nr_objects = reader.read<uint32_t>();
+    if (!reader.canRead(static_cast<uint64_t>(nr_objects) * map_object_min_size)) {
+        std::cerr << "Object map " << objects_path << " is truncated or corrupted, " << nr_objects << " objects do not fit into the file" << std::endl;
+        return false;
+    }
+    for (uint32_t n = 0; n < nr_objects && reader.ok(); n++) {
+        MapObject o;
+        o.id = reader.read<int32_t>();
+        o.plane_id = reader.read<int32_t>();
+        const uint32_t state = reader.read<uint32_t>();
+        if (state > ObjectState::UNKNOWN) {
+            std::cerr << "Object map " << objects_path << " is corrupted, object " << o.id << " has state " << state << std::endl;
+            return false;
+        }
+        o.state = static_cast<ObjectState>(state);
+        o.first_seen_scene = reader.readString();
+        o.last_seen_scene = reader.readString();
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                o.pose(r,c) = reader.read<float>();
+        const uint32_t nr_pts = reader.read<uint32_t>();
+        if (!reader.canRead(static_cast<uint64_t>(nr_pts) * sizeof(MapPoint))) {
+            std::cerr << "Object map " << objects_path << " is truncated" << std::endl;
+            return false;
+        }
+
+        o.cloud.reset(new pcl::PointCloud<PointNormal>);
+        o.cloud->points.resize(nr_pts);
+        for (uint32_t i = 0; i < nr_pts; i++) {
+            const MapPoint mp = reader.read<MapPoint>();
+            PointNormal &pt = o.cloud->points[i];
+            pt.x = mp.x; pt.y = mp.y; pt.z = mp.z;
+            pt.normal_x = mp.normal_x; pt.normal_y = mp.normal_y; pt.normal_z = mp.normal_z;
+            pt.rgba = mp.rgba;
+            pt.curvature = mp.curvature;
+        }
+        o.cloud->width = nr_pts;
+        o.cloud->height = 1;
+        o.cloud->is_dense = true;
+        objects[o.id] = o;
+    }
+    if (!reader.ok() || scenes.empty()) {
+        std::cerr << "Object map " << objects_path << " is truncated" << std::endl;
+        return false;
+    }
+
+    planes_ = planes;
+    objects_ = objects;
+    scenes_ = scenes;
+    last_object_id_ = last_object_id;
+    last_plane_id_ = last_plane_id;
+    return true;
+}
+
+bool ObjectMap::save(const std::string &map_dir) {
+    //the map is written into a new folder that replaces the old one, an interrupted save never leaves a mixed map behind
+    const std::string tmp_dir = map_dir + ".tmp";
+    const std::string old_dir = map_dir + ".old";
+    boost::filesystem::remove_all(tmp_dir);
+    boost::filesystem::create_directories(tmp_dir);
+    const std::string bundle_path = tmp_dir + "/" + scene_bundle_filename;
+    for (auto &p : planes_) {
+        if (!p.second.cloud && !loadPlaneCloud(map_dir, p.first, p.second)) {
+            std::cerr << "Could not read the cloud of plane " << p.first << " from the object map " << map_dir << std::endl;
+            return false;
+        }
+    }
+    if (!writeSceneBundle(bundle_path, planes_))
+        return false;
+
+    std::vector<char> buffer;
+    buffer.insert(buffer.end(), object_map_magic, object_map_magic + 4);
+    writeValue(buffer, object_map_version);
+    writeValue(buffer, static_cast<int32_t>(last_object_id_));
+    writeValue(buffer, static_cast<int32_t>(last_plane_id_));
+
+    writeValue(buffer, static_cast<uint32_t>(scenes_.size()));
+    for (const std::string &scene : scenes_)
+        writeString(buffer, scene);
+
+    writeValue(buffer, static_cast<uint32_t>(objects_.size()));
+    for (auto const &obj : objects_) {
+        const MapObject &o = obj.second;
+        const size_t nr_pts = o.cloud ? o.cloud->size() : 0;
+        writeValue(buffer, static_cast<int32_t>(o.id));
+        writeValue(buffer, static_cast<int32_t>(o.plane_id));
+        writeValue(buffer, static_cast<uint32_t>(o.state));
+        writeString(buffer, o.first_seen_scene);
+        writeString(buffer, o.last_seen_scene);
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                writeValue(buffer, o.pose(r,c));
+        writeValue(buffer, static_cast<uint32_t>(nr_pts));
+
+        buffer.reserve(buffer.size() + nr_pts * sizeof(MapPoint));
+        for (size_t i = 0; i < nr_pts; i++) {
+            const PointNormal &pt = o.cloud->points[i];
+            MapPoint mp = {pt.x, pt.y, pt.z, pt.normal_x, pt.normal_y, pt.normal_z, pt.rgba, pt.curvature};
+            writeValue(buffer, mp);
+        }
+    }
+
+    const std::string objects_path = tmp_dir + "/" + object_map_filename;
+    if (!writeBufferToFile(objects_path, buffer)) {
+        std::cerr << "Could not write " << objects_path << std::endl;
+        return false;
+    }
+
+    if (boost::filesystem::exists(map_dir)) {
+        boost::filesystem::remove_all(old_dir);
+        boost::filesystem::rename(map_dir, old_dir);
+    }
+    boost::filesystem::rename(tmp_dir, map_dir);
+    boost::filesystem::remove_all(old_dir);
+    return true;
+}
+
+void ObjectMap::init(const std::map<int, ReconstructedPlane> &rec_planes, const std::string &scene_name) {
+    planes_ = rec_planes;
+    objects_.clear();
+    scenes_.clear();
+    scenes_.push_back(scene_name);
+    last_object_id_ = 0;
+    last_plane_id_ = planes_.empty() ? 0 : planes_.rbegin()->first;
+}
+
+bool ObjectMap::containsScene(const std::string &scene_name) const {
+    return std::find(scenes_.begin(), scenes_.end(), scene_name) != scenes_.end();
+}
+
+void ObjectMap::updatePlane(int plane_id, const ReconstructedPlane &plane) {
+    planes_[plane_id] = plane;
+    planes_[plane_id].is_checked = false;
+}
+
+int ObjectMap::addPlane(const ReconstructedPlane &plane) {
+    updatePlane(++last_plane_id_, plane);
+    return last_plane_id_;
+}
+
+int ObjectMap::addObject(int plane_id, ObjectState state, pcl::PointCloud<PointNormal>::ConstPtr cloud, const std::string &first_seen_scene,
+                         const std::string &last_seen_scene) {
+    MapObject o;
+    o.id = ++last_object_id_;
+    o.plane_id = plane_id;
+    o.state = state;
+    o.first_seen_scene = first_seen_scene;
+    o.last_seen_scene = last_seen_scene;
+    o.cloud.reset(new pcl::PointCloud<PointNormal>);
+    pcl::copyPointCloud(*cloud, *o.cloud);
+    objects_[o.id] = o;
+    return o.id;
+}
+
+int ObjectMap::findObject(int plane_id, pcl::PointCloud<PointNormal>::ConstPtr cloud) const {
+    if (cloud->empty())
+        return -1;
+    Eigen::Vector4f centroid;
+    pcl::compute3DCentroid(*cloud, centroid);
+
+    int closest_id = -1;
+    float min_dist = map_object_assoc_dist;
+    for (auto const &obj : objects_) {
+        const MapObject &o = obj.second;
+        if ((plane_id != -1 && o.plane_id != plane_id) || !o.isOnPlane() || !o.cloud || o.cloud->empty())
+            continue;
+        Eigen::Vector4f map_centroid;
+        pcl::compute3DCentroid(*o.cloud, map_centroid);
+        float dist = (centroid.head<3>() - map_centroid.head<3>()).norm();
+        if (dist < min_dist) {
+            min_dist = dist;
+            closest_id = o.id;
+        }
+    }
+    return closest_id;
+}
+
+void ObjectMap::observeObject(int id, int plane_id, ObjectState state, pcl::PointCloud<PointNormal>::ConstPtr cloud,
+                              const Eigen::Matrix4f &transform, const std::string &scene_name) {
+    MapObject &o = objects_[id];
+    o.plane_id = plane_id;
+    o.state = state;
+    o.last_seen_scene = scene_name;
+    o.pose = transform * Eigen::Matrix4f(o.pose);
+    o.cloud.reset(new pcl::PointCloud<PointNormal>);
+    pcl::copyPointCloud(*cloud, *o.cloud);
+}
+
+void ObjectMap::removeObject(int id) {
+    objects_[id].state = ObjectState::REMOVED;
+}
@@ -1,24 +1,10 @@
 #include <object_matching.h>
 
-Eigen::Vector3f rgb2lab(const Eigen::Vector3i &rgb) {
-    cv::Mat rgb_cv (1,1, CV_8UC3);  //this has some information loss because Lab values are also just uchar and not float
-    rgb_cv.at<cv::Vec3b>(0,0)[0] = rgb[0];
-    rgb_cv.at<cv::Vec3b>(0,0)[1] = rgb[1];
-    rgb_cv.at<cv::Vec3b>(0,0)[2] = rgb[2];
-    cv::Mat lab_cv;
-    cv::cvtColor(rgb_cv, lab_cv, CV_RGB2Lab);
-
-    Eigen::Vector3f lab; //from opencv lab to orig lab definition
-    lab << lab_cv.at<cv::Vec3b>(0,0)[0] / 2.55f, lab_cv.at<cv::Vec3b>(0,0)[1] - 128.f, lab_cv.at<cv::Vec3b>(0,0)[2] - 128.f;
-    return lab;
-}
-
 ObjectMatching::ObjectMatching(std::vector<DetectedObject> model_vec, std::vector<DetectedObject> object_vec,
-                               std::string model_path, std::string cfg_path, std::string obj_match_dir) {
-    model_vec_ = model_vec;
-    object_vec_ = object_vec;
+                               std::string model_path, PipelineContext &context, std::string obj_match_dir) : context_(context) {
+    model_vec_ = std::move(model_vec);
+    object_vec_ = std::move(object_vec);
     model_path_ = model_path;
-    cfg_path_ = cfg_path;
 
     if (obj_match_dir=="") {
         boost::filesystem::path model_path_orig(model_path_);
@@ -31,40 +17,15 @@ ObjectMatching::ObjectMatching(std::vector<DetectedObject> model_vec, std::vecto
 
 std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_result, std::vector<DetectedObject> &curr_result)
 {
+    V4R_TRACE_SCOPE("ObjectMatching::compute");
 
-    // setup recognizer options
+    // setup recognizer options (the PPF parameters are read once per comparison, see PipelineContext)
     //---------------------------------------------------------------------------
-
-
-    bf::path config_file = bf::path(cfg_path_);
+    const v4r::apps::PPFRecognizerParameter &ppf_params = context_.ppfParams();
 
     int verbosity = 0;
     bool force_retrain = false;  // if true, will retrain object models even if trained data already exists
 
-    po::options_description desc("PPF Object Instance Recognizer\n"
-                                 "==============================\n"
-                                 "     **Allowed options**\n");
-
-    po::variables_map vm;
-
-    ppf_params.init(desc);
-
-    if (v4r::io::existsFile(config_file)) {
-        std::ifstream f(config_file.string());
-        po::parsed_options config_parsed = po::parse_config_file(f, desc);
-        po::store(config_parsed, vm);
-        f.close();
-    } else {
-        std::cerr << config_file.string() << " does not exist!" << std::endl;
-    }
-
-    try {
-        po::notify(vm);
-    } catch (const po::error &e) {
-        std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
-        return {};
-    }
-
     if (verbosity >= 0) {
         FLAGS_v = verbosity;
         std::cout << "Enabling verbose logging." << std::endl;
@@ -76,14 +37,20 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
     std::vector<ObjectHypothesesStruct> global_scene_hypotheses;
 
     /// setup recognizer
-    auto start = std::chrono::high_resolution_clock::now();
-    //omp_set_num_threads(1);
-    rec_.reset(new v4r::apps::PPFRecognizer<pcl::PointXYZRGB>{ppf_params});
-    rec_->setModelsDir(model_path_);
-    rec_->setup(force_retrain);
-    auto stop = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::minutes>(stop-start);
-    std::cout << "Time to train the models " << duration.count() << " minutes" << std::endl;
+    {
+        V4R_TRACE_SCOPE("Setup PPF recognizer");
+        auto start = std::chrono::high_resolution_clock::now();
+        //omp_set_num_threads(1);
+        rec_.reset(new v4r::apps::PPFRecognizer<pcl::PointXYZRGB>{ppf_params});
+        rec_->setModelsDir(model_path_); //only used to cache the trained models
+        rec_->setModelClouds(createModelClouds());
+        rec_->setup(force_retrain);
+        auto stop = std::chrono::high_resolution_clock::now();
+        if (!v4r::trace::isEnabled()) { //otherwise the span is in the trace
+            auto duration = std::chrono::duration_cast<std::chrono::minutes>(stop-start);
+            std::cout << "Time to train the models " << duration.count() << " minutes" << std::endl;
+        }
+    }
 
     // use recognizer
     //---------------------------------------------------------------------------
@@ -109,7 +76,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
 
         //compute distance between object and model
         //float dist = estimateDistance(co_iter->getObjectCloud(), ro_iter->getObjectCloud(), match.transform);
-        float dist = computeMeanPointDistance(co_iter->getObjectCloud(), ro_iter->getObjectCloud());
+        float dist = computeMeanPointDistance(*co_iter, *ro_iter);
         bool is_static = dist < max_dist_for_being_static;
 
         ro_iter->match_ = match;
@@ -142,7 +109,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
     }
 
     std::function<float(FitnessScoreStruct)> avgFitness =
-            [](FitnessScoreStruct s) {
+            [&ppf_params](FitnessScoreStruct s) {
         if (std::min(s.object_conf, s.model_conf) < ppf_params.min_avg_fitness_weight_thr_)
             return 0.0f;
         return (s.object_conf + s.model_conf) / 2;
@@ -210,7 +177,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
                 //the matched part of the model
                 ro_iter->setObjectCloud(matched_model_part);
                 ro_iter->match_ = match;
-                ro_iter->object_folder_path_="";
+                ro_iter->partially_matched_ = true;
 
                 //we add the diff_model_part later to the model_vec because it invalidates the vector
             }
@@ -251,7 +218,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
                 //the matched part of the object
                 co_iter->setObjectCloud(matched_object_part);
                 co_iter->match_ = match;
-                co_iter->object_folder_path_="";
+                co_iter->partially_matched_ = true;
 
                 //we add the diff_object_part later to the object_vec because it invalidates the vector
 
@@ -276,7 +243,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
 
             //model and/or object got split, compute distance with the matched parts
             //float dist = estimateDistance(object_cloud, model_cloud, match.transform);
-            float dist = computeMeanPointDistance(co_iter->getObjectCloud(), ro_iter->getObjectCloud());
+            float dist = computeMeanPointDistance(*co_iter, *ro_iter);
             bool is_static = dist < max_dist_for_being_static;
             ro_iter->state_ =(is_static ? ObjectState::STATIC : ObjectState::DISPLACED);
             co_iter->state_ = (is_static ? ObjectState::STATIC : ObjectState::DISPLACED);
@@ -302,7 +269,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
 
                     pcl::PointCloud<PointNormal>::Ptr ds_cloud = downsampleCloudVG(remaining_cluster_cloud, ds_leaf_size_ppf);
                     if (!isObjectUnwanted(ds_cloud, min_object_volume, min_object_size_ds, std::numeric_limits<int>::max(), 0.01, 0.9)) {
-                        DetectedObject diff_model_part(remaining_cluster_cloud, ro_iter_copy.plane_cloud_, ro_iter_copy.plane_coeffs_, ObjectState::REMOVED, "");
+                        DetectedObject diff_model_part(context_.nextObjectID(), remaining_cluster_cloud, ro_iter_copy.plane_cloud_, ro_iter_copy.plane_coeffs_, ObjectState::REMOVED);
                         model_vec_.push_back(diff_model_part);
                     }
                 }
@@ -328,7 +295,7 @@ std::vector<Match> ObjectMatching::compute(std::vector<DetectedObject> &ref_resu
 
                     pcl::PointCloud<PointNormal>::Ptr ds_cloud = downsampleCloudVG(remaining_cluster_cloud, ds_leaf_size_ppf);
                     if (!isObjectUnwanted(ds_cloud, min_object_volume, min_object_size_ds, std::numeric_limits<int>::max(), 0.01, 0.9)) {
-                        DetectedObject diff_object_part(remaining_cluster_cloud, co_iter_copy.plane_cloud_, co_iter_copy.plane_coeffs_, ObjectState::NEW, "");
+                        DetectedObject diff_object_part(context_.nextObjectID(), remaining_cluster_cloud, co_iter_copy.plane_cloud_, co_iter_copy.plane_coeffs_, ObjectState::NEW);
                         object_vec_.push_back(diff_object_part);
                     }
                 }
@@ -496,13 +463,37 @@ FitnessScoreStruct ObjectMatching::computeModelFitness(pcl::PointCloud<PointNorm
     std::vector<bool> object_overlapping_pts(object->size(), false);
     std::vector<bool> model_overlapping_pts(model->size(), false);
 
+    //the correspondence loop only reads normals and colours
+    PointCloudSoA object_soa, model_soa;
+    object_soa.setNormals(*object);
+    model_soa.setNormals(*model);
+    const bool use_color = !param.hv_.ignore_color_even_if_exists_;
+    //a point has many correspondences, so all colours are converted once in a batch. The colour distances of a model
+    //point to its neighbours are computed together.
+    Eigen::MatrixX3f object_lab, nn_lab;
+    std::vector<Eigen::Vector3f> model_lab;
+    Eigen::VectorXf nn_color_distances;
+    if (use_color) {
+        object_soa.setRGB(*object);
+        model_soa.setRGB(*model);
+        object_lab.resize(object->size(), 3);
+        v4r::convertRGBToLab(object_soa.rgba.data(), object->size(),
+                             object_lab.col(0).data(), object_lab.col(1).data(), object_lab.col(2).data());
+        model_lab.resize(model->size());
+        v4r::convertRGBToLab(model_soa.rgba.data(), model->size(), model_lab.data());
+    }
+
     for (size_t midx = 0; midx < model->size(); midx++) {
         PointNormal query_pt;
         query_pt.getVector4fMap() = model->at(midx).getVector4fMap();
         object_octree->radiusSearch(query_pt, param.hv_.inlier_threshold_xyz_, nn_indices, nn_sqrd_distances);
 
-        const Eigen::Vector4f normal_m4f = model->points[midx].getNormalVector4fMap(); //sometimes the last value is nan
-        const Eigen::Vector3f normal_m = normal_m4f.head<3>();
+        if (use_color && !nn_indices.empty()) {
+            nn_lab.resize(nn_indices.size(), 3);
+            for (size_t k = 0; k < nn_indices.size(); k++)
+                nn_lab.row(k) = object_lab.row(nn_indices[k]);
+            v4r::computeCIEDE2000(model_lab[midx], nn_lab, nn_color_distances); //CIEDE2000 is symmetric
+        }
 
         for (size_t k = 0; k < nn_indices.size(); k++) {
             int sidx = nn_indices[k];
@@ -511,20 +502,14 @@ FitnessScoreStruct ObjectMatching::computeModelFitness(pcl::PointCloud<PointNorm
             object_overlapping_pts[sidx] = true;
 
             v4r::ModelSceneCorrespondence c(sidx, midx);
-            const Eigen::Vector4f normal_s4f = object->points[sidx].getNormalVector4fMap();
-            const Eigen::Vector3f normal_s = normal_s4f.head<3>();
-            c.normals_dotp_ = normal_m.dot(normal_s);
+            c.normals_dotp_ = model_soa.normalDot(midx, object_soa, sidx);
 
             float normal_score = c.normals_dotp_ < param.hv_.inlier_threshold_normals_dotp_ ? 0.0 : c.normals_dotp_;
             //bool normal_score = c.normals_dotp_ > param.hv_.inlier_threshold_normals_dotp_;
             //bool color_score = true;
             float color_score = 1.0;
-            if (!param.hv_.ignore_color_even_if_exists_) {
-                Eigen::Vector3i  m_rgb =  model->points[midx].getRGBVector3i();
-                Eigen::Vector3f color_m = rgb2lab(m_rgb);
-                Eigen::Vector3i  o_rgb =  object->points[sidx].getRGBVector3i();
-                Eigen::Vector3f color_o = rgb2lab(o_rgb);
-                c.color_distance_ = v4r::computeCIEDE2000(color_o, color_m);
+            if (use_color) {
+                c.color_distance_ = nn_color_distances[k];
                 //color_score = c.color_distance_ < param.hv_.inlier_threshold_color_;
                 color_score = c.color_distance_ > param.hv_.inlier_threshold_color_ ? 0.0 :  1-(c.color_distance_ / param.hv_.inlier_threshold_color_);
             }
@@ -620,33 +605,14 @@ float ObjectMatching::estimateDistance(const pcl::PointCloud<PointNormal>::Const
     return sum_eucl_dist/nr_overlapping_pts;
 }
 
-float ObjectMatching::computeMeanPointDistance(pcl::PointCloud<PointNormal>::ConstPtr ref_object, pcl::PointCloud<PointNormal>::ConstPtr curr_obj) {
-    PointNormal ref_p_mean, curr_p_mean;
-    ref_p_mean.x = ref_p_mean.y = ref_p_mean.z = 0.0f;
-    curr_p_mean = ref_p_mean;
-
-    for (size_t i = 0; i < ref_object->size(); i++) {
-        ref_p_mean.x += ref_object->points[i].x;
-        ref_p_mean.y += ref_object->points[i].y;
-        ref_p_mean.z += ref_object->points[i].z;
-    }
-    ref_p_mean.x = ref_p_mean.x/ref_object->size();
-    ref_p_mean.y = ref_p_mean.y/ref_object->size();
-    ref_p_mean.z = ref_p_mean.z/ref_object->size();
-
-    for (size_t i = 0; i < curr_obj->size(); i++) {
-        curr_p_mean.x += curr_obj->points[i].x;
-        curr_p_mean.y += curr_obj->points[i].y;
-        curr_p_mean.z += curr_obj->points[i].z;
-    }
-    curr_p_mean.x = curr_p_mean.x/curr_obj->size();
-    curr_p_mean.y = curr_p_mean.y/curr_obj->size();
-    curr_p_mean.z = curr_p_mean.z/curr_obj->size();
-
-    return pcl::euclideanDistance(ref_p_mean, curr_p_mean);
+//distance between the centroids, computed once per object cloud
+float ObjectMatching::computeMeanPointDistance(const DetectedObject &ref_object, const DetectedObject &curr_obj) {
+    return (ref_object.getCloudData().centroid() - curr_obj.getCloudData().centroid()).head<3>().norm();
 }
 
 void ObjectMatching::saveCloudResults(pcl::PointCloud<PointNormal>::ConstPtr object_cloud, pcl::PointCloud<PointNormal>::ConstPtr model_aligned, std::string path) {
+    if (!debugArtifactsEnabled())
+        return;
 
     //assign the matched model another label for better visualization
     pcl::PointXYZRGBL init_label_point;
@@ -656,7 +622,7 @@ void ObjectMatching::saveCloudResults(pcl::PointCloud<PointNormal>::ConstPtr obj
     pcl::copyPointCloud(*model_aligned, *model_aligned_labeled);
     pcl::copyPointCloud(*object_cloud, *model_object_aligned);
     *model_object_aligned += *model_aligned_labeled;
-    pcl::io::savePCDFileBinary(path +".pcd", *model_object_aligned);
+    saveDebugCloud(path +".pcd", *model_object_aligned);
 }
 
 
@@ -712,9 +678,17 @@ std::vector<pcl::PointIndices> ObjectMatching::clusterOutliersBySize(const pcl::
 
 
 
-std::vector<v4r::ObjectHypothesesGroup> ObjectMatching::callRecognizer(DetectedObject &obj) {
-    double ppf_rec_time_sum = 0.0;
+//the models are handed to the recognizer directly from the models registered in the context
+std::vector<std::pair<std::string, pcl::PointCloud<PointNormal>::ConstPtr> > ObjectMatching::createModelClouds() const {
+    std::vector<std::pair<std::string, pcl::PointCloud<PointNormal>::ConstPtr> > model_clouds;
+    for (const DetectedObject &m : model_vec_) {
+        if (context_.hasModel(m.getID()))
+            model_clouds.emplace_back(std::to_string(m.getID()), context_.modelCloud(m.getID()));
+    }
+    return model_clouds;
+}
 
+std::vector<v4r::ObjectHypothesesGroup> ObjectMatching::callRecognizer(DetectedObject &obj) {
     /// Create separate rgb and normal clouds in both cases to be able to call the recognizer
     pcl::PointCloud<pcl::Normal>::Ptr object_normals(new pcl::PointCloud<pcl::Normal>);
     pcl::PointCloud<PointRGB>::Ptr object_rgb(new pcl::PointCloud<PointRGB>);
@@ -732,7 +706,7 @@ std::vector<v4r::ObjectHypothesesGroup> ObjectMatching::callRecognizer(DetectedO
         //if we haven't tried to match this object with this model
         if (obj.already_checked_model_ids.find(m.getID()) == obj.already_checked_model_ids.end())
         {
-            if (boost::filesystem::exists(m.object_folder_path_)) {
+            if (context_.hasModel(m.getID())) {
                 objects_to_look_for.push_back(std::to_string(m.getID()));
                 obj.already_checked_model_ids.insert(m.getID());
             }
@@ -744,13 +718,14 @@ std::vector<v4r::ObjectHypothesesGroup> ObjectMatching::callRecognizer(DetectedO
     }
 
     //call the recognizer with object normals
+    V4R_TRACE_SCOPE_DYNAMIC("PPF recognition of object " + std::to_string(obj.getID()));
     auto start = std::chrono::high_resolution_clock::now();
     auto hypothesis_groups = rec_->recognize(object_rgb, objects_to_look_for, object_normals);
     auto stop = std::chrono::high_resolution_clock::now();
-    ppf_rec_time_sum += std::chrono::duration_cast<std::chrono::milliseconds>(stop-start).count();
-
-    std::cout << "Time spent to recognize objects with PPF: " << (ppf_rec_time_sum/1000) << " seconds." << std::endl;
-
+    if (!v4r::trace::isEnabled()) { //otherwise the span is in the trace
+        double ppf_rec_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop-start).count();
+        std::cout << "Time spent to recognize objects with PPF: " << (ppf_rec_time/1000) << " seconds." << std::endl;
+    }
     return hypothesis_groups;
 }
 
@@ -779,7 +754,7 @@ std::pair<HypothesesStruct, bool> ObjectMatching::filterRecoHypothesis(DetectedO
         }
 
         //compute confidence based on normals and color between object and model
-        FitnessScoreStruct fitness_score  = computeModelFitness(obj.getObjectCloud(), model_aligned_refined, ppf_params);
+        FitnessScoreStruct fitness_score  = computeModelFitness(obj.getObjectCloud(), model_aligned_refined, context_.ppfParams());
 
         //TODO: only object_conf or only model_conf?
         h->confidence_ = (fitness_score.object_conf + fitness_score.model_conf) / 2;
@@ -837,7 +812,7 @@ std::vector<ObjectHypothesesStruct> ObjectMatching::createHypotheses() {
         boost::filesystem::path model_path_orig(model_path_);
         std::string cloud_matches_dir =  cloud_matches_dir_ + "/object" + std::to_string(object_vec_[i].getID());
         boost::filesystem::create_directories(cloud_matches_dir);
-        pcl::io::savePCDFile(cloud_matches_dir + "/object.pcd", *object_vec_[i].getObjectCloud());
+        saveDebugCloud(cloud_matches_dir + "/object.pcd", *object_vec_[i].getObjectCloud());
 
         // use results
         for (auto& hg : hypothesis_groups) {
@@ -850,7 +825,7 @@ std::vector<ObjectHypothesesStruct> ObjectMatching::createHypotheses() {
 
                 std::string result_cloud_path = cloud_matches_dir + "/conf_" + std::to_string(hypo.first.fitness.object_conf) + "_" +
                         std::to_string(hypo.first.fitness.model_conf) + "_model_" + std::to_string(hypo.first.model_id) + "_" +
-                        (ppf_params.ppf_rec_pipeline_.use_color_ ? "_color" : "");
+                        (context_.ppfParams().ppf_rec_pipeline_.use_color_ ? "_color" : "");
                 saveCloudResults(object_hypotheses.object_cloud, model_aligned, result_cloud_path);
             }
         }
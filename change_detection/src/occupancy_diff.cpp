@@ -0,0 +1,139 @@
+#include "occupancy_diff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "settings.h"
+#include "voxel_index_map.h"
+
+struct OccupiedVoxel {
+    int ix, iy, iz;
+    int nr_points = 0;
+    float r = 0.0f, g = 0.0f, b = 0.0f; //sums while the grid is built, means afterwards
+};
+
+typedef std::unordered_map<uint64_t, OccupiedVoxel> OccupancyGrid;
+
+//indices of the finite points that are more than occupancy_min_height above the plane. The distance is signed, points below the
+//plane (e.g. the frame of a table) are not compared. The map frame has z up, the normal is oriented towards +z like the
+//viewpoint of the object extraction.
+static std::vector<int> pointsAbovePlane(const pcl::PointCloud<PointNormal> &cloud, const Eigen::Vector4f &plane_coeffs) {
+    std::vector<int> indices;
+    const float normal_length = plane_coeffs.head<3>().norm();
+    if (normal_length == 0.0f)
+        return indices;
+    Eigen::Vector4f coeffs = plane_coeffs / normal_length;
+    if (coeffs[2] < 0.0f)
+        coeffs = -coeffs;
+    for (size_t i = 0; i < cloud.points.size(); i++) {
+        const PointNormal &pt = cloud.points[i];
+        if (!std::isfinite(pt.x) || !std::isfinite(pt.y) || !std::isfinite(pt.z))
+            continue;
+        const float dist = coeffs[0] * pt.x + coeffs[1] * pt.y + coeffs[2] * pt.z + coeffs[3];
+        if (dist > occupancy_min_height)
+            indices.push_back(i);
+    }
+    return indices;
+}
+
+static OccupancyGrid buildGrid(const pcl::PointCloud<PointNormal> &cloud, const std::vector<int> &indices, float voxel_size) {
+    OccupancyGrid grid;
+    grid.reserve(indices.size() / 4);
+    const float inv_voxel_size = 1.0f / voxel_size;
+    for (int i : indices) {
+        const PointNormal &pt = cloud.points[i];
+        const int ix = static_cast<int>(std::floor(pt.x * inv_voxel_size));
+        const int iy = static_cast<int>(std::floor(pt.y * inv_voxel_size));
+        const int iz = static_cast<int>(std::floor(pt.z * inv_voxel_size));
+        OccupiedVoxel &v = grid[voxelKey(ix, iy, iz)];
+        v.ix = ix; v.iy = iy; v.iz = iz;
+        v.nr_points++;
+        v.r += pt.r; v.g += pt.g; v.b += pt.b;
+    }
+    for (auto &v : grid) {
+        const float norm = 1.0f / (255.0f * v.second.nr_points);
+        v.second.r *= norm; v.second.g *= norm; v.second.b *= norm;
+    }
+    return grid;
+}
+
+static inline float colorDistance(const OccupiedVoxel &v1, const OccupiedVoxel &v2) {
+    const float dr = v1.r - v2.r, dg = v1.g - v2.g, db = v1.b - v2.b;
+    return std::sqrt(dr*dr + dg*dg + db*db);
+}
+
+//voxels of the grid without a counterpart in the other grid. A voxel occupied in both grids has to have a similar colour,
+//otherwise one of the 26 neighbours has to be occupied in the other grid (small misalignments between the scenes).
+static size_t countUnmatchedVoxels(const OccupancyGrid &grid, const OccupancyGrid &other) {
+    size_t nr_unmatched = 0;
+    for (auto const &voxel : grid) {
+        const OccupiedVoxel &v = voxel.second;
+        auto same_it = other.find(voxel.first);
+        if (same_it != other.end()) {
+            if (colorDistance(v, same_it->second) > occupancy_max_color_dist)
+                nr_unmatched++;
+            continue;
+        }
+        bool has_neighbour = false;
+        for (int dx = -1; dx <= 1 && !has_neighbour; dx++)
+            for (int dy = -1; dy <= 1 && !has_neighbour; dy++)
+                for (int dz = -1; dz <= 1 && !has_neighbour; dz++)
+                    has_neighbour = other.count(voxelKey(v.ix + dx, v.iy + dy, v.iz + dz)) > 0;
+        if (!has_neighbour)
+            nr_unmatched++;
+    }
+    return nr_unmatched;
+}
+
+bool haveSameOccupancy(const pcl::PointCloud<PointNormal> &ref_cloud, const Eigen::Vector4f &ref_plane_coeffs,
+                       const pcl::PointCloud<PointNormal> &curr_cloud, const Eigen::Vector4f &curr_plane_coeffs) {
+    const std::vector<int> ref_indices = pointsAbovePlane(ref_cloud, ref_plane_coeffs);
+    const std::vector<int> curr_indices = pointsAbovePlane(curr_cloud, curr_plane_coeffs);
+    if (ref_indices.empty() && curr_indices.empty())
+        return true;
+    if (ref_indices.empty() || curr_indices.empty())
+        return false;
+
+    for (float voxel_size : occupancy_voxel_sizes) {
+        const OccupancyGrid ref_grid = buildGrid(ref_cloud, ref_indices, voxel_size);
+        const OccupancyGrid curr_grid = buildGrid(curr_cloud, curr_indices, voxel_size);
+        const size_t nr_unmatched = countUnmatchedVoxels(ref_grid, curr_grid) + countUnmatchedVoxels(curr_grid, ref_grid);
+        const size_t nr_occupied = ref_grid.size() + curr_grid.size();
+        const float max_unmatched = std::max(static_cast<float>(occupancy_max_unmatched_voxels), occupancy_max_unmatched_ratio * nr_occupied);
+        if (nr_unmatched > max_unmatched) {
+            std::cout << "Occupancy differs with voxel size " << voxel_size << ": " << nr_unmatched << " of " << nr_occupied << " voxels unmatched" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool areObjectsCovered(const pcl::PointCloud<PointNormal> &cloud, const std::vector<std::vector<int> > &objects,
+                       const pcl::PointCloud<PointNormal> &covering_cloud, float max_dist) {
+    if (objects.empty())
+        return true;
+    PointCloudSoA covering_soa;
+    covering_soa.setXYZ(covering_cloud);
+    RadiusSearchGrid covering_grid;
+    covering_grid.build(covering_soa, max_dist);
+
+    std::vector<int> nn_indices;
+    std::vector<float> nn_sqr_distances;
+    for (size_t o = 0; o < objects.size(); o++) {
+        size_t nr_covered = 0;
+        for (int i : objects[o]) {
+            const PointNormal &pt = cloud.points[i];
+            if (covering_grid.radiusSearch(pt.x, pt.y, pt.z, max_dist, nn_indices, nn_sqr_distances) > 0)
+                nr_covered++;
+        }
+        if (nr_covered < unchanged_min_object_coverage * objects[o].size()) {
+            std::cout << "Object " << o << " is not covered by the other plane: " << nr_covered << " of " << objects[o].size() << " points" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#include "pair_checkpoint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "binary_buffer.h"
+
+static const char pair_checkpoint_magic[4] = {'C', 'D', 'P', 'C'};
+
+static bool hashFile(const std::string &path, uint64_t &size, uint64_t &hash) {
+    std::vector<char> buffer;
+    if (!readFileIntoBuffer(path, buffer))
+        return false;
+    size = buffer.size();
+    hash = fnv_offset_basis;
+    hashBytes(hash, buffer.data(), buffer.size());
+    return true;
+}
+
+bool writePairCheckpoint(const std::string &result_path, const std::string &ref_scene, const std::string &curr_scene) {
+    //sorted, so that the record does not depend on the order of the directory entries
+    std::vector<std::string> file_names;
+    for (boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(result_path)) {
+        const std::string name = entry.path().filename().string();
+        if (boost::filesystem::is_regular_file(entry) && name != pair_checkpoint_filename && entry.path().extension() != ".tmp")
+            file_names.push_back(name);
+    }
+    std::sort(file_names.begin(), file_names.end());
+
+    std::vector<char> buffer;
+    buffer.insert(buffer.end(), pair_checkpoint_magic, pair_checkpoint_magic + 4);
+    writeValue(buffer, pair_checkpoint_version);
+    writeString(buffer, ref_scene);
+    writeString(buffer, curr_scene);
+    writeValue(buffer, static_cast<uint32_t>(file_names.size()));
+    for (const std::string &name : file_names) {
+        uint64_t size, hash;
+        if (!hashFile(result_path + "/" + name, size, hash)) {
+            std::cerr << "Could not read " << result_path << "/" << name << " for the completion record" << std::endl;
+            return false;
+        }
+        writeString(buffer, name);
+        writeValue(buffer, size);
+        writeValue(buffer, hash);
+    }
+
+    const std::string path = result_path + "/" + pair_checkpoint_filename;
+    if (!writeBufferToFileAtomically(path, buffer)) {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool verifyPairCheckpoint(const std::string &result_path, const std::string &ref_scene, const std::string &curr_scene) {
+    const std::string path = result_path + "/" + pair_checkpoint_filename;
+    std::vector<char> buffer;
+    if (!boost::filesystem::exists(path) || !readFileIntoBuffer(path, buffer))
+        return false;
+    BufferReader reader(buffer);
+    char magic[4];
+    for (int i = 0; i < 4; i++)
+        magic[i] = reader.read<char>();
+    if (!reader.ok() || std::memcmp(magic, pair_checkpoint_magic, 4) != 0 || reader.read<uint32_t>() != pair_checkpoint_version)
+        return false;
+    if (reader.readString() != ref_scene || reader.readString() != curr_scene)
+        return false;
+
+    const uint32_t nr_files = reader.read<uint32_t>();
+    for (uint32_t f = 0; f < nr_files && reader.ok(); f++) {
+        const std::string name = reader.readString();
+        const uint64_t recorded_size = reader.read<uint64_t>();
+        const uint64_t recorded_hash = reader.read<uint64_t>();
+        uint64_t size, hash;
+        if (!reader.ok() || !hashFile(result_path + "/" + name, size, hash) || size != recorded_size || hash != recorded_hash) {
+            std::cerr << result_path << "/" << name << " does not match the completion record" << std::endl;
+            return false;
+        }
+    }
+    return reader.ok();
+}
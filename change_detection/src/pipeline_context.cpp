@@ -0,0 +1,40 @@
+#include "pipeline_context.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include <v4r/io/filesystem.h>
+
+namespace po = boost::program_options;
+
+bool PipelineContext::loadPPFParams(const std::string &ppf_config_path) {
+    po::options_description desc("PPF Object Instance Recognizer\n"
+                                 "==============================\n"
+                                 "     **Allowed options**\n");
+    po::variables_map vm;
+
+    v4r::apps::PPFRecognizerParameter params;
+    params.init(desc);
+
+    if (v4r::io::existsFile(ppf_config_path)) {
+        std::ifstream f(ppf_config_path);
+        po::parsed_options config_parsed = po::parse_config_file(f, desc);
+        po::store(config_parsed, vm);
+        f.close();
+    } else {
+        std::cerr << ppf_config_path << " does not exist!" << std::endl;
+    }
+
+    try {
+        po::notify(vm);
+    } catch (const po::error &e) {
+        std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+        return false;
+    }
+
+    ppf_params_ = params;
+    ppf_config_path_ = ppf_config_path;
+    return true;
+}
@@ -0,0 +1,115 @@
+#include "plane_extraction_cache.h"
+
+#include <cstring>
+
+#include <boost/make_shared.hpp>
+
+#include "binary_buffer.h"
+
+template <typename T>
+static inline void hashValue(uint64_t &hash, const T &value) {
+    hashBytes(hash, &value, sizeof(T));
+}
+
+//only the fields are hashed, the padding of the pcl point types is not initialized
+static void hashCloud(uint64_t &hash, const pcl::PointCloud<PointNormal> &cloud) {
+    hashValue(hash, cloud.width);
+    hashValue(hash, cloud.height);
+    hashValue(hash, static_cast<uint64_t>(cloud.points.size()));
+    for (const PointNormal &pt : cloud.points) {
+        const float fields[7] = {pt.x, pt.y, pt.z, pt.normal_x, pt.normal_y, pt.normal_z, pt.curvature};
+        hashBytes(hash, fields, sizeof(fields));
+        hashValue(hash, pt.rgba);
+    }
+}
+
+//the indices and coefficients are shared pointers, the cache must not share them with the pipeline
+static std::vector<PlaneWithObjInd> deepCopy(const std::vector<PlaneWithObjInd> &objects) {
+    std::vector<PlaneWithObjInd> copy = objects;
+    for (PlaneWithObjInd &o : copy) {
+        if (o.plane.plane_ind)
+            o.plane.plane_ind = boost::make_shared<pcl::PointIndices>(*o.plane.plane_ind);
+        if (o.plane.coeffs)
+            o.plane.coeffs = boost::make_shared<pcl::ModelCoefficients>(*o.plane.coeffs);
+    }
+    return copy;
+}
+
+uint64_t PlaneExtractionCache::normalsKey(const pcl::PointCloud<PointNormal> &cloud) {
+    uint64_t hash = fnv_offset_basis;
+    hashCloud(hash, cloud);
+    return hash;
+}
+
+uint64_t PlaneExtractionCache::objectsKey(const pcl::PointCloud<PointNormal> &input_cloud, const Eigen::Vector4f &plane_coeffs,
+                                          const pcl::PointCloud<pcl::PointXYZ> &convex_hull_pts, const pcl::PointCloud<PointNormal> &checked_plane_cloud) {
+    uint64_t hash = fnv_offset_basis;
+    hashCloud(hash, input_cloud);
+    for (int i = 0; i < 4; i++)
+        hashValue(hash, plane_coeffs[i]);
+    hashValue(hash, static_cast<uint64_t>(convex_hull_pts.points.size()));
+    for (const pcl::PointXYZ &pt : convex_hull_pts.points) {
+        hashValue(hash, pt.x);
+        hashValue(hash, pt.y);
+        hashValue(hash, pt.z);
+    }
+    hashCloud(hash, checked_plane_cloud);
+    return hash;
+}
+
+bool PlaneExtractionCache::getRefinedNormals(uint64_t key, pcl::PointCloud<PointNormal> &cloud) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = normals_.find(key);
+    if (it == normals_.end()) {
+        misses_++;
+        return false;
+    }
+    hits_++;
+    cloud = *it->second;
+    return true;
+}
+
+void PlaneExtractionCache::putRefinedNormals(uint64_t key, const pcl::PointCloud<PointNormal> &cloud) {
+    if (!cache_normals_)
+        return;
+    pcl::PointCloud<PointNormal>::Ptr copy(new pcl::PointCloud<PointNormal>(cloud));
+    std::lock_guard<std::mutex> lock(mutex_);
+    normals_[key] = copy;
+}
+
+bool PlaneExtractionCache::getObjects(uint64_t key, std::vector<PlaneWithObjInd> &objects, pcl::PointCloud<PointNormal> &checked_plane_points) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = objects_.find(key);
+    if (it == objects_.end()) {
+        misses_++;
+        return false;
+    }
+    hits_++;
+    objects = deepCopy(it->second.objects);
+    checked_plane_points = it->second.checked_plane_points;
+    return true;
+}
+
+size_t PlaneExtractionCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t PlaneExtractionCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+void PlaneExtractionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    normals_.clear();
+    objects_.clear();
+}
+
+void PlaneExtractionCache::putObjects(uint64_t key, const std::vector<PlaneWithObjInd> &objects, const pcl::PointCloud<PointNormal> &checked_plane_points) {
+    ObjectsEntry entry;
+    entry.objects = deepCopy(objects);
+    entry.checked_plane_points = checked_plane_points;
+    std::lock_guard<std::mutex> lock(mutex_);
+    objects_[key] = entry;
+}
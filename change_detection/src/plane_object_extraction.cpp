@@ -83,7 +83,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
     if (cropped_cloud_for_plane->empty()) {
         return {}; //return empty object
     }
-    pcl::io::savePCDFileBinary(result_path_ + "/cropped_cloud.pcd", *cropped_cloud_for_plane);
+    saveDebugCloud(result_path_ + "/cropped_cloud.pcd", *cropped_cloud_for_plane);
 
     //filter normals
     pcl::PointCloud<PointNormal>::Ptr cropped_cloud_filtered(new pcl::PointCloud<PointNormal>);
@@ -147,11 +147,11 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
                 }
             }
         }
-        pcl::io::savePCDFileBinary(result_path_ + "/previously_used_plane_points.pcd", *checked_plane_points_cloud);
+        saveDebugCloud(result_path_ + "/previously_used_plane_points.pcd", *checked_plane_points_cloud);
     }
 
 
-    pcl::io::savePCDFileBinary(result_path_ + "/potential_plane.pcd", *cropped_cloud_filtered);
+    saveDebugCloud(result_path_ + "/potential_plane.pcd", *cropped_cloud_filtered);
 
     std::cout << "potential plane size  " << cropped_cloud_filtered->size() << std::endl;
     std::vector<int> nan_ind_pot_plane;
@@ -239,7 +239,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
         extract.setNegative (false);
         extract.setKeepOrganized(true);
         extract.filter (*plane_cloud);
-        pcl::io::savePCDFileBinary(result_path_ + "/extracted_plane" + std::to_string(c) + ".pcd", *plane_cloud);
+        saveDebugCloud(result_path_ + "/extracted_plane" + std::to_string(c) + ".pcd", *plane_cloud);
 
         extract.setInputCloud (cropped_cloud);
         extract.setIndices (main_plane.plane_ind);
@@ -248,7 +248,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
         extract.filter (*remaining_cloud);
         if (remaining_cloud->empty())
             continue; //return empty object
-        pcl::io::savePCDFileBinary(result_path_ + "/remaining_points" + std::to_string(c) + ".pcd", *remaining_cloud);
+        saveDebugCloud(result_path_ + "/remaining_points" + std::to_string(c) + ".pcd", *remaining_cloud);
 
 
         //check if the plane is intersecting with the original convex hull of the plane
@@ -272,7 +272,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
             std::cerr << "Not enough points left after filtering the plane for wrong normals (< 30) " << std::endl;
             continue; //return empty object
         }
-        pcl::io::savePCDFileBinary(result_path_ + "/normals_filtered" + std::to_string(c) + ".pcd", *cloud_plane_filtered);
+        saveDebugCloud(result_path_ + "/normals_filtered" + std::to_string(c) + ".pcd", *cloud_plane_filtered);
 
         //the filtered normal cloud can have some spourious points left, therefore we remove very small clusters
         pcl::EuclideanClusterExtraction<PointNormal> ec_normal;
@@ -322,7 +322,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
         main_plane.avg_z = new_z_value/c_ind->indices.size();
         main_plane.plane_ind =filtered_plane_ind;
 
-        pcl::io::savePCDFileBinary(result_path_ + "/normals_filtered_clustered" + std::to_string(c) + ".pcd", *cloud_plane_filtered);
+        saveDebugCloud(result_path_ + "/normals_filtered_clustered" + std::to_string(c) + ".pcd", *cloud_plane_filtered);
 
 
         //compute convex hull
@@ -335,10 +335,10 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
         //chull.setAlpha(50);
         chull.reconstruct (*cloud_hull);
         std::cout << "Convex hull has: " << cloud_hull->points.size () << " data points." << std::endl;
-        pcl::io::savePCDFileBinary(result_path_ + "/convex_hull" + std::to_string(c) + ".pcd", *cloud_hull);
+        saveDebugCloud(result_path_ + "/convex_hull" + std::to_string(c) + ".pcd", *cloud_hull);
 
         shrinkConvexHull(cloud_hull, 0.02);
-        pcl::io::savePCDFileBinary(result_path_ + "/convex_hull_shrinked" + std::to_string(c) + ".pcd", *cloud_hull);
+        saveDebugCloud(result_path_ + "/convex_hull_shrinked" + std::to_string(c) + ".pcd", *cloud_hull);
 
         // segment those points that are in the polygonal prism
         pcl::ExtractPolygonalPrismData<PointNormal> ex_prism;
@@ -357,7 +357,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
             extract.setIndices(object_indices);
             extract.setKeepOrganized(true);
             extract.filter(*objects);
-            pcl::io::savePCDFileBinary(result_path_ + "/objects" + std::to_string(c) + ".pcd", *objects);
+            saveDebugCloud(result_path_ + "/objects" + std::to_string(c) + ".pcd", *objects);
 
             //remove plane points by region growing
             pcl::PointCloud<PointNormal>::Ptr plane_obj_combined (new pcl::PointCloud<PointNormal>(objects->width, objects->height, nan_point));
@@ -379,7 +379,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
             extract.filter(*objects);
             extract.setNegative(false);
             extract.filter(*plane_cloud);
-            pcl::io::savePCDFileBinary(result_path_ + "/objects_wo_plane_pts" + std::to_string(c) + ".pcd", *objects);
+            saveDebugCloud(result_path_ + "/objects_wo_plane_pts" + std::to_string(c) + ".pcd", *objects);
             //remove all_plane_points that are in object_indices
             std::sort(all_plane_points.begin(), all_plane_points.end());
             std::sort(object_indices->indices.begin(), object_indices->indices.end());
@@ -414,7 +414,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
                 extract.setIndices(object_indices);
                 extract.setKeepOrganized(true);
                 extract.filter(*objects);
-                pcl::io::savePCDFileBinary(result_path_ + "/objects_filtered" + std::to_string(c) + ".pcd", *objects);
+                saveDebugCloud(result_path_ + "/objects_filtered" + std::to_string(c) + ".pcd", *objects);
 
                 pcl::PointCloud<PointNormal>::Ptr plane(new pcl::PointCloud<PointNormal>);
                 extract.setInputCloud(orig_cloud_);
@@ -422,7 +422,7 @@ std::vector<PlaneWithObjInd> ExtractObjectsFromPlanes::extractObjectInd(pcl::Poi
                 extract.setIndices(plane_ind);
                 extract.setKeepOrganized(true);
                 extract.filter(*plane);
-                pcl::io::savePCDFileBinary(result_path_ + "/plane" + std::to_string(c) + ".pcd", *plane);
+                saveDebugCloud(result_path_ + "/plane" + std::to_string(c) + ".pcd", *plane);
 
 
                 PlaneStruct supp_plane;
@@ -0,0 +1,178 @@
+#include "result_manifest.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "binary_buffer.h"
+#include "object_state.h"
+
+static const char result_manifest_magic[4] = {'C', 'D', 'R', 'M'};
+
+//fixed layout of a point in the manifest, independent of the padding of the pcl point types
+struct ManifestPoint {
+    float x, y, z;
+    uint32_t rgba;
+};
+static_assert(sizeof(ManifestPoint) == 16, "ManifestPoint must not be padded");
+
+//smallest entries: an empty stage name with its runtime, an object without points (ids, scene, state, label, confidences, transform, nr of points)
+static const size_t manifest_timing_min_size = 4 + 8;
+static const size_t manifest_object_min_size = 5*4 + 2*4 + 16*4 + 4;
+
+bool writeResultManifest(const std::string &path, const ResultManifest &manifest) {
+    std::vector<char> buffer;
+    buffer.insert(buffer.end(), result_manifest_magic, result_manifest_magic + 4);
+    writeValue(buffer, result_manifest_version);
+    writeString(buffer, manifest.ref_scene);
+    writeString(buffer, manifest.curr_scene);
+
+    writeValue(buffer, static_cast<uint32_t>(manifest.timings.size()));
+    for (const ManifestTiming &t : manifest.timings) {
+        writeString(buffer, t.stage);
+        writeValue(buffer, t.runtime_ms);
+    }
+
+    writeValue(buffer, static_cast<uint32_t>(manifest.objects.size()));
+    for (const ManifestObject &o : manifest.objects) {
+        const size_t nr_pts = o.cloud ? o.cloud->size() : 0;
+        writeValue(buffer, static_cast<int32_t>(o.id));
+        writeValue(buffer, static_cast<uint32_t>(o.scene));
+        writeValue(buffer, static_cast<uint32_t>(o.state));
+        writeValue(buffer, static_cast<int32_t>(o.match_id));
+        writeValue(buffer, static_cast<int32_t>(o.label));
+        writeValue(buffer, o.object_conf);
+        writeValue(buffer, o.model_conf);
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                writeValue(buffer, o.transform(r,c));
+        writeValue(buffer, static_cast<uint32_t>(nr_pts));
+
+        buffer.reserve(buffer.size() + nr_pts * sizeof(ManifestPoint));
+        for (size_t i = 0; i < nr_pts; i++) {
+            const pcl::PointXYZRGB &pt = o.cloud->points[i];
+            ManifestPoint mp = {pt.x, pt.y, pt.z, pt.rgba};
+            writeValue(buffer, mp);
+        }
+    }
+
+    if (!writeBufferToFileAtomically(path, buffer)) {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readResultManifest(const std::string &path, ResultManifest &manifest) {
+    std::vector<char> buffer;
+    if (!readFileIntoBuffer(path, buffer)) {
+        std::cerr << "Could not read result manifest " << path << std::endl;
+        return false;
+    }
+
+    BufferReader reader(buffer);
+    char magic[4];
+    for (int i = 0; i < 4; i++)
+        magic[i] = reader.read<char>();
+    if (!reader.ok() || std::memcmp(magic, result_manifest_magic, 4) != 0) {
+        std::cerr << path << " is not a result manifest" << std::endl;
+        return false;
+    }
+    const uint32_t version = reader.read<uint32_t>();
+    if (version != result_manifest_version) {
+        std::cerr << "Result manifest " << path << " has version " << version << ", but only version " << result_manifest_version << " is supported" << std::endl;
+        return false;
+    }
+
+    ResultManifest m;
+    m.ref_scene = reader.readString();
+    m.curr_scene = reader.readString();
+
+    //the counts are checked against the rest of the file before anything is allocated
+    const uint32_t nr_timings = reader.read<uint32_t>();
+    if (!reader.canRead(static_cast<uint64_t>(nr_timings) * manifest_timing_min_size)) {
+        std::cerr << "Result manifest " << path << " is truncated or corrupted, " << nr_timings << " timings do not fit into the file" << std::endl;
+        return false;
+    }
+    for (uint32_t t = 0; t < nr_timings && reader.ok(); t++) {
+        ManifestTiming timing;
+        timing.stage = reader.readString();
+        timing.runtime_ms = reader.read<double>();
+        m.timings.push_back(timing);
+    }
+
+    const uint32_t nr_objects = reader.read<uint32_t>();
+    if (!reader.canRead(static_cast<uint64_t>(nr_objects) * manifest_object_min_size)) {
+        std::cerr << "Result manifest " << path << " is truncated or corrupted, " << nr_objects << " objects do not fit into the file" << std::endl;
+        return false;
+    }
+    for (uint32_t n = 0; n < nr_objects && reader.ok(); n++) {
+        ManifestObject o;
+        o.id = reader.read<int32_t>();
+        o.scene = static_cast<ManifestScene>(reader.read<uint32_t>());
+        o.state = static_cast<int>(reader.read<uint32_t>());
+        o.match_id = reader.read<int32_t>();
+        o.label = reader.read<int32_t>();
+        o.object_conf = reader.read<float>();
+        o.model_conf = reader.read<float>();
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                o.transform(r,c) = reader.read<float>();
+        const uint32_t nr_pts = reader.read<uint32_t>();
+        if (!reader.canRead(static_cast<uint64_t>(nr_pts) * sizeof(ManifestPoint))) {
+            std::cerr << "Result manifest " << path << " is truncated" << std::endl;
+            return false;
+        }
+
+        o.cloud.reset(new pcl::PointCloud<pcl::PointXYZRGB>);
+        o.cloud->points.resize(nr_pts);
+        for (uint32_t i = 0; i < nr_pts; i++) {
+            const ManifestPoint mp = reader.read<ManifestPoint>();
+            pcl::PointXYZRGB &pt = o.cloud->points[i];
+            pt.x = mp.x; pt.y = mp.y; pt.z = mp.z;
+            pt.rgba = mp.rgba;
+        }
+        o.cloud->width = nr_pts;
+        o.cloud->height = 1;
+        o.cloud->is_dense = true;
+        m.objects.push_back(o);
+    }
+    if (!reader.ok()) {
+        std::cerr << "Result manifest " << path << " is truncated" << std::endl;
+        return false;
+    }
+
+    manifest = m;
+    return true;
+}
+
+//collects all object points of one scene and state with their label
+static pcl::PointCloud<pcl::PointXYZRGBL>::Ptr extractObjectCloud(const ResultManifest &manifest, ManifestScene scene, ObjectState state) {
+    pcl::PointCloud<pcl::PointXYZRGBL>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZRGBL>);
+    for (const ManifestObject &o : manifest.objects) {
+        if (o.scene != scene || o.state != state || !o.cloud)
+            continue;
+        cloud->points.reserve(cloud->points.size() + o.cloud->size());
+        for (const pcl::PointXYZRGB &pt : o.cloud->points) {
+            pcl::PointXYZRGBL p;
+            p.x = pt.x; p.y = pt.y; p.z = pt.z;
+            p.rgba = pt.rgba;
+            p.label = o.label;
+            cloud->points.push_back(p);
+        }
+    }
+    cloud->width = cloud->points.size();
+    cloud->height = 1;
+    cloud->is_dense = true;
+    return cloud;
+}
+
+ManifestResultClouds extractResultClouds(const ResultManifest &manifest) {
+    ManifestResultClouds clouds;
+    clouds.ref_removed = extractObjectCloud(manifest, MANIFEST_REFERENCE, ObjectState::REMOVED);
+    clouds.ref_displaced = extractObjectCloud(manifest, MANIFEST_REFERENCE, ObjectState::DISPLACED);
+    clouds.ref_static = extractObjectCloud(manifest, MANIFEST_REFERENCE, ObjectState::STATIC);
+    clouds.curr_new = extractObjectCloud(manifest, MANIFEST_CURRENT, ObjectState::NEW);
+    clouds.curr_displaced = extractObjectCloud(manifest, MANIFEST_CURRENT, ObjectState::DISPLACED);
+    clouds.curr_static = extractObjectCloud(manifest, MANIFEST_CURRENT, ObjectState::STATIC);
+    return clouds;
+}
@@ -0,0 +1,448 @@
+#include "scene_bundle.h"
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <pcl/common/transforms.h>
+#include <pcl/io/pcd_io.h>
+
+#include "binary_buffer.h"
+
+static const char scene_bundle_magic[4] = {'C', 'D', 'S', 'B'};
+
+//map of map because for one plane several occurrences are possible
+static std::map<int, std::map<int, Matrix4f_NotAligned>> transformationParser(std::string path) {
+    std::map<int, std::map<int, Matrix4f_NotAligned>> transformation_map;
+    std::ifstream file(path);
+    if (!file.good()) {
+        std::cerr << "File " << path << "does not exist << std::endl";
+        return transformation_map;
+    }
+    std::string str;
+    //Table 1, start at 1567875713.42, occurance 0. Transform:
+    while (std::getline(file, str)) {
+        if (str.rfind("Table",0) == 0) {
+            std::vector<std::string> row_split_result;
+            boost::split(row_split_result, str, boost::is_any_of(",")); //split the first row
+            std::vector<std::string> split_result;
+            boost::split(split_result, row_split_result[0], boost::is_any_of(" ")); //split "Table 1"
+            int table_nr = std::stoi(split_result[1]);
+            boost::split(split_result, row_split_result[2], boost::is_any_of(" ")); //split " occurance 1. Transform"
+            split_result[2].pop_back();
+            int occurrance = std::stoi(split_result[2]);
+
+            //now extract the transformation matrix
+            Matrix4f_NotAligned mat;
+            std::getline(file, str);
+            boost::split(split_result, str, boost::is_any_of("[[ ]"), boost::token_compress_on);
+            mat(0,0) = std::stof(split_result[2]);
+            mat(0,1) = std::stof(split_result[3]);
+            mat(0,2) = std::stof(split_result[4]);
+            mat(0,3) = std::stof(split_result[5]);
+
+            std::getline(file, str);
+            str = str.substr(2, str.size() - 3); //remove the first 2 chars and the last one
+            boost::trim(str);
+            std::vector<std::string> transf_split_result;
+            boost::split(transf_split_result, str, boost::is_any_of(" "), boost::token_compress_on);
+            mat(1,0) = std::stof(transf_split_result[0]);
+            mat(1,1) = std::stof(transf_split_result[1]);
+            mat(1,2) = std::stof(transf_split_result[2]);
+            mat(1,3) = std::stof(transf_split_result[3]);
+
+            std::getline(file, str);
+            str = str.substr(2, str.size() - 3); //remove the first 2 chars and the last one
+            boost::trim(str);
+            boost::split(transf_split_result, str, boost::is_any_of(" "), boost::token_compress_on);
+            mat(2,0) = std::stof(transf_split_result[0]);
+            mat(2,1) = std::stof(transf_split_result[1]);
+            mat(2,2) = std::stof(transf_split_result[2]);
+            mat(2,3) = std::stof(transf_split_result[3]);
+
+            std::getline(file, str);
+            str = str.substr(2, str.size() - 4); //remove the first 2 chars and the last two
+            boost::trim(str);
+            boost::split(transf_split_result, str, boost::is_any_of(" "), boost::token_compress_on);
+            mat(3,0) = std::stof(transf_split_result[0]);
+            mat(3,1) = std::stof(transf_split_result[1]);
+            mat(3,2) = std::stof(transf_split_result[2]);
+            mat(3,3) = std::stof(transf_split_result[3]);
+
+            //transformation_map[table_nr].insert(std::make_pair(occurrance, mat.inverse())); //from camera frame to map frame
+            transformation_map[table_nr].insert(std::make_pair(occurrance, Eigen::Matrix4f::Identity()));
+        }
+    }
+    return transformation_map;
+}
+
+static std::map<int, ReconstructedPlane> convexHullPtsParser(std::string path) {
+    std::map<int, ReconstructedPlane> rec_planes;
+    std::ifstream file(path);
+    if (!file.good()) {
+        std::cerr << "File " << path << "does not exist << std::endl";
+        return rec_planes;
+    }
+    std::string str;
+    int plane_cnt = 0;
+    while (std::getline(file, str)) {
+        if (str.rfind("center",0) == 0) {
+            std::getline(file, str);
+            Point3D point;
+            std::vector<std::string> split_str;
+            boost::split(split_str, str, boost::is_any_of(":"));
+            point.x = std::stof(split_str[1]);
+
+            std::getline(file, str);
+            boost::split(split_str, str, boost::is_any_of(":"));
+            point.y = std::stof(split_str[1]);
+
+            std::getline(file, str);
+            boost::split(split_str, str, boost::is_any_of(":"));
+            point.z = std::stof(split_str[1]);
+
+            rec_planes[plane_cnt].center_point = point;
+            continue;
+        }
+        if (str.rfind("points",0) != 0) {
+            continue;
+        }
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>());
+        while (std::getline(file, str) && str.rfind("plane", 0) != 0) {
+            boost::trim(str);
+            if (str.rfind("x",0) == 0) {
+                pcl::PointXYZ point;
+                std::vector<std::string> split_str;
+                boost::split(split_str, str, boost::is_any_of(":"));
+                point.x = std::stof(split_str[1]);
+
+                std::getline(file, str);
+                boost::split(split_str, str, boost::is_any_of(":"));
+                point.y = std::stof(split_str[1]);
+
+                std::getline(file, str);
+                boost::split(split_str, str, boost::is_any_of(":"));
+                point.z = std::stof(split_str[1]);
+
+                cloud->points.push_back(point);
+            }
+        }
+        cloud->height=1;
+        cloud->width=cloud->points.size();
+        rec_planes[plane_cnt].convex_hull_cloud = cloud;
+
+        //now it is time to parse plane:
+        std::getline(file, str);
+        Vector4f_NotAligned plane_coeffs;
+        std::vector<std::string> split_str;
+        boost::split(split_str, str, boost::is_any_of(":"));
+        plane_coeffs[0] = std::stof(split_str[1]); //x
+
+        std::getline(file, str);
+        boost::split(split_str, str, boost::is_any_of(":"));
+        plane_coeffs[1] = std::stof(split_str[1]); //y
+
+        std::getline(file, str);
+        boost::split(split_str, str, boost::is_any_of(":"));
+        plane_coeffs[2] = std::stof(split_str[1]); //z
+
+        std::getline(file, str);
+        boost::split(split_str, str, boost::is_any_of(":"));
+        plane_coeffs[3] = std::stof(split_str[1]); //d
+
+        rec_planes[plane_cnt].plane_coeffs = plane_coeffs;
+
+        plane_cnt += 1;
+    }
+    return rec_planes;
+}
+
+static std::string planeCloudPath(const std::string &data_path, int plane_id) {
+    return data_path + "/planes/" + std::to_string(plane_id) + "/merged_plane_clouds_ds002.pcd";
+}
+
+std::map<int, ReconstructedPlane> loadSceneFromFolder(const std::string &data_path, bool load_clouds) {
+    std::map<int, ReconstructedPlane> rec_planes;
+    if(!boost::filesystem::exists(data_path) && !boost::filesystem::is_directory(data_path) ) {
+        std::cerr << "The data path does not exist or is not a directory " << data_path << std::endl;
+        return rec_planes;
+    }
+
+    //TODO Read plane coeffs and convex hull points from DB
+    std::map<int, ReconstructedPlane> center_and_convexHull= convexHullPtsParser(data_path + "/table.txt");
+    std::map<int, std::map<int, Matrix4f_NotAligned>> transformations = transformationParser(data_path + "/log.txt");
+
+    //iterate through all plane folders and extract the reconstructed ply-files
+    int plane_nr = 0;
+    bool found_plane_folder = true;
+    while (found_plane_folder) {
+        std::string plane_nr_path = data_path + "/planes/" + std::to_string(plane_nr);
+        if (boost::filesystem::exists(plane_nr_path) && boost::filesystem::is_directory(plane_nr_path)) {
+            const std::string cloud_path = planeCloudPath(data_path, plane_nr);
+            Matrix4f_NotAligned & mat = transformations[plane_nr][0];
+            ReconstructedPlane rec_plane;
+            if (load_clouds) {
+                pcl::PointCloud<PointNormal>::Ptr plane_cloud(new pcl::PointCloud<PointNormal>);
+                if (pcl::io::loadPCDFile<PointNormal> (cloud_path, *plane_cloud) == -1) {
+                    std::cerr << "Couldn't read file " << cloud_path << std::endl;
+                    plane_nr++;
+                    continue;
+                }
+                //transform the ply
+                pcl::transformPointCloudWithNormals(*plane_cloud, *plane_cloud, mat);
+                rec_plane.cloud = plane_cloud;
+                rec_plane.nr_points = plane_cloud->size();
+            } else {
+                //only the header is read, the cloud is loaded later with loadPlaneCloud
+                pcl::PCLPointCloud2 cloud_header;
+                pcl::PCDReader reader;
+                if (reader.readHeader(cloud_path, cloud_header) < 0) {
+                    std::cerr << "Couldn't read file " << cloud_path << std::endl;
+                    plane_nr++;
+                    continue;
+                }
+                rec_plane.nr_points = static_cast<size_t>(cloud_header.width) * cloud_header.height;
+            }
+
+            //save in vector of planeStructs
+            rec_plane.transform = mat;
+            rec_plane.is_checked = false;
+            rec_planes[plane_nr] = rec_plane;
+            plane_nr++;
+        } else {
+            found_plane_folder = false;
+        }
+    }
+
+    //merge center point and convex hull points with loaded point cloud
+    for (std::map<int, ReconstructedPlane>::iterator it = center_and_convexHull.begin(); it != center_and_convexHull.end(); it++) {
+        std::map<int, ReconstructedPlane>::iterator plane_it = rec_planes.find(it->first);
+        if (plane_it == rec_planes.end())
+            continue;
+        plane_it->second.center_point = it->second.center_point;
+        plane_it->second.convex_hull_cloud = it->second.convex_hull_cloud;
+        plane_it->second.plane_coeffs = it->second.plane_coeffs;
+    }
+    return rec_planes;
+}
+
+
+//fixed layout of a point in the bundle, independent of the padding of PointNormal
+struct BundlePoint {
+    float x, y, z;
+    float normal_x, normal_y, normal_z;
+    uint32_t rgba;
+    float curvature;
+};
+static_assert(sizeof(BundlePoint) == 32, "BundlePoint must not be padded");
+
+bool writeSceneBundle(const std::string &path, const std::map<int, ReconstructedPlane> &rec_planes) {
+    //assemble the whole file in memory so that it is written with a single call
+    std::vector<char> buffer;
+    buffer.insert(buffer.end(), scene_bundle_magic, scene_bundle_magic + 4);
+    writeValue(buffer, scene_bundle_version);
+    writeValue(buffer, static_cast<uint32_t>(rec_planes.size()));
+
+    for (auto const &p : rec_planes) {
+        const ReconstructedPlane &plane = p.second;
+        const size_t nr_hull_pts = plane.convex_hull_cloud ? plane.convex_hull_cloud->size() : 0;
+        const size_t nr_cloud_pts = plane.cloud ? plane.cloud->size() : 0;
+        //unorganized clouds are stored with height 1
+        const uint32_t height = (plane.cloud && plane.cloud->height > 0 && plane.cloud->width * plane.cloud->height == nr_cloud_pts) ? plane.cloud->height : 1;
+
+        writeValue(buffer, static_cast<int32_t>(p.first));
+        writeValue(buffer, plane.center_point.x);
+        writeValue(buffer, plane.center_point.y);
+        writeValue(buffer, plane.center_point.z);
+        for (int i = 0; i < 4; i++)
+            writeValue(buffer, plane.plane_coeffs[i]);
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                writeValue(buffer, plane.transform(r,c));
+        writeValue(buffer, static_cast<uint32_t>(nr_hull_pts));
+        writeValue(buffer, static_cast<uint32_t>(nr_cloud_pts / height));
+        writeValue(buffer, height);
+
+        buffer.reserve(buffer.size() + nr_hull_pts * 3 * sizeof(float) + nr_cloud_pts * sizeof(BundlePoint));
+        for (size_t i = 0; i < nr_hull_pts; i++) {
+            const pcl::PointXYZ &pt = plane.convex_hull_cloud->points[i];
+            writeValue(buffer, pt.x);
+            writeValue(buffer, pt.y);
+            writeValue(buffer, pt.z);
+        }
+        for (size_t i = 0; i < nr_cloud_pts; i++) {
+            const PointNormal &pt = plane.cloud->points[i];
+            BundlePoint bp = {pt.x, pt.y, pt.z, pt.normal_x, pt.normal_y, pt.normal_z, pt.rgba, pt.curvature};
+            writeValue(buffer, bp);
+        }
+    }
+
+    if (!writeBufferToFile(path, buffer)) {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//size of the fixed part of a plane entry: id, center, coeffs, transform, nr of hull points, width, height
+static const size_t bundle_plane_header_size = 4 + 3*4 + 4*4 + 16*4 + 3*4;
+
+//reads the planes of a bundle one after the other. The cloud of a plane is only read if load_cloud(plane id) is true,
+//otherwise it is skipped in the file and only its size is stored in nr_points.
+static bool readSceneBundlePlanes(const std::string &path, std::map<int, ReconstructedPlane> &rec_planes,
+                                  const std::function<bool(int)> &load_cloud) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        std::cerr << "Could not read scene bundle " << path << std::endl;
+        return false;
+    }
+
+    //the counts in the file are checked against the bytes left in it before anything is allocated, a corrupted count must
+    //not allocate gigabytes
+    file.seekg(0, std::ios::end);
+    const std::streamoff file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    auto fits = [&file, file_size](uint64_t count, size_t element_size) {
+        const std::streamoff pos = file.tellg();
+        return pos >= 0 && count <= static_cast<uint64_t>(file_size - pos) / element_size;
+    };
+
+    std::vector<char> buffer(4 + 2 * sizeof(uint32_t));
+    file.read(buffer.data(), buffer.size());
+    BufferReader header_reader(buffer);
+    char magic[4];
+    for (int i = 0; i < 4; i++)
+        magic[i] = header_reader.read<char>();
+    if (!file || std::memcmp(magic, scene_bundle_magic, 4) != 0) {
+        std::cerr << path << " is not a scene bundle" << std::endl;
+        return false;
+    }
+    const uint32_t version = header_reader.read<uint32_t>();
+    if (version != scene_bundle_version) {
+        std::cerr << "Scene bundle " << path << " has version " << version << ", but only version " << scene_bundle_version << " is supported" << std::endl;
+        return false;
+    }
+    const uint32_t nr_planes = header_reader.read<uint32_t>();
+    if (!fits(nr_planes, bundle_plane_header_size)) {
+        std::cerr << "Scene bundle " << path << " is truncated or corrupted, " << nr_planes << " planes do not fit into the file" << std::endl;
+        return false;
+    }
+
+    std::map<int, ReconstructedPlane> planes;
+    for (uint32_t p = 0; p < nr_planes; p++) {
+        buffer.resize(bundle_plane_header_size);
+        if (!file.read(buffer.data(), buffer.size())) {
+            std::cerr << "Scene bundle " << path << " is truncated" << std::endl;
+            return false;
+        }
+        BufferReader reader(buffer);
+        ReconstructedPlane plane;
+        const int plane_id = reader.read<int32_t>();
+        plane.center_point.x = reader.read<float>();
+        plane.center_point.y = reader.read<float>();
+        plane.center_point.z = reader.read<float>();
+        for (int i = 0; i < 4; i++)
+            plane.plane_coeffs[i] = reader.read<float>();
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                plane.transform(r,c) = reader.read<float>();
+        const uint32_t nr_hull_pts = reader.read<uint32_t>();
+        const uint32_t width = reader.read<uint32_t>();
+        const uint32_t height = reader.read<uint32_t>();
+        const uint64_t nr_cloud_pts = static_cast<uint64_t>(width) * height;
+        if (!fits(nr_hull_pts, 3 * sizeof(float)) || !fits(nr_cloud_pts, sizeof(BundlePoint))) {
+            std::cerr << "Scene bundle " << path << " is truncated or corrupted, the points of plane " << plane_id << " do not fit into the file" << std::endl;
+            return false;
+        }
+
+        buffer.resize(nr_hull_pts * 3 * sizeof(float));
+        if (!file.read(buffer.data(), buffer.size())) {
+            std::cerr << "Scene bundle " << path << " is truncated" << std::endl;
+            return false;
+        }
+        BufferReader hull_reader(buffer);
+        plane.convex_hull_cloud.reset(new pcl::PointCloud<pcl::PointXYZ>);
+        plane.convex_hull_cloud->points.resize(nr_hull_pts);
+        for (uint32_t i = 0; i < nr_hull_pts; i++) {
+            pcl::PointXYZ &pt = plane.convex_hull_cloud->points[i];
+            pt.x = hull_reader.read<float>();
+            pt.y = hull_reader.read<float>();
+            pt.z = hull_reader.read<float>();
+        }
+        plane.convex_hull_cloud->width = nr_hull_pts;
+        plane.convex_hull_cloud->height = 1;
+
+        plane.nr_points = nr_cloud_pts;
+        if (load_cloud(plane_id)) {
+            buffer.resize(nr_cloud_pts * sizeof(BundlePoint));
+            if (!file.read(buffer.data(), buffer.size())) {
+                std::cerr << "Scene bundle " << path << " is truncated" << std::endl;
+                return false;
+            }
+            BufferReader cloud_reader(buffer);
+            plane.cloud.reset(new pcl::PointCloud<PointNormal>);
+            plane.cloud->points.resize(nr_cloud_pts);
+            for (size_t i = 0; i < nr_cloud_pts; i++) {
+                const BundlePoint bp = cloud_reader.read<BundlePoint>();
+                PointNormal &pt = plane.cloud->points[i];
+                pt.x = bp.x; pt.y = bp.y; pt.z = bp.z;
+                pt.normal_x = bp.normal_x; pt.normal_y = bp.normal_y; pt.normal_z = bp.normal_z;
+                pt.rgba = bp.rgba;
+                pt.curvature = bp.curvature;
+            }
+            plane.cloud->width = width;
+            plane.cloud->height = height;
+            plane.cloud->is_dense = false;
+        } else {
+            file.seekg(nr_cloud_pts * sizeof(BundlePoint), std::ios::cur);
+        }
+
+        plane.is_checked = false;
+        planes[plane_id] = plane;
+    }
+    if (!file) {
+        std::cerr << "Scene bundle " << path << " is truncated" << std::endl;
+        return false;
+    }
+
+    rec_planes = planes;
+    return true;
+}
+
+bool readSceneBundle(const std::string &path, std::map<int, ReconstructedPlane> &rec_planes, bool load_clouds) {
+    return readSceneBundlePlanes(path, rec_planes, [load_clouds](int) { return load_clouds; });
+}
+
+std::map<int, ReconstructedPlane> loadScene(const std::string &data_path, bool load_clouds) {
+    const std::string bundle_path = data_path + "/" + scene_bundle_filename;
+    std::map<int, ReconstructedPlane> rec_planes;
+    if (boost::filesystem::exists(bundle_path) && readSceneBundle(bundle_path, rec_planes, load_clouds))
+        return rec_planes;
+    return loadSceneFromFolder(data_path, load_clouds);
+}
+
+bool loadPlaneCloud(const std::string &data_path, int plane_id, ReconstructedPlane &plane) {
+    const std::string bundle_path = data_path + "/" + scene_bundle_filename;
+    if (boost::filesystem::exists(bundle_path)) {
+        std::map<int, ReconstructedPlane> planes;
+        if (readSceneBundlePlanes(bundle_path, planes, [plane_id](int id) { return id == plane_id; }) && planes.count(plane_id)) {
+            plane.cloud = planes[plane_id].cloud;
+            return true;
+        }
+    }
+
+    pcl::PointCloud<PointNormal>::Ptr plane_cloud(new pcl::PointCloud<PointNormal>);
+    const std::string cloud_path = planeCloudPath(data_path, plane_id);
+    if (pcl::io::loadPCDFile<PointNormal> (cloud_path, *plane_cloud) == -1) {
+        std::cerr << "Couldn't read file " << cloud_path << std::endl;
+        return false;
+    }
+    pcl::transformPointCloudWithNormals(*plane_cloud, *plane_cloud, plane.transform);
+    plane.cloud = plane_cloud;
+    return true;
+}
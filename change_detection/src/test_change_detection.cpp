@@ -64,7 +64,7 @@ std::string ppf_model_path;
 std::string result_path;
 
 
-std::vector<DetectedObject> fromMapToValVec(std::map<int, DetectedObject> map) {
+std::vector<DetectedObject> fromMapToValVec(const std::map<int, DetectedObject> &map) {
     //transform map into vec to be able to call object matching
     std::vector<DetectedObject> vec;
     vec.reserve(map.size());
@@ -114,62 +114,37 @@ bool readInput(std::string input_path, const pcl::PointCloud<PointNormal>::Ptr &
     }
 }
 
-void createNewModelFolder(DetectedObject &ro, std::string ppf_model_path, std::string result_path) {
-    std::string orig_path = ppf_model_path + "/" + std::to_string(ro.getID());
-    ro.object_folder_path_ = orig_path;
-
-    boost::filesystem::create_directories(orig_path);
-    pcl::io::savePCDFile(orig_path + "/3D_model.pcd", *ro.getObjectCloud()); //PPF will create a new model with the new cloud
+//the model was matched partially and should not be used anymore, the whole model is kept as result
+void removeModel(PipelineContext &context, const DetectedObject &ro, std::string ppf_model_path, std::string result_path) {
+    if (!context.hasModel(ro.getID()))
+        return;
+    std::string dest_folder = result_path + "/model_partially_matched/" + std::to_string(ro.getID());
+    boost::filesystem::create_directories(dest_folder);
+    pcl::io::savePCDFile(dest_folder + "/3D_model.pcd", *context.modelCloud(ro.getID()));
+    context.removeModel(ro.getID());
+    //the trained PPF model cached in the model folder is outdated as well
+    boost::filesystem::remove_all(ppf_model_path + "/" + std::to_string(ro.getID()));
 }
 
-
-void removeModelFolder(DetectedObject ro, std::string ppf_model_path, std::string result_path) {
-    //there should already exist a folder
-    std::string orig_path = ppf_model_path + "/" + std::to_string(ro.getID());
-    if (boost::filesystem::exists(orig_path)) {
-        boost::filesystem::path dest_folder = result_path + "/model_partially_matched/" + std::to_string(ro.getID());
-        boost::filesystem::create_directories(dest_folder);
-        //count pcd-files in the folder
-        int nr_pcd_files = 0;
-        boost::filesystem::directory_iterator end_iter; // Default constructor for an iterator is the end iterator
-        for (boost::filesystem::directory_iterator iter(dest_folder); iter != end_iter; ++iter) {
-            if (iter->path().extension() == ".pcd")
-                ++nr_pcd_files;
-        }
-
-        //copy the folder to another directory. The model is already matched and should not be used anymore
-        for (const auto& dirEnt : boost::filesystem::recursive_directory_iterator{orig_path})
-        {
-            if (dirEnt.path().extension() == ".pcd") {
-                const auto& path = dirEnt.path();
-                boost::filesystem::path dest_filename = path.stem().string() + std::to_string(nr_pcd_files) + path.extension().string();
-                boost::filesystem::copy(path, dest_folder / dest_filename);
-                std::cout << "Copy " << path << " to " << (dest_folder / path.filename()) << std::endl;
-            }
-        }
-    }
-    boost::filesystem::remove_all(orig_path);
-}
-
-void updateDetectedObjects(std::vector<DetectedObject>& ref_result, std::vector<DetectedObject>& curr_result) {
+void updateDetectedObjects(PipelineContext &context, std::vector<DetectedObject>& ref_result, std::vector<DetectedObject>& curr_result) {
     for (DetectedObject ro : ref_result) {
         if (ro.state_ == ObjectState::REMOVED) {
-            //means that there was a partial match and have to create a new model folder
-            if (ro.object_folder_path_ == "") {
-                createNewModelFolder(ro, ppf_model_path, result_path);
+            //means that there was a partial match and we need a model of the new part
+            if (!context.hasModel(ro.getID())) {
+                context.addModel(ro.getID(), ro.getObjectCloud());
             }
             pot_removed_obj[ro.getID()] = ro;
         } else if (ro.state_ == ObjectState::DISPLACED) {
             //means that there was a partial match and we do not need the model anymore
-            if (ro.object_folder_path_ == "") {
-                removeModelFolder(ro, ppf_model_path, result_path);
+            if (ro.partially_matched_) {
+                removeModel(context, ro, ppf_model_path, result_path);
             }
             ref_displaced_obj[ro.getID()] = ro;
             pot_removed_obj.erase(ro.getID());
         } else if (ro.state_ == ObjectState::STATIC) {
             //means that there was a partial match and we do not need the model anymore
-            if (ro.object_folder_path_ == "") {
-                removeModelFolder(ro, ppf_model_path, result_path);
+            if (ro.partially_matched_) {
+                removeModel(context, ro, ppf_model_path, result_path);
             }
             ref_static_obj[ro.getID()] = ro;
             pot_removed_obj.erase(ro.getID());
@@ -447,8 +422,12 @@ int main(int argc, char* argv[])
         pcl::io::savePCDFile(current_path + "/convex_hull_" + std::to_string(curr_it->first) + ".pcd", *(curr_it->second.convex_hull_cloud));
     }
 
+    PipelineContext context;
+    if (!context.loadPPFParams(ppf_config_path_path))
+        return -1;
+
     //iterate through all reference planes
-    ChangeDetection change_detection(ppf_config_path_path);
+    ChangeDetection change_detection(context);
     for (std::map<int, ReconstructedPlane>::iterator ref_it = ref_rec_planes.begin(); ref_it != ref_rec_planes.end(); ref_it++ ) {
         if (ref_it->second.cloud->empty()) {
             ref_it->second.is_checked=true;
@@ -493,7 +472,7 @@ int main(int argc, char* argv[])
 
             //TODO check if all existing model folders are also present in ref_result
             //all detected objects labeled as removed (ref_objects) or new (curr_objects) could be placed on another plane
-            updateDetectedObjects(ref_result, curr_result);
+            updateDetectedObjects(context, ref_result, curr_result);
 
 
             //after collecting potential new and removed objects from the plane, try to match them
@@ -502,14 +481,16 @@ int main(int argc, char* argv[])
                 std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
                 pot_rem_obj_vec = fromMapToValVec(pot_removed_obj);
                 pot_new_obj_vec = fromMapToValVec(pot_new_obj);
-                ObjectMatching matching(pot_rem_obj_vec, pot_new_obj_vec, ppf_model_path, ppf_config_path_path);
+                ObjectMatching matching(std::move(pot_rem_obj_vec), std::move(pot_new_obj_vec), ppf_model_path, context);
                 ref_result.clear(); curr_result.clear();
                 matching.compute(ref_result, curr_result);
 
-                ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
-                ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
+                for (int id : ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder)) //merged completely, the copy in the map is outdated
+                    pot_removed_obj.erase(id);
+                for (int id : ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder))
+                    pot_new_obj.erase(id);
 
-                updateDetectedObjects(ref_result, curr_result);
+                updateDetectedObjects(context, ref_result, curr_result);
             }
         }
     }
@@ -533,7 +514,7 @@ int main(int argc, char* argv[])
                                   ref_it->second.convex_hull_cloud, fake_hull_cloud,
                                   ppf_model_path, plane_comparison_path, merge_object_parts_folder);
             change_detection.compute(ref_result, curr_result);
-            updateDetectedObjects(ref_result, curr_result);
+            updateDetectedObjects(context, ref_result, curr_result);
         }
     }
     for (std::map<int, ReconstructedPlane>::iterator curr_it = curr_rec_planes.begin(); curr_it != curr_rec_planes.end(); curr_it++ ) {
@@ -553,7 +534,7 @@ int main(int argc, char* argv[])
                                   fake_hull_cloud, curr_it->second.convex_hull_cloud,
                                   ppf_model_path, plane_comparison_path, merge_object_parts_folder);
             change_detection.compute(ref_result, curr_result);
-            updateDetectedObjects(ref_result, curr_result);
+            updateDetectedObjects(context, ref_result, curr_result);
         }
     }
 
@@ -567,14 +548,16 @@ int main(int argc, char* argv[])
         std::vector<DetectedObject> pot_rem_obj_vec, pot_new_obj_vec;
         pot_rem_obj_vec = fromMapToValVec(pot_removed_obj);
         pot_new_obj_vec = fromMapToValVec(pot_new_obj);
-        ObjectMatching matching(pot_rem_obj_vec, pot_new_obj_vec, ppf_model_path, ppf_config_path_path);
+        ObjectMatching matching(std::move(pot_rem_obj_vec), std::move(pot_new_obj_vec), ppf_model_path, context);
         std::vector<DetectedObject> ref_result, curr_result;
         matching.compute(ref_result, curr_result);
 
-        ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder);
-        ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder);
+        for (int id : ChangeDetection::mergeObjectParts(ref_result, merge_object_parts_folder)) //merged completely, the copy in the map is outdated
+            pot_removed_obj.erase(id);
+        for (int id : ChangeDetection::mergeObjectParts(curr_result, merge_object_parts_folder))
+            pot_new_obj.erase(id);
 
-        updateDetectedObjects(ref_result, curr_result);
+        updateDetectedObjects(context, ref_result, curr_result);
     }
 
 
@@ -638,7 +621,6 @@ int main(int argc, char* argv[])
         for (size_t i = 0; i < curr_objects_cloud->size(); i++) {
             curr_objects_cloud->points[i].label = ref_object.getID() * 20;
         }
-        pcl::io::savePCDFileBinary("/home/edith/Desktop/curr_object_displ.pcd", *curr_objects_cloud);
         *ref_displaced_objects_cloud += *ref_objects_cloud;
         *curr_displaced_objects_cloud += *curr_objects_cloud;
     }
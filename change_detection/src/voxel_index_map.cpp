@@ -0,0 +1,153 @@
+#include "voxel_index_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+//how close to a voxel border (in voxels) a centroid has to be to look at the neighbouring voxel as well
+static const float voxel_border_margin = 1e-3f;
+
+static inline uint64_t pointVoxelKey(const PointNormal &pt, float inv_leaf_size) {
+    return voxelKey(static_cast<int>(std::floor(pt.x * inv_leaf_size)),
+                    static_cast<int>(std::floor(pt.y * inv_leaf_size)),
+                    static_cast<int>(std::floor(pt.z * inv_leaf_size)));
+}
+
+void VoxelIndexMap::build(const pcl::PointCloud<PointNormal> &cloud, double leaf_size) {
+    inv_leaf_size_ = 1.0f / static_cast<float>(leaf_size);
+    voxel_keys_.clear();
+    voxel_offsets_.clear();
+    point_indices_.clear();
+    centroid_x_.clear();
+    centroid_y_.clear();
+    centroid_z_.clear();
+
+    std::vector<std::pair<uint64_t, int> > key_index;
+    key_index.reserve(cloud.points.size());
+    for (size_t i = 0; i < cloud.points.size(); i++) {
+        const PointNormal &pt = cloud.points[i];
+        if (!std::isfinite(pt.x) || !std::isfinite(pt.y) || !std::isfinite(pt.z))
+            continue;
+        key_index.push_back(std::make_pair(pointVoxelKey(pt, inv_leaf_size_), static_cast<int>(i)));
+    }
+    std::sort(key_index.begin(), key_index.end());
+
+    point_indices_.reserve(key_index.size());
+    for (size_t i = 0; i < key_index.size(); i++) {
+        if (i == 0 || key_index[i].first != key_index[i-1].first) {
+            voxel_keys_.push_back(key_index[i].first);
+            voxel_offsets_.push_back(point_indices_.size());
+        }
+        point_indices_.push_back(key_index[i].second);
+    }
+    voxel_offsets_.push_back(point_indices_.size());
+
+    centroid_x_.resize(voxel_keys_.size());
+    centroid_y_.resize(voxel_keys_.size());
+    centroid_z_.resize(voxel_keys_.size());
+    for (size_t v = 0; v < voxel_keys_.size(); v++) {
+        double sum_x = 0, sum_y = 0, sum_z = 0;
+        for (uint32_t p = voxel_offsets_[v]; p < voxel_offsets_[v+1]; p++) {
+            const PointNormal &pt = cloud.points[point_indices_[p]];
+            sum_x += pt.x; sum_y += pt.y; sum_z += pt.z;
+        }
+        const double nr_points = voxel_offsets_[v+1] - voxel_offsets_[v];
+        centroid_x_[v] = sum_x / nr_points; centroid_y_[v] = sum_y / nr_points; centroid_z_[v] = sum_z / nr_points;
+    }
+}
+
+bool VoxelIndexMap::gather(const PointNormal &pt, std::vector<int> &indices) const {
+    if (!std::isfinite(pt.x) || !std::isfinite(pt.y) || !std::isfinite(pt.z))
+        return false;
+    //usually only the voxel of the point itself is a candidate
+    const float x = pt.x * inv_leaf_size_, y = pt.y * inv_leaf_size_, z = pt.z * inv_leaf_size_;
+    const int min_x = static_cast<int>(std::floor(x - voxel_border_margin)), max_x = static_cast<int>(std::floor(x + voxel_border_margin));
+    const int min_y = static_cast<int>(std::floor(y - voxel_border_margin)), max_y = static_cast<int>(std::floor(y + voxel_border_margin));
+    const int min_z = static_cast<int>(std::floor(z - voxel_border_margin)), max_z = static_cast<int>(std::floor(z + voxel_border_margin));
+    size_t v = voxel_keys_.size();
+    float min_sqr_dist = std::numeric_limits<float>::max();
+    for (int ix = min_x; ix <= max_x; ix++) {
+        for (int iy = min_y; iy <= max_y; iy++) {
+            for (int iz = min_z; iz <= max_z; iz++) {
+                const uint64_t key = voxelKey(ix, iy, iz);
+                auto it = std::lower_bound(voxel_keys_.begin(), voxel_keys_.end(), key);
+                if (it == voxel_keys_.end() || *it != key)
+                    continue;
+                const size_t c = it - voxel_keys_.begin();
+                const float dx = centroid_x_[c] - pt.x, dy = centroid_y_[c] - pt.y, dz = centroid_z_[c] - pt.z;
+                const float sqr_dist = dx*dx + dy*dy + dz*dz;
+                if (sqr_dist < min_sqr_dist) {
+                    min_sqr_dist = sqr_dist;
+                    v = c;
+                }
+            }
+        }
+    }
+    if (v == voxel_keys_.size())
+        return false;
+    indices.insert(indices.end(), point_indices_.begin() + voxel_offsets_[v], point_indices_.begin() + voxel_offsets_[v+1]);
+    return true;
+}
+
+void RadiusSearchGrid::build(const PointCloudSoA &cloud, float cell_size) {
+    inv_cell_size_ = 1.0f / cell_size;
+    cells_.clear();
+    cell_offsets_.clear();
+    point_indices_.clear();
+
+    std::vector<std::pair<uint64_t, int> > key_index;
+    key_index.reserve(cloud.size());
+    for (size_t i = 0; i < cloud.size(); i++) {
+        if (!cloud.isFinite(i))
+            continue;
+        const uint64_t key = voxelKey(static_cast<int>(std::floor(cloud.x[i] * inv_cell_size_)),
+                                      static_cast<int>(std::floor(cloud.y[i] * inv_cell_size_)),
+                                      static_cast<int>(std::floor(cloud.z[i] * inv_cell_size_)));
+        key_index.push_back(std::make_pair(key, static_cast<int>(i)));
+    }
+    std::sort(key_index.begin(), key_index.end());
+
+    point_indices_.reserve(key_index.size());
+    x_.resize(key_index.size()); y_.resize(key_index.size()); z_.resize(key_index.size());
+    for (size_t i = 0; i < key_index.size(); i++) {
+        if (i == 0 || key_index[i].first != key_index[i-1].first) {
+            cells_[key_index[i].first] = cell_offsets_.size();
+            cell_offsets_.push_back(point_indices_.size());
+        }
+        const int ind = key_index[i].second;
+        point_indices_.push_back(ind);
+        x_[i] = cloud.x[ind]; y_[i] = cloud.y[ind]; z_[i] = cloud.z[ind];
+    }
+    cell_offsets_.push_back(point_indices_.size());
+}
+
+size_t RadiusSearchGrid::radiusSearch(float x, float y, float z, float radius, std::vector<int> &indices, std::vector<float> &sqr_distances) const {
+    indices.clear();
+    sqr_distances.clear();
+    if (cells_.empty() || !std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z))
+        return 0;
+    const float sqr_radius = radius * radius;
+    const int min_x = static_cast<int>(std::floor((x - radius) * inv_cell_size_)), max_x = static_cast<int>(std::floor((x + radius) * inv_cell_size_));
+    const int min_y = static_cast<int>(std::floor((y - radius) * inv_cell_size_)), max_y = static_cast<int>(std::floor((y + radius) * inv_cell_size_));
+    const int min_z = static_cast<int>(std::floor((z - radius) * inv_cell_size_)), max_z = static_cast<int>(std::floor((z + radius) * inv_cell_size_));
+    for (int ix = min_x; ix <= max_x; ix++) {
+        for (int iy = min_y; iy <= max_y; iy++) {
+            for (int iz = min_z; iz <= max_z; iz++) {
+                auto it = cells_.find(voxelKey(ix, iy, iz));
+                if (it == cells_.end())
+                    continue;
+                const uint32_t end = cell_offsets_[it->second + 1];
+                for (uint32_t p = cell_offsets_[it->second]; p < end; p++) {
+                    const float dx = x_[p] - x, dy = y_[p] - y, dz = z_[p] - z;
+                    const float sqr_dist = dx*dx + dy*dy + dz*dz;
+                    if (sqr_dist <= sqr_radius) {
+                        indices.push_back(point_indices_[p]);
+                        sqr_distances.push_back(sqr_dist);
+                    }
+                }
+            }
+        }
+    }
+    return indices.size();
+}
@@ -0,0 +1,130 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "daemon_protocol.h"
+#include "test_helpers.h"
+
+static ComparisonJob makeJob() {
+    ComparisonJob job;
+    job.room_path = "/data/room1";
+    job.result_path = "/results";
+    job.ppf_config_path = "/config/ppf.ini";
+    job.map_path = "/maps/room1";
+    job.resume_path = "";
+    job.bounded_memory = true;
+    job.artifact_level = 1;
+    return job;
+}
+
+static bool sameJob(const ComparisonJob &j1, const ComparisonJob &j2) {
+    return j1.room_path == j2.room_path && j1.result_path == j2.result_path && j1.ppf_config_path == j2.ppf_config_path &&
+            j1.map_path == j2.map_path && j1.resume_path == j2.resume_path && j1.bounded_memory == j2.bounded_memory &&
+            j1.artifact_level == j2.artifact_level;
+}
+
+//decodes a payload like the daemon: message type first, then the fields
+static bool decodeJobPayload(const std::vector<char> &payload, ComparisonJob &job) {
+    BufferReader reader(payload);
+    if (reader.read<uint32_t>() != DAEMON_JOB)
+        return false;
+    return decodeJob(reader, job);
+}
+
+int main() {
+    //job round trip
+    const ComparisonJob job = makeJob();
+    ComparisonJob decoded_job;
+    TEST_CHECK(decodeJobPayload(encodeJob(job), decoded_job));
+    TEST_CHECK(sameJob(job, decoded_job));
+
+    //truncated job
+    std::vector<char> payload = encodeJob(job);
+    payload.resize(payload.size() - 1);
+    TEST_CHECK(!decodeJobPayload(payload, decoded_job));
+
+    //other protocol version
+    payload = encodeJob(job);
+    const uint32_t other_version = daemon_protocol_version + 1;
+    std::memcpy(payload.data() + sizeof(uint32_t), &other_version, sizeof(other_version));
+    TEST_CHECK(!decodeJobPayload(payload, decoded_job));
+
+    //string longer than the payload
+    payload = encodeJob(job);
+    const uint32_t long_string = 1 << 30;
+    std::memcpy(payload.data() + 2 * sizeof(uint32_t), &long_string, sizeof(long_string));
+    TEST_CHECK(!decodeJobPayload(payload, decoded_job));
+
+    //pair round trip
+    PairResult result;
+    result.ref_scene = "scene1";
+    result.curr_scene = "scene2";
+    result.result_path = "/results/scene1-scene2";
+    result.nr_removed = 1; result.nr_new = 2; result.nr_ref_displaced = 3;
+    result.nr_curr_displaced = 4; result.nr_ref_static = 5; result.nr_curr_static = 6;
+    payload = encodePair(result);
+    BufferReader pair_reader(payload);
+    TEST_CHECK(pair_reader.read<uint32_t>() == DAEMON_PAIR);
+    PairResult decoded_result;
+    TEST_CHECK(decodePair(pair_reader, decoded_result));
+    TEST_CHECK(decoded_result.ref_scene == result.ref_scene && decoded_result.curr_scene == result.curr_scene &&
+               decoded_result.result_path == result.result_path);
+    TEST_CHECK(decoded_result.nr_removed == 1 && decoded_result.nr_new == 2 && decoded_result.nr_ref_displaced == 3 &&
+               decoded_result.nr_curr_displaced == 4 && decoded_result.nr_ref_static == 5 && decoded_result.nr_curr_static == 6);
+
+    //frames over a connected pair of sockets
+    int fds[2];
+    TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    TEST_CHECK(sendFrame(fds[0], encodeJob(job)));
+    TEST_CHECK(sendFrame(fds[0], encodeDone(-1)));
+    std::vector<char> received;
+    TEST_CHECK(receiveFrame(fds[1], received));
+    TEST_CHECK(decodeJobPayload(received, decoded_job) && sameJob(job, decoded_job));
+    TEST_CHECK(receiveFrame(fds[1], received));
+    BufferReader done_reader(received);
+    TEST_CHECK(done_reader.read<uint32_t>() == DAEMON_DONE && done_reader.read<int32_t>() == -1 && done_reader.ok());
+
+    //oversized frame, rejected before the payload is allocated
+    std::vector<char> oversized_header;
+    writeValue(oversized_header, static_cast<uint32_t>(daemon_max_frame_size + 1));
+    TEST_CHECK(write(fds[0], oversized_header.data(), oversized_header.size()) == static_cast<ssize_t>(oversized_header.size()));
+    TEST_CHECK(!receiveFrame(fds[1], received));
+
+    //connection closed in the middle of a frame
+    std::vector<char> partial_frame;
+    writeValue(partial_frame, static_cast<uint32_t>(100));
+    partial_frame.resize(partial_frame.size() + 10);
+    TEST_CHECK(write(fds[0], partial_frame.data(), partial_frame.size()) == static_cast<ssize_t>(partial_frame.size()));
+    close(fds[0]);
+    TEST_CHECK(!receiveFrame(fds[1], received));
+    close(fds[1]);
+
+    //a silent client times out
+    TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    TEST_CHECK(setReceiveTimeout(fds[1], 1));
+    TEST_CHECK(!receiveFrame(fds[1], received));
+    close(fds[0]);
+    close(fds[1]);
+
+    //only the owner can connect to the socket of the daemon
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir);
+    const std::string socket_path = (dir / "daemon.sock").string();
+    const int listen_fd = listenOnUnixSocket(socket_path);
+    TEST_CHECK(listen_fd != -1);
+    struct stat socket_stat;
+    TEST_CHECK(stat(socket_path.c_str(), &socket_stat) == 0 && (socket_stat.st_mode & 0777) == 0600);
+    const int client_fd = connectToUnixSocket(socket_path);
+    TEST_CHECK(client_fd != -1);
+    close(client_fd);
+    close(listen_fd);
+    boost::filesystem::remove_all(dir);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,19 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <iostream>
+
+//Minimal checks for the test executables run by ctest. assert() is compiled out in the Release builds of this project.
+static int test_failures = 0;
+
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #cond << std::endl; \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif // TEST_HELPERS_H
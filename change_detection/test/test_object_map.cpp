@@ -0,0 +1,132 @@
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "binary_buffer.h"
+#include "object_map.h"
+#include "test_helpers.h"
+
+static pcl::PointCloud<PointNormal>::Ptr makeCloud(float x0, float y0, int nr_points) {
+    pcl::PointCloud<PointNormal>::Ptr cloud(new pcl::PointCloud<PointNormal>);
+    for (int i = 0; i < nr_points; i++) {
+        PointNormal pt{};
+        pt.x = x0 + 0.001f * i; pt.y = y0; pt.z = 0.75f;
+        pt.normal_z = 1.0f;
+        pt.r = i % 256; pt.g = 1; pt.b = 2; pt.a = 255;
+        pt.curvature = 0.01f;
+        cloud->points.push_back(pt);
+    }
+    cloud->width = nr_points;
+    cloud->height = 1;
+    return cloud;
+}
+
+static ReconstructedPlane makePlane(float x0) {
+    ReconstructedPlane plane;
+    plane.cloud = makeCloud(x0, 0.0f, 100);
+    plane.nr_points = 100;
+    plane.plane_coeffs = Vector4f_NotAligned(0.0f, 0.0f, 1.0f, -0.7f);
+    plane.convex_hull_cloud.reset(new pcl::PointCloud<pcl::PointXYZ>);
+    plane.is_checked = false;
+    return plane;
+}
+
+static void checkSameObjects(const ObjectMap &expected, const ObjectMap &map) {
+    TEST_CHECK(map.objects().size() == expected.objects().size());
+    for (auto const &obj : expected.objects()) {
+        auto it = map.objects().find(obj.first);
+        TEST_CHECK(it != map.objects().end());
+        if (it == map.objects().end())
+            continue;
+        const MapObject &o = it->second, &e = obj.second;
+        TEST_CHECK(o.id == e.id && o.plane_id == e.plane_id && o.state == e.state);
+        TEST_CHECK(o.first_seen_scene == e.first_seen_scene && o.last_seen_scene == e.last_seen_scene);
+        TEST_CHECK(o.pose == e.pose);
+        TEST_CHECK(o.cloud && o.cloud->points.size() == e.cloud->points.size());
+        for (size_t i = 0; o.cloud && i < o.cloud->points.size(); i++) {
+            const PointNormal &p1 = o.cloud->points[i], &p2 = e.cloud->points[i];
+            TEST_CHECK(p1.x == p2.x && p1.y == p2.y && p1.z == p2.z && p1.normal_z == p2.normal_z && p1.rgba == p2.rgba &&
+                       p1.curvature == p2.curvature);
+        }
+    }
+}
+
+static void overwriteUint32(const std::string &path, size_t offset, uint32_t value) {
+    std::vector<char> buffer;
+    readFileIntoBuffer(path, buffer);
+    std::memcpy(buffer.data() + offset, &value, sizeof(value));
+    writeBufferToFile(path, buffer);
+}
+
+int main() {
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    const std::string map_dir = (dir / "map").string();
+
+    std::map<int, ReconstructedPlane> planes;
+    planes[0] = makePlane(0.0f);
+    planes[2] = makePlane(2.0f);
+
+    ObjectMap map;
+    map.init(planes, "scene1");
+    map.addScene("scene2");
+    const int cup = map.addObject(0, ObjectState::STATIC, makeCloud(0.1f, 0.1f, 50), "scene1", "scene1");
+    const int book = map.addObject(2, ObjectState::NEW, makeCloud(2.1f, 0.1f, 80), "scene2", "scene2");
+    Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+    transform(0,3) = 0.05f;
+    map.observeObject(cup, 0, ObjectState::DISPLACED, makeCloud(0.15f, 0.1f, 60), transform, "scene2");
+    map.removeObject(book);
+    const int new_plane = map.addPlane(makePlane(4.0f));
+    TEST_CHECK(new_plane == 3);
+    TEST_CHECK(map.save(map_dir));
+
+    //round trip
+    ObjectMap loaded;
+    TEST_CHECK(loaded.load(map_dir));
+    TEST_CHECK(loaded.scenes() == map.scenes());
+    TEST_CHECK(loaded.planes().size() == map.planes().size());
+    checkSameObjects(map, loaded);
+    TEST_CHECK(loaded.objects().at(cup).pose(0,3) == 0.05f);
+    TEST_CHECK(loaded.findObject(0, makeCloud(0.16f, 0.1f, 60)) == cup);
+    TEST_CHECK(loaded.findObject(2, makeCloud(2.1f, 0.1f, 80)) == -1); //removed
+    //the IDs continue after the loaded ones
+    TEST_CHECK(loaded.addObject(3, ObjectState::NEW, makeCloud(4.1f, 0.0f, 10), "scene3", "scene3") == book + 1);
+    TEST_CHECK(loaded.addPlane(makePlane(6.0f)) == new_plane + 1);
+
+    //a save that was interrupted after the old map was moved away
+    boost::filesystem::rename(map_dir, map_dir + ".old");
+    ObjectMap restored;
+    TEST_CHECK(restored.load(map_dir));
+    checkSameObjects(map, restored);
+
+    //corrupted counts and states are rejected before anything is allocated
+    const std::string objects_path = map_dir + "/" + object_map_filename;
+    std::vector<char> original;
+    TEST_CHECK(readFileIntoBuffer(objects_path, original));
+    const size_t nr_scenes_offset = 4 + 3 * sizeof(uint32_t);
+    size_t nr_objects_offset = nr_scenes_offset + sizeof(uint32_t);
+    for (const std::string &scene : map.scenes())
+        nr_objects_offset += sizeof(uint32_t) + scene.size();
+    const size_t first_state_offset = nr_objects_offset + 3 * sizeof(uint32_t);
+
+    ObjectMap corrupted;
+    overwriteUint32(objects_path, nr_scenes_offset, 0xFFFFFFFF);
+    TEST_CHECK(!corrupted.load(map_dir));
+    writeBufferToFile(objects_path, original);
+    overwriteUint32(objects_path, nr_objects_offset, 0xFFFFFFFF);
+    TEST_CHECK(!corrupted.load(map_dir));
+    writeBufferToFile(objects_path, original);
+    overwriteUint32(objects_path, first_state_offset, 1000);
+    TEST_CHECK(!corrupted.load(map_dir));
+    TEST_CHECK(corrupted.empty());
+
+    //truncated
+    std::vector<char> truncated(original.begin(), original.end() - 4);
+    writeBufferToFile(objects_path, truncated);
+    TEST_CHECK(!corrupted.load(map_dir));
+
+    boost::filesystem::remove_all(dir);
+    return TEST_RESULT();
+}
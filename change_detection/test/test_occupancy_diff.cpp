@@ -0,0 +1,104 @@
+#include <random>
+#include <vector>
+
+#include "occupancy_diff.h"
+#include "settings.h"
+#include "test_helpers.h"
+
+typedef pcl::PointCloud<PointNormal> Cloud;
+
+static const Eigen::Vector4f plane_coeffs(0.0f, 0.0f, 1.0f, -0.7f); //table at 70cm
+
+static void addPlane(Cloud &cloud, std::mt19937 &gen) {
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for (int i = 0; i < 20000; i++) {
+        PointNormal pt{};
+        pt.x = u(gen); pt.y = u(gen); pt.z = 0.7f;
+        pt.r = pt.g = pt.b = 200;
+        cloud.points.push_back(pt);
+    }
+}
+
+//random points in the cube [x0,x0+size]x[y0,y0+size]x[z0,z0+size], returns their indices
+static std::vector<int> addCube(Cloud &cloud, float x0, float y0, float z0, float size, int nr_points, uint8_t r, std::mt19937 &gen) {
+    std::uniform_real_distribution<float> u(0.0f, size);
+    std::vector<int> indices;
+    for (int i = 0; i < nr_points; i++) {
+        PointNormal pt{};
+        pt.x = x0 + u(gen); pt.y = y0 + u(gen); pt.z = z0 + u(gen);
+        pt.r = r; pt.g = 100; pt.b = 100;
+        indices.push_back(cloud.points.size());
+        cloud.points.push_back(pt);
+    }
+    return indices;
+}
+
+struct Scene {
+    Cloud cloud;
+    std::vector<std::vector<int> > objects;
+};
+
+static Scene crowdedPlane(std::mt19937 &gen) {
+    Scene scene;
+    addPlane(scene.cloud, gen);
+    scene.objects.push_back(addCube(scene.cloud, 0.1f, 0.1f, 0.72f, 0.1f, 2000, 50, gen));
+    scene.objects.push_back(addCube(scene.cloud, 0.6f, 0.6f, 0.72f, 0.06f, 2000, 250, gen));
+    scene.objects.push_back(addCube(scene.cloud, 0.1f, 0.7f, 0.72f, 0.08f, 2000, 150, gen));
+    scene.objects.push_back(addCube(scene.cloud, 0.7f, 0.1f, 0.72f, 0.12f, 2000, 20, gen));
+    scene.objects.push_back(addCube(scene.cloud, 0.4f, 0.4f, 0.72f, 0.1f, 2000, 100, gen));
+    return scene;
+}
+
+static Cloud objectPoints(const Scene &scene) {
+    Cloud cloud;
+    for (const std::vector<int> &object : scene.objects) {
+        for (int i : object)
+            cloud.points.push_back(scene.cloud.points[i]);
+    }
+    return cloud;
+}
+
+//the cheap tests of the early-out in ChangeDetection::compute
+static bool takesEarlyOut(const Scene &ref, const Scene &curr) {
+    return haveSameOccupancy(ref.cloud, plane_coeffs, curr.cloud, plane_coeffs) &&
+            areObjectsCovered(curr.cloud, curr.objects, objectPoints(ref), unchanged_max_cover_dist);
+}
+
+int main() {
+    std::mt19937 gen(1);
+    const Scene ref = crowdedPlane(gen);
+
+    //unchanged plane
+    const Scene same = crowdedPlane(gen);
+    TEST_CHECK(takesEarlyOut(ref, same));
+
+    //the orientation of the plane normal does not matter
+    TEST_CHECK(haveSameOccupancy(ref.cloud, -plane_coeffs, same.cloud, plane_coeffs));
+
+    //points below the plane are ignored
+    Scene below = crowdedPlane(gen);
+    addCube(below.cloud, 0.3f, 0.3f, 0.4f, 0.2f, 2000, 0, gen);
+    TEST_CHECK(haveSameOccupancy(ref.cloud, plane_coeffs, below.cloud, plane_coeffs));
+
+    //removed object
+    Scene removed = crowdedPlane(gen);
+    removed.objects.pop_back();
+    removed.cloud.points.resize(removed.cloud.points.size() - 2000);
+    TEST_CHECK(!takesEarlyOut(ref, removed));
+
+    //moved object
+    Scene moved = crowdedPlane(gen);
+    for (int i : moved.objects[1])
+        moved.cloud.points[i].x += 0.15f;
+    TEST_CHECK(!takesEarlyOut(ref, moved));
+
+    //one small object added to the crowded plane. It fits into the tolerance of the occupancy, but it is not covered by a
+    //reference object.
+    Scene added = crowdedPlane(gen);
+    added.objects.push_back(addCube(added.cloud, 0.85f, 0.5f, 0.72f, 0.03f, 200, 120, gen));
+    TEST_CHECK(haveSameOccupancy(ref.cloud, plane_coeffs, added.cloud, plane_coeffs));
+    TEST_CHECK(!areObjectsCovered(added.cloud, added.objects, objectPoints(ref), unchanged_max_cover_dist));
+    TEST_CHECK(!takesEarlyOut(ref, added));
+
+    return TEST_RESULT();
+}
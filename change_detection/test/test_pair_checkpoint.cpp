@@ -0,0 +1,74 @@
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "binary_buffer.h"
+#include "pair_checkpoint.h"
+#include "test_helpers.h"
+
+static void writeFile(const std::string &path, const std::string &content) {
+    writeBufferToFile(path, std::vector<char>(content.begin(), content.end()));
+}
+
+int main() {
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir / "debug");
+    const std::string result_path = dir.string();
+    const std::string manifest_path = result_path + "/result.manifest";
+    const std::string cloud_path = result_path + "/ref_removed_objects.pcd";
+    writeFile(manifest_path, "manifest content");
+    writeFile(cloud_path, std::string(1000, 'p'));
+    writeFile(result_path + "/debug/plane.pcd", "debug clouds are not part of the record");
+
+    //no record yet
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    TEST_CHECK(writePairCheckpoint(result_path, "scene1", "scene2"));
+    TEST_CHECK(verifyPairCheckpoint(result_path, "scene1", "scene2"));
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene2", "scene1"));
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene3"));
+
+    //debug folders and temporary files do not matter
+    writeFile(result_path + "/debug/plane.pcd", "changed");
+    writeFile(result_path + "/result.manifest.tmp", "interrupted write");
+    TEST_CHECK(verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    //truncated result file
+    writeFile(cloud_path, std::string(999, 'p'));
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    //corrupted result file of the same size
+    writeFile(cloud_path, std::string(999, 'p') + "x");
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    //missing result file
+    writeFile(cloud_path, std::string(1000, 'p'));
+    TEST_CHECK(verifyPairCheckpoint(result_path, "scene1", "scene2"));
+    boost::filesystem::remove(manifest_path);
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    //the record is written again after the comparison was repeated
+    writeFile(manifest_path, "new manifest content");
+    TEST_CHECK(writePairCheckpoint(result_path, "scene1", "scene2"));
+    TEST_CHECK(verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    //truncated or corrupted record
+    const std::string record_path = result_path + "/" + pair_checkpoint_filename;
+    std::vector<char> record;
+    TEST_CHECK(readFileIntoBuffer(record_path, record));
+    std::vector<char> truncated(record.begin(), record.end() - 1);
+    writeBufferToFile(record_path, truncated);
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+    std::vector<char> corrupted = record;
+    corrupted.back() ^= 0x1;
+    writeBufferToFile(record_path, corrupted);
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+    corrupted = record;
+    corrupted[0] = 'X';
+    writeBufferToFile(record_path, corrupted);
+    TEST_CHECK(!verifyPairCheckpoint(result_path, "scene1", "scene2"));
+
+    boost::filesystem::remove_all(dir);
+    return TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "binary_buffer.h"
+#include "object_state.h"
+#include "result_manifest.h"
+#include "test_helpers.h"
+
+static ManifestObject makeObject(int id, ManifestScene scene, ObjectState state, int nr_points) {
+    ManifestObject o;
+    o.id = id;
+    o.scene = scene;
+    o.state = state;
+    o.match_id = state == ObjectState::NEW || state == ObjectState::REMOVED ? -1 : id + 100;
+    o.label = id;
+    o.object_conf = 0.1f * id;
+    o.model_conf = 0.2f * id;
+    o.transform(0,3) = 0.5f * id;
+    o.cloud.reset(new pcl::PointCloud<pcl::PointXYZRGB>);
+    for (int i = 0; i < nr_points; i++) {
+        pcl::PointXYZRGB pt;
+        pt.x = id + 0.01f * i; pt.y = 0.02f * i; pt.z = 0.7f;
+        pt.r = i % 256; pt.g = id; pt.b = 3; pt.a = 255;
+        o.cloud->points.push_back(pt);
+    }
+    o.cloud->width = nr_points;
+    o.cloud->height = 1;
+    return o;
+}
+
+static void overwriteUint32(const std::string &path, size_t offset, uint32_t value) {
+    std::vector<char> buffer;
+    readFileIntoBuffer(path, buffer);
+    std::memcpy(buffer.data() + offset, &value, sizeof(value));
+    writeBufferToFile(path, buffer);
+}
+
+int main() {
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir);
+    const std::string path = (dir / result_manifest_filename).string();
+
+    ResultManifest manifest;
+    manifest.ref_scene = "scene2";
+    manifest.curr_scene = "scene5";
+    manifest.timings.push_back(ManifestTiming{"load scenes", 12.5});
+    manifest.timings.push_back(ManifestTiming{"change detection", 1234.25});
+    manifest.objects.push_back(makeObject(1, MANIFEST_REFERENCE, ObjectState::REMOVED, 50));
+    manifest.objects.push_back(makeObject(2, MANIFEST_REFERENCE, ObjectState::STATIC, 30));
+    manifest.objects.push_back(makeObject(3, MANIFEST_CURRENT, ObjectState::STATIC, 30));
+    manifest.objects.push_back(makeObject(4, MANIFEST_CURRENT, ObjectState::NEW, 0));
+    TEST_CHECK(writeResultManifest(path, manifest));
+
+    //round trip
+    ResultManifest read_manifest;
+    TEST_CHECK(readResultManifest(path, read_manifest));
+    TEST_CHECK(read_manifest.ref_scene == manifest.ref_scene);
+    TEST_CHECK(read_manifest.curr_scene == manifest.curr_scene);
+    TEST_CHECK(read_manifest.timings.size() == manifest.timings.size());
+    for (size_t t = 0; t < read_manifest.timings.size() && t < manifest.timings.size(); t++) {
+        TEST_CHECK(read_manifest.timings[t].stage == manifest.timings[t].stage);
+        TEST_CHECK(read_manifest.timings[t].runtime_ms == manifest.timings[t].runtime_ms);
+    }
+    TEST_CHECK(read_manifest.objects.size() == manifest.objects.size());
+    for (size_t n = 0; n < read_manifest.objects.size() && n < manifest.objects.size(); n++) {
+        const ManifestObject &o = read_manifest.objects[n], &expected = manifest.objects[n];
+        TEST_CHECK(o.id == expected.id && o.scene == expected.scene && o.state == expected.state);
+        TEST_CHECK(o.match_id == expected.match_id && o.label == expected.label);
+        TEST_CHECK(o.object_conf == expected.object_conf && o.model_conf == expected.model_conf);
+        TEST_CHECK(o.transform == expected.transform);
+        TEST_CHECK(o.cloud && o.cloud->points.size() == expected.cloud->points.size());
+        for (size_t i = 0; o.cloud && i < o.cloud->points.size(); i++) {
+            const pcl::PointXYZRGB &pt = o.cloud->points[i], &expected_pt = expected.cloud->points[i];
+            TEST_CHECK(pt.x == expected_pt.x && pt.y == expected_pt.y && pt.z == expected_pt.z && pt.rgba == expected_pt.rgba);
+        }
+    }
+
+    //result clouds grouped by scene and state
+    ManifestResultClouds clouds = extractResultClouds(read_manifest);
+    TEST_CHECK(clouds.ref_removed->points.size() == 50);
+    TEST_CHECK(clouds.ref_static->points.size() == 30);
+    TEST_CHECK(clouds.curr_static->points.size() == 30);
+    TEST_CHECK(clouds.curr_new->points.empty());
+    TEST_CHECK(clouds.ref_displaced->points.empty() && clouds.curr_displaced->points.empty());
+    TEST_CHECK(!clouds.ref_static->points.empty() && clouds.ref_static->points[0].label == 2);
+
+    //corrupted counts are rejected before anything is allocated, the manifest is not changed
+    std::vector<char> original;
+    TEST_CHECK(readFileIntoBuffer(path, original));
+    const size_t nr_timings_offset = 4 + sizeof(uint32_t) + 2 * sizeof(uint32_t) + manifest.ref_scene.size() + manifest.curr_scene.size();
+    size_t nr_objects_offset = nr_timings_offset + sizeof(uint32_t);
+    for (const ManifestTiming &t : manifest.timings)
+        nr_objects_offset += sizeof(uint32_t) + t.stage.size() + sizeof(double);
+    const size_t first_nr_pts_offset = nr_objects_offset + sizeof(uint32_t) + 7 * sizeof(uint32_t) + 16 * sizeof(float);
+
+    overwriteUint32(path, nr_timings_offset, 0xFFFFFFFF);
+    TEST_CHECK(!readResultManifest(path, read_manifest));
+    writeBufferToFile(path, original);
+    overwriteUint32(path, nr_objects_offset, 0xFFFFFFFF);
+    TEST_CHECK(!readResultManifest(path, read_manifest));
+    writeBufferToFile(path, original);
+    overwriteUint32(path, first_nr_pts_offset, 0xFFFFFFFF);
+    TEST_CHECK(!readResultManifest(path, read_manifest));
+    TEST_CHECK(read_manifest.objects.size() == manifest.objects.size());
+    writeBufferToFile(path, original);
+    TEST_CHECK(readResultManifest(path, read_manifest));
+
+    //truncated file, the manifest is not changed
+    std::vector<char> buffer;
+    TEST_CHECK(readFileIntoBuffer(path, buffer));
+    buffer.resize(buffer.size() - 8);
+    writeBufferToFile(path, buffer);
+    TEST_CHECK(!readResultManifest(path, read_manifest));
+    TEST_CHECK(read_manifest.objects.size() == manifest.objects.size());
+
+    //not a manifest
+    buffer.assign(64, 'x');
+    writeBufferToFile(path, buffer);
+    TEST_CHECK(!readResultManifest(path, read_manifest));
+
+    boost::filesystem::remove_all(dir);
+    return TEST_RESULT();
+}
@@ -0,0 +1,146 @@
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "binary_buffer.h"
+#include "scene_bundle.h"
+#include "test_helpers.h"
+
+static ReconstructedPlane makePlane(int nr_points, int nr_hull_points, float offset) {
+    ReconstructedPlane plane;
+    plane.center_point = {offset, 2.0f * offset, 0.7f};
+    plane.plane_coeffs = Vector4f_NotAligned(0.0f, 0.1f, 1.0f, -0.7f - offset);
+    plane.transform(0,3) = offset;
+    plane.convex_hull_cloud.reset(new pcl::PointCloud<pcl::PointXYZ>);
+    for (int i = 0; i < nr_hull_points; i++) {
+        pcl::PointXYZ pt;
+        pt.x = offset + i; pt.y = -i; pt.z = 0.7f;
+        plane.convex_hull_cloud->points.push_back(pt);
+    }
+    plane.convex_hull_cloud->width = nr_hull_points;
+    plane.convex_hull_cloud->height = 1;
+    if (nr_points > 0) {
+        plane.cloud.reset(new pcl::PointCloud<PointNormal>);
+        for (int i = 0; i < nr_points; i++) {
+            PointNormal pt{};
+            pt.x = offset + 0.01f * i; pt.y = 0.02f * i; pt.z = 0.7f;
+            pt.normal_x = 0.0f; pt.normal_y = 0.0f; pt.normal_z = 1.0f;
+            pt.r = i % 256; pt.g = 10; pt.b = 20; pt.a = 255;
+            pt.curvature = 0.001f * i;
+            plane.cloud->points.push_back(pt);
+        }
+        plane.cloud->width = nr_points;
+        plane.cloud->height = 1;
+    }
+    plane.nr_points = nr_points;
+    return plane;
+}
+
+static bool samePoint(const PointNormal &p1, const PointNormal &p2) {
+    return p1.x == p2.x && p1.y == p2.y && p1.z == p2.z && p1.normal_x == p2.normal_x && p1.normal_y == p2.normal_y &&
+            p1.normal_z == p2.normal_z && p1.rgba == p2.rgba && p1.curvature == p2.curvature;
+}
+
+static void checkSamePlane(const ReconstructedPlane &expected, const ReconstructedPlane &plane, bool with_cloud) {
+    TEST_CHECK(plane.nr_points == expected.nr_points);
+    TEST_CHECK(plane.center_point.x == expected.center_point.x && plane.center_point.y == expected.center_point.y &&
+               plane.center_point.z == expected.center_point.z);
+    TEST_CHECK(plane.plane_coeffs == expected.plane_coeffs);
+    TEST_CHECK(plane.transform == expected.transform);
+    TEST_CHECK(plane.convex_hull_cloud && plane.convex_hull_cloud->points.size() == expected.convex_hull_cloud->points.size());
+    for (size_t i = 0; plane.convex_hull_cloud && i < plane.convex_hull_cloud->points.size(); i++)
+        TEST_CHECK(plane.convex_hull_cloud->points[i].x == expected.convex_hull_cloud->points[i].x &&
+                   plane.convex_hull_cloud->points[i].y == expected.convex_hull_cloud->points[i].y);
+    if (!with_cloud) {
+        TEST_CHECK(!plane.cloud);
+        return;
+    }
+    TEST_CHECK(plane.cloud && plane.cloud->points.size() == expected.nr_points);
+    for (size_t i = 0; plane.cloud && i < plane.cloud->points.size(); i++)
+        TEST_CHECK(samePoint(plane.cloud->points[i], expected.cloud->points[i]));
+}
+
+static void overwriteUint32(const std::string &path, size_t offset, uint32_t value) {
+    std::vector<char> buffer;
+    readFileIntoBuffer(path, buffer);
+    std::memcpy(buffer.data() + offset, &value, sizeof(value));
+    writeBufferToFile(path, buffer);
+}
+
+int main() {
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir);
+    const std::string path = (dir / scene_bundle_filename).string();
+
+    std::map<int, ReconstructedPlane> planes;
+    planes[0] = makePlane(500, 8, 0.0f);
+    planes[3] = makePlane(0, 4, 1.0f); //plane without a cloud
+    planes[7] = makePlane(1, 0, 2.0f);
+    TEST_CHECK(writeSceneBundle(path, planes));
+
+    //round trip
+    std::map<int, ReconstructedPlane> read_planes;
+    TEST_CHECK(readSceneBundle(path, read_planes));
+    TEST_CHECK(read_planes.size() == planes.size());
+    for (auto const &p : planes) {
+        TEST_CHECK(read_planes.count(p.first) == 1);
+        if (read_planes.count(p.first))
+            checkSamePlane(p.second, read_planes[p.first], true);
+    }
+
+    //without clouds only the sizes are read
+    read_planes.clear();
+    TEST_CHECK(readSceneBundle(path, read_planes, false));
+    TEST_CHECK(read_planes.size() == planes.size());
+    for (auto const &p : planes) {
+        if (read_planes.count(p.first))
+            checkSamePlane(p.second, read_planes[p.first], false);
+    }
+
+    //a single cloud is loaded again from the bundle
+    ReconstructedPlane plane = makePlane(0, 0, 0.0f);
+    TEST_CHECK(loadPlaneCloud(dir.string(), 0, plane));
+    TEST_CHECK(plane.cloud && plane.cloud->points.size() == planes[0].nr_points);
+
+    std::vector<char> original;
+    TEST_CHECK(readFileIntoBuffer(path, original));
+
+    //truncated file
+    std::vector<char> truncated(original.begin(), original.begin() + original.size() - 10);
+    writeBufferToFile(path, truncated);
+    read_planes.clear();
+    TEST_CHECK(!readSceneBundle(path, read_planes));
+    TEST_CHECK(read_planes.empty());
+
+    //corrupted counts are rejected before anything is allocated
+    const size_t nr_planes_offset = 4 + sizeof(uint32_t);
+    const size_t first_plane_counts_offset = 4 + 2 * sizeof(uint32_t) + 4 + 3*4 + 4*4 + 16*4; //nr of hull points, width, height
+    writeBufferToFile(path, original);
+    overwriteUint32(path, nr_planes_offset, 0xFFFFFFFF);
+    TEST_CHECK(!readSceneBundle(path, read_planes));
+    writeBufferToFile(path, original);
+    overwriteUint32(path, first_plane_counts_offset, 0x7FFFFFFF);
+    TEST_CHECK(!readSceneBundle(path, read_planes));
+    writeBufferToFile(path, original);
+    overwriteUint32(path, first_plane_counts_offset + 4, 0xFFFFFFFF);
+    overwriteUint32(path, first_plane_counts_offset + 8, 0xFFFFFFFF);
+    TEST_CHECK(!readSceneBundle(path, read_planes));
+    TEST_CHECK(!readSceneBundle(path, read_planes, false));
+
+    //wrong magic
+    writeBufferToFile(path, original);
+    overwriteUint32(path, 0, 0);
+    TEST_CHECK(!readSceneBundle(path, read_planes));
+
+    //a path that cannot be read as a file, the buffer is not resized to a bogus size
+    std::vector<char> buffer;
+    TEST_CHECK(!readFileIntoBuffer(dir.string(), buffer));
+    TEST_CHECK(buffer.empty());
+    TEST_CHECK(!readSceneBundle(dir.string(), read_planes));
+
+    boost::filesystem::remove_all(dir);
+    return TEST_RESULT();
+}
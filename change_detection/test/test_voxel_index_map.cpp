@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "voxel_index_map.h"
+#include "test_helpers.h"
+
+typedef pcl::PointCloud<PointNormal> Cloud;
+
+static void addPoint(Cloud &cloud, float x, float y, float z) {
+    PointNormal pt{};
+    pt.x = x; pt.y = y; pt.z = z;
+    cloud.points.push_back(pt);
+}
+
+static std::vector<int> gatherSorted(const VoxelIndexMap &voxel_map, float x, float y, float z) {
+    PointNormal pt{};
+    pt.x = x; pt.y = y; pt.z = z;
+    std::vector<int> indices;
+    voxel_map.gather(pt, indices);
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+int main() {
+    const float leaf_size = 0.1f;
+    const float inv_leaf_size = 1.0f / leaf_size;
+    Cloud cloud;
+    //voxel 0: two points right below the border to voxel 1
+    const float below_border = 0.0999999f;
+    addPoint(cloud, below_border, 0.05f, 0.05f);
+    addPoint(cloud, below_border, 0.06f, 0.05f);
+    //voxel 1
+    addPoint(cloud, 0.15f, 0.05f, 0.05f);
+    //voxel 3, nothing in voxel 2
+    addPoint(cloud, 0.35f, 0.05f, 0.05f);
+    TEST_CHECK(static_cast<int>(std::floor(below_border * inv_leaf_size)) == 0);
+
+    VoxelIndexMap voxel_map;
+    voxel_map.build(cloud, leaf_size);
+    TEST_CHECK(!voxel_map.empty());
+
+    //the centroids of the voxels
+    TEST_CHECK(gatherSorted(voxel_map, below_border, 0.055f, 0.05f) == std::vector<int>({0, 1}));
+    TEST_CHECK(gatherSorted(voxel_map, 0.15f, 0.05f, 0.05f) == std::vector<int>({2}));
+    TEST_CHECK(gatherSorted(voxel_map, 0.35f, 0.05f, 0.05f) == std::vector<int>({3}));
+
+    //the centroid of voxel 0 rounded into voxel 1, which is not empty
+    const float above_border = 0.1000001f;
+    TEST_CHECK(static_cast<int>(std::floor(above_border * inv_leaf_size)) == 1);
+    TEST_CHECK(gatherSorted(voxel_map, above_border, 0.055f, 0.05f) == std::vector<int>({0, 1}));
+
+    //a point in an empty voxel, away from any border
+    PointNormal empty_pt{};
+    empty_pt.x = 0.25f; empty_pt.y = 0.05f; empty_pt.z = 0.05f;
+    std::vector<int> indices;
+    TEST_CHECK(!voxel_map.gather(empty_pt, indices));
+    TEST_CHECK(indices.empty());
+
+    //non-finite points are not in any voxel
+    PointNormal nan_pt{};
+    nan_pt.x = std::nanf(""); nan_pt.y = 0.05f; nan_pt.z = 0.05f;
+    TEST_CHECK(!voxel_map.gather(nan_pt, indices));
+
+    return TEST_RESULT();
+}
@@ -26,6 +26,7 @@
 #include <pcl/filters/voxel_grid.h>
 
 #include <settings.h>
+#include <result_manifest.h>
 
 typedef pcl::PointXYZRGBL PointLabel;
 
@@ -306,17 +307,31 @@ int main(int argc, char* argv[])
         std::vector<std::string> reduced_ref_matched_removed, reduced_curr_matched_novel, reduced_matched_moved, reduced_matched_static;
 
         pcl::PointCloud<PointLabel>::Ptr novel_obj_cloud(new pcl::PointCloud<PointLabel>);
-        readInput(scene_comp.result_path + "/" + c_new_obj_name, novel_obj_cloud);
         pcl::PointCloud<PointLabel>::Ptr removed_obj_cloud(new pcl::PointCloud<PointLabel>);
-        readInput(scene_comp.result_path + "/" + r_rem_obj_name, removed_obj_cloud);
         pcl::PointCloud<PointLabel>::Ptr r_moved_obj_cloud(new pcl::PointCloud<PointLabel>);
-        readInput(scene_comp.result_path + "/" + r_dis_obj_name, r_moved_obj_cloud);
         pcl::PointCloud<PointLabel>::Ptr c_moved_obj_cloud(new pcl::PointCloud<PointLabel>);
-        readInput(scene_comp.result_path + "/" + c_dis_obj_name, c_moved_obj_cloud);
         pcl::PointCloud<PointLabel>::Ptr r_static_obj_cloud(new pcl::PointCloud<PointLabel>);
-        readInput(scene_comp.result_path + "/" + r_static_obj_name, r_static_obj_cloud);
         pcl::PointCloud<PointLabel>::Ptr c_static_obj_cloud(new pcl::PointCloud<PointLabel>);
-        readInput(scene_comp.result_path + "/" + c_static_obj_name, c_static_obj_cloud);
+        std::string manifest_path = scene_comp.result_path + "/" + result_manifest_filename;
+        ResultManifest manifest;
+        if (boost::filesystem::exists(manifest_path) && readResultManifest(manifest_path, manifest)) {
+            //all results of the comparison are in one file
+            ManifestResultClouds result_clouds = extractResultClouds(manifest);
+            novel_obj_cloud = result_clouds.curr_new;
+            removed_obj_cloud = result_clouds.ref_removed;
+            r_moved_obj_cloud = result_clouds.ref_displaced;
+            c_moved_obj_cloud = result_clouds.curr_displaced;
+            r_static_obj_cloud = result_clouds.ref_static;
+            c_static_obj_cloud = result_clouds.curr_static;
+        } else {
+            //results of older runs without manifest
+            readInput(scene_comp.result_path + "/" + c_new_obj_name, novel_obj_cloud);
+            readInput(scene_comp.result_path + "/" + r_rem_obj_name, removed_obj_cloud);
+            readInput(scene_comp.result_path + "/" + r_dis_obj_name, r_moved_obj_cloud);
+            readInput(scene_comp.result_path + "/" + c_dis_obj_name, c_moved_obj_cloud);
+            readInput(scene_comp.result_path + "/" + r_static_obj_name, r_static_obj_cloud);
+            readInput(scene_comp.result_path + "/" + c_static_obj_name, c_static_obj_cloud);
+        }
 
 
         //combine all detected results and compare it to GT
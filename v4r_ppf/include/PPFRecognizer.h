@@ -75,6 +75,9 @@ class PPFRecognizer {
   typename v4r::HypothesisVerification<PointT>::Ptr hv_;                            ///< hypothesis verification object
 
   bf::path models_dir_;
+  std::vector<std::pair<std::string, typename pcl::PointCloud<PointTWithNormal>::ConstPtr>>
+      model_clouds_;                ///< object models given in memory (see setModelClouds)
+  bool use_model_clouds_ = false;  ///< if true, model_clouds_ are used instead of the models in models_dir_
 
   PPFRecognizerParameter param_;  ///< parameters for object recognition
 
@@ -169,6 +172,18 @@ class PPFRecognizer {
     models_dir_ = dir;
   }
 
+  /**
+   * @brief set object models directly from memory instead of loading them from the models directory. If a models
+   * directory is set as well, it is only used to cache the trained model search of each object model (in a folder named
+   * after the model, which is created if needed).
+   * @param model_clouds model identity and full resolution point cloud (with normals) of each object model
+   */
+  void setModelClouds(
+      const std::vector<std::pair<std::string, typename pcl::PointCloud<PointTWithNormal>::ConstPtr>> &model_clouds) {
+    model_clouds_ = model_clouds;
+    use_model_clouds_ = true;
+  }
+
   /**
    * @brief getElapsedTimes
    * @return compuation time measurements for various components
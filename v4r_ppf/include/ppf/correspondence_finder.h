@@ -39,6 +39,7 @@
 
 #pragma once
 
+#include <cstring>
 #include <vector>
 
 #include <Eigen/Geometry>
@@ -48,32 +49,13 @@
 #include <pcl/search/kdtree.h>
 #include <pcl/search/organized.h>
 
+#include <v4r/common/color_conversion.h>
+
 #include <ppf/correspondence.h>
 #include <ppf/model_search.h>
 
 namespace ppf {
 
-Eigen::Vector3f float2lab(float col) {
-    //from float to RGB
-    Eigen::Vector3i rgb;
-    int32_t col_int = reinterpret_cast<int32_t&>(col);
-    rgb[0] = (col_int >> 16) & 0x0000ff;
-    rgb[1] = (col_int >> 8)  & 0x0000ff;
-    rgb[2] = (col_int)     & 0x0000ff;
-
-    cv::Mat rgb_cv (1,1, CV_8UC3);  //this has some information loss because Lab values are also just uchar and not float
-    rgb_cv.at<cv::Vec3b>(0,0)[0] = rgb[0];
-    rgb_cv.at<cv::Vec3b>(0,0)[1] = rgb[1];
-    rgb_cv.at<cv::Vec3b>(0,0)[2] = rgb[2];
-    cv::Mat lab_cv;
-    cv::cvtColor(rgb_cv, lab_cv, CV_RGB2Lab);
-
-    Eigen::Vector3f lab; //from opencv lab to orig lab definition
-    lab << lab_cv.at<cv::Vec3b>(0,0)[0] / 2.55f, lab_cv.at<cv::Vec3b>(0,0)[1] - 128.f, lab_cv.at<cv::Vec3b>(0,0)[2] - 128.f;
-    return lab;
-}
-
-
 /// Given a scene point cloud and a PPF model search object, this class finds correspondences between scene points and
 /// model points.
 ///
@@ -109,18 +91,15 @@ class CorrespondenceFinder {
     else
       scene_search_tree_.reset(new pcl::search::KdTree<PointT>);
     scene_search_tree_->setInputCloud(scene_);
+    updateSceneLabColors();
   }
 
   /// Set search object for querying model local coordinates of point pairs.
   void setModelSearch(const ModelSearch::ConstPtr& model_search) {
     model_search_ = model_search;
     const std::vector<float>model_point_colors = model_search_->getModelPointColors();
-    if (model_point_colors.size() != 0) {
-        model_lab_cols_.resize(model_point_colors.size());
-        for (size_t i = 0; i < model_point_colors.size(); i++) {
-            model_lab_cols_[i] = float2lab(model_point_colors[i]);
-        }
-    }
+    if (model_point_colors.size() != 0)
+        model_lab_cols_ = floatColorsToLab(model_point_colors);
   }
 
   /// Find correspondences for a scene point with a given index.
@@ -151,6 +130,7 @@ class CorrespondenceFinder {
         check_col_before_voting_ = check_color;
         color_inlier_thr_ = color_inlier_thr_;
       }
+      updateSceneLabColors();
   }
 
  private:
@@ -161,8 +141,31 @@ class CorrespondenceFinder {
   size_t min_votes_ = 3;
   size_t num_angular_bins_ = 30;
   std::vector<Eigen::Vector3f> model_lab_cols_;
+  std::vector<Eigen::Vector3f> scene_lab_cols_;  ///< only filled if the colour is checked before voting
   bool check_col_before_voting_ = false;
   float color_inlier_thr_ = 30;
+
+  /// Lab colours of colours packed into floats (PCL rgb field), converted in one batch.
+  static std::vector<Eigen::Vector3f> floatColorsToLab(const std::vector<float>& cols) {
+    std::vector<uint32_t> rgb(cols.size());
+    if (!cols.empty())
+      std::memcpy(rgb.data(), cols.data(), cols.size() * sizeof(float));
+    std::vector<Eigen::Vector3f> lab(cols.size());
+    v4r::convertRGBToLab(rgb.data(), rgb.size(), lab.data());
+    return lab;
+  }
+
+  /// Every scene point is the first or second point of many pairs in find(), so its Lab colour is computed once for
+  /// the whole scene.
+  void updateSceneLabColors() {
+    scene_lab_cols_.clear();
+    if (!check_col_before_voting_ || !scene_)
+      return;
+    std::vector<float> scene_cols(scene_->size());
+    for (size_t i = 0; i < scene_->size(); i++)
+      scene_cols[i] = scene_->points[i].rgb;
+    scene_lab_cols_ = floatColorsToLab(scene_cols);
+  }
 };
 
 }  // namespace ppf
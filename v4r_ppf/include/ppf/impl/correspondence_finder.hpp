@@ -87,14 +87,10 @@ Correspondence::Vector CorrespondenceFinder<PointT>::find(uint32_t scene_index,
             hv.castVote({lc.model_point_index1, lc.model_point_index2, lc.rotation_angle - alpha_s});
     }
     else {
-        const float *c1; const float *c2;
         Eigen::Vector3f c1_lab, c2_lab;
         if (check_col_before_voting_) { //this is set to false if the cloud does not contain color information
-            c1 = &scene_->at(scene_index).rgb;
-            c2 = &scene_->at(index).rgb;
-
-            c1_lab = float2lab(*c1);
-            c2_lab = float2lab(*c2);
+            c1_lab = scene_lab_cols_[scene_index];
+            c2_lab = scene_lab_cols_[index];
         }
 
         const auto& lcs = model_search_->find(p1, n1, p2, n2);
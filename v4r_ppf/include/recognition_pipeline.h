@@ -51,6 +51,7 @@
 
 // #include <v4r/common/pcl_visualization_utils.h>   //@TODO: remove if not needed
 #include <v4r/common/point_types.h>
+#include <v4r/common/trace.h>
 // #include <v4r/config.h>                           //@TODO: remove if not needed
 #include <v4r/recognition/object_hypothesis.h>
 #include <v4r/recognition/source.h>
@@ -88,7 +89,7 @@ class RecognitionPipeline {
   Eigen::Matrix4f transform_to_world_;  ///< rigid transform that aligns camera to world reference frame
   bool transform_to_world_set_;
 
-  static std::vector<std::pair<std::string, float>> elapsed_time_;  ///< to measure performance
+  std::vector<std::pair<std::string, float>> elapsed_time_;  ///< to measure performance
 
   virtual void doInit(const bf::path &trained_dir, bool retrain,
                       const std::vector<std::string> &object_instances_to_load) = 0;
@@ -98,9 +99,13 @@ class RecognitionPipeline {
   class StopWatch {
     std::string desc_;
     boost::posix_time::ptime start_time_;
+    trace::Span span_;  ///< records the scope in the trace if tracing is enabled
+    std::vector<std::pair<std::string, float>> &elapsed_time_;  ///< measurements of the pipeline the time is added to
 
    public:
-    StopWatch(const std::string &desc) : desc_(desc), start_time_(boost::posix_time::microsec_clock::local_time()) {}
+    StopWatch(const std::string &desc, std::vector<std::pair<std::string, float>> &elapsed_time)
+    : desc_(desc), start_time_(boost::posix_time::microsec_clock::local_time()), span_(desc_),
+      elapsed_time_(elapsed_time) {}
 
     ~StopWatch();
   };
@@ -211,7 +216,4 @@ class RecognitionPipeline {
                  const boost::optional<Eigen::Matrix4f> &camera_pose = boost::none);
 };
 
-template <typename PointT>
-std::vector<std::pair<std::string, float>> RecognitionPipeline<PointT>::elapsed_time_;
-
 }  // namespace v4r
@@ -0,0 +1,174 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+
+/**
+ * @file bitset_clique_enumerator.h
+ * @brief Enumeration of the maximal cliques of a correspondence graph on a bitset adjacency matrix, used by
+ * GraphGeometricConsistencyGrouping.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/tuple/tuple.hpp>
+
+namespace v4r {
+
+/**
+ * @brief dense adjacency matrix of an undirected graph storing one bit per vertex pair. Row v holds the neighbours
+ * of vertex v, which allows set operations on neighbourhoods 64 vertices at a time.
+ */
+class BitsetAdjacency {
+ public:
+  using Word = uint64_t;
+
+  explicit BitsetAdjacency(size_t num_vertices)
+  : num_vertices_(num_vertices), num_words_((num_vertices + 63) / 64), bits_(num_vertices * num_words_, 0) {}
+
+  /// @brief adjacency of a boost graph with vecS vertex storage (vertex descriptors are the indices)
+  template <typename Graph>
+  static BitsetAdjacency fromGraph(const Graph &g) {
+    BitsetAdjacency adj(num_vertices(g));
+    typename boost::graph_traits<Graph>::edge_iterator edgeIt, edgeEnd;
+    for (boost::tie(edgeIt, edgeEnd) = edges(g); edgeIt != edgeEnd; ++edgeIt)
+      adj.addEdge(source(*edgeIt, g), target(*edgeIt, g));
+    return adj;
+  }
+
+  /// @brief adds the undirected edge (a, b), self loops are ignored
+  void addEdge(size_t a, size_t b) {
+    if (a != b) {
+      bits_[a * num_words_ + (b >> 6)] |= Word(1) << (b & 63);
+      bits_[b * num_words_ + (a >> 6)] |= Word(1) << (a & 63);
+    }
+  }
+
+  bool hasEdge(size_t a, size_t b) const {
+    return (row(a)[b >> 6] >> (b & 63)) & 1;
+  }
+
+  size_t degree(size_t v) const {
+    size_t d = 0;
+    for (size_t w = 0; w < num_words_; w++)
+      d += __builtin_popcountll(row(v)[w]);
+    return d;
+  }
+
+  const Word *row(size_t v) const {
+    return bits_.data() + v * num_words_;
+  }
+
+  size_t numVertices() const {
+    return num_vertices_;
+  }
+
+  size_t numWords() const {
+    return num_words_;
+  }
+
+ private:
+  size_t num_vertices_;
+  size_t num_words_;
+  std::vector<Word> bits_;
+};
+
+/**
+ * @brief enumerates all maximal cliques with at least a minimum number of vertices (Bron-Kerbosch with Tomita
+ * pivoting on bitsets). Branches are pruned when a greedy colouring of the candidate set shows that no clique of the
+ * required size can be reached. The search stops after a fixed number of search nodes or when a time limit is
+ * exceeded, whichever comes first. Cliques are reported in the same order in both cases, so a truncated result is a
+ * prefix of the complete one.
+ */
+class BitsetCliqueEnumerator {
+ public:
+  using Word = BitsetAdjacency::Word;
+
+  /**
+   * @param adj graph
+   * @param min_clique_size only maximal cliques with at least this many vertices are reported
+   * @param max_search_nodes maximum number of search nodes visited
+   * @param max_time_ms maximum time in milliseconds spent on the search
+   */
+  BitsetCliqueEnumerator(const BitsetAdjacency &adj, size_t min_clique_size,
+                         size_t max_search_nodes = std::numeric_limits<size_t>::max(),
+                         double max_time_ms = std::numeric_limits<double>::infinity())
+  : adj_(adj), min_clique_size_(min_clique_size), max_search_nodes_(max_search_nodes), max_time_ms_(max_time_ms) {}
+
+  /**
+   * @brief enumerate the cliques
+   * @param[out] cliques maximal cliques (vertex ids) with at least min_clique_size vertices
+   * @return false if the search was stopped because the node budget or the time limit was exhausted
+   */
+  bool compute(std::vector<std::vector<size_t>> &cliques);
+
+  size_t getNumVisitedNodes() const {
+    return visited_nodes_;
+  }
+
+  /// @brief true if the last search was stopped by the time limit rather than by the node budget
+  bool timedOut() const {
+    return timed_out_;
+  }
+
+ private:
+  const BitsetAdjacency &adj_;
+  size_t min_clique_size_;
+  size_t max_search_nodes_;
+  double max_time_ms_;
+  std::vector<std::vector<size_t>> *cliques_ = nullptr;
+  std::vector<size_t> clique_;                  ///< current clique (R)
+  std::vector<std::vector<Word>> p_stack_;     ///< candidate set (P) for each recursion depth
+  std::vector<std::vector<Word>> x_stack_;     ///< excluded set (X) for each recursion depth
+  std::vector<Word> colour_uncoloured_, colour_candidates_;
+  size_t visited_nodes_ = 0;
+  bool stopped_ = false;
+  bool timed_out_ = false;
+  double start_time_ms_ = 0;
+
+  bool colouringAllowsClique(const std::vector<Word> &P, size_t needed);
+  void expand(size_t depth);
+};
+
+}  // namespace v4r
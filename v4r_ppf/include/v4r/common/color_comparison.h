@@ -70,6 +70,18 @@ float computeCIE94_DEFAULT(const Eigen::Vector3f &a, const Eigen::Vector3f &b);
 
 float computeCIEDE2000(const Eigen::Vector3f &a, const Eigen::Vector3f &b);
 
+/**
+ * @brief batch versions of the colour differences above in single precision. Each row of a and b is a Lab colour
+ * (n x 3, every channel is a contiguous column), diff(i) is the difference of row i of a and row i of b. With a single
+ * colour a, diff(i) is the difference of a and row i of b.
+ */
+void computeCIE76(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff);
+void computeCIE76(const Eigen::Vector3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff);
+void computeCIE94_DEFAULT(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff);
+void computeCIE94_DEFAULT(const Eigen::Vector3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff);
+void computeCIEDE2000(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff);
+void computeCIEDE2000(const Eigen::Vector3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff);
+
 enum class ColorComparisonMethod { CIE76, CIE94, CIEDE2000, CUSTOM };
 
 std::istream &operator>>(std::istream &in, ColorComparisonMethod &dm);
@@ -0,0 +1,94 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+
+/**
+ * @file color_conversion.h
+ * @brief Batch colour space conversions of packed RGB colours (0x00RRGGBB, like the rgba field of PCL points). Every
+ * stage that compares colours converts whole clouds at once instead of calling a conversion per point. The loops
+ * work on blocks of structure-of-arrays data without branches, so the compiler vectorizes them. The sRGB gamma step
+ * of the Lab conversion is a lookup table.
+ *
+ * \code
+ * std::vector<Eigen::Vector3f> lab(cloud.size());
+ * v4r::convertRGBToLab(rgba.data(), rgba.size(), lab.data());
+ * \endcode
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <Eigen/Core>
+
+namespace v4r {
+
+/**
+ * @brief RGB to CIE Lab (D65 white point, sRGB gamma). L is in [0, 100], a and b are around 0. These are the values
+ * of OpenCV's floating point conversion, without the quantization of its 8 bit conversion.
+ * @param rgb n packed colours
+ * @param L, a, b output arrays with n elements each
+ */
+void convertRGBToLab(const uint32_t *rgb, size_t n, float *L, float *a, float *b);
+
+/**
+ * @brief same as above, one Lab vector per colour (e.g. as input of computeCIEDE2000)
+ */
+void convertRGBToLab(const uint32_t *rgb, size_t n, Eigen::Vector3f *lab);
+
+/**
+ * @brief RGB to HSV. Hue is in degrees [0, 360), saturation and value in [0, 1]. Black and grey colours get hue 0.
+ * @param h, s, v output arrays with n elements each
+ */
+void convertRGBToHSV(const uint32_t *rgb, size_t n, float *h, float *s, float *v);
+
+/**
+ * @brief same as above, one (h, s, v) vector per colour
+ */
+void convertRGBToHSV(const uint32_t *rgb, size_t n, Eigen::Vector3f *hsv);
+
+/**
+ * @brief packs 8 bit channels like the rgba field of PCL points
+ */
+inline uint32_t packRGB(int r, int g, int b) {
+  return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
+}
+
+}  // namespace v4r
@@ -66,9 +66,13 @@ struct GraphGeometricConsistencyGroupingParameter {
   bool check_normals_orientation_ = true;
   double max_time_allowed_cliques_comptutation_ = 100.;  ///< max time allowed for finding maximal cliques procedure
                                                          ///< during grouping correspondences
+  size_t max_clique_search_nodes_ = 1000000;  ///< max number of search nodes visited by the maximal cliques
+                                              ///< procedure during grouping correspondences. Unlike the time limit,
+                                              ///< this does not depend on the machine load. The search stops at
+                                              ///< whichever limit is reached first
   size_t min_cliques_to_proceed_ =
       10000;  ///< if finding maximal cliques procedure returns less than this defined value before
-              ///< timeout, correspondences will be no longer computed by this graph based approach
+              ///< reaching one of its limits, correspondences will be no longer computed by this graph based approach
               ///< but by the simpler greedy correspondence grouping algorithm
   float ransac_threshold_ = 0.015f;    ///< maximum inlier threshold for RANSAC used for correspondence rejection
   int ransac_max_iterations_ = 10000;  ///< maximum iterations for RANSAC used for correspondence rejection (0... to
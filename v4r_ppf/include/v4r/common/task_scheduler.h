@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+
+/**
+ * @file task_scheduler.h
+ * @brief Process-wide work-stealing task scheduler. All parallel stages submit their work to one pool whose size is
+ * capped at the number of cores, so nested parallel loops (e.g. a parallel loop inside a task of another parallel
+ * loop) do not oversubscribe the machine. A thread waiting for its tasks executes pending tasks of the same task group
+ * (and of the groups nested in them) itself, which keeps nested loops efficient and free of deadlocks. It never runs
+ * unrelated tasks, because it may hold locks those tasks need as well.
+ *
+ * \code
+ * v4r::parallelFor(0, cloud->size(), [&](size_t i) {
+ *   // ... process point i
+ * });
+ *
+ * v4r::TaskGroup group;
+ * group.run([&] { computeA(); });
+ * computeB();
+ * group.wait();
+ * \endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace v4r {
+
+class TaskGroup;
+
+class TaskScheduler {
+ public:
+  /**
+   * @param num_threads total number of threads executing tasks, including the thread waiting for them. 0 uses the
+   * number of hardware threads.
+   */
+  explicit TaskScheduler(size_t num_threads = 0);
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /**
+   * @brief scheduler shared by all stages of the process. Its size can be set with the environment variable
+   * V4R_NUM_THREADS (default: number of hardware threads).
+   */
+  static TaskScheduler &global();
+
+  /// @return number of threads executing tasks (worker threads + the waiting thread)
+  size_t numThreads() const {
+    return workers_.size() + 1;
+  }
+
+  /**
+   * @brief queues a task. Tasks submitted from a worker go to its own queue (and are executed by it unless
+   * stolen by an idle worker), tasks from other threads are distributed round robin among the workers.
+   */
+  void submit(std::function<void()> &&task, const TaskGroup *group = nullptr);
+
+  /**
+   * @brief executes one pending task of this scheduler in the calling thread
+   * @param group if set, only a task of this group or of a group nested in its tasks is executed
+   * @return false if there was no such pending task
+   */
+  bool runPendingTask(const TaskGroup *group = nullptr);
+
+ private:
+  struct Task {
+    std::function<void()> fn;
+    const TaskGroup *group;
+  };
+
+  struct WorkQueue {
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+  };
+
+  void workerLoop(size_t id);
+  bool popTask(size_t first_queue, const TaskGroup *group, std::function<void()> &task);
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;  ///< one queue per worker, the owner pops LIFO, thieves steal FIFO
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> num_pending_;  ///< number of queued tasks not yet taken by any thread
+  std::atomic<size_t> next_queue_;   ///< round robin counter for tasks submitted by non-worker threads
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_up_;
+  bool stop_;
+};
+
+/**
+ * @brief set of tasks that can be waited for. wait() executes pending tasks of this group and of the groups created
+ * inside its tasks while the tasks of this group are still running. If there is none, it blocks until a task of the
+ * group finishes. The first exception thrown by a task is rethrown by wait().
+ */
+class TaskGroup {
+ public:
+  /// a group created inside a task of another group is nested in that group
+  explicit TaskGroup(TaskScheduler &scheduler = TaskScheduler::global());
+
+  /// waits for all tasks, an exception of a task is dropped here. Call wait() to receive it.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  void run(std::function<void()> task);
+
+  void wait();
+
+  /// @return true if this is the given group or a group nested (at any depth) in its tasks
+  bool isNestedIn(const TaskGroup *group) const;
+
+ private:
+  void waitUntilDone();
+
+  TaskScheduler &scheduler_;
+  const TaskGroup *parent_;  ///< group of the task that created this group, nullptr if created outside of any task
+  std::atomic<size_t> num_running_;
+  std::mutex done_mutex_;
+  std::condition_variable task_done_;  ///< notified whenever a task of the group finishes
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+/**
+ * @brief calls f(chunk_begin, chunk_end) for consecutive chunks covering [begin, end) in parallel. Useful if each
+ * chunk accumulates into local buffers that are merged once per chunk.
+ * @param grain_size minimum number of indices per chunk. 0 splits the range into a few chunks per thread.
+ */
+template <typename Func>
+void parallelForChunks(size_t begin, size_t end, Func f, size_t grain_size = 0,
+                       TaskScheduler &scheduler = TaskScheduler::global()) {
+  if (begin >= end)
+    return;
+  const size_t n = end - begin;
+  const size_t num_threads = scheduler.numThreads();
+  const size_t chunk_size = std::max<size_t>(std::max<size_t>(grain_size, 1), n / (4 * num_threads));
+  if (num_threads == 1 || n <= chunk_size) {
+    f(begin, end);
+    return;
+  }
+
+  TaskGroup group(scheduler);
+  // the first chunk is executed by the calling thread
+  for (size_t chunk_begin = begin + chunk_size; chunk_begin < end; chunk_begin += chunk_size) {
+    const size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+    group.run([&f, chunk_begin, chunk_end] { f(chunk_begin, chunk_end); });
+  }
+  f(begin, std::min(end, begin + chunk_size));
+  group.wait();
+}
+
+/**
+ * @brief calls f(i) for every i in [begin, end) in parallel (replacement for "#pragma omp parallel for")
+ */
+template <typename Func>
+void parallelFor(size_t begin, size_t end, Func f, size_t grain_size = 0,
+                 TaskScheduler &scheduler = TaskScheduler::global()) {
+  parallelForChunks(begin, end,
+                    [&f](size_t chunk_begin, size_t chunk_end) {
+                      for (size_t i = chunk_begin; i < chunk_end; i++)
+                        f(i);
+                    },
+                    grain_size, scheduler);
+}
+
+}  // namespace v4r
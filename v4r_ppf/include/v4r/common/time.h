@@ -40,6 +40,8 @@
 #pragma once
 #include <string>
 
+#include <v4r/common/trace.h>
+
 #ifndef Q_MOC_RUN
 #include <boost/date_time/posix_time/posix_time.hpp>
 #endif
@@ -100,9 +102,10 @@ class  StopWatch {
 class  ScopeTime : public StopWatch {
  private:
   std::string title_;
+  trace::Span span_;  ///< records the scope in the trace if tracing is enabled
 
  public:
-  ScopeTime(const std::string& title = "") : StopWatch(), title_(title) {}
+  ScopeTime(const std::string& title = "") : StopWatch(), title_(title), span_(title_) {}
 
   ~ScopeTime();
 };
@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+
+/**
+ * @file trace.h
+ * @brief Low-overhead tracing of nested scopes. Each thread records its spans into its own ring buffer, which can be
+ * written out as Chrome trace JSON (load it in chrome://tracing or https://ui.perfetto.dev). When tracing is
+ * disabled, a span only costs a relaxed atomic load.
+ *
+ * \code
+ * v4r::trace::enable();
+ * {
+ *   V4R_TRACE_SCOPE("recognition");
+ *   V4R_TRACE_SCOPE_DYNAMIC("model " + std::to_string(model_id));
+ *   // ... perform calculation here
+ * }
+ * v4r::trace::writeChromeTrace("trace.json");
+ * \endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace v4r {
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> enabled;
+
+/// @brief nanoseconds since the tracing epoch (steady clock)
+int64_t now();
+
+/// @brief records a finished span in the ring buffer of the calling thread
+void record(const char *category, const char *name, std::string &&dynamic_name, int64_t start_ns, int64_t end_ns);
+}  // namespace detail
+
+/**
+ * @return true if spans are currently being recorded
+ */
+inline bool isEnabled() {
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief starts recording spans
+ * @param events_per_thread capacity of each thread's ring buffer. Once full, the oldest spans of that thread are
+ * overwritten. Only applies to threads that did not record any span yet.
+ */
+void enable(size_t events_per_thread = 1 << 16);
+
+/**
+ * @brief stops recording spans. Already recorded spans are kept until clear() is called.
+ */
+void disable();
+
+/**
+ * @brief discards all recorded spans of all threads
+ */
+void clear();
+
+/**
+ * @brief writes all recorded spans as Chrome trace event JSON
+ * @param filename output file
+ * @return true on success
+ */
+bool writeChromeTrace(const std::string &filename);
+
+/**
+ * @brief RAII span covering the lifetime of the object. The name given as const char* must outlive the span (i.e.
+ * usually a string literal); a std::string name is only copied if tracing is enabled.
+ */
+class Span {
+ public:
+  explicit Span(const char *name, const char *category = "v4r")
+  : category_(category), name_(name), start_(isEnabled() ? detail::now() : -1) {}
+
+  explicit Span(const std::string &name, const char *category = "v4r")
+  : category_(category), name_(nullptr), start_(-1) {
+    if (isEnabled()) {
+      dynamic_name_ = name;
+      start_ = detail::now();
+    }
+  }
+
+  ~Span() {
+    if (start_ >= 0)
+      detail::record(category_, name_, std::move(dynamic_name_), start_, detail::now());
+  }
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+
+ private:
+  const char *category_;
+  const char *name_;
+  std::string dynamic_name_;
+  int64_t start_;  ///< start time in ns, negative if tracing was disabled when the span was created
+};
+
+}  // namespace trace
+}  // namespace v4r
+
+#define V4R_TRACE_CONCAT_IMPL(a, b) a##b
+#define V4R_TRACE_CONCAT(a, b) V4R_TRACE_CONCAT_IMPL(a, b)
+
+/// traces the enclosing scope with the given name (string literal or std::string)
+#define V4R_TRACE_SCOPE(...) ::v4r::trace::Span V4R_TRACE_CONCAT(v4r_trace_span_, __LINE__)(__VA_ARGS__)
+
+/// traces the enclosing scope with a name built at runtime, e.g. "pair " + std::to_string(id). The name expression is
+/// only evaluated if tracing is enabled, so the string concatenations cost nothing otherwise.
+#define V4R_TRACE_SCOPE_DYNAMIC(name_expr)                                                                           \
+  ::v4r::trace::Span V4R_TRACE_CONCAT(v4r_trace_span_, __LINE__)(::v4r::trace::isEnabled() ? std::string(name_expr) \
+                                                                                           : std::string())
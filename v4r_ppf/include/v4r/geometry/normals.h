@@ -64,7 +64,7 @@ struct NormalEstimatorParameter {
   enum class Method { PCL_DEFAULT, PCL_INTEGRAL_NORMAL, Z_ADAPTIVE };
 
   float radius_ = 0.02f;                           ///< smoothings size.
-  bool use_omp_ = true;                            ///< if true, uses openmp for surface normal estimation
+  bool use_omp_ = true;                            ///< if true, estimates surface normals in parallel
   float smoothing_size_ = 10.f;                    ///< smoothings size.
   float max_depth_change_factor_ = 20.f * 0.001f;  ///<  depth change threshold for computing object borders
   bool use_depth_depended_smoothing_ = true;       ///< use depth depended smoothing
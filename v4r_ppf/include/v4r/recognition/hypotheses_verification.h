@@ -148,7 +148,7 @@ class HypothesisVerification {
 
   std::vector<std::vector<PtFitness>> scene_pts_explained_solution_;
 
-  static std::vector<std::pair<std::string, float>>
+  std::vector<std::pair<std::string, float>>
       elapsed_time_;  ///< measurements of computation times for various components
 
   struct Solution {
@@ -490,7 +490,4 @@ class HypothesisVerification {
   }
 };
 
-template <typename PointT>
-std::vector<std::pair<std::string, float>> HypothesisVerification<PointT>::elapsed_time_;
-
 }  // namespace v4r
@@ -49,6 +49,11 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/serialization/vector.hpp>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <glog/logging.h>
 
 #include <pcl/common/centroid.h>
 #include <pcl/point_cloud.h>
@@ -143,6 +148,10 @@ class Model {
     (void)version;
     ar &class_;
     ar &id_;
+    // the cluster properties are only computed once the model is assembled
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
+    CHECK(cluster_props_) << "Object model " << id_ << " has to be initialized before it is serialized";
     ar &*cluster_props_;
   }
 
@@ -153,25 +162,51 @@ class Model {
    * avoid additional computational cost in extracting cloud and normals separately from the cloud.
    */
 
-  mutable typename std::map<int, typename pcl::PointCloud<PointTWithNormal>::ConstPtr>
-      voxelized_assembled_;  ///< cached point clouds of object models downsampled to a specific resolution in
-                             ///< millimeter (for speed-up purposes)
+  /// downsampling method, resolution (micrometer) and angular threshold (millidegree) of a downsampled model
+  using DownsamplingKey = std::tuple<int, long, long>;
+
+  mutable std::map<DownsamplingKey, typename pcl::PointCloud<PointTWithNormal>::ConstPtr>
+      voxelized_assembled_;  ///< cached point clouds of object models downsampled with specific parameters (for
+                             ///< speed-up purposes)
+  mutable std::mutex voxelized_assembled_mutex_;  ///< guards voxelized_assembled_ and assembled_generation_
+  mutable size_t assembled_generation_ = 0;       ///< incremented by invalidateAssembled(), a downsampled cloud is only
+                                                  ///< cached if the model did not change while it was computed
+
+  bf::path model_filename_;           ///< path to the 3D model given to initialize()
+  typename pcl::PointCloud<PointTWithNormal>::ConstPtr
+      model_cloud_;                    ///< 3D model given to initialize() directly (takes precedence over model_filename_)
+  NormalEstimatorParameter ne_param_;  ///< normal estimation parameters given to initialize()
+  bool initialize_requested_ = false;  ///< true once initialize() was called
+  mutable std::mutex assembled_mutex_;  ///< guards lazy creation of the members below
+  mutable bool assembled_ = false;      ///< true once the members below have been computed
+
+  mutable typename pcl::PointCloud<PointTWithNormal>::ConstPtr all_assembled_;  ///< full resolution object model
+  mutable typename pcl::PointCloud<PointTWithNormal>::Ptr convex_hull_points_;  ///< convex hull of object model
+  mutable Eigen::Vector4f minPoint_ = Eigen::Vector4f::Zero();  ///< defines the 3D bounding box of the object model
+  mutable Eigen::Vector4f maxPoint_ = Eigen::Vector4f::Zero();  ///< defines the 3D bounding box of the object model
+  mutable Cluster::Ptr cluster_props_;  ///< elongation of the object model along the three principal
+                                        ///< axes. First element corresponds to largest elongation,
+                                        ///< third element to smallest.
+  mutable float diameter_ = 0.f;  ///< model diameter in meter (maximum distance between two points of the object)
+
+  /**
+   * @brief loads (or creates from the training views) the full resolution 3D model and computes its derived
+   * properties (bounding box, convex hull, diameter, principal axes) if not done yet. Requires assembled_mutex_ to be
+   * locked by the caller.
+   */
+  void assemble() const;
 
-  typename pcl::PointCloud<PointTWithNormal>::ConstPtr all_assembled_;  ///< full resolution object model
-  typename pcl::PointCloud<PointTWithNormal>::Ptr convex_hull_points_;  ///< convex hull of object model
+  /**
+   * @brief loads the 3D model from model_filename_ or creates it by accumulating the training views
+   */
+  typename pcl::PointCloud<PointTWithNormal>::Ptr loadOrCreateModelCloud() const;
 
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   std::vector<typename TrainingView<PointT>::Ptr> views_;
   std::string class_, id_;
-  Eigen::Vector4f minPoint_;  ///< defines the 3D bounding box of the object model
-  Eigen::Vector4f maxPoint_;  ///< defines the 3D bounding box of the object model
   ModelProperties properties_;
-  Cluster::Ptr cluster_props_;  ///< elongation of the object model along the three principal
-                                ///< axes. First element corresponds to largest elongation,
-                                ///< third element to smallest.
-  float diameter_ = 0.f;        ///< model diameter in meter (maximum distance between two points of the object)
 
   Model() {}
 
@@ -185,8 +220,15 @@ class Model {
    */
   void addTrainingView(const typename TrainingView<PointT>::Ptr tv) {
     views_.push_back(tv);
+    invalidateAssembled();
   }
 
+  /**
+   * @brief discards the assembled 3D model and all cached downsampled versions of it, so that they get recomputed on
+   * next access. Needs to be called when views_ is modified directly.
+   */
+  void invalidateAssembled();
+
   std::vector<typename TrainingView<PointT>::Ptr> getTrainingViews() const {
     return views_;
   }
@@ -197,6 +239,12 @@ class Model {
    * eigen_pose_alignment, etc. are being kept
    */
   void cleanUpTrainingData(bool keep_computed_properties = false) {
+    // the 3D model might still need to be created from the training views
+    {
+      std::lock_guard<std::mutex> lock(assembled_mutex_);
+      assemble();
+    }
+
     if (keep_computed_properties) {
       for (auto &v : views_)
         v->clearClouds();
@@ -206,7 +254,8 @@ class Model {
   }
 
   /**
-   * @brief initialize initializes the model creating 3D models and so on
+   * @brief initialize initializes the model creating 3D models and so on. The 3D model is only loaded (or created)
+   * when it is accessed for the first time.
    * @param model_filename path to the 3D model (if path does not exist or is empty, 3D model will be created by simple
    * accumulation of points in the training views)
    * @param normal_estimator normal estimator parameters to estimate normals in the individual training views (if
@@ -215,46 +264,72 @@ class Model {
   void initialize(const bf::path &model_filename = "",
                   const NormalEstimatorParameter &ne_param = NormalEstimatorParameter());
 
+  /**
+   * @brief initialize initializes the model from a 3D model that is already in memory (no file is read or written)
+   * @param model_cloud full resolution point cloud of the object model with normals
+   */
+  void initialize(const typename pcl::PointCloud<PointTWithNormal>::ConstPtr &model_cloud);
+
   /**
    * @brief return model point cloud (with normals)
    * @return point cloud model of the object
    */
   typename pcl::PointCloud<PointTWithNormal>::ConstPtr getAssembled() const {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
     return all_assembled_;
   }
 
   typename pcl::PointCloud<PointTWithNormal>::ConstPtr getConvexHull() const {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
     return convex_hull_points_;
   }
 
   /**
-   * @brief return model point cloud (with normals) in desired resolution
+   * @return minimum corner of the 3D bounding box of the object model
+   */
+  Eigen::Vector4f getMinPoint() const {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
+    return minPoint_;
+  }
+
+  /**
+   * @return maximum corner of the 3D bounding box of the object model
+   */
+  Eigen::Vector4f getMaxPoint() const {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
+    return maxPoint_;
+  }
+
+  /**
+   * @return elongation of the object model along its three principal axes
+   */
+  Cluster::ConstPtr getClusterProperties() const {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
+    return cluster_props_;
+  }
+
+  /**
+   * @brief return model point cloud (with normals) in desired resolution. Thread-safe. Repeated calls with the same
+   * downsampling parameters return the same (immutable) point cloud until the model changes.
    * @param ds_param Downsampling parameter
    * @param keep_downsampled_cloud if true, caches the downsampled point cloud and returns this cloud from memory next
-   * time the assembly function is called with the same resolution
+   * time the assembly function is called with the same downsampling parameters
    * @return point cloud model of the object
    */
   typename pcl::PointCloud<PointTWithNormal>::ConstPtr getAssembled(const DownsamplerParameter &ds_param,
-                                                                    bool keep_downsampled_cloud = true) const {
-    int resolution_mm = static_cast<int>(ds_param.resolution_ * 1000.f);
-    assert(resolution_mm >= 0);
-
-    const auto it = voxelized_assembled_.find(resolution_mm);
-    if (it != voxelized_assembled_.end()) {
-      return it->second;
-    } else {
-      Downsampler ds(ds_param);
-      const auto downsampled_cloud = ds.downsample<PointTWithNormal>(all_assembled_);
-      if (keep_downsampled_cloud)
-        voxelized_assembled_[resolution_mm] = downsampled_cloud;
-      return downsampled_cloud;
-    }
-  }
+                                                                    bool keep_downsampled_cloud = true) const;
 
   /**
    * @return model diameter in meter (maximum distance between two points of the object)
    */
   float getDiameter() const {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    assemble();
     return diameter_;
   }
 
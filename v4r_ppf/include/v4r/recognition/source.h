@@ -48,6 +48,7 @@
 #pragma once
 
 #include <v4r/recognition/model.h>
+#include <unordered_map>
 
 namespace v4r {
 
@@ -70,10 +71,28 @@ struct SourceParameter {
  */
 template <typename PointT>
 class Source {
+ public:
+  using PointTWithNormal = v4r::add_normal_t<PointT>;
+
  private:
   SourceParameter param_;
 
   std::vector<typename Model<PointT>::Ptr> models_;  ///< all models
+  std::unordered_map<std::string, typename Model<PointT>::Ptr>
+      models_by_id_;  ///< all models indexed by their class and instance id (see getModelKey)
+
+  /**
+   * @brief unique key of a model in models_by_id_
+   */
+  static std::string getModelKey(const std::string &class_id, const std::string &instance_id) {
+    return class_id + "/" + instance_id;
+  }
+
+  /**
+   * @brief creates a model with its training view filenames and metadata from its folder in the model database
+   */
+  typename Model<PointT>::Ptr loadModel(const bf::path &class_path, const std::string &class_id,
+                                        const std::string &instance_id) const;
 
  public:
   Source(const SourceParameter &p = SourceParameter()) : param_(p) {}
@@ -92,6 +111,16 @@ class Source {
   void init(const boost::filesystem::path &model_database_path,
             const std::vector<std::string> &object_instances_to_load = {});
 
+  /**
+   * @brief fills the database with object models that are already in memory instead of reading them from a model
+   * database folder. No training views are attached to these models and no metadata is read, i.e. they get default
+   * model properties.
+   * @param model_clouds instance id and full resolution 3D model (with normals) of each object model
+   * @param class_id category of all given models
+   */
+  void init(const std::vector<std::pair<std::string, typename pcl::PointCloud<PointTWithNormal>::ConstPtr>> &model_clouds,
+            const std::string &class_id = "");
+
   /**
    * \brief Get the generated model
    * \return returns all generated models
@@ -109,11 +138,13 @@ class Source {
   typename Model<PointT>::ConstPtr getModelById(const std::string &class_id, const std::string &instance_id) const;
 
   /**
-   * @brief addModel add a model to the database
+   * @brief addModel add a model to the database. If a model with the same class and instance id already exists, it
+   * is still returned by getModelById.
    * @param m model
    */
   void addModel(const typename Model<PointT>::Ptr m) {
     models_.push_back(m);
+    models_by_id_.emplace(getModelKey(m->class_, m->id_), m);
   }
 
   /**
@@ -148,6 +148,15 @@ class NMBasedCloudIntegration {
     big_cloud_info_.clear();
   }
 
+  /**
+   * @brief computes the noise properties of all valid points of a single view in the global reference frame. Does
+   * not modify any state and can therefore be called for several views concurrently.
+   */
+  void computeViewInfo(const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                       const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
+                       const Eigen::Matrix4f &transform_to_global_reference_frame,
+                       const boost::optional<std::vector<int>> &indices, std::vector<PointInfo> &view_info) const;
+
  public:
   NMBasedCloudIntegration(
       const NMBasedCloudIntegrationParameter &p = NMBasedCloudIntegrationParameter(),
@@ -175,6 +184,19 @@ class NMBasedCloudIntegration {
                const Eigen::Matrix4f &transform_to_global_reference_frame,
                const boost::optional<std::vector<int>> &indices = boost::none);
 
+  /**
+   * @brief add several views at once. The views are processed in parallel and appended in the given order, i.e. the
+   * result is the same as calling addView for each view sequentially.
+   * @param clouds organized input clouds in the camera reference frame
+   * @param normals associated surface normals
+   * @param transforms_to_global_reference_frame SE(3) camera poses bringing the input clouds into a common reference
+   * frame
+   */
+  void addViews(const std::vector<typename pcl::PointCloud<PointT>::ConstPtr> &clouds,
+                const std::vector<pcl::PointCloud<pcl::Normal>::ConstPtr> &normals,
+                const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>>
+                    &transforms_to_global_reference_frame);
+
   /**
    * @brief compute the registered point cloud taking into account the noise model of the cameras
    * @param registered cloud
@@ -113,6 +113,22 @@ class PlaneExtractorTile : public PlaneExtractor<PointT> {
       zz += p(2) * p(2);
       nrPoints++;
     }
+
+    /**
+     * @brief addMoments
+     * adds moments accumulated as sum of outer products of homogeneous points (x,y,z,1). The last column holds the
+     * sum of the points, the bottom right element the number of points.
+     */
+    void addMoments(const Eigen::Matrix4d &m) {
+      sum += m.block<3, 1>(0, 3);
+      xx += m(0, 0);
+      xy += m(0, 1);
+      xz += m(0, 2);
+      yy += m(1, 1);
+      yz += m(1, 2);
+      zz += m(2, 2);
+      nrPoints += static_cast<size_t>(m(3, 3));
+    }
   };
 
   /**
@@ -143,6 +159,12 @@ class PlaneExtractorTile : public PlaneExtractor<PointT> {
 
   Eigen::Vector4f calcPlaneFromMatrix(const PlaneMatrix &mat) const;
 
+  /**
+   * @brief accumulatePatch
+   * accumulates the moments of all finite points of patch (i,j) with vectorized 4x4 outer products
+   */
+  PlaneMatrix accumulatePatch(size_t i, size_t j) const;
+
   void replace(int from, int to, int maxIndex);
 
   cv::Mat getDebugImage(bool doNormalTest);
@@ -38,12 +38,14 @@
 ****************************************************************************/
 
 #include <array>
+#include <cstring>
 #include <map>
 
 #include <cmph.h>
 
 #include <glog/logging.h>
 
+#include <v4r/common/color_conversion.h>
 #include <v4r/common/greedy_local_clustering.h>
 #include <ppf/model_search.h>
 
@@ -144,6 +146,18 @@ ModelSearch::ModelSearch(const Eigen::Matrix<float, 3, Eigen::Dynamic>& model_po
 
   std::map<QuantizedPPF, LocalCoordinate::Vector> buckets;
 
+  // Every point is part of num_points_ pairs, its HSV colour is computed once in a batch instead of for every pair
+  std::vector<Eigen::Vector3f> model_hsv;
+  if (ppf_type == FeatureType::CPPF) {
+    std::vector<uint32_t> model_rgb(num_points_);
+    for (uint32_t j = 0; j < num_points_; ++j) {
+      const float col = (*model_colors)(0, j);
+      std::memcpy(&model_rgb[j], &col, sizeof(col));
+    }
+    model_hsv.resize(num_points_);
+    v4r::convertRGBToHSV(model_rgb.data(), num_points_, model_hsv.data());
+  }
+
   // Compute point pair features for every pair of points in the cloud
   for (uint32_t i = 0; i < num_anchor_points_; ++i) {
     for (uint32_t j = 0; j < num_points_; ++j) {
@@ -155,21 +169,8 @@ ModelSearch::ModelSearch(const Eigen::Matrix<float, 3, Eigen::Dynamic>& model_po
       const auto& n2 = model_normals.col(j);
 
       if(ppf_type == FeatureType::CPPF) {
-          float c1 = (*model_colors).col(i).value();
-          Eigen::Vector3i rgb1;
-          floatColToRGB(c1, rgb1);
-
-          float c2 = (*model_colors).col(j).value();
-          Eigen::Vector3i rgb2;
-          floatColToRGB(c2, rgb2);
-
-          Eigen::Vector3f hsv1;
-          Eigen::Vector3f hsv2;
-          RGBtoHSV (rgb1,hsv1);
-          RGBtoHSV (rgb2,hsv2);
-
           float cppf_f[10];
-          computeCPPF(p1, n1, p2, n2, hsv1, hsv2, cppf_f);
+          computeCPPF(p1, n1, p2, n2, model_hsv[i], model_hsv[j], cppf_f);
 
           // Calculate alpha_m angle ([VLLM18], figure 4)
           Eigen::Affine3f transform_mg;
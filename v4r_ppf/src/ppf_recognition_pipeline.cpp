@@ -7,6 +7,7 @@
 
 #include <v4r/common/downsampler.h>
 #include <v4r/common/miscellaneous.h>
+#include <v4r/common/task_scheduler.h>
 #include <v4r/geometry/average.h>
 #include <ppf/correspondence.h>
 #include <ppf_recognition_pipeline.h>
@@ -213,8 +214,19 @@ void PPFRecognitionPipeline<PointT>::doInit(const bf::path& trained_dir, bool fo
     boost::format cache_fmt("ppf_model_d%.0f_a%.0f_ds%0.f_spreading%s%s.hash");
 
   const auto& models = m_db_->getModels();
+
+  // models are loaded lazily, so load the ones needed here in parallel before training their model search
+  std::vector<typename Model<PointT>::Ptr> models_to_init;
+  for (const auto& m : models) {
+    if (object_instances_to_load.empty() || std::find(object_instances_to_load.begin(), object_instances_to_load.end(),
+                                                      m->id_) != object_instances_to_load.end())
+      models_to_init.push_back(m);
+  }
+  parallelFor(0, models_to_init.size(), [&](size_t i) { models_to_init[i]->getDiameter(); }, 1);
+
   for (const auto& m : models) {
     const auto model_name = m->id_;
+    V4R_TRACE_SCOPE_DYNAMIC("PPF model search setup of " + model_name);
     if (!object_instances_to_load.empty() && std::find(object_instances_to_load.begin(), object_instances_to_load.end(),
                                                        model_name) == object_instances_to_load.end()) {
       LOG(INFO) << "Skipping object " << m->id_ << " because it is not in the lists of objects to load.";
@@ -236,7 +248,8 @@ void PPFRecognitionPipeline<PointT>::doInit(const bf::path& trained_dir, bool fo
         trained_dir / model_name / boost::str(cache_fmt % (dqs * 1e6) % (aqs * 1e6) % (downsampling_resolution * 1e6)  %(use_symmetry ? "_sym" : "") %
                                                          (use_color ? "_color" + std::to_string(cqs[0] * 1e2) + "_" + std::to_string(cqs[1] * 1e2) + "_" + std::to_string(cqs[2] * 1e2) : ""));
 
-    if (bf::is_regular_file(fn) && !force_retrain) {
+    const bool use_cache = !trained_dir.empty();
+    if (use_cache && bf::is_regular_file(fn) && !force_retrain) {
       // Load "trained" model search from file
       model_search_[model_name].reset(new ppf::ModelSearch(fn.string()));
     } else {
@@ -256,7 +269,10 @@ void PPFRecognitionPipeline<PointT>::doInit(const bf::path& trained_dir, bool fo
                use_color ? ppf::ModelSearch::FeatureType::CPPF : ppf::ModelSearch::FeatureType::PPF));
 
       }
-      model_search_[model_name]->save(fn.string());
+      if (use_cache) {
+        bf::create_directories(fn.parent_path());
+        model_search_[model_name]->save(fn.string());
+      }
     }
     // Initialize symmetry rotations for the model (if requested and if symmetries are present)
     if (param_.use_symmetry_) {
@@ -273,6 +289,7 @@ void PPFRecognitionPipeline<PointT>::do_recognize(const std::vector<std::string>
   CHECK(scene_normals_->size() == scene_->size()) << "Scene normals do not match in size with scene point cloud";
 
   for (const auto& model_name : model_ids_to_search) {
+    V4R_TRACE_SCOPE_DYNAMIC("PPF recognition of " + model_name);
     const auto m = m_db_->getModelById("", model_name);
 
     const auto& model_search = model_search_.at(model_name);
@@ -300,14 +317,25 @@ void PPFRecognitionPipeline<PointT>::do_recognize(const std::vector<std::string>
 
     ppf::ModelSearch::FeatureType ppf_type = param_.use_color_ ? ppf::ModelSearch::FeatureType::CPPF : ppf::ModelSearch::FeatureType::PPF;
 
+    // every chunk of scene reference points collects its correspondences locally, they are concatenated in order
+    const size_t subsampling_rate = std::max<size_t>(1, param_.scene_subsampling_rate_);
+    const size_t num_reference_points = (downsampled->size() + subsampling_rate - 1) / subsampling_rate;
+    std::vector<ppf::Correspondence::Vector> chunk_correspondences(num_reference_points);
+    parallelForChunks(0, num_reference_points, [&](size_t chunk_begin, size_t chunk_end) {
+      auto& chunk_cc = chunk_correspondences[chunk_begin];
+      for (size_t i = chunk_begin; i < chunk_end; i++) {
+        const auto& cc = cfinder.find(i * subsampling_rate, ppf_type);
+        chunk_cc.insert(chunk_cc.end(), cc.begin(), cc.end());
+      }
+    });
+
     ppf::Correspondence::Vector correspondences;
-#pragma omp parallel for schedule(dynamic)
-    for (size_t scene_reference_index = 0; scene_reference_index < downsampled->size();
-         scene_reference_index += param_.scene_subsampling_rate_) {
-      const auto& cc = cfinder.find(scene_reference_index, ppf_type);
-#pragma omp critical
+    size_t num_correspondences = 0;
+    for (const auto& cc : chunk_correspondences)
+      num_correspondences += cc.size();
+    correspondences.reserve(num_correspondences);
+    for (const auto& cc : chunk_correspondences)
       correspondences.insert(correspondences.end(), cc.begin(), cc.end());
-    }
 
     LOG(INFO) << "Found " << correspondences.size() << " correspondences to the model";
 
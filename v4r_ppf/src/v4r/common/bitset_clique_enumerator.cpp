@@ -0,0 +1,151 @@
+#include <v4r/common/bitset_clique_enumerator.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace v4r {
+
+namespace {
+using Word = BitsetAdjacency::Word;
+
+size_t count(const std::vector<Word> &s) {
+  size_t c = 0;
+  for (Word w : s)
+    c += __builtin_popcountll(w);
+  return c;
+}
+
+bool empty(const std::vector<Word> &s) {
+  return std::all_of(s.begin(), s.end(), [](Word w) { return w == 0; });
+}
+
+double nowMs() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the clock is only read every this many search nodes
+const size_t time_check_interval = 1024;
+}  // namespace
+
+bool BitsetCliqueEnumerator::compute(std::vector<std::vector<size_t>> &cliques) {
+  const size_t nw = adj_.numWords();
+  const size_t n = adj_.numVertices();
+  cliques_ = &cliques;
+  visited_nodes_ = 0;
+  stopped_ = false;
+  timed_out_ = false;
+  start_time_ms_ = nowMs();
+  clique_.clear();
+  p_stack_.assign(n + 2, std::vector<Word>());
+  x_stack_.assign(n + 2, std::vector<Word>());
+  p_stack_[0].assign(nw, 0);
+  x_stack_[0].assign(nw, 0);
+  for (size_t v = 0; v < n; v++)
+    p_stack_[0][v >> 6] |= Word(1) << (v & 63);
+
+  expand(0);
+  return !stopped_;
+}
+
+/// @brief greedy sequential colouring of the candidate set. Stops as soon as enough colours are used to possibly
+/// reach the required clique size, as the exact number is not needed then.
+bool BitsetCliqueEnumerator::colouringAllowsClique(const std::vector<Word> &P, size_t needed) {
+  const size_t nw = P.size();
+  colour_uncoloured_ = P;
+  size_t num_colours = 0;
+  while (!empty(colour_uncoloured_)) {
+    if (++num_colours >= needed)
+      return true;
+    colour_candidates_ = colour_uncoloured_;
+    for (size_t w = 0; w < nw; w++) {
+      while (colour_candidates_[w]) {
+        const size_t v = w * 64 + __builtin_ctzll(colour_candidates_[w]);
+        colour_uncoloured_[w] &= ~(Word(1) << (v & 63));
+        const Word *nv = adj_.row(v);
+        for (size_t k = w; k < nw; k++)
+          colour_candidates_[k] &= ~nv[k];
+        colour_candidates_[w] &= ~(Word(1) << (v & 63));
+      }
+    }
+  }
+  return false;
+}
+
+void BitsetCliqueEnumerator::expand(size_t depth) {
+  if (++visited_nodes_ > max_search_nodes_) {
+    stopped_ = true;
+    return;
+  }
+  if (visited_nodes_ % time_check_interval == 0 && nowMs() - start_time_ms_ > max_time_ms_) {
+    stopped_ = true;
+    timed_out_ = true;
+    return;
+  }
+
+  std::vector<Word> &P = p_stack_[depth];
+  std::vector<Word> &X = x_stack_[depth];
+  const size_t nw = P.size();
+
+  if (empty(P)) {
+    if (empty(X) && clique_.size() >= min_clique_size_)
+      cliques_->push_back(clique_);
+    return;
+  }
+
+  if (clique_.size() < min_clique_size_) {
+    const size_t needed = min_clique_size_ - clique_.size();
+    if (count(P) < needed || !colouringAllowsClique(P, needed))
+      return;
+  }
+
+  // choose pivot u from P u X maximizing |P n N(u)|
+  size_t pivot = 0, best = 0;
+  bool pivot_found = false;
+  for (size_t w = 0; w < nw; w++) {
+    Word candidates = P[w] | X[w];
+    while (candidates) {
+      const size_t u = w * 64 + __builtin_ctzll(candidates);
+      candidates &= candidates - 1;
+      const Word *nu = adj_.row(u);
+      size_t c = 0;
+      for (size_t k = 0; k < nw; k++)
+        c += __builtin_popcountll(P[k] & nu[k]);
+      if (!pivot_found || c > best) {
+        pivot = u;
+        best = c;
+        pivot_found = true;
+      }
+    }
+  }
+
+  const Word *npivot = adj_.row(pivot);
+  std::vector<Word> &P_next = p_stack_[depth + 1];
+  std::vector<Word> &X_next = x_stack_[depth + 1];
+  P_next.resize(nw);
+  X_next.resize(nw);
+
+  for (size_t w = 0; w < nw; w++) {
+    Word branch = P[w] & ~npivot[w];
+    while (branch) {
+      const size_t v = w * 64 + __builtin_ctzll(branch);
+      branch &= branch - 1;
+      const Word *nv = adj_.row(v);
+      for (size_t k = 0; k < nw; k++) {
+        P_next[k] = P[k] & nv[k];
+        X_next[k] = X[k] & nv[k];
+      }
+
+      clique_.push_back(v);
+      expand(depth + 1);
+      clique_.pop_back();
+
+      if (stopped_)
+        return;
+
+      P[w] &= ~(Word(1) << (v & 63));
+      X[w] |= Word(1) << (v & 63);
+    }
+  }
+}
+
+}  // namespace v4r
@@ -1,5 +1,7 @@
 #include <glog/logging.h>
 #include <math.h> /* sin */
+#include <algorithm>
+#include <cmath>
 #include <omp.h>
 #include <pcl/common/angles.h>
 #include <v4r/common/color_comparison.h>
@@ -168,17 +170,138 @@ float computeCIEDE2000(const Eigen::Vector3f &a, const Eigen::Vector3f &b) {
   return CIEDE2000;
 }
 
-// Eigen::VectorXf computeCIE76(const Eigen::MatrixXf &a, const Eigen::MatrixXf &b)
-//{
-//    CHECK(a.rows() == b.rows() && a.cols() == b.cols());
+namespace {
+// Colours of a batch. The channels are separate arrays (the columns of an n x 3 matrix), a stride of 0 repeats a single
+// colour for the whole batch.
+struct LabArrays {
+  const float *L, *a, *b;
+  size_t stride;
+
+  explicit LabArrays(const Eigen::MatrixX3f &m) : L(m.col(0).data()), a(m.col(1).data()), b(m.col(2).data()), stride(1) {}
+  explicit LabArrays(const Eigen::Vector3f &c) : L(&c[0]), a(&c[1]), b(&c[2]), stride(0) {}
+};
+
+// The kernels are branch-free loops over the arrays in single precision, so the compiler can vectorize them. Cases of
+// the scalar versions are computed both and selected afterwards.
+void cie76Kernel(const LabArrays &c1, const LabArrays &c2, size_t n, float *diff) {
+  for (size_t i = 0; i < n; i++) {
+    const float dL = c1.L[i * c1.stride] - c2.L[i * c2.stride];
+    const float da = c1.a[i * c1.stride] - c2.a[i * c2.stride];
+    const float db = c1.b[i * c1.stride] - c2.b[i * c2.stride];
+    diff[i] = std::sqrt(dL * dL + da * da + db * db);
+  }
+}
+
+void cie94Kernel(const LabArrays &c1, const LabArrays &c2, size_t n, float K1, float K2, float Kl, float *diff) {
+  for (size_t i = 0; i < n; i++) {
+    const float a1 = c1.a[i * c1.stride], b1 = c1.b[i * c1.stride];
+    const float a2 = c2.a[i * c2.stride], b2 = c2.b[i * c2.stride];
+    const float deltaL = c1.L[i * c1.stride] - c2.L[i * c2.stride];
+    const float deltaA = a1 - a2;
+    const float deltaB = b1 - b2;
+    const float chroma1 = std::sqrt(a1 * a1 + b1 * b1);
+    const float chroma2 = std::sqrt(a2 * a2 + b2 * b2);
+    const float deltaC = chroma1 - chroma2;
+    const float deltaH_sqr = std::max(deltaA * deltaA + deltaB * deltaB - deltaC * deltaC, 0.f);
+    const float deltaLKlsl = deltaL / Kl;
+    const float deltaCkcsc = deltaC / (1.f + K1 * chroma1);
+    const float deltaHkhsh_sqr = deltaH_sqr / ((1.f + K2 * chroma1) * (1.f + K2 * chroma1));
+    diff[i] = std::sqrt(std::max(deltaLKlsl * deltaLKlsl + deltaCkcsc * deltaCkcsc + deltaHkhsh_sqr, 0.f));
+  }
+}
+
+void ciede2000Kernel(const LabArrays &c1, const LabArrays &c2, size_t n, float *diff) {
+  const float pow25_7 = 6103515625.f;
+  const float rad_per_deg = static_cast<float>(M_PI) / 180.f;
+  for (size_t i = 0; i < n; i++) {
+    const float L1 = c1.L[i * c1.stride], a1 = c1.a[i * c1.stride], b1 = c1.b[i * c1.stride];
+    const float L2 = c2.L[i * c2.stride], a2 = c2.a[i * c2.stride], b2 = c2.b[i * c2.stride];
+
+    const float c_star_average_ab = (std::sqrt(a1 * a1 + b1 * b1) + std::sqrt(a2 * a2 + b2 * b2)) / 2.f;
+    float c_star_average_ab_pot7 = c_star_average_ab * c_star_average_ab * c_star_average_ab;
+    c_star_average_ab_pot7 *= c_star_average_ab_pot7 * c_star_average_ab;
+    const float G = 0.5f * (1.f - std::sqrt(c_star_average_ab_pot7 / (c_star_average_ab_pot7 + pow25_7)));
+    const float a1_prime = (1.f + G) * a1;
+    const float a2_prime = (1.f + G) * a2;
+
+    const float C_prime_1 = std::sqrt(a1_prime * a1_prime + b1 * b1);
+    const float C_prime_2 = std::sqrt(a2_prime * a2_prime + b2 * b2);
+    // angles in degree, in [0, 360)
+    float h_prime_1 = std::atan2(b1, a1_prime) / rad_per_deg;
+    float h_prime_2 = std::atan2(b2, a2_prime) / rad_per_deg;
+    h_prime_1 = h_prime_1 < 0.f ? h_prime_1 + 360.f : h_prime_1;
+    h_prime_2 = h_prime_2 < 0.f ? h_prime_2 + 360.f : h_prime_2;
+
+    const float delta_L_prime = L2 - L1;
+    const float delta_C_prime = C_prime_2 - C_prime_1;
+
+    const bool zero_chroma = C_prime_1 * C_prime_2 == 0.f;
+    const float h_bar = std::abs(h_prime_1 - h_prime_2);
+    float delta_h_prime = h_prime_2 - h_prime_1;
+    delta_h_prime = h_bar <= 180.f ? delta_h_prime : (h_prime_2 <= h_prime_1 ? delta_h_prime + 360.f : delta_h_prime - 360.f);
+    delta_h_prime = zero_chroma ? 0.f : delta_h_prime;
+    const float delta_H_prime = 2.f * std::sqrt(C_prime_1 * C_prime_2) * std::sin(delta_h_prime * rad_per_deg / 2.f);
+
+    const float L_prime_average = (L1 + L2) / 2.f;
+    const float C_prime_average = (C_prime_1 + C_prime_2) / 2.f;
+    const float h_sum = h_prime_1 + h_prime_2;
+    float h_prime_average = h_bar <= 180.f ? h_sum / 2.f : (h_sum < 360.f ? (h_sum + 360.f) / 2.f : (h_sum - 360.f) / 2.f);
+    h_prime_average = zero_chroma ? 0.f : h_prime_average;
+
+    const float L_prime_average_minus_50_square = (L_prime_average - 50.f) * (L_prime_average - 50.f);
+    const float S_L = 1.f + ((.015f * L_prime_average_minus_50_square) / std::sqrt(20.f + L_prime_average_minus_50_square));
+    const float S_C = 1.f + .045f * C_prime_average;
+    const float T = 1.f - .17f * std::cos((h_prime_average - 30.f) * rad_per_deg) +
+                    .24f * std::cos((h_prime_average * 2.f) * rad_per_deg) +
+                    .32f * std::cos((h_prime_average * 3.f + 6.f) * rad_per_deg) -
+                    .2f * std::cos((h_prime_average * 4.f - 63.f) * rad_per_deg);
+    const float S_H = 1.f + .015f * T * C_prime_average;
+    const float h_prime_average_minus_275_div_25 = (h_prime_average - 275.f) / 25.f;
+    const float delta_theta = 30.f * std::exp(-h_prime_average_minus_275_div_25 * h_prime_average_minus_275_div_25);
+
+    float C_prime_average_pot_7 = C_prime_average * C_prime_average * C_prime_average;
+    C_prime_average_pot_7 *= C_prime_average_pot_7 * C_prime_average;
+    const float R_C = 2.f * std::sqrt(C_prime_average_pot_7 / (C_prime_average_pot_7 + pow25_7));
+    const float R_T = -std::sin(2.f * delta_theta * rad_per_deg) * R_C;
+
+    const float delta_L = delta_L_prime / S_L;
+    const float delta_C = delta_C_prime / S_C;
+    const float delta_H = delta_H_prime / S_H;
+    diff[i] = std::sqrt(delta_L * delta_L + delta_C * delta_C + delta_H * delta_H + R_T * delta_C * delta_H);
+  }
+}
+}  // namespace
 
-//    Eigen::VectorXf diff(a.rows());
+void computeCIE76(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff) {
+  CHECK(a.rows() == b.rows());
+  diff.resize(a.rows());
+  cie76Kernel(LabArrays(a), LabArrays(b), a.rows(), diff.data());
+}
+
+void computeCIE76(const Eigen::Vector3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff) {
+  diff.resize(b.rows());
+  cie76Kernel(LabArrays(a), LabArrays(b), b.rows(), diff.data());
+}
+
+void computeCIE94_DEFAULT(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff) {
+  CHECK(a.rows() == b.rows());
+  diff.resize(a.rows());
+  cie94Kernel(LabArrays(a), LabArrays(b), a.rows(), 1.f, .045f, .015f, diff.data());
+}
 
-//#pragma omp parallel for schedule(dynamic)
+void computeCIE94_DEFAULT(const Eigen::Vector3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff) {
+  diff.resize(b.rows());
+  cie94Kernel(LabArrays(a), LabArrays(b), b.rows(), 1.f, .045f, .015f, diff.data());
+}
 
-//    for(size_t i=0; i<a.rows(); i++)
-//        diff(i) = computeCIE76(a.row(i), b.row(i));
+void computeCIEDE2000(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff) {
+  CHECK(a.rows() == b.rows());
+  diff.resize(a.rows());
+  ciede2000Kernel(LabArrays(a), LabArrays(b), a.rows(), diff.data());
+}
 
-//    return diff;
-//}
+void computeCIEDE2000(const Eigen::Vector3f &a, const Eigen::MatrixX3f &b, Eigen::VectorXf &diff) {
+  diff.resize(b.rows());
+  ciede2000Kernel(LabArrays(a), LabArrays(b), b.rows(), diff.data());
+}
 }  // namespace v4r
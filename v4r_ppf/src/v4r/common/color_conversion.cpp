@@ -0,0 +1,114 @@
+#include <v4r/common/color_conversion.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace v4r {
+
+namespace {
+// colours are converted in blocks, the intermediate arrays of a block stay in the L1 cache
+constexpr size_t kBlockSize = 256;
+
+// sRGB gamma expansion of the 256 possible channel values
+struct SRGBToLinearTable {
+  float values[256];
+
+  SRGBToLinearTable() {
+    for (int i = 0; i < 256; i++) {
+      const float c = i / 255.f;
+      values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+  }
+};
+
+const SRGBToLinearTable &srgbToLinear() {
+  static const SRGBToLinearTable table;
+  return table;
+}
+
+// cube root of a non-negative number without a call into the math library: the initial guess divides the exponent
+// bits by three, two Halley iterations (cubic convergence) refine it to float precision
+inline float cubeRoot(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  bits = bits / 3 + 709921077u;
+  float y;
+  std::memcpy(&y, &bits, sizeof(y));
+  for (int i = 0; i < 2; i++) {
+    const float y3 = y * y * y;
+    y = y * (y3 + 2.f * x) / (2.f * y3 + x);
+  }
+  return y;
+}
+
+inline float labF(float t) {
+  return t > 0.008856f ? cubeRoot(t) : 7.787f * t + 16.f / 116.f;
+}
+}  // namespace
+
+void convertRGBToLab(const uint32_t *rgb, size_t n, float *L, float *a, float *b) {
+  const float *to_linear = srgbToLinear().values;
+  float x[kBlockSize], y[kBlockSize], z[kBlockSize];
+  for (size_t begin = 0; begin < n; begin += kBlockSize) {
+    const size_t m = std::min(kBlockSize, n - begin);
+    const uint32_t *block = rgb + begin;
+    // linear RGB -> XYZ, X and Z are divided by the D65 white point
+    for (size_t i = 0; i < m; i++) {
+      const float r_lin = to_linear[(block[i] >> 16) & 0xff];
+      const float g_lin = to_linear[(block[i] >> 8) & 0xff];
+      const float b_lin = to_linear[block[i] & 0xff];
+      x[i] = 0.433953f * r_lin + 0.376219f * g_lin + 0.189828f * b_lin;
+      y[i] = 0.212671f * r_lin + 0.715160f * g_lin + 0.072169f * b_lin;
+      z[i] = 0.017758f * r_lin + 0.109477f * g_lin + 0.872766f * b_lin;
+    }
+    for (size_t i = 0; i < m; i++) {
+      const float fx = labF(x[i]), fy = labF(y[i]), fz = labF(z[i]);
+      L[begin + i] = 116.f * fy - 16.f;
+      a[begin + i] = 500.f * (fx - fy);
+      b[begin + i] = 200.f * (fy - fz);
+    }
+  }
+}
+
+void convertRGBToLab(const uint32_t *rgb, size_t n, Eigen::Vector3f *lab) {
+  float L[kBlockSize], a[kBlockSize], b[kBlockSize];
+  for (size_t begin = 0; begin < n; begin += kBlockSize) {
+    const size_t m = std::min(kBlockSize, n - begin);
+    convertRGBToLab(rgb + begin, m, L, a, b);
+    for (size_t i = 0; i < m; i++)
+      lab[begin + i] = Eigen::Vector3f(L[i], a[i], b[i]);
+  }
+}
+
+void convertRGBToHSV(const uint32_t *rgb, size_t n, float *h, float *s, float *v) {
+  for (size_t i = 0; i < n; i++) {
+    const int r = (rgb[i] >> 16) & 0xff, g = (rgb[i] >> 8) & 0xff, b = rgb[i] & 0xff;
+    const int max = std::max(r, std::max(g, b));
+    const int min = std::min(r, std::min(g, b));
+    const float diff = static_cast<float>(max - min);
+    // all cases are computed and selected afterwards, the divisors of the unused cases must not be zero
+    const float safe_diff = diff > 0.f ? diff : 1.f;
+    const float safe_max = max > 0 ? static_cast<float>(max) : 1.f;
+
+    float hue = max == r ? 60.f * (static_cast<float>(g - b) / safe_diff)
+                         : (max == g ? 60.f * (2.f + static_cast<float>(b - r) / safe_diff)
+                                     : 60.f * (4.f + static_cast<float>(r - g) / safe_diff));
+    hue = hue < 0.f ? hue + 360.f : hue;
+    h[i] = diff > 0.f ? hue : 0.f;
+    s[i] = max > 0 ? diff / safe_max : 0.f;
+    v[i] = static_cast<float>(max) / 255.f;
+  }
+}
+
+void convertRGBToHSV(const uint32_t *rgb, size_t n, Eigen::Vector3f *hsv) {
+  float h[kBlockSize], s[kBlockSize], v[kBlockSize];
+  for (size_t begin = 0; begin < n; begin += kBlockSize) {
+    const size_t m = std::min(kBlockSize, n - begin);
+    convertRGBToHSV(rgb + begin, m, h, s, v);
+    for (size_t i = 0; i < m; i++)
+      hsv[begin + i] = Eigen::Vector3f(h[i], s[i], v[i]);
+  }
+}
+
+}  // namespace v4r
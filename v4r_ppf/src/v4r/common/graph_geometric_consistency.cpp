@@ -1,16 +1,17 @@
-#include <exception>
+#include <algorithm>
 
 #include <glog/logging.h>
 #include <pcl/common/angles.h>
 #include <pcl/common/time.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
+#include <v4r/common/bitset_clique_enumerator.h>
 #include <v4r/common/graph_geometric_consistency.h>
 #include <v4r/common/topsort_pruning.h>
+#include <v4r/common/trace.h>
 #include <v4r/geometry/geometry.h>
 #include <v4r/geometry/normals.h>
 #include <boost/format.hpp>
 #include <boost/graph/biconnected_components.hpp>
-#include <boost/graph/bron_kerbosch_all_cliques.hpp>
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/copy.hpp>
 #include <boost/graph/iteration_macros.hpp>
@@ -19,39 +20,8 @@
 
 namespace po = boost::program_options;
 
-struct MaxTimeAllowedReachedException : public std::exception {
-  const char* what() const noexcept override {
-    return "MaxTimeAllowedReachedException";
-  }
-};
-
 namespace v4r {
 
-struct CliqueVisitor {
-  CliqueVisitor(std::vector<std::vector<size_t>>& max_cliques,
-                double max_time_allowed = std::numeric_limits<double>::infinity())
-  : max_cliques(max_cliques), max_time_allowed_(max_time_allowed) {
-    time_elapsed_.reset();
-  }
-  template <typename Clique, typename Graph>
-  void clique(const Clique& c, const Graph& /*g*/) {
-    std::vector<size_t> current_clique;
-    for (auto it = c.begin(); it != c.end(); ++it) {
-      current_clique.emplace_back(*it);
-    }
-    max_cliques.push_back(std::move(current_clique));
-    if (time_elapsed_.getTime() > max_time_allowed_) {
-      throw MaxTimeAllowedReachedException();
-    }
-  };
-  void reset() {
-    max_cliques.clear();
-  }
-  std::vector<std::vector<size_t>>& max_cliques;
-  double max_time_allowed_;
-  pcl::StopWatch time_elapsed_;
-};
-
 template <typename PointModelT, typename PointSceneT>
 void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::filterCorrespondences(
     const pcl::Correspondences& input_corrs, pcl::Correspondences& filtered_corrs, std::vector<int>& inlier_indices,
@@ -125,20 +95,27 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::groupCorrespon
     if (param_.prune_by_CC_)
       correspondence_to_instance.resize(model_scene_corrs_->size());
 
+    const BitsetAdjacency adjacency = BitsetAdjacency::fromGraph(connected_graph);
+
     std::vector<std::vector<size_t>> cliques;
     if (cliques_computation_possible[c]) {
-      CliqueVisitor visitor(cliques, param_.max_time_allowed_cliques_comptutation_);
+      BitsetCliqueEnumerator clique_enumerator(adjacency, param_.gc_threshold_, param_.max_clique_search_nodes_,
+                                               param_.max_time_allowed_cliques_comptutation_);
       pcl::StopWatch t;
-      try {
-        boost::bron_kerbosch_all_cliques(connected_graph, visitor, param_.gc_threshold_);
-      } catch (MaxTimeAllowedReachedException& e) {
-        LOG(INFO) << "bron_kerbosch_all_cliques timed out (>" << param_.max_time_allowed_cliques_comptutation_
-                  << "ms )";
+      V4R_TRACE_SCOPE("Maximal clique search");
+      if (!clique_enumerator.compute(cliques)) {
+        if (clique_enumerator.timedOut())
+          LOG(INFO) << "maximal clique search timed out (>" << param_.max_time_allowed_cliques_comptutation_
+                    << "ms )";
+        else
+          LOG(INFO) << "maximal clique search stopped after visiting " << param_.max_clique_search_nodes_
+                    << " search nodes";
       }
       if (cliques.size() < param_.min_cliques_to_proceed_) {
         cliques_computation_possible[c] = false;
       }
-      VLOG(1) << "cliques found: " << cliques.size() << ", took: " << t.getTime() << " ms.";
+      VLOG(1) << "cliques found: " << cliques.size() << " (" << clique_enumerator.getNumVisitedNodes()
+              << " search nodes), took: " << t.getTime() << " ms.";
     }
 
     if (cliques_computation_possible[c]) {
@@ -149,8 +126,8 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::groupCorrespon
         }
       }
 
-      std::sort(cliques.begin(), cliques.end(),
-                [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.size() > b.size(); });
+      std::stable_sort(cliques.begin(), cliques.end(),
+                       [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.size() > b.size(); });
 
       if (!param_.cliques_big_to_small_)
         std::reverse(cliques.begin(), cliques.end());
@@ -209,11 +186,9 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::groupCorrespon
       std::vector<bool> taken_corresps(local_vertices.size(), false);
 
       if (!param_.prune_by_TS_) {
-        typename boost::graph_traits<GraphGGCG>::vertex_iterator vertexIt, vertexEnd;
-        boost::tie(vertexIt, vertexEnd) = boost::vertices(connected_graph);
-        for (; vertexIt != vertexEnd; ++vertexIt) {
-          if (boost::out_degree(*vertexIt, connected_graph) < (param_.gc_threshold_ - 1))
-            taken_corresps[*vertexIt] = true;
+        for (size_t v = 0; v < adjacency.numVertices(); v++) {
+          if (adjacency.degree(v) < (param_.gc_threshold_ - 1))
+            taken_corresps[v] = true;
         }
       }
 
@@ -230,10 +205,10 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::groupCorrespon
 
           // Let's check if j fits into the current consensus set
           bool is_a_good_candidate = std::all_of(consensus_set.begin(), consensus_set.begin() + consensus_size,
-                                                 [j, &connected_graph](size_t k) {
+                                                 [j, &adjacency](size_t k) {
                                                    // check if edge (j, consensus_set[k] exists in the graph, if it
                                                    // does not, is_a_good_candidate = false!...
-                                                   return boost::edge(j, k, connected_graph).second;
+                                                   return adjacency.hasEdge(j, k);
                                                  });
 
           if (is_a_good_candidate)
@@ -523,10 +498,14 @@ void GraphGeometricConsistencyGroupingParameter::init(boost::program_options::op
                      po::value<double>(&max_time_allowed_cliques_comptutation_)
                          ->default_value(max_time_allowed_cliques_comptutation_, "100.0"),
                      " max time allowed for finding maximal cliques procedure during grouping correspondences");
+  desc.add_options()((section_name + ".max_clique_search_nodes").c_str(),
+                     po::value<size_t>(&max_clique_search_nodes_)->default_value(max_clique_search_nodes_),
+                     "maximum number of search nodes visited by the maximal cliques procedure during grouping "
+                     "correspondences");
   desc.add_options()(
       (section_name + ".min_cliques_to_proceed").c_str(),
       po::value<size_t>(&min_cliques_to_proceed_)->default_value(min_cliques_to_proceed_, "10000"),
-      "if finding maximal cliques procedure returns less than this defined value before timeout, "
+      "if finding maximal cliques procedure returns less than this defined value before reaching one of its limits, "
       "correspondences will be no longer computed by this graph based approach but by the simpler greedy "
       "correspondence grouping algorithm");
   desc.add_options()((section_name + ".ransac_threshold").c_str(),
@@ -1,6 +1,8 @@
 #include <glog/logging.h>
-#include <omp.h>
 #include <v4r/common/histogram.h>
+#include <v4r/common/task_scheduler.h>
+
+#include <mutex>
 
 namespace v4r {
 
@@ -26,23 +28,19 @@ void computeHistogram(const Eigen::MatrixXf &data, Eigen::MatrixXi &histogram, s
   int num_dim = data.cols();
   histogram = Eigen::MatrixXi::Zero(num_dim, bins);
 
-  for (int dim = 0; dim < num_dim; dim++) {
-    omp_lock_t bin_lock[bins];
-    for (size_t pos = 0; pos < bins; pos++)
-      omp_init_lock(&bin_lock[pos]);
-
-#pragma omp parallel for firstprivate(min, max, bins) schedule(dynamic)
-    for (int j = 0; j < data.rows(); j++) {
-      int pos = std::max<int>(0, std::min<int>(bins - 1, std::floor((data(j, dim) - min) / bin_size)));
-
-      omp_set_lock(&bin_lock[pos]);
-      histogram(dim, pos)++;
-      omp_unset_lock(&bin_lock[pos]);
+  // every chunk of rows counts into its own histogram, the chunk histograms are added once per chunk
+  std::mutex histogram_mutex;
+  parallelForChunks(0, data.rows(), [&](size_t row_begin, size_t row_end) {
+    Eigen::MatrixXi chunk_histogram = Eigen::MatrixXi::Zero(num_dim, bins);
+    for (int dim = 0; dim < num_dim; dim++) {
+      for (size_t j = row_begin; j < row_end; j++) {
+        int pos = std::max<int>(0, std::min<int>(bins - 1, std::floor((data(j, dim) - min) / bin_size)));
+        chunk_histogram(dim, pos)++;
+      }
     }
-
-    for (size_t pos = 0; pos < bins; pos++)
-      omp_destroy_lock(&bin_lock[pos]);
-  }
+    std::lock_guard<std::mutex> lock(histogram_mutex);
+    histogram += chunk_histogram;
+  }, 1024);
 }
 
 void shiftHistogram(const Eigen::VectorXi &hist, Eigen::VectorXi &hist_shifted, bool direction) {
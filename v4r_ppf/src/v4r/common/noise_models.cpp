@@ -1,7 +1,7 @@
 #include <v4r/common/noise_models.h>
+#include <v4r/common/task_scheduler.h>
 
 #include <glog/logging.h>
-#include <omp.h>
 
 namespace v4r {
 
@@ -33,10 +33,9 @@ std::vector<std::vector<float>> NguyenNoiseModel<PointT>::compute(
   CHECK(input->isOrganized());
   std::vector<std::vector<float>> pt_properties(input->size(), std::vector<float>(2));
 
-#pragma omp parallel for schedule(dynamic)
-  for (size_t i = 0; i < input->size(); i++) {
+  parallelFor(0, input->size(), [&](size_t i) {
     computeNoiseLevel(input->points[i], normals->points[i], pt_properties[i][0], pt_properties[i][1], focal_length);
-  }
+  });
   return pt_properties;
 }
 
@@ -0,0 +1,197 @@
+#include <glog/logging.h>
+#include <v4r/common/task_scheduler.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+
+namespace v4r {
+
+namespace {
+// identifies the worker threads, tasks they submit go to their own queue
+thread_local TaskScheduler *current_scheduler = nullptr;
+thread_local size_t current_worker = 0;
+// group of the task the thread is executing, groups created in a task are nested in it
+thread_local const TaskGroup *current_group = nullptr;
+
+size_t defaultNumThreads() {
+  const char *env = std::getenv("V4R_NUM_THREADS");
+  if (env) {
+    const int num_threads = std::atoi(env);
+    if (num_threads > 0)
+      return static_cast<size_t>(num_threads);
+    LOG(WARNING) << "Ignoring invalid V4R_NUM_THREADS=" << env;
+  }
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+}  // namespace
+
+TaskScheduler::TaskScheduler(size_t num_threads) : num_pending_(0), next_queue_(0), stop_(false) {
+  if (num_threads == 0)
+    num_threads = defaultNumThreads();
+
+  // the thread waiting for a task group helps executing tasks, so it counts as one of the threads
+  const size_t num_workers = num_threads - 1;
+  queues_.reserve(std::max<size_t>(1, num_workers));
+  for (size_t i = 0; i < std::max<size_t>(1, num_workers); i++)
+    queues_.emplace_back(new WorkQueue);
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++)
+    workers_.emplace_back(&TaskScheduler::workerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_up_.notify_all();
+  for (auto &worker : workers_)
+    worker.join();
+}
+
+TaskScheduler &TaskScheduler::global() {
+  static TaskScheduler scheduler;
+  return scheduler;
+}
+
+void TaskScheduler::submit(std::function<void()> &&task, const TaskGroup *group) {
+  if (workers_.empty()) {  // single threaded, nothing to distribute
+    task();
+    return;
+  }
+
+  const size_t queue_id = current_scheduler == this ? current_worker : next_queue_++ % queues_.size();
+  num_pending_++;
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue_id]->mutex_);
+    queues_[queue_id]->tasks_.push_back(Task{std::move(task), group});
+  }
+  {
+    // taking the lock avoids a lost wake-up between a worker's check of num_pending_ and its wait
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  wake_up_.notify_one();
+}
+
+bool TaskScheduler::popTask(size_t first_queue, const TaskGroup *group, std::function<void()> &task) {
+  if (num_pending_.load() == 0)
+    return false;
+
+  const auto runnable = [group](const Task &t) { return !group || (t.group && t.group->isNestedIn(group)); };
+
+  // own queue first (newest task, its data is most likely still in cache), then steal the oldest task of the others
+  {
+    WorkQueue &q = *queues_[first_queue];
+    std::lock_guard<std::mutex> lock(q.mutex_);
+    const auto it = std::find_if(q.tasks_.rbegin(), q.tasks_.rend(), runnable);
+    if (it != q.tasks_.rend()) {
+      task = std::move(it->fn);
+      q.tasks_.erase(std::next(it).base());
+      num_pending_--;
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues_.size(); i++) {
+    WorkQueue &q = *queues_[(first_queue + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(q.mutex_);
+    const auto it = std::find_if(q.tasks_.begin(), q.tasks_.end(), runnable);
+    if (it != q.tasks_.end()) {
+      task = std::move(it->fn);
+      q.tasks_.erase(it);
+      num_pending_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TaskScheduler::runPendingTask(const TaskGroup *group) {
+  const size_t first_queue = current_scheduler == this ? current_worker : 0;
+  std::function<void()> task;
+  if (!popTask(first_queue, group, task))
+    return false;
+  task();
+  return true;
+}
+
+void TaskScheduler::workerLoop(size_t id) {
+  current_scheduler = this;
+  current_worker = id;
+
+  std::function<void()> task;
+  while (true) {
+    if (popTask(id, nullptr, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_up_.wait(lock, [this] { return stop_ || num_pending_.load() > 0; });
+    if (stop_)
+      return;
+  }
+}
+
+TaskGroup::TaskGroup(TaskScheduler &scheduler) : scheduler_(scheduler), parent_(current_group), num_running_(0) {}
+
+TaskGroup::~TaskGroup() {
+  waitUntilDone();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+  num_running_++;
+  scheduler_.submit([this, task] {
+    const TaskGroup *previous_group = current_group;
+    current_group = this;
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exception_mutex_);
+      if (!exception_)
+        exception_ = std::current_exception();
+    }
+    current_group = previous_group;
+    // the group may be destroyed as soon as the waiting thread sees the last task finish, nothing is touched afterwards
+    std::lock_guard<std::mutex> lock(done_mutex_);
+    num_running_--;
+    task_done_.notify_all();
+  }, this);
+}
+
+void TaskGroup::waitUntilDone() {
+  while (num_running_.load() > 0) {
+    // help with our own tasks and the tasks of groups nested in them. Unrelated tasks are not executed here, the
+    // caller may hold locks (e.g. of a model that is being assembled) that these tasks need as well.
+    if (scheduler_.runPendingTask(this))
+      continue;
+    std::unique_lock<std::mutex> lock(done_mutex_);
+    if (num_running_.load() > 0)
+      task_done_.wait(lock);
+  }
+  // the last task may still hold done_mutex_ after its decrement was seen, the group must not be destroyed before
+  std::lock_guard<std::mutex> lock(done_mutex_);
+}
+
+bool TaskGroup::isNestedIn(const TaskGroup *group) const {
+  for (const TaskGroup *g = this; g; g = g->parent_) {
+    if (g == group)
+      return true;
+  }
+  return false;
+}
+
+void TaskGroup::wait() {
+  waitUntilDone();
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(exception_mutex_);
+    std::swap(exception, exception_);
+  }
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+}  // namespace v4r
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+#include <glog/logging.h>
+#include <v4r/common/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace v4r {
+namespace trace {
+
+namespace {
+struct Event {
+  const char *category_;
+  const char *name_;          ///< static name, nullptr if dynamic_name_ is used
+  std::string dynamic_name_;  ///< name built at runtime
+  int64_t start_ns_;
+  int64_t end_ns_;
+};
+
+/// ring buffer of one thread. Only written by its own thread, the mutex is uncontended except while exporting.
+struct ThreadBuffer {
+  std::mutex mutex_;
+  std::vector<Event> events_;
+  size_t next_ = 0;      ///< slot for the next event
+  size_t num_valid_ = 0;  ///< number of valid events (<= capacity)
+  int tid_;
+};
+
+std::atomic<size_t> buffer_capacity(1 << 16);
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;  ///< buffers of all threads that ever recorded a span
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer &getThreadBuffer() {
+  // the registry keeps the buffer alive after the thread exits so its spans can still be exported
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    buffer->events_.resize(std::max<size_t>(1, buffer_capacity.load()));
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffer->tid_ = static_cast<int>(registry.size());
+    registry.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void writeJsonString(std::ostream &os, const char *s) {
+  os << '"';
+  for (; *s; ++s) {
+    const unsigned char c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\')
+      os << '\\' << c;
+    else if (c < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      os << buf;
+    } else
+      os << c;
+  }
+  os << '"';
+}
+}  // namespace
+
+namespace detail {
+std::atomic<bool> enabled(false);
+
+int64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char *category, const char *name, std::string &&dynamic_name, int64_t start_ns, int64_t end_ns) {
+  ThreadBuffer &buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex_);
+  Event &e = buffer.events_[buffer.next_];
+  e.category_ = category;
+  e.name_ = name;
+  e.dynamic_name_ = std::move(dynamic_name);
+  e.start_ns_ = start_ns;
+  e.end_ns_ = end_ns;
+  buffer.next_ = (buffer.next_ + 1) % buffer.events_.size();
+  buffer.num_valid_ = std::min(buffer.num_valid_ + 1, buffer.events_.size());
+}
+}  // namespace detail
+
+void enable(size_t events_per_thread) {
+  buffer_capacity = events_per_thread;
+  detail::enabled = true;
+}
+
+void disable() {
+  detail::enabled = false;
+}
+
+void clear() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto &buffer : registry) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex_);
+    buffer->next_ = 0;
+    buffer->num_valid_ = 0;
+  }
+}
+
+bool writeChromeTrace(const std::string &filename) {
+  std::ofstream f(filename);
+  if (!f.is_open()) {
+    LOG(ERROR) << "Could not open " << filename << " for writing the trace!";
+    return false;
+  }
+
+  f << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  char ts[64];
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto &buffer : registry) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex_);
+    const size_t capacity = buffer->events_.size();
+    const size_t oldest = (buffer->next_ + capacity - buffer->num_valid_) % capacity;
+
+    for (size_t i = 0; i < buffer->num_valid_; i++) {
+      const Event &e = buffer->events_[(oldest + i) % capacity];
+      f << (first ? "\n" : ",\n") << "{\"name\":";
+      writeJsonString(f, e.name_ ? e.name_ : e.dynamic_name_.c_str());
+      f << ",\"cat\":";
+      writeJsonString(f, e.category_);
+      // chrome trace timestamps are in microseconds
+      std::snprintf(ts, sizeof(ts), ",\"ts\":%.3f,\"dur\":%.3f", e.start_ns_ * 1e-3, (e.end_ns_ - e.start_ns_) * 1e-3);
+      f << ",\"ph\":\"X\"" << ts << ",\"pid\":1,\"tid\":" << buffer->tid_ << "}";
+      first = false;
+    }
+  }
+  f << "\n]}\n";
+
+  if (!f.good()) {
+    LOG(ERROR) << "Writing trace to " << filename << " failed!";
+    return false;
+  }
+  LOG(INFO) << "Wrote trace to " << filename;
+  return true;
+}
+
+}  // namespace trace
+}  // namespace v4r
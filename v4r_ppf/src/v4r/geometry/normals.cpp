@@ -1,6 +1,7 @@
 #include <glog/logging.h>
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/features/normal_3d_omp.h>
+#include <v4r/common/task_scheduler.h>
 #include <v4r/geometry/normals.h>
 #include <boost/algorithm/string.hpp>
 #include <numeric>
@@ -150,8 +151,9 @@ pcl::PointCloud<pcl::Normal>::Ptr computeNormals(const typename pcl::PointCloud<
     case NormalEstimatorParameter::Method::PCL_DEFAULT: {
       typename pcl::NormalEstimation<PointT, pcl::Normal>::Ptr ne;
 
+      // PCL runs its own OpenMP team, keep it at the size of the task scheduler
       if (param.use_omp_)
-        ne.reset(new pcl::NormalEstimationOMP<PointT, pcl::Normal>);
+        ne.reset(new pcl::NormalEstimationOMP<PointT, pcl::Normal>(TaskScheduler::global().numThreads()));
       else
         ne.reset(new pcl::NormalEstimation<PointT, pcl::Normal>);
 
@@ -173,15 +175,14 @@ pcl::PointCloud<pcl::Normal>::Ptr computeNormals(const typename pcl::PointCloud<
       break;
     }
     case NormalEstimatorParameter::Method::Z_ADAPTIVE: {
-#pragma omp parallel for if (param.use_omp_)
-      for (size_t i = 0; i < _indices->size(); i++) {
+      const auto estimate_normal = [&](size_t i) {
         int idx = indices->operator[](i);
         const PointT &p = cloud->operator[](idx);
         pcl::Normal &n = normals->operator[](idx);
 
         if (!pcl::isFinite(p)) {
           n.normal_x = n.normal_y = n.normal_z = std::numeric_limits<float>::quiet_NaN();
-          continue;
+          return;
         }
 
         // get neighboring indices
@@ -222,7 +223,12 @@ pcl::PointCloud<pcl::Normal>::Ptr computeNormals(const typename pcl::PointCloud<
 
         n = computeNormal(*cloud, neighbor_indices);
         pcl::flipNormalTowardsViewpoint(p, 0.f, 0.f, 0.f, n.normal_x, n.normal_y, n.normal_z);
-      }
+      };
+      if (param.use_omp_)
+        parallelFor(0, _indices->size(), estimate_normal, 64);
+      else
+        for (size_t i = 0; i < _indices->size(); i++)
+          estimate_normal(i);
     } break;
   }
   return normals;
@@ -5,6 +5,7 @@
 #include <v4r/common/miscellaneous.h>
 #include <v4r/common/occlusion_reasoning.h>
 #include <v4r/common/pcl_utils.h>
+#include <v4r/common/task_scheduler.h>
 #include <v4r/common/time.h>
 #include <v4r/geometry/normals.h>
 #include <v4r/recognition/hypotheses_verification.h>
@@ -18,7 +19,6 @@
 #include <pcl/registration/gicp.h>
 #include <pcl_1_8/keypoints/uniform_sampling.h>
 
-#include <omp.h>
 #include <opencv2/opencv.hpp>
 
 namespace {
@@ -307,8 +307,8 @@ void HypothesisVerification<PointT>::refinePose(HVRecognitionModel<PointT> &rm)
   // EASY_BLOCK("Pose refinement");
 
   const auto m = m_db_->getModelById("", rm.oh_->model_id_);
-  const Eigen::Vector4f max_model_point = m->maxPoint_;
-  const Eigen::Vector4f min_model_point = m->minPoint_;
+  const Eigen::Vector4f max_model_point = m->getMaxPoint();
+  const Eigen::Vector4f min_model_point = m->getMinPoint();
 
   typename pcl::PointCloud<PointTWithNormal>::Ptr cropped_scene(new pcl::PointCloud<PointTWithNormal>);
   {
@@ -849,8 +849,7 @@ void HypothesisVerification<PointT>::initialize() {
   }
   const size_t n_flat_hypotheses = flat_hypotheses_list.size();
 
-#pragma omp parallel for schedule(dynamic)
-  for (size_t i = 0; i < n_flat_hypotheses; ++i) {
+  parallelFor(0, n_flat_hypotheses, [&](size_t i) {
     HVRecognitionModel<PointT> &rm = *flat_hypotheses_list[i];
     computeVisibleModelPoints(rm);
     if (param_.icp_iterations_) {
@@ -863,21 +862,20 @@ void HypothesisVerification<PointT>::initialize() {
       } else
         refinePose<pcl::IterativeClosestPoint<PointTWithNormal, PointTWithNormal>>(rm);
     }
-  }
+  }, 1);
 
   removeRedundantPoses();
 
-#pragma omp parallel for schedule(dynamic)
-  for (size_t i = 0; i < n_flat_hypotheses; ++i) {
+  parallelFor(0, n_flat_hypotheses, [&](size_t i) {
     HVRecognitionModel<PointT> &rm = *flat_hypotheses_list[i];
     if (rm.isRejected())
-      continue;
+      return;
 
     if (param_.reject_under_floor_ && transform_to_world_) {
       if (checkIfModelIsUnderFloor(rm, transform_to_world_.get())) {
         VLOG(1) << "Removed " << rm.oh_->model_id_
                 << " hypothesis: model part is found under floor by thresh=" << param_.floor_z_min_;
-        continue;
+        return;
       }
     }
 
@@ -897,7 +895,7 @@ void HypothesisVerification<PointT>::initialize() {
       rm.rejected_due_to_low_visibility_ = true;
       VLOG(1) << "Removed " << rm.oh_->model_id_ << " due to low visibility (" << visible_ratio << " by thresh "
               << param_.min_visible_ratio_ << ")!";
-      continue;
+      return;
     }
 
     if (!param_.ignore_color_even_if_exists_) {
@@ -907,7 +905,7 @@ void HypothesisVerification<PointT>::initialize() {
     }
 
     computeModelFitness(rm);
-  }
+  }, 1);
 
   if (vis_model_) {
     for (size_t i = 0; i < obj_hypotheses_groups_.size(); i++) {
@@ -1045,41 +1043,37 @@ void HypothesisVerification<PointT>::setSceneCloud(
   checkInput();
   downsampleSceneCloud();
 
-#pragma omp parallel sections
-  {
-#pragma omp section
-    {
-      // EASY_BLOCK("Computing octree");
-      ScopeTime t("Computing octree");
-      octree_scene_downsampled_.reset(
-          new pcl::octree::OctreePointCloudSearch<PointTWithNormal>(param_.octree_resolution_m_));
-      octree_scene_downsampled_->setInputCloud(scene_cloud_downsampled_);
-      octree_scene_downsampled_->addPointsFromInputCloud();
+  // the scene structures are independent of each other
+  TaskGroup scene_setup;
+  scene_setup.run([this] {
+    if (param_.check_smooth_clusters_) {
+      ScopeTime t("Extracting smooth clusters");
+      extractEuclideanClustersSmooth();
     }
-#pragma omp section
-    {
-      if (param_.check_smooth_clusters_) {
-        ScopeTime t("Extracting smooth clusters");
-        extractEuclideanClustersSmooth();
-      }
-    }
-#pragma omp section
-    {
-      if (!param_.ignore_color_even_if_exists_) {
-        ScopeTime t("Converting scene color values");
-        // EASY_BLOCK("Converting scene color values");
-        convertColor(*scene_cloud_downsampled_, scene_color_channels_, CV_RGB2Lab);
-      }
+  });
+  scene_setup.run([this] {
+    if (!param_.ignore_color_even_if_exists_) {
+      ScopeTime t("Converting scene color values");
+      // EASY_BLOCK("Converting scene color values");
+      convertColor(*scene_cloud_downsampled_, scene_color_channels_, CV_RGB2Lab);
     }
-#pragma omp section
-    {
-      if (param_.outline_verification_) {
-        ScopeTime t("Precompute scene distance field");
-        // EASY_BLOCK("Precompute scene distance fields");
-        outline_verification_.setScene(*scene_cloud, depth_outlines_param_);
-      }
+  });
+  scene_setup.run([this, &scene_cloud] {
+    if (param_.outline_verification_) {
+      ScopeTime t("Precompute scene distance field");
+      // EASY_BLOCK("Precompute scene distance fields");
+      outline_verification_.setScene(*scene_cloud, depth_outlines_param_);
     }
+  });
+  {
+    // EASY_BLOCK("Computing octree");
+    ScopeTime t("Computing octree");
+    octree_scene_downsampled_.reset(
+        new pcl::octree::OctreePointCloudSearch<PointTWithNormal>(param_.octree_resolution_m_));
+    octree_scene_downsampled_->setInputCloud(scene_cloud_downsampled_);
+    octree_scene_downsampled_->addPointsFromInputCloud();
   }
+  scene_setup.wait();
 }
 
 template <typename PointT>
@@ -15,6 +15,8 @@
 #include <glog/logging.h>
 #include <yaml-cpp/yaml.h>
 
+#include <cmath>
+
 constexpr const auto kSymmetryXyz = "symmetry_xyz";
 constexpr const auto kRotationalInvariance = "rotational_invariance_xyz";
 
@@ -49,6 +51,104 @@ ModelProperties::ModelProperties(const bf::path &metadata_file) {
 
 template <typename PointT>
 void Model<PointT>::initialize(const bf::path &model_filename, const NormalEstimatorParameter &ne_param) {
+  {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    model_filename_ = model_filename;
+    ne_param_ = ne_param;
+    model_cloud_.reset();
+    initialize_requested_ = true;
+  }
+  invalidateAssembled();
+}
+
+template <typename PointT>
+void Model<PointT>::initialize(const typename pcl::PointCloud<PointTWithNormal>::ConstPtr &model_cloud) {
+  CHECK(model_cloud) << "No 3D model given for object model " << id_;
+  {
+    std::lock_guard<std::mutex> lock(assembled_mutex_);
+    model_filename_ = "";
+    model_cloud_ = model_cloud;
+    initialize_requested_ = true;
+  }
+  invalidateAssembled();
+}
+
+template <typename PointT>
+void Model<PointT>::invalidateAssembled() {
+  std::lock(assembled_mutex_, voxelized_assembled_mutex_);
+  std::lock_guard<std::mutex> lock(assembled_mutex_, std::adopt_lock);
+  std::lock_guard<std::mutex> lock_voxelized(voxelized_assembled_mutex_, std::adopt_lock);
+  assembled_ = false;
+  all_assembled_.reset();
+  convex_hull_points_.reset();
+  cluster_props_.reset();
+  diameter_ = 0.f;
+  voxelized_assembled_.clear();
+  assembled_generation_++;
+}
+
+template <typename PointT>
+typename pcl::PointCloud<typename Model<PointT>::PointTWithNormal>::ConstPtr Model<PointT>::getAssembled(
+    const DownsamplerParameter &ds_param, bool keep_downsampled_cloud) const {
+  CHECK(ds_param.resolution_ >= 0.f);
+  const DownsamplingKey key(static_cast<int>(ds_param.method_), std::lround(ds_param.resolution_ * 1e6f),
+                            std::lround(ds_param.advanced_angular_distance_thershold_ * 1e3f));
+
+  while (true) {
+    size_t generation;
+    {
+      std::lock_guard<std::mutex> lock(voxelized_assembled_mutex_);
+      const auto it = voxelized_assembled_.find(key);
+      if (it != voxelized_assembled_.end())
+        return it->second;
+      generation = assembled_generation_;
+    }
+
+    // downsample without holding the lock so that other resolutions (or models) are not blocked
+    Downsampler ds(ds_param);
+    typename pcl::PointCloud<PointTWithNormal>::ConstPtr downsampled_cloud =
+        ds.downsample<PointTWithNormal>(getAssembled());
+
+    if (!keep_downsampled_cloud)
+      return downsampled_cloud;
+
+    // if another thread was faster, return its result so that all callers share the same cloud. If the model was
+    // invalidated in the meantime, the cloud may be downsampled from the old model and is computed again.
+    std::lock_guard<std::mutex> lock(voxelized_assembled_mutex_);
+    if (assembled_generation_ == generation)
+      return voxelized_assembled_.emplace(key, downsampled_cloud).first->second;
+  }
+}
+
+template <typename PointT>
+void Model<PointT>::assemble() const {
+  if (assembled_ || !initialize_requested_)
+    return;
+
+  if (model_cloud_)
+    all_assembled_ = model_cloud_;
+  else
+    all_assembled_ = loadOrCreateModelCloud();
+
+  pcl::getMinMax3D(*all_assembled_, minPoint_, maxPoint_);
+  convex_hull_points_.reset(new pcl::PointCloud<PointTWithNormal>);
+  {
+    // qhull keeps global state, so only one convex hull can be computed at a time
+    static std::mutex convex_hull_mutex;
+    std::lock_guard<std::mutex> convex_hull_lock(convex_hull_mutex);
+    pcl::ConvexHull<PointTWithNormal> convex_hull;
+    convex_hull.setInputCloud(all_assembled_);
+    convex_hull.reconstruct(*convex_hull_points_);
+  }
+  diameter_ = computePointcloudDiameter(*convex_hull_points_);
+  cluster_props_.reset(new Cluster(*all_assembled_));
+  assembled_ = true;
+}
+
+template <typename PointT>
+typename pcl::PointCloud<typename Model<PointT>::PointTWithNormal>::Ptr Model<PointT>::loadOrCreateModelCloud() const {
+  const bf::path &model_filename = model_filename_;
+  const NormalEstimatorParameter &ne_param = ne_param_;
   typename pcl::PointCloud<PointTWithNormal>::Ptr all_assembled(new pcl::PointCloud<PointTWithNormal>);
   if (!io::existsFile(model_filename) || pcl::io::loadPCDFile(model_filename.string(), *all_assembled) == -1) {
     v4r::ScopeTime t("Creating 3D model");
@@ -141,14 +241,7 @@ void Model<PointT>::initialize(const bf::path &model_filename, const NormalEstim
       }
   }
 
-  all_assembled_ = all_assembled;
-  pcl::getMinMax3D(*all_assembled_, minPoint_, maxPoint_);
-  pcl::ConvexHull<PointTWithNormal> convex_hull;
-  convex_hull.setInputCloud(all_assembled_);
-  convex_hull_points_.reset(new pcl::PointCloud<PointTWithNormal>);
-  convex_hull.reconstruct(*convex_hull_points_);
-  diameter_ = computePointcloudDiameter(*convex_hull_points_);
-  cluster_props_.reset(new Cluster(*all_assembled_));
+  return all_assembled;
 }
 
 template class Model<pcl::PointXYZ>;
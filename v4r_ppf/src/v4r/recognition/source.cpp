@@ -1,11 +1,51 @@
 #include <glog/logging.h>
 #include <pcl/point_types.h>
+#include <v4r/common/task_scheduler.h>
 #include <v4r/io/filesystem.h>
 #include <v4r/recognition/source.h>
 #include <boost/algorithm/string.hpp>
 
 namespace v4r {
 
+template <typename PointT>
+typename Model<PointT>::Ptr Source<PointT>::loadModel(const bf::path &class_path, const std::string &class_id,
+                                                      const std::string &instance_id) const {
+  typename Model<PointT>::Ptr obj(new Model<PointT>);
+  obj->id_ = instance_id;
+  obj->class_ = class_id;
+
+  const bf::path object_dir = class_path / instance_id / param_.view_folder_name_;
+  const std::string view_pattern = ".*" + param_.view_prefix_ + ".*.pcd";
+  std::vector<std::string> training_view_filenames = io::getFilesInDirectory(object_dir, view_pattern, false);
+
+  LOG(INFO) << " ** loading model (class: " << class_id << ", instance: " << instance_id << ") with "
+            << training_view_filenames.size() << " views. ";
+
+  for (size_t v_id = 0; v_id < training_view_filenames.size(); v_id++) {
+    typename TrainingView<PointT>::Ptr v(new TrainingView<PointT>);
+    v->filename_ = object_dir / training_view_filenames[v_id];
+
+    std::string pose_filename = v->filename_.string();
+    boost::replace_last(pose_filename, param_.view_prefix_, param_.pose_prefix_);
+    boost::replace_last(pose_filename, ".pcd", ".txt");
+    v->pose_filename_ = pose_filename;
+
+    std::string indices_filename = v->filename_.string();
+    boost::replace_last(indices_filename, param_.view_prefix_, param_.indices_prefix_);
+    boost::replace_last(indices_filename, ".pcd", ".txt");
+    v->indices_filename_ = indices_filename;
+
+    obj->addTrainingView(v);
+  }
+
+  if (!param_.has_categories_) {
+    bf::path model3D_path = class_path / instance_id / param_.name_3D_model_;
+    obj->initialize(model3D_path);
+  }
+  obj->properties_ = ModelProperties(class_path / instance_id / param_.metadata_name_);
+  return obj;
+}
+
 template <typename PointT>
 void Source<PointT>::init(const bf::path &model_database_path,
                           const std::vector<std::string> &object_instances_to_load) {
@@ -15,6 +55,9 @@ void Source<PointT>::init(const bf::path &model_database_path,
   else
     categories.push_back("");
 
+  // (class, instance) of all models to load
+  std::vector<std::pair<std::string, std::string>> models_to_load;
+
   for (const std::string &cat : categories) {
     const bf::path class_path = model_database_path / cat;
     const std::vector<std::string> instance_names = io::getFoldersInDirectory(class_path);
@@ -36,53 +79,47 @@ void Source<PointT>::init(const bf::path &model_database_path,
         LOG(INFO) << "Skipping object " << instance_name << " because it is not in the list of objects to load.";
         continue;
       }
+      models_to_load.emplace_back(cat, instance_name);
+    }
+  }
 
-      typename Model<PointT>::Ptr obj(new Model<PointT>);
-      obj->id_ = instance_name;
-      obj->class_ = cat;
-
-      const bf::path object_dir = class_path / instance_name / param_.view_folder_name_;
-      const std::string view_pattern = ".*" + param_.view_prefix_ + ".*.pcd";
-      std::vector<std::string> training_view_filenames = io::getFilesInDirectory(object_dir, view_pattern, false);
-
-      LOG(INFO) << " ** loading model (class: " << cat << ", instance: " << instance_name << ") with "
-                << training_view_filenames.size() << " views. ";
-
-      for (size_t v_id = 0; v_id < training_view_filenames.size(); v_id++) {
-        typename TrainingView<PointT>::Ptr v(new TrainingView<PointT>);
-        v->filename_ = object_dir / training_view_filenames[v_id];
-
-        std::string pose_filename = v->filename_.string();
-        boost::replace_last(pose_filename, param_.view_prefix_, param_.pose_prefix_);
-        boost::replace_last(pose_filename, ".pcd", ".txt");
-        v->pose_filename_ = pose_filename;
-
-        std::string indices_filename = v->filename_.string();
-        boost::replace_last(indices_filename, param_.view_prefix_, param_.indices_prefix_);
-        boost::replace_last(indices_filename, ".pcd", ".txt");
-        v->indices_filename_ = indices_filename;
-
-        obj->addTrainingView(v);
-      }
+  // the 3D models themselves are only loaded when first accessed (see Model::initialize)
+  std::vector<typename Model<PointT>::Ptr> loaded_models(models_to_load.size());
+  parallelFor(0, models_to_load.size(), [&](size_t i) {
+    const std::string &cat = models_to_load[i].first;
+    loaded_models[i] = loadModel(model_database_path / cat, cat, models_to_load[i].second);
+  }, 1);
+
+  models_.reserve(models_.size() + loaded_models.size());
+  models_by_id_.reserve(models_by_id_.size() + loaded_models.size());
+  for (const auto &m : loaded_models)
+    addModel(m);
+}
 
-      if (!param_.has_categories_) {
-        bf::path model3D_path = class_path / instance_name / param_.name_3D_model_;
-        obj->initialize(model3D_path);
-      }
-      obj->properties_ = ModelProperties(class_path / instance_name / param_.metadata_name_);
-      addModel(obj);
-    }
+template <typename PointT>
+void Source<PointT>::init(
+    const std::vector<std::pair<std::string, typename pcl::PointCloud<PointTWithNormal>::ConstPtr>> &model_clouds,
+    const std::string &class_id) {
+  LOG(INFO) << "Adding " << model_clouds.size() << " object models from memory. ";
+
+  models_.reserve(models_.size() + model_clouds.size());
+  models_by_id_.reserve(models_by_id_.size() + model_clouds.size());
+  for (const auto &instance : model_clouds) {
+    typename Model<PointT>::Ptr obj(new Model<PointT>);
+    obj->id_ = instance.first;
+    obj->class_ = class_id;
+    obj->initialize(instance.second);
+    addModel(obj);
   }
 }
 
 template <typename PointT>
 typename Model<PointT>::ConstPtr Source<PointT>::getModelById(const std::string &class_id,
                                                               const std::string &instance_id) const {
-  for (size_t i = 0; i < models_.size(); i++) {
-    if (models_[i]->id_.compare(instance_id) == 0 && models_[i]->class_.compare(class_id) == 0) {
-      return models_[i];
-    }
-  }
+  const auto it = models_by_id_.find(getModelKey(class_id, instance_id));
+  if (it != models_by_id_.end())
+    return it->second;
+
   LOG(ERROR) << "Model with class: " << class_id << " and instance: " << instance_id << " not found";
   return nullptr;
 }
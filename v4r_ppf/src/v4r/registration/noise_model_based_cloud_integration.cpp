@@ -3,6 +3,7 @@
 #include <pcl/octree/octree_pointcloud_pointvector.h>
 #include <pcl/pcl_config.h>
 #include <v4r/common/noise_models.h>
+#include <v4r/common/task_scheduler.h>
 #include <v4r/geometry/normals.h>
 #include <v4r/registration/noise_model_based_cloud_integration.h>
 #include <numeric>
@@ -10,7 +11,6 @@
 #include <pcl/octree/impl/octree_iterator.hpp>
 
 #include <glog/logging.h>
-#include <omp.h>
 
 namespace po = boost::program_options;
 
@@ -57,14 +57,14 @@ void NMBasedCloudIntegrationParameter::init(boost::program_options::options_desc
 }
 
 template <typename PointT>
-void NMBasedCloudIntegration<PointT>::addView(const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
-                                              const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
-                                              const Eigen::Matrix4f &transform_to_global_reference_frame,
-                                              const boost::optional<std::vector<int>> &indices) {
+void NMBasedCloudIntegration<PointT>::computeViewInfo(const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                                      const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
+                                                      const Eigen::Matrix4f &transform_to_global_reference_frame,
+                                                      const boost::optional<std::vector<int>> &indices,
+                                                      std::vector<PointInfo> &view_info) const {
   // pre-allocate memory
-  size_t old_size = big_cloud_info_.size();
-  size_t max_new_pts = indices ? old_size + indices.get().size() : cloud->size();
-  big_cloud_info_.resize(old_size + max_new_pts);
+  size_t max_new_pts = indices ? indices.get().size() : cloud->size();
+  view_info.resize(max_new_pts);
   cv::Mat img_boundary_distance;
   std::vector<std::vector<float>> pt_properties;
 
@@ -105,16 +105,12 @@ void NMBasedCloudIntegration<PointT>::addView(const typename pcl::PointCloud<Poi
   pcl::transformPointCloud(*cloud, cloud_aligned, transform_to_global_reference_frame);
   v4r::transformNormals(*normals, normals_aligned, transform_to_global_reference_frame);
 
-  size_t kept_new_pts = 0;
-  std::vector<int> fake_indices;
-  if (indices) {
-    fake_indices = indices.get();
-  } else {
-    fake_indices.resize(cloud_aligned.size());
-    std::iota(std::begin(fake_indices), std::end(fake_indices), 0);
-  }
+  // the rotation is the same for all points of this view
+  const Eigen::Matrix3f rotation = transform_to_global_reference_frame.block<3, 3>(0, 0);
 
-  for (int idx : fake_indices) {
+  size_t kept_new_pts = 0;
+  for (size_t i = 0; i < max_new_pts; i++) {
+    const int idx = indices ? indices.get()[i] : static_cast<int>(i);
     const auto &p_orig = cloud->points[idx];
     const auto &n_orig = normals->points[idx];
     const auto &p_aligned = cloud_aligned.points[idx];
@@ -123,7 +119,7 @@ void NMBasedCloudIntegration<PointT>::addView(const typename pcl::PointCloud<Poi
     if (!pcl::isFinite(p_aligned) || !pcl::isFinite(n_aligned))
       continue;
 
-    auto &pt = big_cloud_info_[old_size + kept_new_pts];
+    auto &pt = view_info[kept_new_pts];
     pt.pt_ = p_aligned;
     pt.normal_ = n_aligned;
     pt.dotp_ = p_orig.getVector3fMap().normalized().dot(n_orig.getNormalVector3fMap());
@@ -138,8 +134,6 @@ void NMBasedCloudIntegration<PointT>::addView(const typename pcl::PointCloud<Poi
       const auto sigma_lateral_ = pt_properties[idx][0];
       const auto sigma_axial_ = pt_properties[idx][1];
       const Eigen::DiagonalMatrix<float, 3> sigma(sigma_lateral_, sigma_lateral_, sigma_axial_);
-      const Eigen::Matrix4f &tf = transform_to_global_reference_frame;
-      Eigen::Matrix3f rotation = tf.block<3, 3>(0, 0);  // or inverse?
       Eigen::Matrix3f sigma_aligned = rotation * sigma * rotation.transpose();
       double det = sigma_aligned.determinant();
 
@@ -158,7 +152,41 @@ void NMBasedCloudIntegration<PointT>::addView(const typename pcl::PointCloud<Poi
 
     kept_new_pts++;
   }
-  big_cloud_info_.resize(old_size + kept_new_pts);
+  view_info.resize(kept_new_pts);
+}
+
+template <typename PointT>
+void NMBasedCloudIntegration<PointT>::addView(const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                              const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
+                                              const Eigen::Matrix4f &transform_to_global_reference_frame,
+                                              const boost::optional<std::vector<int>> &indices) {
+  std::vector<PointInfo> view_info;
+  computeViewInfo(cloud, normals, transform_to_global_reference_frame, indices, view_info);
+  big_cloud_info_.insert(big_cloud_info_.end(), view_info.begin(), view_info.end());
+}
+
+template <typename PointT>
+void NMBasedCloudIntegration<PointT>::addViews(
+    const std::vector<typename pcl::PointCloud<PointT>::ConstPtr> &clouds,
+    const std::vector<pcl::PointCloud<pcl::Normal>::ConstPtr> &normals,
+    const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> &transforms_to_global_reference_frame) {
+  CHECK(clouds.size() == normals.size() && clouds.size() == transforms_to_global_reference_frame.size());
+
+  std::vector<std::vector<PointInfo>> views_info(clouds.size());
+
+  parallelFor(0, clouds.size(), [&](size_t v_id) {
+    computeViewInfo(clouds[v_id], normals[v_id], transforms_to_global_reference_frame[v_id], boost::none,
+                    views_info[v_id]);
+  }, 1);
+
+  // append in view order so the big cloud is the same as when adding the views one by one
+  size_t num_new_pts = 0;
+  for (const auto &view_info : views_info)
+    num_new_pts += view_info.size();
+
+  big_cloud_info_.reserve(big_cloud_info_.size() + num_new_pts);
+  for (const auto &view_info : views_info)
+    big_cloud_info_.insert(big_cloud_info_.end(), view_info.begin(), view_info.end());
 }
 
 template <typename PointT>
@@ -179,36 +207,10 @@ void NMBasedCloudIntegration<PointT>::compute(typename pcl::PointCloud<PointT>::
   const typename pcl::octree::OctreePointCloudPointVector<PointT>::LeafNodeIterator it2_end = octree.leaf_end();
 #endif
 
-  size_t kept = 0;
-  size_t total_used = 0;
-  size_t min_points_per_voxel = param_.min_points_per_voxel_;
-
-  if (param_.resolution_adaptive_min_points_) {
-    size_t max_pts_per_voxel = 0;
-#if PCL_VERSION_COMPARE(>=, 1, 9, 0)
-    for (leaf_it = octree.leaf_depth_begin(); leaf_it != it2_end; ++leaf_it) {
-#else
-    for (leaf_it = octree.leaf_begin(); leaf_it != it2_end; ++leaf_it) {
-#endif
-      pcl::octree::OctreeContainerPointIndices &container = leaf_it.getLeafContainer();
-
-      // add points from leaf node to indexVector
-      std::vector<int> indexVector;
-      container.getPointIndices(indexVector);
-
-      if (indexVector.size() > max_pts_per_voxel)
-        max_pts_per_voxel = indexVector.size();
-    }
-    min_points_per_voxel =
-        std::max<size_t>(param_.min_points_per_voxel_,
-                         static_cast<size_t>(param_.adaptive_min_points_percentage_thresh_ * max_pts_per_voxel));
-    LOG(INFO) << "Adaptive filtering enable with a threshold computed at " << min_points_per_voxel
-              << " points given a maximum number of " << max_pts_per_voxel << " and an adaptive threshold of "
-              << param_.adaptive_min_points_percentage_thresh_;
-  }
-
-  std::vector<PointInfo> filtered_cloud_info(big_cloud_info_.size());
-
+  // gather the point indices of all non-empty leaves once (in octree traversal order) so that the voxels can be
+  // processed independently
+  std::vector<std::vector<int>> voxel_indices;
+  size_t max_pts_per_voxel = 0;
 #if PCL_VERSION_COMPARE(>=, 1, 9, 0)
   for (leaf_it = octree.leaf_depth_begin(); leaf_it != it2_end; ++leaf_it) {
 #else
@@ -223,59 +225,95 @@ void NMBasedCloudIntegration<PointT>::compute(typename pcl::PointCloud<PointT>::
     if (indexVector.empty())
       continue;
 
-    std::vector<PointInfo> voxel_pts(indexVector.size());
+    max_pts_per_voxel = std::max<size_t>(max_pts_per_voxel, indexVector.size());
+    voxel_indices.push_back(std::move(indexVector));
+  }
 
-    for (size_t k = 0; k < indexVector.size(); k++)
-      voxel_pts[k] = big_cloud_info_[indexVector[k]];
+  size_t min_points_per_voxel = param_.min_points_per_voxel_;
 
-    size_t num_good_pts = std::count_if(voxel_pts.begin(), voxel_pts.end(), [this](const PointInfo &p) {
-      return p.distance_to_depth_discontinuity_ > this->param_.min_px_distance_to_depth_discontinuity_;
-    });
+  if (param_.resolution_adaptive_min_points_) {
+    min_points_per_voxel =
+        std::max<size_t>(param_.min_points_per_voxel_,
+                         static_cast<size_t>(param_.adaptive_min_points_percentage_thresh_ * max_pts_per_voxel));
+    LOG(INFO) << "Adaptive filtering enable with a threshold computed at " << min_points_per_voxel
+              << " points given a maximum number of " << max_pts_per_voxel << " and an adaptive threshold of "
+              << param_.adaptive_min_points_percentage_thresh_;
+  }
 
-    if (num_good_pts < min_points_per_voxel)
-      continue;
+  std::vector<PointInfo> voxel_result(voxel_indices.size());
+  std::vector<unsigned char> voxel_is_kept(voxel_indices.size(), 0);
+  std::atomic<size_t> total_used(0);
 
-    PointInfo p;
+  parallelForChunks(0, voxel_indices.size(), [&](size_t chunk_begin, size_t chunk_end) {
+    size_t chunk_used = 0;
+    for (size_t v = chunk_begin; v < chunk_end; v++) {
+      const std::vector<int> &indexVector = voxel_indices[v];
+      std::vector<PointInfo> voxel_pts(indexVector.size());
 
-    if (param_.average_) {
-      for (const PointInfo &pt_tmp : voxel_pts) {
-        if (pt_tmp.distance_to_depth_discontinuity_ > param_.min_px_distance_to_depth_discontinuity_) {
-          p.moving_average(pt_tmp);
-        }
-      }
-      total_used += num_good_pts;
-    } else {
-      // now comes the actual magic. We only return the point with minimum weight within this voxel. Except the viewray
-      // to surface configuration is so bad that we rather return a point whose surface is more facing the camera.
-      std::sort(voxel_pts.begin(), voxel_pts.end(), [this](const PointInfo &a, const PointInfo &b) {
-        if ((a.distance_to_depth_discontinuity_ < param_.px_distance_to_depth_discontinuity_thresh_ ||
-             b.distance_to_depth_discontinuity_ < param_.px_distance_to_depth_discontinuity_thresh_) &&
-            (static_cast<int>(a.distance_to_depth_discontinuity_) !=
-             static_cast<int>(b.distance_to_depth_discontinuity_)))
-          return a.distance_to_depth_discontinuity_ > b.distance_to_depth_discontinuity_;
-
-        // we take a minus here because the viewpoint and the surface normal will have a negative inner product
-        if (a.dotp_ > -param_.viewpoint_surface_orienation_dotp_thresh_ ||
-            b.dotp_ > -param_.viewpoint_surface_orienation_dotp_thresh_)
-          return a.dotp_ < b.dotp_;
-
-        return a.weight_ < b.weight_;
-      });
+      for (size_t k = 0; k < indexVector.size(); k++)
+        voxel_pts[k] = big_cloud_info_[indexVector[k]];
 
-      const auto it = std::find_if(voxel_pts.begin(), voxel_pts.end(), [this](const auto &pt) -> bool {
-        return pt.distance_to_depth_discontinuity_ > param_.min_px_distance_to_depth_discontinuity_;
+      size_t num_good_pts = std::count_if(voxel_pts.begin(), voxel_pts.end(), [this](const PointInfo &p) {
+        return p.distance_to_depth_discontinuity_ > this->param_.min_px_distance_to_depth_discontinuity_;
       });
 
-      if (it != voxel_pts.end())
-        p = *it;
+      if (num_good_pts < min_points_per_voxel)
+        continue;
+
+      PointInfo p;
 
-      total_used++;
+      if (param_.average_) {
+        for (const PointInfo &pt_tmp : voxel_pts) {
+          if (pt_tmp.distance_to_depth_discontinuity_ > param_.min_px_distance_to_depth_discontinuity_) {
+            p.moving_average(pt_tmp);
+          }
+        }
+        chunk_used += num_good_pts;
+      } else {
+        // now comes the actual magic. We only return the point with minimum weight within this voxel. Except the
+        // viewray to surface configuration is so bad that we rather return a point whose surface is more facing the
+        // camera.
+        std::sort(voxel_pts.begin(), voxel_pts.end(), [this](const PointInfo &a, const PointInfo &b) {
+          if ((a.distance_to_depth_discontinuity_ < param_.px_distance_to_depth_discontinuity_thresh_ ||
+               b.distance_to_depth_discontinuity_ < param_.px_distance_to_depth_discontinuity_thresh_) &&
+              (static_cast<int>(a.distance_to_depth_discontinuity_) !=
+               static_cast<int>(b.distance_to_depth_discontinuity_)))
+            return a.distance_to_depth_discontinuity_ > b.distance_to_depth_discontinuity_;
+
+          // we take a minus here because the viewpoint and the surface normal will have a negative inner product
+          if (a.dotp_ > -param_.viewpoint_surface_orienation_dotp_thresh_ ||
+              b.dotp_ > -param_.viewpoint_surface_orienation_dotp_thresh_)
+            return a.dotp_ < b.dotp_;
+
+          return a.weight_ < b.weight_;
+        });
+
+        const auto it = std::find_if(voxel_pts.begin(), voxel_pts.end(), [this](const auto &pt) -> bool {
+          return pt.distance_to_depth_discontinuity_ > param_.min_px_distance_to_depth_discontinuity_;
+        });
+
+        if (it != voxel_pts.end())
+          p = *it;
+
+        chunk_used++;
+      }
+      voxel_result[v] = p;
+      voxel_is_kept[v] = 1;
     }
-    filtered_cloud_info[kept++] = p;
+    total_used += chunk_used;
+  }, 64);
+
+  // compact in voxel order to keep the output independent of the thread scheduling
+  std::vector<PointInfo> filtered_cloud_info;
+  filtered_cloud_info.reserve(voxel_result.size());
+  for (size_t v = 0; v < voxel_result.size(); v++) {
+    if (voxel_is_kept[v])
+      filtered_cloud_info.push_back(voxel_result[v]);
   }
-  filtered_cloud_info.resize(kept);
+  const size_t kept = filtered_cloud_info.size();
 
-  LOG(INFO) << "Number of points in final noise model based integrated cloud: " << kept << " used: " << total_used;
+  LOG(INFO) << "Number of points in final noise model based integrated cloud: " << kept
+            << " used: " << total_used.load();
 
   if (!output)
     output.reset(new pcl::PointCloud<PointT>);
@@ -287,10 +325,10 @@ void NMBasedCloudIntegration<PointT>::compute(typename pcl::PointCloud<PointT>::
   output_normals_->resize(kept);
   output->is_dense = output_normals_->is_dense = true;
 
-  for (size_t i = 0; i < filtered_cloud_info.size(); i++) {
+  parallelFor(0, filtered_cloud_info.size(), [&](size_t i) {
     output_normals_->points[i] = filtered_cloud_info[i].normal_;
     output->points[i] = filtered_cloud_info[i].pt_;
-  }
+  });
   cleanUp();
 }
 
@@ -1,4 +1,5 @@
 #include <v4r/common/point_types.h>
+#include <v4r/common/task_scheduler.h>
 #include <v4r/segmentation/plane_extractor_tile.h>
 #include <v4r/segmentation/plane_utils.h>
 
@@ -215,28 +216,37 @@ int PlaneExtractorTile<PointT>::allocateMemory() {
 }
 
 template <typename PointT>
-void PlaneExtractorTile<PointT>::calculatePlaneSegments(bool doNormalTest) {
-  // create the blockwise plane description
-  for (size_t i = 0; i < rowsOfPatches; i++) {
-    for (size_t j = 0; j < colsOfPatches; j++) {
-      PlaneMatrix pm;
-      for (size_t m = 0; m < param_.patchDim_; m++) {
-        for (size_t n = 0; n < param_.patchDim_; n++) {
-          const PointT &p = cloud_->at(
-              j * param_.patchDim_ + n,
-              i * param_.patchDim_ + m);  // points.at<Eigen::Vector4f>(i*param_.patchDim_+m+1,j*param_.patchDim_+n+1);
-          if (pcl::isFinite(p)) {
-            pm.addPoint(p.getVector3fMap());
-          }
-        }
+typename PlaneExtractorTile<PointT>::PlaneMatrix PlaneExtractorTile<PointT>::accumulatePatch(size_t i,
+                                                                                             size_t j) const {
+  // (x,y,z,1) * (x,y,z,1)^T yields all second order moments, the point sum and the point count in one packet
+  // operation per point, instead of the scalar updates of PlaneMatrix::addPoint
+  Eigen::Matrix4d moments = Eigen::Matrix4d::Zero();
+  for (size_t m = 0; m < param_.patchDim_; m++) {
+    const PointT *row = &cloud_->at(j * param_.patchDim_, i * param_.patchDim_ + m);
+    for (size_t n = 0; n < param_.patchDim_; n++) {
+      const PointT &p = row[n];
+      if (pcl::isFinite(p)) {
+        const Eigen::Vector4d ph(p.x, p.y, p.z, 1.);
+        moments.noalias() += ph * ph.transpose();
       }
-      matrices[i * colsOfPatches + j] = pm;
     }
   }
 
-  // calculate all plane segments
-  for (size_t i = 0; i < rowsOfPatches; i++) {
+  PlaneMatrix pm;
+  pm.addMoments(moments);
+  return pm;
+}
+
+template <typename PointT>
+void PlaneExtractorTile<PointT>::calculatePlaneSegments(bool doNormalTest) {
+  // patches are independent of each other (each one only writes its own pixels and its own entries in the patch
+  // buffers), so the blockwise plane description is computed tile-parallel
+  parallelFor(0, rowsOfPatches, [&](size_t i) {
     for (size_t j = 0; j < colsOfPatches; j++) {
+      // create the blockwise plane description
+      matrices[i * colsOfPatches + j] = accumulatePatch(i, j);
+
+      // calculate the plane segment
       const PlaneMatrix &m = matrices[i * colsOfPatches + j];
       const Eigen::Vector3f msum = m.sum.template cast<float>();
       centerPoints[i][j] = msum / m.nrPoints;
@@ -309,7 +319,7 @@ void PlaneExtractorTile<PointT>::calculatePlaneSegments(bool doNormalTest) {
         planes[i][j].nrInliers = 0;
       }
     }
-  }
+  }, 1);
 }
 
 template <typename PointT>
@@ -0,0 +1,161 @@
+#include <glog/logging.h>
+#include <v4r/common/bitset_clique_enumerator.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::vector<std::vector<size_t>> Cliques;
+
+v4r::BitsetAdjacency randomGraph(size_t n, double edge_probability, std::mt19937 &gen) {
+  std::bernoulli_distribution has_edge(edge_probability);
+  v4r::BitsetAdjacency adj(n);
+  for (size_t a = 0; a < n; a++) {
+    for (size_t b = a + 1; b < n; b++) {
+      if (has_edge(gen))
+        adj.addEdge(a, b);
+    }
+  }
+  return adj;
+}
+
+// all maximal cliques with at least min_size vertices by checking every vertex subset
+Cliques bruteForceCliques(const v4r::BitsetAdjacency &adj, size_t min_size) {
+  const size_t n = adj.numVertices();
+  Cliques cliques;
+  for (uint32_t subset = 1; subset < (uint32_t(1) << n); subset++) {
+    std::vector<size_t> clique;
+    for (size_t v = 0; v < n; v++) {
+      if (subset & (uint32_t(1) << v))
+        clique.push_back(v);
+    }
+    if (clique.size() < min_size)
+      continue;
+
+    bool is_clique = true;
+    for (size_t i = 0; i < clique.size() && is_clique; i++) {
+      for (size_t j = i + 1; j < clique.size() && is_clique; j++)
+        is_clique = adj.hasEdge(clique[i], clique[j]);
+    }
+    if (!is_clique)
+      continue;
+
+    bool is_maximal = true;
+    for (size_t v = 0; v < n && is_maximal; v++) {
+      if (subset & (uint32_t(1) << v))
+        continue;
+      is_maximal = !std::all_of(clique.begin(), clique.end(), [&](size_t u) { return adj.hasEdge(u, v); });
+    }
+    if (is_maximal)
+      cliques.push_back(clique);
+  }
+  return cliques;
+}
+
+Cliques normalized(Cliques cliques) {
+  for (auto &c : cliques)
+    std::sort(c.begin(), c.end());
+  std::sort(cliques.begin(), cliques.end());
+  return cliques;
+}
+
+// without limits the enumerator finds exactly the maximal cliques of the brute force search, each of them once
+void testAgainstBruteForce() {
+  std::mt19937 gen(1);
+  for (size_t n : {0, 1, 2, 5, 8, 12, 16}) {
+    for (double p : {0.0, 0.3, 0.6, 0.9, 1.0}) {
+      for (int rep = 0; rep < 3; rep++) {
+        const v4r::BitsetAdjacency adj = randomGraph(n, p, gen);
+        for (size_t min_size = 1; min_size <= 5; min_size++) {
+          Cliques cliques;
+          v4r::BitsetCliqueEnumerator enumerator(adj, min_size);
+          CHECK(enumerator.compute(cliques));
+          CHECK(!enumerator.timedOut());
+          CHECK(normalized(cliques) == normalized(bruteForceCliques(adj, min_size)))
+              << "n " << n << ", p " << p << ", min clique size " << min_size;
+        }
+      }
+    }
+  }
+}
+
+// a graph with more than 64 vertices spans several bitset words per row
+void testMultiWordGraph() {
+  std::mt19937 gen(2);
+  v4r::BitsetAdjacency adj(150);
+  std::vector<size_t> planted = {3, 40, 63, 64, 65, 100, 127, 128, 149};
+  for (size_t i = 0; i < planted.size(); i++) {
+    for (size_t j = i + 1; j < planted.size(); j++)
+      adj.addEdge(planted[i], planted[j]);
+  }
+  std::bernoulli_distribution has_edge(0.05);
+  for (size_t a = 0; a < 150; a++) {
+    for (size_t b = a + 1; b < 150; b++) {
+      if (has_edge(gen))
+        adj.addEdge(a, b);
+    }
+  }
+
+  Cliques cliques;
+  v4r::BitsetCliqueEnumerator enumerator(adj, 6);
+  CHECK(enumerator.compute(cliques));
+  CHECK_EQ(cliques.size(), 1u);
+  std::sort(cliques[0].begin(), cliques[0].end());
+  CHECK(cliques[0] == planted);
+}
+
+// a search stopped by its node budget reports whatever it found so far: a prefix of the complete result, and the same
+// prefix for the same budget
+void testNodeBudget() {
+  std::mt19937 gen(3);
+  const v4r::BitsetAdjacency adj = randomGraph(16, 0.6, gen);
+  const size_t min_size = 3;
+
+  Cliques all_cliques;
+  v4r::BitsetCliqueEnumerator full_enumerator(adj, min_size);
+  CHECK(full_enumerator.compute(all_cliques));
+  CHECK(normalized(all_cliques) == normalized(bruteForceCliques(adj, min_size)));
+  const size_t needed_nodes = full_enumerator.getNumVisitedNodes();
+  CHECK_GT(needed_nodes, 10u);
+
+  Cliques cliques;
+  v4r::BitsetCliqueEnumerator exact_enumerator(adj, min_size, needed_nodes);
+  CHECK(exact_enumerator.compute(cliques));
+  CHECK(cliques == all_cliques);
+
+  for (size_t budget : {size_t(0), size_t(1), needed_nodes / 4, needed_nodes / 2, needed_nodes - 1}) {
+    Cliques truncated, repeated;
+    v4r::BitsetCliqueEnumerator enumerator(adj, min_size, budget);
+    CHECK(!enumerator.compute(truncated)) << "budget " << budget;
+    CHECK(!enumerator.timedOut());
+    CHECK_LE(truncated.size(), all_cliques.size());
+    CHECK(std::equal(truncated.begin(), truncated.end(), all_cliques.begin())) << "budget " << budget;
+
+    CHECK(!enumerator.compute(repeated));
+    CHECK(repeated == truncated);
+  }
+}
+
+// on a graph with far too many cliques the time limit stops the search
+void testTimeLimit() {
+  std::mt19937 gen(4);
+  const v4r::BitsetAdjacency adj = randomGraph(400, 0.5, gen);
+  Cliques cliques;
+  v4r::BitsetCliqueEnumerator enumerator(adj, 3, std::numeric_limits<size_t>::max(), 1.);
+  CHECK(!enumerator.compute(cliques));
+  CHECK(enumerator.timedOut());
+}
+
+}  // namespace
+
+int main() {
+  testAgainstBruteForce();
+  testMultiWordGraph();
+  testNodeBudget();
+  testTimeLimit();
+  return 0;
+}
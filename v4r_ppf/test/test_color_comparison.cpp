@@ -0,0 +1,89 @@
+#include <glog/logging.h>
+#include <v4r/common/color_comparison.h>
+#include <v4r/common/color_conversion.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// the batch kernels compute in single precision, the scalar functions are the reference. The error is relative to
+// differences larger than 1, computeCIE94_DEFAULT (Kl = .015) returns differences in the thousands.
+const float max_diff = 3e-5f;
+
+float tolerance(float expected) {
+  return max_diff * std::max(1.f, std::abs(expected));
+}
+
+// random colours plus the corner cases (black, grey, white, identical and achromatic pairs)
+void makeLabPairs(Eigen::MatrixX3f &a, Eigen::MatrixX3f &b) {
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<int> channel(0, 255);
+  const int n = 5000;
+  std::vector<uint32_t> rgb(n);
+  for (auto &c : rgb)
+    c = v4r::packRGB(channel(gen), channel(gen), channel(gen));
+  rgb[0] = v4r::packRGB(0, 0, 0);
+  rgb[1] = v4r::packRGB(128, 128, 128);
+  rgb[2] = v4r::packRGB(255, 255, 255);
+  std::vector<Eigen::Vector3f> lab(n);
+  v4r::convertRGBToLab(rgb.data(), n, lab.data());
+
+  a.resize(n, 3);
+  b.resize(n, 3);
+  for (int i = 0; i < n; i++) {
+    a.row(i) = lab[i].transpose();
+    b.row(i) = lab[(i * 7 + 3) % n].transpose();
+  }
+  b.row(5) = a.row(5);
+  b.row(6) = a.row(1);
+  a.row(7) = a.row(0);
+}
+
+template <typename BatchFunc, typename ScalarFunc>
+void checkAgainstScalar(const Eigen::MatrixX3f &a, const Eigen::MatrixX3f &b, BatchFunc batch, ScalarFunc scalar,
+                        const char *name) {
+  Eigen::VectorXf diff;
+  batch(a, b, diff);
+  CHECK_EQ(diff.size(), a.rows());
+  for (int i = 0; i < a.rows(); i++) {
+    const Eigen::Vector3f ai = a.row(i).transpose(), bi = b.row(i).transpose();
+    const float expected = scalar(ai, bi);
+    CHECK_NEAR(diff[i], expected, tolerance(expected)) << name << " row " << i;
+  }
+
+  // one colour against many
+  const Eigen::Vector3f a0 = a.row(10).transpose();
+  batch(a0, b, diff);
+  CHECK_EQ(diff.size(), b.rows());
+  for (int i = 0; i < b.rows(); i++) {
+    const Eigen::Vector3f bi = b.row(i).transpose();
+    const float expected = scalar(a0, bi);
+    CHECK_NEAR(diff[i], expected, tolerance(expected)) << name << " (one against many) row " << i;
+  }
+}
+
+}  // namespace
+
+int main() {
+  Eigen::MatrixX3f a, b;
+  makeLabPairs(a, b);
+
+  checkAgainstScalar(
+      a, b, [](const auto &x, const Eigen::MatrixX3f &y, Eigen::VectorXf &d) { v4r::computeCIE76(x, y, d); },
+      [](const Eigen::Vector3f &x, const Eigen::Vector3f &y) { return v4r::computeCIE76(x, y); }, "CIE76");
+  checkAgainstScalar(
+      a, b, [](const auto &x, const Eigen::MatrixX3f &y, Eigen::VectorXf &d) { v4r::computeCIE94_DEFAULT(x, y, d); },
+      [](const Eigen::Vector3f &x, const Eigen::Vector3f &y) { return v4r::computeCIE94_DEFAULT(x, y); }, "CIE94");
+  checkAgainstScalar(
+      a, b, [](const auto &x, const Eigen::MatrixX3f &y, Eigen::VectorXf &d) { v4r::computeCIEDE2000(x, y, d); },
+      [](const Eigen::Vector3f &x, const Eigen::Vector3f &y) { return v4r::computeCIEDE2000(x, y); }, "CIEDE2000");
+
+  // identical colours have no difference
+  Eigen::VectorXf diff;
+  v4r::computeCIEDE2000(a, a, diff);
+  CHECK_LE(diff.cwiseAbs().maxCoeff(), max_diff);
+  return 0;
+}
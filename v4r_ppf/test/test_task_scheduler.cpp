@@ -0,0 +1,170 @@
+#include <glog/logging.h>
+#include <v4r/common/task_scheduler.h>
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// every index of the range is processed exactly once
+void testParallelFor(v4r::TaskScheduler &scheduler) {
+  const size_t n = 100000;
+  std::vector<int> visits(n, 0);
+  v4r::parallelFor(0, n, [&](size_t i) { visits[i]++; }, 0, scheduler);
+  for (size_t i = 0; i < n; i++)
+    CHECK_EQ(visits[i], 1) << "index " << i;
+
+  std::atomic<size_t> sum(0);
+  v4r::parallelForChunks(10, 1010, [&](size_t begin, size_t end) {
+    size_t chunk_sum = 0;
+    for (size_t i = begin; i < end; i++)
+      chunk_sum += i;
+    sum += chunk_sum;
+  }, 16, scheduler);
+  CHECK_EQ(sum.load(), (10 + 1009) * 1000 / 2);
+}
+
+// a parallel loop inside the tasks of another parallel loop finishes without deadlock
+void testNestedParallelFor(v4r::TaskScheduler &scheduler) {
+  const size_t outer = 16, inner = 2000;
+  std::vector<std::atomic<int>> visits(outer * inner);
+  for (auto &v : visits)
+    v = 0;
+  v4r::parallelFor(0, outer, [&](size_t i) {
+    v4r::parallelFor(0, inner, [&](size_t j) { visits[i * inner + j]++; }, 0, scheduler);
+  }, 1, scheduler);
+  for (size_t k = 0; k < visits.size(); k++)
+    CHECK_EQ(visits[k].load(), 1) << "index " << k;
+}
+
+// the exception of a task is rethrown in the waiting thread, the scheduler stays usable afterwards
+void testExceptionPropagation(v4r::TaskScheduler &scheduler) {
+  bool caught = false;
+  try {
+    v4r::parallelFor(0, 10000, [](size_t i) {
+      if (i == 7777)
+        throw std::runtime_error("task failed");
+    }, 0, scheduler);
+  } catch (const std::runtime_error &e) {
+    caught = std::string(e.what()) == "task failed";
+  }
+  CHECK(caught);
+
+  caught = false;
+  try {
+    v4r::TaskGroup group(scheduler);
+    group.run([] { throw std::logic_error("group task failed"); });
+    group.run([] {});
+    group.wait();
+  } catch (const std::logic_error &) {
+    caught = true;
+  }
+  CHECK(caught);
+
+  testParallelFor(scheduler);
+}
+
+// a thread waiting for its group does not run unrelated tasks, they may need a lock the waiting thread holds
+void testWaitOnlyRunsOwnTasks() {
+  v4r::TaskScheduler scheduler(2);
+  std::atomic<bool> blocker_started(false), release_blocker(false), locker_ran(false);
+  std::mutex model_mutex;
+
+  v4r::TaskGroup unrelated(scheduler);
+  // keeps the only worker busy, so the tasks below stay queued until the waiting thread takes them
+  unrelated.run([&] {
+    blocker_started = true;
+    while (!release_blocker)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+  while (!blocker_started)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  {
+    std::lock_guard<std::mutex> lock(model_mutex);
+    bool own_task_ran = false;
+    v4r::TaskGroup group(scheduler);
+    group.run([&] { own_task_ran = true; });
+    // queued after the own task, a waiting thread that ran any task would take it first
+    unrelated.run([&] {
+      locker_ran = true;
+      if (model_mutex.try_lock())
+        model_mutex.unlock();
+    });
+    group.wait();
+    CHECK(own_task_ran);
+    CHECK(!locker_ran);
+  }
+  release_blocker = true;
+  unrelated.wait();
+  CHECK(locker_ran);
+}
+
+double threadCpuSeconds() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// a thread waiting for a running task of its group blocks instead of spinning
+void testWaitDoesNotSpin() {
+  v4r::TaskScheduler scheduler(2);
+  std::atomic<bool> started(false);
+  v4r::TaskGroup group(scheduler);
+  group.run([&] {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  });
+  while (!started)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  const double cpu_begin = threadCpuSeconds();
+  group.wait();
+  CHECK_LT(threadCpuSeconds() - cpu_begin, 0.1);
+}
+
+// with one thread everything runs in the calling thread
+void testSingleThread() {
+  v4r::TaskScheduler scheduler(1);
+  CHECK_EQ(scheduler.numThreads(), 1u);
+  const std::thread::id caller = std::this_thread::get_id();
+  bool all_in_caller = true;
+  v4r::parallelFor(0, 1000, [&](size_t) { all_in_caller = all_in_caller && std::this_thread::get_id() == caller; }, 0,
+                   scheduler);
+  v4r::TaskGroup group(scheduler);
+  group.run([&] { all_in_caller = all_in_caller && std::this_thread::get_id() == caller; });
+  group.wait();
+  CHECK(all_in_caller);
+
+  testNestedParallelFor(scheduler);
+  testExceptionPropagation(scheduler);
+}
+
+}  // namespace
+
+int main() {
+  v4r::TaskScheduler scheduler(4);
+  CHECK_EQ(scheduler.numThreads(), 4u);
+  testParallelFor(scheduler);
+  testNestedParallelFor(scheduler);
+  testExceptionPropagation(scheduler);
+  testWaitOnlyRunsOwnTasks();
+  testWaitDoesNotSpin();
+  testSingleThread();
+
+  // ctest runs this test a second time with V4R_NUM_THREADS=1
+  const char *env = std::getenv("V4R_NUM_THREADS");
+  if (env) {
+    CHECK_EQ(v4r::TaskScheduler::global().numThreads(), static_cast<size_t>(std::atoi(env)));
+    testParallelFor(v4r::TaskScheduler::global());
+    testNestedParallelFor(v4r::TaskScheduler::global());
+    testExceptionPropagation(v4r::TaskScheduler::global());
+  }
+  return 0;
+}